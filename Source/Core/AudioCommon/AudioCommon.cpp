@@ -68,9 +68,12 @@ namespace AudioCommon
 			{
 				if (SConfig::GetInstance().m_DumpAudio)
 				{
-					std::string audio_file_name = File::GetUserPath(D_DUMPAUDIO_IDX) + "audiodump.wav";
-					File::CreateFullPath(audio_file_name);
-					mixer->StartLogAudio(audio_file_name);
+					std::string audio_file_name_dtk = File::GetUserPath(D_DUMPAUDIO_IDX) + "dtkdump.wav";
+					std::string audio_file_name_dsp = File::GetUserPath(D_DUMPAUDIO_IDX) + "dspdump.wav";
+					File::CreateFullPath(audio_file_name_dtk);
+					File::CreateFullPath(audio_file_name_dsp);
+					mixer->StartLogDTKAudio(audio_file_name_dtk);
+					mixer->StartLogDSPAudio(audio_file_name_dsp);
 				}
 
 				return soundStream;
@@ -93,8 +96,10 @@ namespace AudioCommon
 		{
 			soundStream->Stop();
 			if (SConfig::GetInstance().m_DumpAudio)
-				soundStream->GetMixer()->StopLogAudio();
-				//soundStream->StopLogAudio();
+			{
+				soundStream->GetMixer()->StopLogDTKAudio();
+				soundStream->GetMixer()->StopLogDSPAudio();
+			}
 			delete soundStream;
 			soundStream = nullptr;
 		}
@@ -2,6 +2,9 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cmath>
+
 #include "AudioCommon/AudioCommon.h"
 #include "AudioCommon/Mixer.h"
 #include "Common/Atomic.h"
@@ -15,15 +18,161 @@
 // UGLINESS
 #include "Core/PowerPC/PowerPC.h"
 
-#if _M_SSE >= 0x301 && !(defined __GNUC__ && !defined __SSSE3__)
-#include <tmmintrin.h>
+#if _M_SSE >= 0x200
+#include <emmintrin.h>
 #endif
 
-// Executed from sound stream thread
-unsigned int CMixer::MixerFifo::Mix(short* samples, unsigned int numSamples, bool consider_framelimit)
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Kaiser windowed sinc filter in 2.14 fixed point, one set of taps per phase.
+// The taps are stored in pairs as c0 c1 c0 c1, so that one pmaddwd filters
+// both channels of two stereo samples.
+static GC_ALIGNED16(s16 s_resampler_filter[RESAMPLER_PHASES][RESAMPLER_TAPS * 2]);
+
+static double BesselI0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; ++k)
+	{
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+static void InitResamplerFilter()
+{
+	// For 32 kHz input this is flat up to 14 kHz and rejects images above
+	// 17 kHz by about 60dB.
+	const double cutoff = 0.95;
+	const double beta = 5.65;
+	const double half = RESAMPLER_TAPS / 2;
+
+	for (int phase = 0; phase < RESAMPLER_PHASES; ++phase)
+	{
+		// The output sample lies between taps half - 1 and half.
+		double frac = (double)phase / RESAMPLER_PHASES;
+		double coefs[RESAMPLER_TAPS];
+		double sum = 0.0;
+		for (int tap = 0; tap < RESAMPLER_TAPS; ++tap)
+		{
+			double x = tap - (half - 1) - frac;
+			double w = x / half;
+			double window = w * w < 1.0 ? BesselI0(beta * sqrt(1.0 - w * w)) / BesselI0(beta) : 0.0;
+			double sinc = x == 0.0 ? 1.0 : sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+			coefs[tap] = sinc * window;
+			sum += coefs[tap];
+		}
+
+		// Normalize to unity gain, and keep it exact after rounding so that
+		// constant input stays constant.
+		int quantized[RESAMPLER_TAPS];
+		int total = 0;
+		int largest = 0;
+		for (int tap = 0; tap < RESAMPLER_TAPS; ++tap)
+		{
+			quantized[tap] = (int)floor(coefs[tap] / sum * (1 << 14) + 0.5);
+			total += quantized[tap];
+			if (quantized[tap] > quantized[largest])
+				largest = tap;
+		}
+		quantized[largest] += (1 << 14) - total;
+
+		for (int tap = 0; tap < RESAMPLER_TAPS; tap += 2)
+		{
+			s16* pair = &s_resampler_filter[phase][tap * 2];
+			pair[0] = pair[2] = quantized[tap];
+			pair[1] = pair[3] = quantized[tap + 1];
+		}
+	}
+}
+
+void CMixer::ResampleSampleScalar(const short* input, u32 phase, int* left, int* right)
 {
-	unsigned int currentSample = 0;
+	const s16* filter = s_resampler_filter[phase];
+	int l = 0;
+	int r = 0;
+	for (int i = 0; i < RESAMPLER_TAPS * 2; i += 4)
+	{
+		l += input[i] * filter[i] + input[i + 2] * filter[i + 1];
+		r += input[i + 1] * filter[i] + input[i + 3] * filter[i + 1];
+	}
+	*left = (l + (1 << 13)) >> 14;
+	*right = (r + (1 << 13)) >> 14;
+}
 
+void CMixer::ResampleSample(const short* input, u32 phase, int* left, int* right)
+{
+#if _M_SSE >= 0x200
+	const s16* filter = s_resampler_filter[phase];
+	__m128i acc = _mm_setzero_si128();
+	for (int i = 0; i < RESAMPLER_TAPS * 2; i += 8)
+	{
+		// l0 r0 l1 r1 l2 r2 l3 r3 -> l0 l1 r0 r1 l2 l3 r2 r3
+		__m128i s = _mm_loadu_si128((const __m128i*)(input + i));
+		s = _mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 1, 2, 0));
+		s = _mm_shufflehi_epi16(s, _MM_SHUFFLE(3, 1, 2, 0));
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(s, _mm_load_si128((const __m128i*)(filter + i))));
+	}
+	acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 8));
+	*left = (_mm_cvtsi128_si32(acc) + (1 << 13)) >> 14;
+	*right = (_mm_cvtsi128_si32(_mm_srli_si128(acc, 4)) + (1 << 13)) >> 14;
+#else
+	ResampleSampleScalar(input, phase, left, right);
+#endif
+}
+
+// Adds count resampled stereo samples to the mix, scaled by the volumes.
+// The fifos hand their pairs to the output swapped, so the right channel
+// comes first.
+static void AddWithVolume(int* samples, const int* resampled, unsigned int count, s32 lvolume, s32 rvolume)
+{
+	unsigned int i = 0;
+	count *= 2;
+#if _M_SSE >= 0x200
+	// There is no 32 bit multiply before SSE4.1, so the even and odd lanes
+	// are multiplied separately and put back together.
+	const __m128i volume = _mm_setr_epi32(rvolume, lvolume, rvolume, lvolume);
+	const __m128i volume_odd = _mm_srli_epi64(volume, 32);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i in = _mm_loadu_si128((const __m128i*)(resampled + i));
+		__m128i even = _mm_mul_epu32(in, volume);
+		__m128i odd = _mm_mul_epu32(_mm_srli_epi64(in, 32), volume_odd);
+		__m128i scaled = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(3, 1, 2, 0)),
+		                                    _mm_shuffle_epi32(odd, _MM_SHUFFLE(3, 1, 2, 0)));
+		__m128i out = _mm_loadu_si128((const __m128i*)(samples + i));
+		out = _mm_add_epi32(out, _mm_srai_epi32(scaled, 8));
+		_mm_storeu_si128((__m128i*)(samples + i), out);
+	}
+#endif
+	for (; i < count; i += 2)
+	{
+		samples[i] += (resampled[i] * rvolume) >> 8;
+		samples[i + 1] += (resampled[i + 1] * lvolume) >> 8;
+	}
+}
+
+CMixer::CMixer(unsigned int BackendSampleRate)
+	: m_dma_mixer(this, 32000)
+	, m_streaming_mixer(this, 48000)
+	, m_wiimote_speaker_mixer(this, 3000)
+	, m_sampleRate(BackendSampleRate)
+	, m_log_dtk_audio(false)
+	, m_log_dsp_audio(false)
+	, m_reported_underruns(0)
+	, m_speed(0)
+{
+	InitResamplerFilter();
+	INFO_LOG(AUDIO_INTERFACE, "Mixer is initialized");
+}
+
+// Executed from sound stream thread
+void CMixer::MixerFifo::Mix(int* samples, unsigned int numSamples, bool consider_framelimit)
+{
 	// Cache access in non-volatile variable
 	// This is the only function changing the read value, so it's safe to
 	// cache it locally although it's written here.
@@ -32,76 +181,98 @@ unsigned int CMixer::MixerFifo::Mix(short* samples, unsigned int numSamples, boo
 	// Without this cache, the compiler wouldn't be allowed to optimize the
 	// interpolation loop.
 	u32 indexR = Common::AtomicLoad(m_indexR);
-	u32 indexW = Common::AtomicLoad(m_indexW);
+	u32 indexW = Common::AtomicLoadAcquire(m_indexW);
 
-	float numLeft = (float)(((indexW - indexR) & INDEX_MASK) / 2);
-	m_numLeftI = (numLeft + m_numLeftI*(CONTROL_AVG-1)) / CONTROL_AVG;
-	float offset = (m_numLeftI - LOW_WATERMARK) * CONTROL_FACTOR;
+	u32 numLeft = ((indexW - indexR) & INDEX_MASK) / 2;
+	m_numLeftI = ((s32)numLeft * 256 + m_numLeftI * (CONTROL_AVG - 1)) / CONTROL_AVG;
+	s32 offset = (m_numLeftI - LOW_WATERMARK * 256) / (CONTROL_DIVISOR * 256);
 	if (offset > MAX_FREQ_SHIFT) offset = MAX_FREQ_SHIFT;
 	if (offset < -MAX_FREQ_SHIFT) offset = -MAX_FREQ_SHIFT;
 
-	//render numleft sample pairs to samples[]
-	//advance indexR with sample position
-	//remember fractional offset
-
-	u32 framelimit = SConfig::GetInstance().m_Framelimit;
-	float aid_sample_rate = m_input_sample_rate + offset;
-	if (consider_framelimit && framelimit > 1)
+	u64 aid_sample_rate = (u64)((s32)m_input_sample_rate + offset);
+	if (consider_framelimit)
 	{
-		aid_sample_rate = aid_sample_rate * (framelimit - 1) * 5 / VideoInterface::TargetRefreshRate;
+		u32 framelimit = SConfig::GetInstance().m_Framelimit;
+		if (framelimit > 1)
+			aid_sample_rate = aid_sample_rate * (framelimit - 1) * 5 / VideoInterface::TargetRefreshRate;
 	}
 
-	const u32 ratio = (u32)( 65536.0f * aid_sample_rate / (float)m_mixer->m_sampleRate );
+	const u32 ratio = (u32)((aid_sample_rate << 16) / m_mixer->m_sampleRate);
 
 	s32 lvolume = m_LVolume;
 	s32 rvolume = m_RVolume;
 
-	// TODO: consider a higher-quality resampling algorithm.
-	for (; currentSample < numSamples*2 && ((indexW-indexR) & INDEX_MASK) > 2; currentSample+=2)
+	// Output sample i is filtered from the input samples starting at
+	// (m_frac + i * ratio) >> 16, so work out up front how many can be
+	// rendered before the fifo runs dry.
+	unsigned int count = 0;
+	if (numLeft >= RESAMPLER_TAPS)
 	{
-		u32 indexR2 = indexR + 2; //next sample
-
-		s16 l1 = Common::swap16(m_buffer[indexR & INDEX_MASK]); //current
-		s16 l2 = Common::swap16(m_buffer[indexR2 & INDEX_MASK]); //next
-		int sampleL = ((l1 << 16) + (l2 - l1) * (u16)m_frac)  >> 16;
-		sampleL = (sampleL * lvolume) >> 8;
-		sampleL += samples[currentSample + 1];
-		MathUtil::Clamp(&sampleL, -32767, 32767);
-		samples[currentSample+1] = sampleL;
-
-		s16 r1 = Common::swap16(m_buffer[(indexR + 1) & INDEX_MASK]); //current
-		s16 r2 = Common::swap16(m_buffer[(indexR2 + 1) & INDEX_MASK]); //next
-		int sampleR = ((r1 << 16) + (r2 - r1) * (u16)m_frac)  >> 16;
-		sampleR = (sampleR * rvolume) >> 8;
-		sampleR += samples[currentSample];
-		MathUtil::Clamp(&sampleR, -32767, 32767);
-		samples[currentSample] = sampleR;
+		u64 last_start = ((u64)(numLeft - RESAMPLER_TAPS) << 16) + 0xFFFF - m_frac;
+		count = ratio ? (unsigned int)std::min<u64>(last_start / ratio + 1, numSamples) : numSamples;
+	}
 
-		m_frac += ratio;
-		indexR += 2 * (u16)(m_frac >> 16);
-		m_frac &= 0xffff;
+	// Resampled in chunks, and the volume is applied to a whole chunk.
+	const unsigned int chunk_size = 128;
+	int resampled[chunk_size * 2];
+	u32 pos = m_frac;
+	int left = m_last[0];
+	int right = m_last[1];
+	for (unsigned int done = 0; done < count; )
+	{
+		unsigned int chunk = std::min(count - done, chunk_size);
+		for (unsigned int i = 0; i < chunk; ++i, pos += ratio)
+		{
+			const short* input = &m_buffer[(indexR + (pos >> 16) * 2) & INDEX_MASK];
+			ResampleSample(input, ((pos & 0xFFFF) * RESAMPLER_PHASES) >> 16, &resampled[i * 2 + 1], &resampled[i * 2]);
+		}
+		AddWithVolume(samples + done * 2, resampled, chunk, lvolume, rvolume);
+		left = resampled[chunk * 2 - 1];
+		right = resampled[chunk * 2 - 2];
+		done += chunk;
 	}
+	indexR += (pos >> 16) * 2;
+	m_frac = pos & 0xFFFF;
+	m_last[0] = left;
+	m_last[1] = right;
 
 	// Padding
-	short s[2];
-	s[0] = Common::swap16(m_buffer[(indexR - 1) & INDEX_MASK]);
-	s[1] = Common::swap16(m_buffer[(indexR - 2) & INDEX_MASK]);
-	s[0] = (s[0] * rvolume) >> 8;
-	s[1] = (s[1] * lvolume) >> 8;
-	for (; currentSample < numSamples * 2; currentSample += 2)
+	if (count < numSamples)
 	{
-		int sampleR = s[0] + samples[currentSample];
-		MathUtil::Clamp(&sampleR, -32767, 32767);
-		samples[currentSample] = sampleR;
-		int sampleL = s[1] + samples[currentSample + 1];
-		MathUtil::Clamp(&sampleL, -32767, 32767);
-		samples[currentSample + 1] = sampleL;
+		Common::AtomicIncrement(m_underruns);
+		int sampleL = (left * lvolume) >> 8;
+		int sampleR = (right * rvolume) >> 8;
+		for (unsigned int i = count; i < numSamples; ++i)
+		{
+			samples[i * 2] += sampleR;
+			samples[i * 2 + 1] += sampleL;
+		}
 	}
 
 	// Flush cached variable
-	Common::AtomicStore(m_indexR, indexR);
+	Common::AtomicStoreRelease(m_indexR, indexR);
+}
 
-	return numSamples;
+// Clamps the mixed samples to 16 bits.
+static void ClampSamples(short* samples, const int* mixed, unsigned int count)
+{
+	unsigned int i = 0;
+#if _M_SSE >= 0x200
+	const __m128i min = _mm_set1_epi16(-32767);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i lo = _mm_loadu_si128((const __m128i*)(mixed + i));
+		__m128i hi = _mm_loadu_si128((const __m128i*)(mixed + i + 4));
+		__m128i packed = _mm_max_epi16(_mm_packs_epi32(lo, hi), min);
+		_mm_storeu_si128((__m128i*)(samples + i), packed);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		int sample = mixed[i];
+		MathUtil::Clamp(&sample, -32767, 32767);
+		samples[i] = sample;
+	}
 }
 
 unsigned int CMixer::Mix(short* samples, unsigned int num_samples, bool consider_framelimit)
@@ -111,23 +282,31 @@ unsigned int CMixer::Mix(short* samples, unsigned int num_samples, bool consider
 
 	std::lock_guard<std::mutex> lk(m_csMixing);
 
-	memset(samples, 0, num_samples * 2 * sizeof(short));
-
 	if (PowerPC::GetState() != PowerPC::CPU_RUNNING)
 	{
 		// Silence
+		memset(samples, 0, num_samples * 2 * sizeof(short));
 		return num_samples;
 	}
 
-	m_dma_mixer.Mix(samples, num_samples, consider_framelimit);
-	m_streaming_mixer.Mix(samples, num_samples, consider_framelimit);
-	m_wiimote_speaker_mixer.Mix(samples, num_samples, consider_framelimit);
-	if (m_logAudio)
-		g_wave_writer.AddStereoSamples(samples, num_samples);
+	m_accumulator.assign(num_samples * 2, 0);
+	m_dma_mixer.Mix(&m_accumulator[0], num_samples, consider_framelimit);
+	m_streaming_mixer.Mix(&m_accumulator[0], num_samples, consider_framelimit);
+	m_wiimote_speaker_mixer.Mix(&m_accumulator[0], num_samples, consider_framelimit);
+	ClampSamples(samples, &m_accumulator[0], num_samples * 2);
+
 	return num_samples;
 }
 
-void CMixer::MixerFifo::PushSamples(const short *samples, unsigned int num_samples)
+unsigned int CMixer::GetNewUnderruns()
+{
+	unsigned int underruns = GetUnderruns();
+	unsigned int new_underruns = underruns - m_reported_underruns;
+	m_reported_underruns = underruns;
+	return new_underruns;
+}
+
+void CMixer::MixerFifo::PushSamples(const short *samples, unsigned int num_samples, bool swap)
 {
 	// Cache access in non-volatile variable
 	// indexR isn't allowed to cache in the audio throttling loop as it
@@ -136,36 +315,42 @@ void CMixer::MixerFifo::PushSamples(const short *samples, unsigned int num_sampl
 
 	// Check if we have enough free space
 	// indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW
-	if (num_samples * 2 + ((indexW - Common::AtomicLoad(m_indexR)) & INDEX_MASK) >= MAX_SAMPLES * 2)
+	if (num_samples * 2 + ((indexW - Common::AtomicLoadAcquire(m_indexR)) & INDEX_MASK) >= MAX_SAMPLES * 2)
 		return;
 
 	// AyuanX: Actual re-sampling work has been moved to sound thread
 	// to alleviate the workload on main thread
 	// and we simply store raw data here to make fast mem copy
-	int over_bytes = num_samples * 4 - (MAX_SAMPLES * 2 - (indexW & INDEX_MASK)) * sizeof(short);
-	if (over_bytes > 0)
-	{
-		memcpy(&m_buffer[indexW & INDEX_MASK], samples, num_samples * 4 - over_bytes);
-		memcpy(&m_buffer[0], samples + (num_samples * 4 - over_bytes) / sizeof(short), over_bytes);
-	}
-	else
+	u32 start = indexW & INDEX_MASK;
+	u32 count = num_samples * 2;
+	for (u32 i = 0; i < count; ++i)
 	{
-		memcpy(&m_buffer[indexW & INDEX_MASK], samples, num_samples * 4);
+		short sample = swap ? Common::swap16(samples[i]) : samples[i];
+		m_buffer[(start + i) & INDEX_MASK] = sample;
 	}
 
-	Common::AtomicAdd(m_indexW, num_samples * 2);
+	// Repeat whatever was written to the start of the buffer after its end.
+	const u32 guard = RESAMPLER_TAPS * 2;
+	if (start < guard)
+		memcpy(&m_buffer[MAX_SAMPLES * 2 + start], &m_buffer[start], (std::min(start + count, guard) - start) * sizeof(short));
+	if (start + count > MAX_SAMPLES * 2)
+		memcpy(&m_buffer[MAX_SAMPLES * 2], &m_buffer[0], std::min(start + count - MAX_SAMPLES * 2, guard) * sizeof(short));
 
-	return;
+	Common::AtomicStoreRelease(m_indexW, indexW + count);
 }
 
 void CMixer::PushSamples(const short *samples, unsigned int num_samples)
 {
-	m_dma_mixer.PushSamples(samples, num_samples);
+	m_dma_mixer.PushSamples(samples, num_samples, true);
+	if (m_log_dsp_audio)
+		m_wave_writer_dsp.AddStereoSamplesBE(samples, num_samples);
 }
 
 void CMixer::PushStreamingSamples(const short *samples, unsigned int num_samples)
 {
-	m_streaming_mixer.PushSamples(samples, num_samples);
+	m_streaming_mixer.PushSamples(samples, num_samples, false);
+	if (m_log_dtk_audio)
+		m_wave_writer_dtk.AddStereoSamplesRL(samples, num_samples);
 }
 
 void CMixer::PushWiimoteSpeakerSamples(const short *samples, unsigned int num_samples, unsigned int sample_rate)
@@ -178,22 +363,32 @@ void CMixer::PushWiimoteSpeakerSamples(const short *samples, unsigned int num_sa
 
 		for (unsigned int i = 0; i < num_samples; ++i)
 		{
-			samples_stereo[i * 2] = Common::swap16(samples[i]);
-			samples_stereo[i * 2 + 1] = Common::swap16(samples[i]);
+			samples_stereo[i * 2] = samples[i];
+			samples_stereo[i * 2 + 1] = samples[i];
 		}
 
-		m_wiimote_speaker_mixer.PushSamples(samples_stereo, num_samples);
+		m_wiimote_speaker_mixer.PushSamples(samples_stereo, num_samples, false);
 	}
 }
 
 void CMixer::SetDMAInputSampleRate(unsigned int rate)
 {
 	m_dma_mixer.SetInputSampleRate(rate);
+	if (m_log_dsp_audio && !m_wave_writer_dsp.SetSampleRate(rate))
+	{
+		m_log_dsp_audio = false;
+		ERROR_LOG(DSPHLE, "Stopping DSP Audio logging");
+	}
 }
 
 void CMixer::SetStreamInputSampleRate(unsigned int rate)
 {
 	m_streaming_mixer.SetInputSampleRate(rate);
+	if (m_log_dtk_audio && !m_wave_writer_dtk.SetSampleRate(rate))
+	{
+		m_log_dtk_audio = false;
+		ERROR_LOG(DSPHLE, "Stopping DTK Audio logging");
+	}
 }
 
 void CMixer::SetStreamingVolume(unsigned int lvolume, unsigned int rvolume)
@@ -216,3 +411,65 @@ void CMixer::MixerFifo::SetVolume(unsigned int lvolume, unsigned int rvolume)
 	m_LVolume = lvolume + (lvolume >> 7);
 	m_RVolume = rvolume + (rvolume >> 7);
 }
+
+void CMixer::StartLogDTKAudio(const std::string& filename)
+{
+	if (!m_log_dtk_audio)
+	{
+		m_log_dtk_audio = m_wave_writer_dtk.Start(filename, m_streaming_mixer.GetInputSampleRate());
+		m_wave_writer_dtk.SetSkipSilence(false);
+		NOTICE_LOG(DSPHLE, "Starting DTK Audio logging");
+	}
+	else
+	{
+		WARN_LOG(DSPHLE, "DTK Audio logging has already been started");
+	}
+}
+
+void CMixer::StopLogDTKAudio()
+{
+	if (m_log_dtk_audio)
+	{
+		m_log_dtk_audio = false;
+		m_wave_writer_dtk.Stop();
+		NOTICE_LOG(DSPHLE, "Stopping DTK Audio logging");
+	}
+	else
+	{
+		WARN_LOG(DSPHLE, "DTK Audio logging has already been stopped");
+	}
+}
+
+void CMixer::StartLogDSPAudio(const std::string& filename)
+{
+	if (!m_log_dsp_audio)
+	{
+		m_log_dsp_audio = m_wave_writer_dsp.Start(filename, m_dma_mixer.GetInputSampleRate());
+		m_wave_writer_dsp.SetSkipSilence(false);
+		NOTICE_LOG(DSPHLE, "Starting DSP Audio logging");
+	}
+	else
+	{
+		WARN_LOG(DSPHLE, "DSP Audio logging has already been started");
+	}
+}
+
+void CMixer::StopLogDSPAudio()
+{
+	if (m_log_dsp_audio)
+	{
+		m_log_dsp_audio = false;
+		m_wave_writer_dsp.Stop();
+		NOTICE_LOG(DSPHLE, "Stopping DSP Audio logging");
+	}
+	else
+	{
+		WARN_LOG(DSPHLE, "DSP Audio logging has already been stopped");
+	}
+}
+
+unsigned int CMixer::MixerFifo::GetLatencyMs() const
+{
+	u32 num_samples = ((m_indexW - m_indexR) & INDEX_MASK) / 2;
+	return m_input_sample_rate ? num_samples * 1000 / m_input_sample_rate : 0;
+}
@@ -6,6 +6,7 @@
 
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "AudioCommon/WaveFile.h"
 
@@ -15,22 +16,17 @@
 
 #define LOW_WATERMARK   1280 // 40 ms
 #define MAX_FREQ_SHIFT  200  // per 32000 Hz
-#define CONTROL_FACTOR  0.2f // in freq_shift per fifo size offset
+#define CONTROL_DIVISOR 5    // in fifo size offset per freq_shift
 #define CONTROL_AVG     32
 
+// Windowed sinc resampler
+#define RESAMPLER_TAPS   32  // input samples per output sample
+#define RESAMPLER_PHASES 256 // filters between two input samples
+
 class CMixer {
 
 public:
-	CMixer(unsigned int BackendSampleRate)
-		: m_dma_mixer(this, 32000)
-		, m_streaming_mixer(this, 48000)
-		, m_wiimote_speaker_mixer(this, 3000)
-		, m_sampleRate(BackendSampleRate)
-		, m_logAudio(0)
-		, m_speed(0)
-	{
-		INFO_LOG(AUDIO_INTERFACE, "Mixer is initialized");
-	}
+	CMixer(unsigned int BackendSampleRate);
 
 	virtual ~CMixer() {}
 
@@ -38,44 +34,31 @@ public:
 	virtual unsigned int Mix(short* samples, unsigned int numSamples, bool consider_framelimit = true);
 
 	// Called from main thread
+	// DMA samples are big endian, as they are in emulated memory. Streaming
+	// and Wiimote speaker samples are in host byte order.
 	virtual void PushSamples(const short* samples, unsigned int num_samples);
 	virtual void PushStreamingSamples(const short* samples, unsigned int num_samples);
 	virtual void PushWiimoteSpeakerSamples(const short* samples, unsigned int num_samples, unsigned int sample_rate);
 	unsigned int GetSampleRate() const { return m_sampleRate; }
 
+	// Buffered DMA audio, and the number of mixes that ran out of it.
+	unsigned int GetLatencyMs() const { return m_dma_mixer.GetLatencyMs(); }
+	unsigned int GetUnderruns() const { return m_dma_mixer.GetUnderruns(); }
+	// Underruns since the last call, for reporting them as they happen.
+	unsigned int GetNewUnderruns();
+
 	void SetDMAInputSampleRate(unsigned int rate);
 	void SetStreamInputSampleRate(unsigned int rate);
 	void SetStreamingVolume(unsigned int lvolume, unsigned int rvolume);
 	void SetWiimoteSpeakerVolume(unsigned int lvolume, unsigned int rvolume);
 
-	virtual void StartLogAudio(const std::string& filename)
-	{
-		if (! m_logAudio)
-		{
-			m_logAudio = true;
-			g_wave_writer.Start(filename, GetSampleRate());
-			g_wave_writer.SetSkipSilence(false);
-			NOTICE_LOG(DSPHLE, "Starting Audio logging");
-		}
-		else
-		{
-			WARN_LOG(DSPHLE, "Audio logging has already been started");
-		}
-	}
+	// Dumps the samples as they are pushed, in emulated time and at the
+	// input sample rate, so that they line up with frame dumps.
+	void StartLogDTKAudio(const std::string& filename);
+	void StopLogDTKAudio();
 
-	virtual void StopLogAudio()
-	{
-		if (m_logAudio)
-		{
-			m_logAudio = false;
-			g_wave_writer.Stop();
-			NOTICE_LOG(DSPHLE, "Stopping Audio logging");
-		}
-		else
-		{
-			WARN_LOG(DSPHLE, "Audio logging has already been stopped");
-		}
-	}
+	void StartLogDSPAudio(const std::string& filename);
+	void StopLogDSPAudio();
 
 	std::mutex& MixerCritical() { return m_csMixing; }
 
@@ -83,6 +66,11 @@ public:
 	void UpdateSpeed(volatile float val) { m_speed = val; }
 
 protected:
+	// Filters RESAMPLER_TAPS stereo samples starting at input with the
+	// filter for the given phase, one of RESAMPLER_PHASES.
+	static void ResampleSample(const short* input, u32 phase, int* left, int* right);
+	static void ResampleSampleScalar(const short* input, u32 phase, int* left, int* right);
+
 	class MixerFifo {
 	public:
 		MixerFifo(CMixer *mixer, unsigned sample_rate)
@@ -92,35 +80,53 @@ protected:
 			, m_indexR(0)
 			, m_LVolume(256)
 			, m_RVolume(256)
-			, m_numLeftI(0.0f)
+			, m_numLeftI(0)
 			, m_frac(0)
+			, m_underruns(0)
 		{
 			memset(m_buffer, 0, sizeof(m_buffer));
+			m_last[0] = m_last[1] = 0;
 		}
-		void PushSamples(const short* samples, unsigned int num_samples);
-		unsigned int Mix(short* samples, unsigned int numSamples, bool consider_framelimit = true);
+		void PushSamples(const short* samples, unsigned int num_samples, bool swap);
+		void Mix(int* samples, unsigned int numSamples, bool consider_framelimit = true);
 		void SetInputSampleRate(unsigned int rate);
 		void SetVolume(unsigned int lvolume, unsigned int rvolume);
+		unsigned int GetLatencyMs() const;
+		unsigned int GetUnderruns() const { return m_underruns; }
+		unsigned int GetInputSampleRate() const { return m_input_sample_rate; }
 	private:
 		CMixer *m_mixer;
 		unsigned m_input_sample_rate;
-		short m_buffer[MAX_SAMPLES * 2];
+		// Host byte order. The first RESAMPLER_TAPS samples are repeated after
+		// the end so that the resampler never has to wrap around.
+		short m_buffer[(MAX_SAMPLES + RESAMPLER_TAPS) * 2];
 		volatile u32 m_indexW;
 		volatile u32 m_indexR;
 		// Volume ranges from 0-256
 		volatile s32 m_LVolume;
 		volatile s32 m_RVolume;
-		float m_numLeftI;
+		// Average fifo size in 1/256 samples
+		s32 m_numLeftI;
 		u32 m_frac;
+		// Last resampled sample, repeated when the fifo runs dry
+		int m_last[2];
+		volatile u32 m_underruns;
 	};
 	MixerFifo m_dma_mixer;
 	MixerFifo m_streaming_mixer;
 	MixerFifo m_wiimote_speaker_mixer;
 	unsigned int m_sampleRate;
 
-	WaveFileWriter g_wave_writer;
+	// The fifos are mixed here before clamping to 16 bits.
+	std::vector<int> m_accumulator;
+
+	WaveFileWriter m_wave_writer_dtk;
+	WaveFileWriter m_wave_writer_dsp;
+
+	bool m_log_dtk_audio;
+	bool m_log_dsp_audio;
 
-	bool m_logAudio;
+	unsigned int m_reported_underruns;
 
 	std::mutex m_csMixing;
 
@@ -2,32 +2,43 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
 #include <string>
 
 #include "AudioCommon/WaveFile.h"
+#include "Common/Atomic.h"
 #include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
 #include "Core/ConfigManager.h"
 
-enum {BUF_SIZE = 32*1024};
+enum
+{
+	RING_SIZE = 1024 * 1024,  // in shorts, about 5 seconds of 48 kHz audio
+	RING_MASK = RING_SIZE - 1,
+	WRITE_CHUNK = 64 * 1024,  // wake the writer once this many shorts are pending
+};
 
 WaveFileWriter::WaveFileWriter():
 	skip_silence(false),
 	audio_size(0),
-	conv_buffer(nullptr)
+	sample_rate(0),
+	file_index(0),
+	ring(nullptr),
+	write_index(0),
+	read_index(0)
 {
 }
 
 WaveFileWriter::~WaveFileWriter()
 {
-	delete [] conv_buffer;
 	Stop();
+	delete [] ring;
 }
 
 bool WaveFileWriter::Start(const std::string& filename, unsigned int HLESampleRate)
 {
-	if (!conv_buffer)
-		conv_buffer = new short[BUF_SIZE];
-
 	// Check if the file is already open
 	if (file)
 	{
@@ -35,6 +46,36 @@ bool WaveFileWriter::Start(const std::string& filename, unsigned int HLESampleRa
 		return false;
 	}
 
+	basename = filename.substr(0, filename.find_last_of('.'));
+	file_index = 0;
+	sample_rate = HLESampleRate;
+	return Open(filename);
+}
+
+void WaveFileWriter::Stop()
+{
+	if (file)
+		Close();
+}
+
+bool WaveFileWriter::SetSampleRate(unsigned int rate)
+{
+	if (rate == sample_rate)
+		return true;
+
+	sample_rate = rate;
+	if (!file)
+		return true;
+
+	Close();
+	return Open(StringFromFormat("%s%u.wav", basename.c_str(), ++file_index));
+}
+
+bool WaveFileWriter::Open(const std::string& filename)
+{
+	if (!ring)
+		ring = new short[RING_SIZE];
+
 	file.Open(filename, "wb");
 	if (!file)
 	{
@@ -55,7 +96,6 @@ bool WaveFileWriter::Start(const std::string& filename, unsigned int HLESampleRa
 	Write(16);  // size of fmt block
 	Write(0x00020001); //two channels, uncompressed
 
-	const u32 sample_rate = HLESampleRate;
 	Write(sample_rate);
 	Write(sample_rate * 2 * 2); //two channels, 16bit
 
@@ -67,12 +107,21 @@ bool WaveFileWriter::Start(const std::string& filename, unsigned int HLESampleRa
 	if (file.Tell() != 44)
 		PanicAlert("Wrong offset: %lld", (long long)file.Tell());
 
+	write_index = 0;
+	read_index = 0;
+	writer_thread = std::thread(&WaveFileWriter::WriterThread, this);
+
 	return true;
 }
 
-void WaveFileWriter::Stop()
+void WaveFileWriter::Close()
 {
-	// u32 file_size = (u32)ftello(file);
+	// Let the writer drain the ring before the header is finished.
+	stopping.Set();
+	data_ready.Set();
+	writer_thread.join();
+	stopping.Clear();
+
 	file.Seek(4, SEEK_SET);
 	Write(audio_size + 36);
 
@@ -82,6 +131,36 @@ void WaveFileWriter::Stop()
 	file.Close();
 }
 
+void WaveFileWriter::WriterThread()
+{
+	Common::SetCurrentThreadName("Audio dump writer");
+
+	// Batches of samples are collected until a chunk is pending, but the
+	// dump shouldn't lag the emulation by more than a second either.
+	while (!stopping.IsSet())
+	{
+		data_ready.WaitFor(std::chrono::seconds(1));
+		Flush();
+	}
+	Flush();
+}
+
+void WaveFileWriter::Flush()
+{
+	u32 index = read_index;
+	const u32 end = Common::AtomicLoadAcquire(write_index);
+	while (index != end)
+	{
+		u32 start = index & RING_MASK;
+		u32 size = std::min<u32>(end - index, RING_SIZE - start);
+		file.WriteArray(&ring[start], size);
+		index += size;
+	}
+
+	Common::AtomicStoreRelease(read_index, index);
+	space_free.Set();
+}
+
 void WaveFileWriter::Write(u32 value)
 {
 	file.WriteArray(&value, 1);
@@ -92,10 +171,19 @@ void WaveFileWriter::Write4(const char *ptr)
 	file.WriteBytes(ptr, 4);
 }
 
-void WaveFileWriter::AddStereoSamples(const short *sample_data, u32 count)
+void WaveFileWriter::AddSamples(const short *sample_data, u32 count, bool big_endian, bool swap_channels)
 {
 	if (!file)
+	{
 		PanicAlertT("WaveFileWriter - file not open.");
+		return;
+	}
+
+	if (count * 2 > RING_SIZE / 2)
+	{
+		PanicAlert("WaveFileWriter - buffer too small (count = %u).", count);
+		return;
+	}
 
 	if (skip_silence)
 	{
@@ -111,35 +199,48 @@ void WaveFileWriter::AddStereoSamples(const short *sample_data, u32 count)
 			return;
 	}
 
-	file.WriteBytes(sample_data, count * 4);
-	audio_size += count * 4;
-}
-
-void WaveFileWriter::AddStereoSamplesBE(const short *sample_data, u32 count)
-{
-	if (!file)
-		PanicAlertT("WaveFileWriter - file not open.");
-
-	if (count > BUF_SIZE * 2)
-		PanicAlert("WaveFileWriter - buffer too small (count = %u).", count);
-
-	if (skip_silence)
+	// Only wait for the writer thread when the disk can't keep up.
+	const u32 size = count * 2;
+	const u32 index = write_index;
+	while (RING_SIZE - (index - Common::AtomicLoadAcquire(read_index)) < size)
 	{
-		bool all_zero = true;
+		data_ready.Set();
+		space_free.Wait();
+	}
 
-		for (u32 i = 0; i < count * 2; i++)
+	// index is always even, so a frame never straddles the end of the ring.
+	const u32 first = swap_channels ? 1 : 0;
+	for (u32 i = 0; i < count; i++)
+	{
+		u16 left = sample_data[i * 2 + first];
+		u16 right = sample_data[i * 2 + (first ^ 1)];
+		if (big_endian)
 		{
-			if (sample_data[i])
-				all_zero = false;
+			left = Common::swap16(left);
+			right = Common::swap16(right);
 		}
-
-		if (all_zero)
-			return;
+		ring[(index + i * 2) & RING_MASK] = left;
+		ring[(index + i * 2 + 1) & RING_MASK] = right;
 	}
 
-	for (u32 i = 0; i < count * 2; i++)
-		conv_buffer[i] = Common::swap16((u16)sample_data[i]);
+	Common::AtomicStoreRelease(write_index, index + size);
+	audio_size += size * sizeof(short);
+
+	if (index + size - Common::AtomicLoad(read_index) >= WRITE_CHUNK)
+		data_ready.Set();
+}
 
-	file.WriteBytes(conv_buffer, count * 4);
-	audio_size += count * 4;
+void WaveFileWriter::AddStereoSamples(const short *sample_data, u32 count)
+{
+	AddSamples(sample_data, count, false, false);
+}
+
+void WaveFileWriter::AddStereoSamplesBE(const short *sample_data, u32 count)
+{
+	AddSamples(sample_data, count, true, true);
+}
+
+void WaveFileWriter::AddStereoSamplesRL(const short *sample_data, u32 count)
+{
+	AddSamples(sample_data, count, false, true);
 }
@@ -7,16 +7,23 @@
 // Description: Simple utility class to make it easy to write long 16-bit stereo
 // audio streams to disk.
 // Use Start() to start recording to a file, and AddStereoSamples to add wave data.
-// The float variant will convert from -1.0-1.0 range and clamp.
-// Alternatively, AddSamplesBE for big endian wave data.
+// Alternatively, AddStereoSamplesBE for big endian wave data as it is stored in
+// emulated memory (right channel first), and AddStereoSamplesRL for right channel
+// first data in host byte order.
+// Samples are copied into a ring buffer and written to disk in large chunks by a
+// separate thread, so adding samples never waits on the disk unless the ring is full.
 // If Stop is not called when it destructs, the destructor will call Stop().
 // ---------------------------------------------------------------------------------
 
 #pragma once
 
 #include <string>
+#include <thread>
+
 #include "Common/CommonTypes.h"
+#include "Common/Event.h"
 #include "Common/FileUtil.h"
+#include "Common/Flag.h"
 
 class WaveFileWriter : NonCopyable
 {
@@ -29,15 +36,38 @@ public:
 
 	void SetSkipSilence(bool skip) { skip_silence = skip; }
 
+	// A wave file has a single sample rate, so a change continues the dump in
+	// a new numbered file next to the first one. Returns false if that file
+	// could not be opened, which ends the dump.
+	bool SetSampleRate(unsigned int rate);
+
 	void AddStereoSamples(const short *sample_data, u32 count);
-	void AddStereoSamplesBE(const short *sample_data, u32 count);  // big endian
+	void AddStereoSamplesBE(const short *sample_data, u32 count);  // big endian, right channel first
+	void AddStereoSamplesRL(const short *sample_data, u32 count);  // host byte order, right channel first
 	u32 GetAudioSize() const { return audio_size; }
 
 private:
 	File::IOFile file;
 	bool skip_silence;
 	u32 audio_size;
-	short* conv_buffer;
+	unsigned int sample_rate;
+	std::string basename;
+	u32 file_index;
+
+	// Single producer, single consumer ring of interleaved samples, in shorts.
+	short* ring;
+	volatile u32 write_index;
+	volatile u32 read_index;
+	std::thread writer_thread;
+	Common::Event data_ready;
+	Common::Event space_free;
+	Common::Flag stopping;
+
+	bool Open(const std::string& filename);
+	void Close();
+	void AddSamples(const short *sample_data, u32 count, bool big_endian, bool swap_channels);
+	void WriterThread();
+	void Flush();
 	void Write(u32 value);
 	void Write4(const char* ptr);
 };
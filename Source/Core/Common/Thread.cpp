@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "Common/CommonTypes.h"
 #include "Common/Thread.h"
 
@@ -126,4 +128,10 @@ void SetCurrentThreadName(const char* szThreadName)
 
 #endif
 
+u32 GetHelperThreadCount()
+{
+	// don't span to many threads they will kill the rest of the emu :)
+	return std::max((std::thread::hardware_concurrency() + 2) / 3, 1u);
+}
+
 } // namespace Common
@@ -81,4 +81,9 @@ inline void YieldCPU()
 
 void SetCurrentThreadName(const char *name);
 
+// The number of threads a pool of helper threads should use, counting the
+// thread that hands out the work. The CPU and GPU threads need the rest of
+// the host's hardware threads.
+u32 GetHelperThreadCount();
+
 } // namespace Common
@@ -324,10 +324,12 @@ void SConfig::SaveDSPSettings(IniFile& ini)
 	IniFile::Section* dsp = ini.GetOrCreateSection("DSP");
 
 	dsp->Set("EnableJIT", m_DSPEnableJIT);
+	dsp->Set("ThreadMaxSkew", m_DSPThreadMaxSkew);
 	dsp->Set("DumpAudio", m_DumpAudio);
 	dsp->Set("Backend", sBackend);
 	dsp->Set("Volume", m_Volume);
 	dsp->Set("CaptureLog", m_DSPCaptureLog);
+	dsp->Set("JITStats", m_DSPJITStats);
 }
 
 void SConfig::SaveInputSettings(IniFile& ini)
@@ -549,6 +551,7 @@ void SConfig::LoadDSPSettings(IniFile& ini)
 	IniFile::Section* dsp = ini.GetOrCreateSection("DSP");
 
 	dsp->Get("EnableJIT", &m_DSPEnableJIT, true);
+	dsp->Get("ThreadMaxSkew", &m_DSPThreadMaxSkew, 50400);
 	dsp->Get("DumpAudio", &m_DumpAudio, false);
 #if defined __linux__ && HAVE_ALSA
 	dsp->Get("Backend", &sBackend, BACKEND_ALSA);
@@ -563,6 +566,7 @@ void SConfig::LoadDSPSettings(IniFile& ini)
 #endif
 	dsp->Get("Volume", &m_Volume, 100);
 	dsp->Get("CaptureLog", &m_DSPCaptureLog, false);
+	dsp->Get("JITStats", &m_DSPJITStats, false);
 }
 
 void SConfig::LoadInputSettings(IniFile& ini)
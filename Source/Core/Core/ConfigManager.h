@@ -91,7 +91,11 @@ struct SConfig : NonCopyable
 
 	// DSP settings
 	bool m_DSPEnableJIT;
+	// How far, in CPU cycles, the LLE DSP thread may fall behind the CPU.
+	int m_DSPThreadMaxSkew;
 	bool m_DSPCaptureLog;
+	// Count in the DSP JIT code how blocks hand over control.
+	bool m_DSPJITStats;
 	bool m_DumpAudio;
 	int m_Volume;
 	std::string sBackend;
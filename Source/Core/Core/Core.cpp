@@ -676,6 +676,13 @@ void UpdateTitle()
 					SystemTimers::GetTicksPerSecond() / 1000000,
 					_CoreParameter.bSkipIdle ? "~" : "",
 					TicksPercentage);
+
+			if (soundStream)
+			{
+				CMixer* pMixer = soundStream->GetMixer();
+				SFPS += StringFromFormat(" | Audio: %u ms [Underruns: %u]",
+						pMixer->GetLatencyMs(), pMixer->GetUnderruns());
+			}
 		}
 	}
 	// This is our final "frame counter" string
@@ -686,6 +693,13 @@ void UpdateTitle()
 	{
 		CMixer* pMixer = soundStream->GetMixer();
 		pMixer->UpdateSpeed((float)Speed / 100);
+
+		unsigned int underruns = pMixer->GetNewUnderruns();
+		if (underruns)
+		{
+			WARN_LOG(AUDIO, "Audio mixer ran dry %u times since the last update (%u ms buffered)",
+				underruns, pMixer->GetLatencyMs());
+		}
 	}
 
 	Host_UpdateTitle(SMessage);
@@ -2,12 +2,13 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <string>
 #include <vector>
 
 #include "Common/ChunkFile.h"
-#include "Common/FifoQueue.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
 
@@ -22,27 +23,41 @@
 namespace CoreTiming
 {
 
+struct Event
+{
+	s64 time;
+	u64 userdata;
+	int type;
+
+	// Breaks ties between events at the same time, so that they run in the
+	// order they were scheduled in.
+	u64 order;
+	// Where the event is in the heap.
+	size_t heap_index;
+	// The other pending events of the same type.
+	Event* prev_of_type;
+	Event* next_of_type;
+	// Next free event in the pool, or next event in the thread-safe queue.
+	Event* next;
+};
+
 struct EventType
 {
 	TimedCallback callback;
 	std::string name;
+	Event* first_pending;
 };
 
 static std::vector<EventType> event_types;
 
-struct BaseEvent
-{
-	s64 time;
-	u64 userdata;
-	int type;
-};
-
-typedef LinkedListItem<BaseEvent> Event;
-
 // STATE_TO_SAVE
-static Event *first;
-static std::mutex tsWriteLock;
-static Common::FifoQueue<BaseEvent, false> tsQueue;
+// A binary min-heap on (time, order).
+static std::vector<Event*> event_queue;
+static u64 next_order;
+
+// Events scheduled from other threads, pushed onto a lock-free stack that
+// the CPU thread takes all at once in MoveEvents.
+static std::atomic<Event*> ts_queue;
 
 // event pools
 static Event *eventPool = nullptr;
@@ -79,6 +94,93 @@ static void FreeEvent(Event* ev)
 	eventPool = ev;
 }
 
+static bool EventBefore(const Event* a, const Event* b)
+{
+	return a->time < b->time || (a->time == b->time && a->order < b->order);
+}
+
+static void PlaceInQueue(Event* ev, size_t index)
+{
+	event_queue[index] = ev;
+	ev->heap_index = index;
+}
+
+static void SiftUp(Event* ev, size_t index)
+{
+	while (index > 0)
+	{
+		size_t parent = (index - 1) / 2;
+		if (!EventBefore(ev, event_queue[parent]))
+			break;
+		PlaceInQueue(event_queue[parent], index);
+		index = parent;
+	}
+	PlaceInQueue(ev, index);
+}
+
+static void SiftDown(Event* ev, size_t index)
+{
+	size_t size = event_queue.size();
+	for (;;)
+	{
+		size_t child = index * 2 + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && EventBefore(event_queue[child + 1], event_queue[child]))
+			++child;
+		if (!EventBefore(event_queue[child], ev))
+			break;
+		PlaceInQueue(event_queue[child], index);
+		index = child;
+	}
+	PlaceInQueue(ev, index);
+}
+
+static void AddEventToQueue(Event* ne)
+{
+	ne->order = next_order++;
+
+	EventType& type = event_types[ne->type];
+	ne->prev_of_type = nullptr;
+	ne->next_of_type = type.first_pending;
+	if (type.first_pending)
+		type.first_pending->prev_of_type = ne;
+	type.first_pending = ne;
+
+	event_queue.push_back(ne);
+	SiftUp(ne, event_queue.size() - 1);
+}
+
+// Takes the event out of the queue without freeing it.
+static void UnlinkEvent(Event* ev)
+{
+	if (ev->prev_of_type)
+		ev->prev_of_type->next_of_type = ev->next_of_type;
+	else
+		event_types[ev->type].first_pending = ev->next_of_type;
+	if (ev->next_of_type)
+		ev->next_of_type->prev_of_type = ev->prev_of_type;
+
+	Event* last = event_queue.back();
+	event_queue.pop_back();
+	if (last == ev)
+		return;
+
+	size_t index = ev->heap_index;
+	if (index > 0 && EventBefore(last, event_queue[(index - 1) / 2]))
+		SiftUp(last, index);
+	else
+		SiftDown(last, index);
+}
+
+// Returns the pending events, earliest first.
+static std::vector<Event*> GetSortedEvents()
+{
+	std::vector<Event*> events(event_queue);
+	std::sort(events.begin(), events.end(), EventBefore);
+	return events;
+}
+
 static void EmptyTimedCallback(u64 userdata, int cyclesLate) {}
 
 int RegisterEvent(const std::string& name, TimedCallback callback)
@@ -86,6 +188,7 @@ int RegisterEvent(const std::string& name, TimedCallback callback)
 	EventType type;
 	type.name = name;
 	type.callback = callback;
+	type.first_pending = nullptr;
 
 	// check for existing type with same name.
 	// we want event type names to remain unique so that we can use them for serialization.
@@ -107,7 +210,7 @@ int RegisterEvent(const std::string& name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-	if (first)
+	if (!event_queue.empty())
 		PanicAlertT("Cannot unregister events with events pending");
 	event_types.clear();
 }
@@ -118,13 +221,13 @@ void Init()
 	slicelength = maxSliceLength;
 	globalTimer = 0;
 	idledCycles = 0;
+	next_order = 0;
 
 	ev_lost = RegisterEvent("_lost_event", &EmptyTimedCallback);
 }
 
 void Shutdown()
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
 	MoveEvents();
 	ClearPendingEvents();
 	UnregisterAllEvents();
@@ -137,7 +240,7 @@ void Shutdown()
 	}
 }
 
-static void EventDoState(PointerWrap &p, BaseEvent* ev)
+static void EventDoState(PointerWrap &p, Event* ev)
 {
 	p.Do(ev->time);
 
@@ -173,7 +276,6 @@ static void EventDoState(PointerWrap &p, BaseEvent* ev)
 
 void DoState(PointerWrap &p)
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
 	p.Do(slicelength);
 	p.Do(globalTimer);
 	p.Do(idledCycles);
@@ -185,7 +287,34 @@ void DoState(PointerWrap &p)
 
 	MoveEvents();
 
-	p.DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, EventDoState>(first);
+	// The events are stored in time order, each preceded by a 1 byte and
+	// followed by a 0 byte, as the linked list they used to be kept in was.
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		ClearPendingEvents();
+		for (;;)
+		{
+			u8 shouldExist = 0;
+			p.Do(shouldExist);
+			if (shouldExist != 1)
+				break;
+
+			Event* ev = GetNewEvent();
+			EventDoState(p, ev);
+			AddEventToQueue(ev);
+		}
+	}
+	else
+	{
+		for (Event* ev : GetSortedEvents())
+		{
+			u8 shouldExist = 1;
+			p.Do(shouldExist);
+			EventDoState(p, ev);
+		}
+		u8 shouldExist = 0;
+		p.Do(shouldExist);
+	}
 	p.DoMarker("CoreTimingEvents");
 }
 
@@ -203,12 +332,14 @@ u64 GetIdleTicks()
 // schedule things to be executed on the main thread.
 void ScheduleEvent_Threadsafe(int cyclesIntoFuture, int event_type, u64 userdata)
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
-	Event ne;
-	ne.time = globalTimer + cyclesIntoFuture;
-	ne.type = event_type;
-	ne.userdata = userdata;
-	tsQueue.Push(ne);
+	Event* ne = new Event;
+	ne->time = globalTimer + cyclesIntoFuture;
+	ne->type = event_type;
+	ne->userdata = userdata;
+
+	ne->next = ts_queue.load(std::memory_order_relaxed);
+	while (!ts_queue.compare_exchange_weak(ne->next, ne, std::memory_order_release, std::memory_order_relaxed))
+		;
 }
 
 // Same as ScheduleEvent_Threadsafe(0, ...) EXCEPT if we are already on the CPU thread
@@ -227,30 +358,11 @@ void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata)
 
 void ClearPendingEvents()
 {
-	while (first)
-	{
-		Event *e = first->next;
-		FreeEvent(first);
-		first = e;
-	}
-}
-
-static void AddEventToQueue(Event* ne)
-{
-	Event* prev = nullptr;
-	Event** pNext = &first;
-	for (;;)
-	{
-		Event*& next = *pNext;
-		if (!next || ne->time < next->time)
-		{
-			ne->next = next;
-			next = ne;
-			break;
-		}
-		prev = next;
-		pNext = &prev->next;
-	}
+	for (Event* ev : event_queue)
+		FreeEvent(ev);
+	event_queue.clear();
+	for (EventType& type : event_types)
+		type.first_pending = nullptr;
 }
 
 // This must be run ONLY from within the cpu thread
@@ -272,55 +384,15 @@ void RegisterAdvanceCallback(void (*callback)(int cyclesExecuted))
 
 bool IsScheduled(int event_type)
 {
-	if (!first)
-		return false;
-	Event *e = first;
-	while (e)
-	{
-		if (e->type == event_type)
-			return true;
-		e = e->next;
-	}
-	return false;
+	return event_types[event_type].first_pending != nullptr;
 }
 
 void RemoveEvent(int event_type)
 {
-	if (!first)
-		return;
-
-	while (first)
-	{
-		if (first->type == event_type)
-		{
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-
-	if (!first)
-		return;
-
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
+	while (Event* ev = event_types[event_type].first_pending)
 	{
-		if (ptr->type == event_type)
-		{
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
-		}
+		UnlinkEvent(ev);
+		FreeEvent(ev);
 	}
 }
 
@@ -350,40 +422,60 @@ void ResetSliceLength()
 }
 
 
+// Takes the first event out of the queue if it is due.
+static Event* PopDueEvent()
+{
+	if (event_queue.empty() || event_queue[0]->time > globalTimer)
+		return nullptr;
+
+	Event* evt = event_queue[0];
+	UnlinkEvent(evt);
+	return evt;
+}
+
 //This raise only the events required while the fifo is processing data
 void ProcessFifoWaitEvents()
 {
 	MoveEvents();
 
-	if (!first)
-		return;
-
-	while (first)
+	while (Event* evt = PopDueEvent())
 	{
-		if (first->time <= globalTimer)
-		{
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
+		event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
+		FreeEvent(evt);
 	}
 }
 
 void MoveEvents()
 {
-	BaseEvent sevt;
-	while (tsQueue.Pop(sevt))
+	if (!ts_queue.load(std::memory_order_relaxed))
+		return;
+
+	// The stack has the newest event on top; reverse it so that events
+	// scheduled at the same time keep their order.
+	Event* ev = ts_queue.exchange(nullptr, std::memory_order_acquire);
+	Event* oldest = nullptr;
+	while (ev)
+	{
+		Event* next = ev->next;
+		ev->next = oldest;
+		oldest = ev;
+		ev = next;
+	}
+
+	// The events were allocated on other threads. Copy them into pooled
+	// ones instead of queueing them, or every one of them would end up in
+	// the pool and it would grow for as long as they keep coming.
+	while (oldest)
 	{
-		Event *evt = GetNewEvent();
-		evt->time = sevt.time;
-		evt->userdata = sevt.userdata;
-		evt->type = sevt.type;
-		AddEventToQueue(evt);
+		Event* ne = GetNewEvent();
+		ne->time = oldest->time;
+		ne->userdata = oldest->userdata;
+		ne->type = oldest->type;
+		AddEventToQueue(ne);
+
+		Event* next = oldest->next;
+		delete oldest;
+		oldest = next;
 	}
 }
 
@@ -395,31 +487,22 @@ void Advance()
 	globalTimer += cyclesExecuted;
 	PowerPC::ppcState.downcount = slicelength;
 
-	while (first)
+	while (Event* evt = PopDueEvent())
 	{
-		if (first->time <= globalTimer)
-		{
-			//LOG(POWERPC, "[Scheduler] %s     (%lld, %lld) ",
-			//             event_types[first->type].name ? event_types[first->type].name : "?", (u64)globalTimer, (u64)first->time);
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
+		//LOG(POWERPC, "[Scheduler] %s     (%lld, %lld) ",
+		//             event_types[evt->type].name ? event_types[evt->type].name : "?", (u64)globalTimer, (u64)evt->time);
+		event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
+		FreeEvent(evt);
 	}
 
-	if (!first)
+	if (event_queue.empty())
 	{
 		WARN_LOG(POWERPC, "WARNING - no events in queue. Setting downcount to 10000");
 		PowerPC::ppcState.downcount += 10000;
 	}
 	else
 	{
-		slicelength = (int)(first->time - globalTimer);
+		slicelength = (int)(event_queue[0]->time - globalTimer);
 		if (slicelength > maxSliceLength)
 			slicelength = maxSliceLength;
 		PowerPC::ppcState.downcount = slicelength;
@@ -431,12 +514,8 @@ void Advance()
 
 void LogPendingEvents()
 {
-	Event *ptr = first;
-	while (ptr)
-	{
+	for (Event* ptr : GetSortedEvents())
 		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d", globalTimer, ptr->time, ptr->type);
-		ptr = ptr->next;
-	}
 }
 
 void Idle()
@@ -460,10 +539,9 @@ void Idle()
 
 std::string GetScheduledEventsSummary()
 {
-	Event *ptr = first;
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
-	while (ptr)
+	for (Event* ptr : GetSortedEvents())
 	{
 		unsigned int t = ptr->type;
 		if (t >= event_types.size())
@@ -472,7 +550,6 @@ std::string GetScheduledEventsSummary()
 		const std::string& name = event_types[ptr->type].name;
 
 		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", name.c_str(), ptr->time, ptr->userdata);
-		ptr = ptr->next;
 	}
 	return text;
 }
@@ -23,6 +23,9 @@
 
    ====================================================================*/
 
+#include <cinttypes>
+
+#include "Common/Atomic.h"
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
 #include "Common/FileUtil.h"
@@ -170,7 +173,7 @@ bool DSPCore_Init(const DSPInitOptions& opts)
 
 	// Initialize JIT, if necessary
 	if (opts.core_type == DSPInitOptions::CORE_JIT)
-		dspjit = new DSPEmitter();
+		dspjit = new DSPEmitter(opts.jit_stats);
 
 	g_dsp_cap.reset(opts.capture_logger);
 
@@ -187,6 +190,14 @@ void DSPCore_Shutdown()
 
 	if (dspjit)
 	{
+		const DSPJitStats& stats = g_dsp_jit_stats;
+		INFO_LOG(DSPLLE, "JIT: %u blocks compiled", stats.blocks_compiled);
+		if (dspjit->collectStats)
+		{
+			INFO_LOG(DSPLLE, "JIT: %" PRIu64 " dispatcher exits, %" PRIu64 " of %" PRIu64 " links taken, %" PRIu64 " idle skips",
+			         stats.dispatcher_exits, stats.linked_jumps, stats.link_checks, stats.idle_skips);
+		}
+
 		delete dspjit;
 		dspjit = nullptr;
 	}
@@ -216,7 +227,9 @@ void DSPCore_SetException(u8 level)
 // Notify that an external interrupt is pending (used by thread mode)
 void DSPCore_SetExternalInterrupt(bool val)
 {
-	g_dsp.external_interrupt_waiting = val;
+	// Release, so that the DSP thread sees the control register written
+	// before the interrupt.
+	Common::AtomicStoreRelease(g_dsp.external_interrupt_waiting, val);
 }
 
 // Coming from the CPU
@@ -273,11 +286,13 @@ int DSPCore_RunCycles(int cycles)
 {
 	if (dspjit)
 	{
-		if (g_dsp.external_interrupt_waiting)
+		// Clear the request before taking it, so that one raised by the CPU
+		// thread meanwhile is not lost.
+		if (Common::AtomicLoadAcquire(g_dsp.external_interrupt_waiting))
 		{
+			DSPCore_SetExternalInterrupt(false);
 			DSPCore_CheckExternalInterrupt();
 			DSPCore_CheckExceptions();
-			DSPCore_SetExternalInterrupt(false);
 		}
 
 		cyclesLeft = cycles;
@@ -344,23 +359,6 @@ void DSPCore_Step()
 void CompileCurrent()
 {
 	dspjit->Compile(g_dsp.pc);
-
-	bool retry = true;
-
-	while (retry)
-	{
-		retry = false;
-		for (u16 i = 0x0000; i < 0xffff; ++i)
-		{
-			if (!dspjit->unresolvedJumps[i].empty())
-			{
-				u16 addrToCompile = dspjit->unresolvedJumps[i].front();
-				dspjit->Compile(addrToCompile);
-				if (!dspjit->unresolvedJumps[i].empty())
-					retry = true;
-			}
-		}
-	}
 }
 
 u16 DSPCore_ReadRegister(int reg)
@@ -300,12 +300,18 @@ struct DSPInitOptions
 	};
 	CoreType core_type;
 
+	// Whether the JIT counts at run time how compiled blocks hand over
+	// control, and logs the totals at shutdown. This slows it down a bit.
+	// Default: false.
+	bool jit_stats;
+
 	// Optional capture logger used to log internal DSP data transfers.
 	// Default: dummy implementation, does nothing.
 	DSPCaptureLogger* capture_logger;
 
 	DSPInitOptions()
 		: core_type(CORE_JIT),
+		  jit_stats(false),
 		  capture_logger(new DefaultDSPCaptureLogger())
 	{
 	}
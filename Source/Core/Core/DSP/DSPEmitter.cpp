@@ -11,12 +11,14 @@
 #include "Core/DSP/DSPInterpreter.h"
 #include "Core/DSP/DSPMemoryMap.h"
 
-#define MAX_BLOCK_SIZE 250
 #define DSP_IDLE_SKIP_CYCLES 0x1000
 
 using namespace Gen;
 
-DSPEmitter::DSPEmitter() : gpr(*this), storeIndex(-1), storeIndex2(-1)
+DSPJitStats g_dsp_jit_stats;
+
+DSPEmitter::DSPEmitter(bool collect_stats)
+	: collectStats(collect_stats), gpr(*this), storeIndex(-1), storeIndex2(-1)
 {
 	m_compiledCode = nullptr;
 
@@ -30,6 +32,8 @@ DSPEmitter::DSPEmitter() : gpr(*this), storeIndex(-1), storeIndex2(-1)
 	compileSR |= SR_INT_ENABLE;
 	compileSR |= SR_EXT_INT_ENABLE;
 
+	memset(&g_dsp_jit_stats, 0, sizeof(g_dsp_jit_stats));
+
 	CompileDispatcher();
 	stubEntryPoint = CompileStub();
 
@@ -57,7 +61,6 @@ void DSPEmitter::ClearIRAM()
 		blocks[i] = (DSPCompiledCode)stubEntryPoint;
 		blockLinks[i] = nullptr;
 		blockSize[i] = 0;
-		unresolvedJumps[i].clear();
 	}
 	g_dsp.reset_dspjit_codespace = true;
 }
@@ -73,7 +76,6 @@ void DSPEmitter::ClearIRAMandDSPJITCodespaceReset()
 		blocks[i] = (DSPCompiledCode)stubEntryPoint;
 		blockLinks[i] = nullptr;
 		blockSize[i] = 0;
-		unresolvedJumps[i].clear();
 	}
 	g_dsp.reset_dspjit_codespace = false;
 }
@@ -99,6 +101,94 @@ void DSPEmitter::checkExceptions(u32 retval)
 	SetJumpTarget(skipCheck);
 }
 
+bool DSPEmitter::IsIdleSkipBlock() const
+{
+	return !DSPHost::OnThread() && (DSPAnalyzer::code_flags[startAddr] & DSPAnalyzer::CODE_IDLE_SKIP);
+}
+
+// Saves the registers and returns to the dispatcher with the cycles the block
+// took, or the rest of the time slice for idle skip blocks. This ends the
+// block: the register cache is left saved, which is how the next block
+// expects it.
+void DSPEmitter::WriteBlockExit()
+{
+	gpr.saveRegs();
+	if (IsIdleSkipBlock())
+	{
+		if (collectStats)
+			ADD(64, M(&g_dsp_jit_stats.idle_skips), Imm8(1));
+		MOV(16, R(EAX), Imm16(DSP_IDLE_SKIP_CYCLES));
+	}
+	else
+	{
+		MOV(16, R(EAX), Imm16(blockSize[startAddr]));
+	}
+	if (collectStats)
+		ADD(64, M(&g_dsp_jit_stats.dispatcher_exits), Imm8(1));
+	JMP(returnDispatcher, true);
+}
+
+// Like WriteBlockExit, for exits taken in the middle of a block. The code
+// after them still has the registers cached.
+void DSPEmitter::WriteBranchExit()
+{
+	DSPJitRegCache c(gpr);
+	WriteBlockExit();
+	gpr.loadRegs(false);
+	gpr.flushRegs(c,false);
+}
+
+// Jumps straight to the block at dest if there are enough cycles left to run
+// it, and falls through otherwise. The destination is looked up when the jump
+// is taken, so links pick up blocks compiled later and stop at blocks cleared
+// along with the IRAM.
+void DSPEmitter::WriteBlockLink(u16 dest)
+{
+	// Idle skip blocks have to give up the rest of the time slice.
+	if (IsIdleSkipBlock())
+		return;
+
+	gpr.flushRegs();
+
+	if (collectStats)
+		ADD(64, M(&g_dsp_jit_stats.link_checks), Imm8(1));
+
+	// Leave the same way the dispatcher would.
+	FixupBranch exceptionExit;
+	if (DSPHost::OnThread())
+	{
+		CMP(8, M(const_cast<bool*>(&g_dsp.external_interrupt_waiting)), Imm8(0));
+		exceptionExit = J_CC(CC_NE, true);
+	}
+	TEST(8, M(&g_dsp.cr), Imm8(CR_HALT));
+	FixupBranch halted = J_CC(CC_NE, true);
+
+	MOV(64, R(RAX), ImmPtr(&blockLinks[dest]));
+	MOV(64, R(RAX), MatR(RAX));
+	TEST(64, R(RAX), R(RAX));
+	FixupBranch notCompiled = J_CC(CC_Z);
+
+	// Check if we have enough cycles to execute the next block
+	MOV(64, R(RDX), ImmPtr(&blockSize[dest]));
+	MOVZX(32, 16, EDX, MatR(RDX));
+	ADD(32, R(EDX), Imm32(blockSize[startAddr]));
+	MOVZX(32, 16, ECX, M(&cyclesLeft));
+	CMP(32, R(ECX), R(EDX));
+	FixupBranch notEnoughCycles = J_CC(CC_BE);
+
+	SUB(16, R(ECX), Imm16(blockSize[startAddr]));
+	MOV(16, M(&cyclesLeft), R(ECX));
+	if (collectStats)
+		ADD(64, M(&g_dsp_jit_stats.linked_jumps), Imm8(1));
+	JMPptr(R(RAX));
+
+	SetJumpTarget(notEnoughCycles);
+	SetJumpTarget(notCompiled);
+	SetJumpTarget(halted);
+	if (DSPHost::OnThread())
+		SetJumpTarget(exceptionExit);
+}
+
 bool DSPEmitter::FlagsNeeded()
 {
 	if (!(DSPAnalyzer::code_flags[compilePC] & DSPAnalyzer::CODE_START_OF_INST) ||
@@ -202,7 +292,6 @@ void DSPEmitter::Compile(u16 start_addr)
 {
 	// Remember the current block address for later
 	startAddr = start_addr;
-	unresolvedJumps[start_addr].clear();
 
 	const u8 *entryPoint = AlignCode16();
 
@@ -236,9 +325,6 @@ void DSPEmitter::Compile(u16 start_addr)
 		blockSize[start_addr]++;
 		compilePC += opcode->size;
 
-		// If the block was trying to link into itself, remove the link
-		unresolvedJumps[start_addr].remove(compilePC);
-
 		fixup_pc = true;
 
 		// Handle loop condition, only if current instruction was flagged as a loop destination
@@ -263,17 +349,21 @@ void DSPEmitter::Compile(u16 start_addr)
 			// end of each block and in this order
 			DSPJitRegCache c(gpr);
 			HandleLoop();
-			gpr.saveRegs();
-			if (!DSPHost::OnThread() && DSPAnalyzer::code_flags[start_addr] & DSPAnalyzer::CODE_IDLE_SKIP)
-			{
-				MOV(16, R(EAX), Imm16(DSP_IDLE_SKIP_CYCLES));
-			}
-			else
+
+			// Loop bodies usually make up a whole block, so if the loop goes
+			// around again, go straight back to the start of this one.
+			if (!IsIdleSkipBlock())
 			{
-				MOV(16, R(EAX), Imm16(blockSize[start_addr]));
+				MOVZX(32, 16, EAX, M(&g_dsp.pc));
+				CMP(32, R(EAX), Imm32(start_addr));
+				FixupBranch notBlockStart = J_CC(CC_NE, true);
+				DSPJitRegCache c2(gpr);
+				WriteBlockLink(start_addr);
+				gpr.flushRegs(c2);
+				SetJumpTarget(notBlockStart);
 			}
-			JMP(returnDispatcher, true);
-			gpr.loadRegs(false);
+
+			WriteBranchExit();
 			gpr.flushRegs(c,false);
 
 			SetJumpTarget(rLoopAddressExit);
@@ -295,20 +385,8 @@ void DSPEmitter::Compile(u16 start_addr)
 				CMP(16, R(AX), Imm16(compilePC));
 				FixupBranch rNoBranch = J_CC(CC_Z, true);
 
-				DSPJitRegCache c(gpr);
 				//don't update g_dsp.pc -- the branch insn already did
-				gpr.saveRegs();
-				if (!DSPHost::OnThread() && DSPAnalyzer::code_flags[start_addr] & DSPAnalyzer::CODE_IDLE_SKIP)
-				{
-					MOV(16, R(EAX), Imm16(DSP_IDLE_SKIP_CYCLES));
-				}
-				else
-				{
-					MOV(16, R(EAX), Imm16(blockSize[start_addr]));
-				}
-				JMP(returnDispatcher, true);
-				gpr.loadRegs(false);
-				gpr.flushRegs(c,false);
+				WriteBranchExit();
 
 				SetJumpTarget(rNoBranch);
 			}
@@ -321,37 +399,6 @@ void DSPEmitter::Compile(u16 start_addr)
 		}
 	}
 
-	if (fixup_pc)
-	{
-		MOV(16, M(&(g_dsp.pc)), Imm16(compilePC));
-	}
-
-	blocks[start_addr] = (DSPCompiledCode)entryPoint;
-
-	// Mark this block as a linkable destination if it does not contain
-	// any unresolved CALL's
-	if (unresolvedJumps[start_addr].empty())
-	{
-		blockLinks[start_addr] = blockLinkEntry;
-
-		for (u16 i = 0x0000; i < 0xffff; ++i)
-		{
-			if (!unresolvedJumps[i].empty())
-			{
-				// Check if there were any blocks waiting for this block to be linkable
-				size_t size = unresolvedJumps[i].size();
-				unresolvedJumps[i].remove(start_addr);
-				if (unresolvedJumps[i].size() < size)
-				{
-					// Mark the block to be recompiled again
-					blocks[i] = (DSPCompiledCode)stubEntryPoint;
-					blockLinks[i] = nullptr;
-					blockSize[i] = 0;
-				}
-			}
-		}
-	}
-
 	if (blockSize[start_addr] == 0)
 	{
 		// just a safeguard, should never happen anymore.
@@ -360,16 +407,18 @@ void DSPEmitter::Compile(u16 start_addr)
 		blockSize[start_addr] = 1;
 	}
 
-	gpr.saveRegs();
-	if (!DSPHost::OnThread() && DSPAnalyzer::code_flags[start_addr] & DSPAnalyzer::CODE_IDLE_SKIP)
-	{
-		MOV(16, R(EAX), Imm16(DSP_IDLE_SKIP_CYCLES));
-	}
-	else
+	if (fixup_pc)
 	{
-		MOV(16, R(EAX), Imm16(blockSize[start_addr]));
+		MOV(16, M(&(g_dsp.pc)), Imm16(compilePC));
+		// Fall through into the next block.
+		WriteBlockLink(compilePC);
 	}
-	JMP(returnDispatcher, true);
+
+	WriteBlockExit();
+
+	blocks[start_addr] = (DSPCompiledCode)entryPoint;
+	blockLinks[start_addr] = blockLinkEntry;
+	g_dsp_jit_stats.blocks_compiled++;
 }
 
 const u8 *DSPEmitter::CompileStub()
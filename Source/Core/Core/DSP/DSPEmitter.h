@@ -4,8 +4,6 @@
 
 #pragma once
 
-#include <list>
-
 #include "Common/x64ABI.h"
 #include "Common/x64Emitter.h"
 
@@ -14,14 +12,31 @@
 
 #define COMPILED_CODE_SIZE 2097152
 #define MAX_BLOCKS         0x10000
+#define MAX_BLOCK_SIZE     250
 
 typedef u32 (*DSPCompiledCode)();
 typedef const u8 *Block;
 
+// Counters for how compiled blocks hand over control. Apart from the compiled
+// blocks, they are counted by the compiled code, and only if the emitter was
+// created to collect them.
+struct DSPJitStats
+{
+	u32 blocks_compiled;
+	// Returns to the dispatcher, including idle skips.
+	u64 dispatcher_exits;
+	// Links reached, and those that jumped on to their destination.
+	u64 link_checks;
+	u64 linked_jumps;
+	u64 idle_skips;
+};
+
+extern DSPJitStats g_dsp_jit_stats;
+
 class DSPEmitter : public Gen::X64CodeBlock
 {
 public:
-	DSPEmitter();
+	explicit DSPEmitter(bool collect_stats = false);
 	~DSPEmitter();
 
 	Block m_compiledCode;
@@ -35,6 +50,11 @@ public:
 	void Compile(u16 start_addr);
 	void ClearCallFlag();
 
+	// Block exits
+	void WriteBlockExit();
+	void WriteBranchExit();
+	void WriteBlockLink(u16 dest);
+
 	bool FlagsNeeded();
 
 	void Default(UDSPInstruction inst);
@@ -247,10 +267,10 @@ public:
 	const u8 *stubEntryPoint;
 	const u8 *returnDispatcher;
 	u16 compilePC;
+	const bool collectStats;
 	u16 startAddr;
 	Block *blockLinks;
 	u16 *blockSize;
-	std::list<u16> unresolvedJumps[MAX_BLOCKS];
 
 	DSPJitRegCache gpr;
 private:
@@ -265,6 +285,8 @@ private:
 	// Counts down.
 	// int cycles;
 
+	bool IsIdleSkipBlock() const;
+
 	void Update_SR_Register(Gen::X64Reg val = Gen::EAX);
 
 	void get_long_prod(Gen::X64Reg long_prod = Gen::RAX);
@@ -23,6 +23,8 @@
 
    ====================================================================*/
 
+#include "Common/Atomic.h"
+
 #include "Core/DSP/DSPAnalyzer.h"
 #include "Core/DSP/DSPCore.h"
 #include "Core/DSP/DSPHWInterface.h"
@@ -108,10 +110,10 @@ int RunCyclesThread(int cycles)
 		if (g_dsp.cr & CR_HALT)
 			return 0;
 
-		if (g_dsp.external_interrupt_waiting)
+		if (Common::AtomicLoadAcquire(g_dsp.external_interrupt_waiting))
 		{
-			DSPCore_CheckExternalInterrupt();
 			DSPCore_SetExternalInterrupt(false);
+			DSPCore_CheckExternalInterrupt();
 		}
 
 		Step();
@@ -2,7 +2,6 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
-#include "Core/DSP/DSPAnalyzer.h"
 #include "Core/DSP/DSPEmitter.h"
 #include "Core/DSP/DSPMemoryMap.h"
 #include "Core/DSP/DSPStacks.h"
@@ -73,60 +72,20 @@ static void ReJitConditional(const UDSPInstruction opc, DSPEmitter& emitter)
 	emitter.SetJumpTarget(skipCode);
 }
 
-static void WriteBranchExit(DSPEmitter& emitter)
+// Links a branch to its destination block. Branches back into the block
+// being compiled can only be linked to its start.
+static void WriteBranchLink(DSPEmitter& emitter, u16 dest)
 {
-	DSPJitRegCache c(emitter.gpr);
-	emitter.gpr.saveRegs();
-	if (DSPAnalyzer::code_flags[emitter.startAddr] & DSPAnalyzer::CODE_IDLE_SKIP)
-	{
-		emitter.MOV(16, R(EAX), Imm16(0x1000));
-	}
-	else
-	{
-		emitter.MOV(16, R(EAX), Imm16(emitter.blockSize[emitter.startAddr]));
-	}
-	emitter.JMP(emitter.returnDispatcher, true);
-	emitter.gpr.loadRegs(false);
-	emitter.gpr.flushRegs(c,false);
-}
-
-static void WriteBlockLink(DSPEmitter& emitter, u16 dest)
-{
-	// Jump directly to the called block if it has already been compiled.
-	if (!(dest >= emitter.startAddr && dest <= emitter.compilePC))
-	{
-		if (emitter.blockLinks[dest] != nullptr )
-		{
-			emitter.gpr.flushRegs();
-			// Check if we have enough cycles to execute the next block
-			emitter.MOV(16, R(ECX), M(&cyclesLeft));
-			emitter.CMP(16, R(ECX), Imm16(emitter.blockSize[emitter.startAddr] + emitter.blockSize[dest]));
-			FixupBranch notEnoughCycles = emitter.J_CC(CC_BE);
-
-			emitter.SUB(16, R(ECX), Imm16(emitter.blockSize[emitter.startAddr]));
-			emitter.MOV(16, M(&cyclesLeft), R(ECX));
-			emitter.JMP(emitter.blockLinks[dest], true);
-			emitter.SetJumpTarget(notEnoughCycles);
-		}
-		else
-		{
-			// The destination has not been compiled yet.  Add it to the list
-			// of blocks that this block is waiting on.
-			emitter.unresolvedJumps[emitter.startAddr].push_back(dest);
-		}
-	}
+	if (dest <= emitter.startAddr || dest > emitter.compilePC)
+		emitter.WriteBlockLink(dest);
 }
 
 static void r_jcc(const UDSPInstruction opc, DSPEmitter& emitter)
 {
 	u16 dest = dsp_imem_read(emitter.compilePC + 1);
-	const DSPOPCTemplate *opcode = GetOpTemplate(opc);
-
-	// If the block is unconditional, attempt to link block
-	if (opcode->uncond_branch)
-		WriteBlockLink(emitter, dest);
+	WriteBranchLink(emitter, dest);
 	emitter.MOV(16, M(&(g_dsp.pc)), Imm16(dest));
-	WriteBranchExit(emitter);
+	emitter.WriteBranchExit();
 }
 // Generic jmp implementation
 // Jcc addressA
@@ -148,7 +107,7 @@ static void r_jmprcc(const UDSPInstruction opc, DSPEmitter& emitter)
 	//no need to handle DSP_REG_STx.
 	emitter.dsp_op_read_reg(reg, RAX, NONE);
 	emitter.MOV(16, M(&g_dsp.pc), R(EAX));
-	WriteBranchExit(emitter);
+	emitter.WriteBranchExit();
 }
 // Generic jmpr implementation
 // JMPcc $R
@@ -166,13 +125,9 @@ static void r_call(const UDSPInstruction opc, DSPEmitter& emitter)
 	emitter.MOV(16, R(DX), Imm16(emitter.compilePC + 2));
 	emitter.dsp_reg_store_stack(DSP_STACK_C);
 	u16 dest = dsp_imem_read(emitter.compilePC + 1);
-	const DSPOPCTemplate *opcode = GetOpTemplate(opc);
-
-	// If the block is unconditional, attempt to link block
-	if (opcode->uncond_branch)
-		WriteBlockLink(emitter, dest);
+	WriteBranchLink(emitter, dest);
 	emitter.MOV(16, M(&(g_dsp.pc)), Imm16(dest));
-	WriteBranchExit(emitter);
+	emitter.WriteBranchExit();
 }
 // Generic call implementation
 // CALLcc addressA
@@ -195,7 +150,7 @@ static void r_callr(const UDSPInstruction opc, DSPEmitter& emitter)
 	emitter.dsp_reg_store_stack(DSP_STACK_C);
 	emitter.dsp_op_read_reg(reg, RAX, NONE);
 	emitter.MOV(16, M(&g_dsp.pc), R(EAX));
-	WriteBranchExit(emitter);
+	emitter.WriteBranchExit();
 }
 // Generic callr implementation
 // CALLRcc $R
@@ -223,14 +178,14 @@ void DSPEmitter::ifcc(const UDSPInstruction opc)
 {
 	MOV(16, M(&g_dsp.pc), Imm16((compilePC + 1) + opTable[dsp_imem_read(compilePC + 1)]->size));
 	ReJitConditional<r_ifcc>(opc, *this);
-	WriteBranchExit(*this);
+	WriteBranchExit();
 }
 
 static void r_ret(const UDSPInstruction opc, DSPEmitter& emitter)
 {
 	emitter.dsp_reg_load_stack(DSP_STACK_C);
 	emitter.MOV(16, M(&g_dsp.pc), R(DX));
-	WriteBranchExit(emitter);
+	emitter.WriteBranchExit();
 }
 
 // Generic ret implementation
@@ -338,7 +293,7 @@ void DSPEmitter::loop(const UDSPInstruction opc)
 	SetJumpTarget(cnt);
 	//		dsp_skip_inst();
 	MOV(16, M(&g_dsp.pc), Imm16(loop_pc + opTable[dsp_imem_read(loop_pc)]->size));
-	WriteBranchExit(*this);
+	WriteBranchExit();
 	gpr.flushRegs(c,false);
 	SetJumpTarget(exit);
 }
@@ -371,7 +326,7 @@ void DSPEmitter::loopi(const UDSPInstruction opc)
 	{
 //		dsp_skip_inst();
 		MOV(16, M(&g_dsp.pc), Imm16(loop_pc + opTable[dsp_imem_read(loop_pc)]->size));
-		WriteBranchExit(*this);
+		WriteBranchExit();
 	}
 }
 
@@ -409,7 +364,7 @@ void DSPEmitter::bloop(const UDSPInstruction opc)
 	//		g_dsp.pc = loop_pc;
 	//		dsp_skip_inst();
 	MOV(16, M(&g_dsp.pc), Imm16(loop_pc + opTable[dsp_imem_read(loop_pc)]->size));
-	WriteBranchExit(*this);
+	WriteBranchExit();
 	gpr.flushRegs(c,false);
 	SetJumpTarget(exit);
 }
@@ -445,6 +400,6 @@ void DSPEmitter::bloopi(const UDSPInstruction opc)
 //		g_dsp.pc = loop_pc;
 //		dsp_skip_inst();
 		MOV(16, M(&g_dsp.pc), Imm16(loop_pc + opTable[dsp_imem_read(loop_pc)]->size));
-		WriteBranchExit(*this);
+		WriteBranchExit();
 	}
 }
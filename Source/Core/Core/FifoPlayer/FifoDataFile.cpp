@@ -4,8 +4,10 @@
 
 #include <algorithm>
 #include <string>
+#include <lzo/lzo1x.h>
 
 #include "Common/FileUtil.h"
+#include "Common/Hash.h"
 
 #include "Core/FifoPlayer/FifoDataFile.h"
 #include "Core/FifoPlayer/FifoFileStruct.h"
@@ -20,12 +22,10 @@ FifoDataFile::FifoDataFile() :
 FifoDataFile::~FifoDataFile()
 {
 	for (auto& frame : m_Frames)
-	{
-		for (auto& update : frame.memoryUpdates)
-			delete []update.data;
-
 		delete []frame.fifoData;
-	}
+
+	for (auto& entry : m_UpdateData)
+		delete []entry.second.data;
 }
 
 void FifoDataFile::SetIsWii(bool isWii)
@@ -38,6 +38,26 @@ bool FifoDataFile::GetIsWii() const
 	return GetFlag(FLAG_IS_WII);
 }
 
+u8 *FifoDataFile::StoreMemoryUpdateData(const u8 *data, u32 size)
+{
+	u64 hash = GetHash64(data, size, 0);
+
+	auto range = m_UpdateData.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second.size == size && memcmp(it->second.data, data, size) == 0)
+			return it->second.data;
+	}
+
+	UpdateData copy;
+	copy.data = new u8[size];
+	copy.size = size;
+	memcpy(copy.data, data, size);
+	m_UpdateData.insert(std::make_pair(hash, copy));
+
+	return copy.data;
+}
+
 void FifoDataFile::AddFrame(const FifoFrameInfo &frameInfo)
 {
 	m_Frames.push_back(frameInfo);
@@ -94,6 +114,13 @@ bool FifoDataFile::Save(const std::string& filename)
 	file.Seek(0, SEEK_SET);
 	file.WriteBytes(&header, sizeof(FileHeader));
 
+	// Offsets of the update data that has been written, which is shared between
+	// updates with the same contents
+	std::unordered_map<const u8*, u64> blobOffsets;
+
+	// The compressor's scratch memory, shared by all blocks of this file
+	std::vector<lzo_align_t> workMem((LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) / sizeof(lzo_align_t));
+
 	// Write frames list
 	for (unsigned int i = 0; i < m_Frames.size(); ++i)
 	{
@@ -102,12 +129,14 @@ bool FifoDataFile::Save(const std::string& filename)
 		// Write FIFO data
 		file.Seek(0, SEEK_END);
 		u64 dataOffset = file.Tell();
-		file.WriteBytes(srcFrame.fifoData, srcFrame.fifoDataSize);
+		u32 compressedSize = WriteCompressed(srcFrame.fifoData, srcFrame.fifoDataSize, workMem.data(), file);
 
-		u64 memoryUpdatesOffset = WriteMemoryUpdates(srcFrame.memoryUpdates, file);
+		u64 memoryUpdatesOffset = WriteMemoryUpdates(srcFrame.memoryUpdates, blobOffsets, workMem.data(), file);
 
 		FileFrameInfo dstFrame;
+		memset(&dstFrame, 0, sizeof(FileFrameInfo));
 		dstFrame.fifoDataSize = srcFrame.fifoDataSize;
+		dstFrame.fifoDataCompressedSize = compressedSize;
 		dstFrame.fifoDataOffset = dataOffset;
 		dstFrame.fifoStart = srcFrame.fifoStart;
 		dstFrame.fifoEnd = srcFrame.fifoEnd;
@@ -136,7 +165,7 @@ FifoDataFile *FifoDataFile::Load(const std::string &filename, bool flagsOnly)
 	FileHeader header;
 	file.ReadBytes(&header, sizeof(header));
 
-	if (header.fileId != FILE_ID || header.min_loader_version > VERSION_NUMBER)
+	if (header.fileId != FILE_ID || header.min_loader_version > VERSION_NUMBER || header.file_version > VERSION_NUMBER)
 	{
 		file.Close();
 		return nullptr;
@@ -168,6 +197,9 @@ FifoDataFile *FifoDataFile::Load(const std::string &filename, bool flagsOnly)
 	file.Seek(header.xfRegsOffset, SEEK_SET);
 	file.ReadArray(dataFile->m_XFRegs, size);
 
+	// Update data already read, by offset
+	std::unordered_map<u64, u8*> blobs;
+
 	// Read frames
 	for (u32 i = 0; i < header.frameCount; ++i)
 	{
@@ -182,12 +214,23 @@ FifoDataFile *FifoDataFile::Load(const std::string &filename, bool flagsOnly)
 		dstFrame.fifoStart = srcFrame.fifoStart;
 		dstFrame.fifoEnd = srcFrame.fifoEnd;
 
+		u32 compressedSize = srcFrame.fifoDataSize;
+		if (header.file_version >= 2)
+			compressedSize = srcFrame.fifoDataCompressedSize;
+
 		file.Seek(srcFrame.fifoDataOffset, SEEK_SET);
-		file.ReadBytes(dstFrame.fifoData, srcFrame.fifoDataSize);
+		bool ok = ReadCompressed(dstFrame.fifoData, srcFrame.fifoDataSize, compressedSize, file);
 
-		ReadMemoryUpdates(srcFrame.memoryUpdatesOffset, srcFrame.numMemoryUpdates, dstFrame.memoryUpdates, file);
+		ok = ok && dataFile->ReadMemoryUpdates(srcFrame.memoryUpdatesOffset, srcFrame.numMemoryUpdates, header.file_version, dstFrame.memoryUpdates, blobs, file);
 
 		dataFile->AddFrame(dstFrame);
+
+		if (!ok)
+		{
+			file.Close();
+			delete dataFile;
+			return nullptr;
+		}
 	}
 
 	file.Close();
@@ -214,7 +257,7 @@ bool FifoDataFile::GetFlag(u32 flag) const
 	return !!(m_Flags & flag);
 }
 
-u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates, File::IOFile &file)
+u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates, std::unordered_map<const u8*, u64> &blobOffsets, void *workMem, File::IOFile &file)
 {
 	// Add space for memory update list
 	u64 updateListOffset = file.Tell();
@@ -224,10 +267,27 @@ u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates
 	{
 		const MemoryUpdate &srcUpdate = memUpdates[i];
 
-		// Write memory
-		file.Seek(0, SEEK_END);
-		u64 dataOffset = file.Tell();
-		file.WriteBytes(srcUpdate.data, srcUpdate.size);
+		// Write memory, unless the same contents were already written
+		u64 dataOffset;
+		auto blobOffset = blobOffsets.find(srcUpdate.data);
+		if (blobOffset != blobOffsets.end())
+		{
+			dataOffset = blobOffset->second;
+		}
+		else
+		{
+			file.Seek(0, SEEK_END);
+			dataOffset = file.Tell();
+
+			FileBlob blob;
+			PadFile(sizeof(FileBlob), file);
+			blob.compressedSize = WriteCompressed(srcUpdate.data, srcUpdate.size, workMem, file);
+
+			file.Seek(dataOffset, SEEK_SET);
+			file.WriteBytes(&blob, sizeof(FileBlob));
+
+			blobOffsets[srcUpdate.data] = dataOffset;
+		}
 
 		FileMemoryUpdate dstUpdate;
 		dstUpdate.address = srcUpdate.address;
@@ -244,8 +304,10 @@ u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates
 	return updateListOffset;
 }
 
-void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates, std::vector<MemoryUpdate> &memUpdates, File::IOFile &file)
+bool FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates, u32 version, std::vector<MemoryUpdate> &memUpdates, std::unordered_map<u64, u8*> &blobs, File::IOFile &file)
 {
+	std::vector<u8> data;
+
 	memUpdates.resize(numUpdates);
 
 	for (u32 i = 0; i < numUpdates; ++i)
@@ -259,10 +321,66 @@ void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates, std::vector
 		dstUpdate.address = srcUpdate.address;
 		dstUpdate.fifoPosition = srcUpdate.fifoPosition;
 		dstUpdate.size = srcUpdate.dataSize;
-		dstUpdate.data = new u8[srcUpdate.dataSize];
 		dstUpdate.type = (MemoryUpdate::Type)srcUpdate.type;
 
+		auto blob = blobs.find(srcUpdate.dataOffset);
+		if (blob != blobs.end())
+		{
+			dstUpdate.data = blob->second;
+			continue;
+		}
+
+		data.resize(srcUpdate.dataSize);
 		file.Seek(srcUpdate.dataOffset, SEEK_SET);
-		file.ReadBytes(dstUpdate.data, srcUpdate.dataSize);
+
+		if (version >= 2)
+		{
+			FileBlob srcBlob;
+			file.ReadBytes(&srcBlob, sizeof(FileBlob));
+			if (!ReadCompressed(data.data(), srcUpdate.dataSize, srcBlob.compressedSize, file))
+				return false;
+		}
+		else
+		{
+			if (!file.ReadBytes(data.data(), srcUpdate.dataSize))
+				return false;
+		}
+
+		// Version 1 files repeat the data for every update
+		dstUpdate.data = StoreMemoryUpdateData(data.data(), srcUpdate.dataSize);
+		blobs[srcUpdate.dataOffset] = dstUpdate.data;
+	}
+
+	return true;
+}
+
+// Uses the LZO library initialized by State::Init()
+u32 FifoDataFile::WriteCompressed(const u8 *data, u32 size, void *workMem, File::IOFile &file)
+{
+	std::vector<u8> out(size + size / 16 + 64 + 3);
+	lzo_uint outLen = 0;
+
+	if (size > 0 &&
+	    lzo1x_1_compress(data, size, out.data(), &outLen, workMem) == LZO_E_OK &&
+	    outLen < size)
+	{
+		file.WriteBytes(out.data(), outLen);
+		return (u32)outLen;
 	}
+
+	file.WriteBytes(data, size);
+	return size;
+}
+
+bool FifoDataFile::ReadCompressed(u8 *data, u32 size, u32 compressedSize, File::IOFile &file)
+{
+	if (compressedSize == size)
+		return file.ReadBytes(data, size);
+
+	std::vector<u8> in(compressedSize);
+	if (!file.ReadBytes(in.data(), compressedSize))
+		return false;
+
+	lzo_uint newLen = size;
+	return lzo1x_decompress_safe(in.data(), compressedSize, data, &newLen, nullptr) == LZO_E_OK && newLen == size;
 }
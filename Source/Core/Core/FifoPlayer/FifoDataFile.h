@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -27,6 +28,7 @@ struct MemoryUpdate
 	u32 fifoPosition;
 	u32 address;
 	u32 size;
+	// Owned by the FifoDataFile and shared by updates with the same contents
 	u8 *data;
 	Type type;
 };
@@ -65,6 +67,10 @@ public:
 	u32 *GetXFMem() { return m_XFMem; }
 	u32 *GetXFRegs() { return m_XFRegs; }
 
+	// Returns a copy of data owned by the file for a MemoryUpdate. Textures and
+	// vertex data re-uploaded every frame are only stored once.
+	u8 *StoreMemoryUpdateData(const u8 *data, u32 size);
+
 	void AddFrame(const FifoFrameInfo &frameInfo);
 	const FifoFrameInfo &GetFrame(u32 frame) const { return m_Frames[frame]; }
 	u32 GetFrameCount() { return static_cast<u32>(m_Frames.size()); }
@@ -84,8 +90,18 @@ private:
 	void SetFlag(u32 flag, bool set);
 	bool GetFlag(u32 flag) const;
 
-	u64 WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates, File::IOFile &file);
-	static void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates, std::vector<MemoryUpdate> &memUpdates, File::IOFile &file);
+	u64 WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates, std::unordered_map<const u8*, u64> &blobOffsets, void *workMem, File::IOFile &file);
+	bool ReadMemoryUpdates(u64 fileOffset, u32 numUpdates, u32 version, std::vector<MemoryUpdate> &memUpdates, std::unordered_map<u64, u8*> &blobs, File::IOFile &file);
+
+	// workMem is the compressor's scratch memory, allocated once per Save()
+	static u32 WriteCompressed(const u8 *data, u32 size, void *workMem, File::IOFile &file);
+	static bool ReadCompressed(u8 *data, u32 size, u32 compressedSize, File::IOFile &file);
+
+	struct UpdateData
+	{
+		u8 *data;
+		u32 size;
+	};
 
 	u32 m_BPMem[BP_MEM_SIZE];
 	u32 m_CPMem[CP_MEM_SIZE];
@@ -95,4 +111,7 @@ private:
 	u32 m_Flags;
 
 	std::vector<FifoFrameInfo> m_Frames;
+
+	// Memory update data by content hash
+	std::unordered_multimap<u64, UpdateData> m_UpdateData;
 };
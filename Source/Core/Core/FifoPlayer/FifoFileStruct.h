@@ -12,10 +12,15 @@ namespace FifoFileStruct
 enum
 {
 	FILE_ID            = 0x0d01f1f0,
-	VERSION_NUMBER     = 1,
-	MIN_LOADER_VERSION = 1,
+	VERSION_NUMBER     = 2,
+	MIN_LOADER_VERSION = 2,
 };
 
+// Version 1 stores FIFO data and memory updates uncompressed.
+// Version 2 writes each frame as one chunk of LZO compressed FIFO data followed
+// by its memory update list. Update data is stored as a FileBlob the first time
+// its contents are seen, and later updates with the same contents point to it.
+
 #pragma pack(push, 4)
 
 union FileHeader
@@ -50,6 +55,7 @@ union FileFrameInfo
 		u32 fifoEnd;
 		u64 memoryUpdatesOffset;
 		u32 numMemoryUpdates;
+		u32 fifoDataCompressedSize; // version 2
 	};
 	u32 rawData[16];
 };
@@ -64,6 +70,13 @@ struct FileMemoryUpdate
 	u8 type;
 };
 
+// Version 2 memory update data, compressedSize equals the update's dataSize
+// when compressing didn't make it smaller and the data follows uncompressed
+struct FileBlob
+{
+	u32 compressedSize;
+};
+
 #pragma pack(pop)
 
 }
@@ -60,6 +60,7 @@ bool FifoPlayer::Play()
 		return false;
 
 	m_CurrentFrame = m_FrameRangeStart;
+	u32 loopsPlayed = 0;
 
 	LoadMemory();
 
@@ -70,7 +71,9 @@ bool FifoPlayer::Play()
 		{
 			if (m_CurrentFrame >= m_FrameRangeEnd)
 			{
-				if (m_Loop)
+				++loopsPlayed;
+
+				if (m_LoopCount ? loopsPlayed < m_LoopCount : m_Loop)
 				{
 					m_CurrentFrame = m_FrameRangeStart;
 
@@ -152,6 +155,7 @@ FifoPlayer &FifoPlayer::GetInstance()
 }
 
 FifoPlayer::FifoPlayer() :
+	m_LoopCount(0),
 	m_CurrentFrame(0),
 	m_FrameRangeStart(0),
 	m_FrameRangeEnd(0),
@@ -51,6 +51,9 @@ public:
 	// Default is disabled
 	void SetEarlyMemoryUpdates(bool enabled) { m_EarlyMemoryUpdates = enabled; }
 
+	// Stops after playing the frame range this many times, 0 leaves it to the loop setting
+	void SetLoopCount(u32 count) { m_LoopCount = count; }
+
 	// Callbacks
 	void SetFileLoadedCallback(CallbackFunc callback) { m_FileLoadedCb = callback; }
 	void SetFrameWrittenCallback(CallbackFunc callback) { m_FrameWrittenCb = callback; }
@@ -87,6 +90,7 @@ private:
 	bool ShouldLoadBP(u8 address);
 
 	bool m_Loop;
+	u32 m_LoopCount;
 
 	u32 m_CurrentFrame;
 	u32 m_FrameRangeStart;
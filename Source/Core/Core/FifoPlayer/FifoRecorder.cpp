@@ -132,8 +132,7 @@ void FifoRecorder::WriteMemory(u32 address, u32 size, MemoryUpdate::Type type)
 		memUpdate.fifoPosition = (u32)(m_FifoData.size());
 		memUpdate.size = size;
 		memUpdate.type = type;
-		memUpdate.data = new u8[size];
-		memcpy(memUpdate.data, newData, size);
+		memUpdate.data = m_File->StoreMemoryUpdateData(newData, size);
 
 		m_CurrentFrame.memoryUpdates.push_back(memUpdate);
 	}
@@ -218,12 +218,12 @@ DSPEmulator *GetDSPEmulator()
 	return dsp_emulator;
 }
 
-void Init(bool hle)
+void Init(bool hle, bool wii)
 {
 	dsp_emulator = CreateDSPEmulator(hle);
 	dsp_is_lle = dsp_emulator->IsLLE();
 
-	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii)
+	if (wii)
 	{
 		g_ARAM.wii_mode = true;
 		g_ARAM.size = Memory::EXRAM_SIZE;
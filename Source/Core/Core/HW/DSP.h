@@ -56,7 +56,9 @@ union UDSPControl
 	UDSPControl(u16 _Hex = 0) : Hex(_Hex) {}
 };
 
-void Init(bool hle);
+// On the Wii, ARAM is the second block of main memory, so Memory must be
+// initialized first.
+void Init(bool hle, bool wii);
 void Shutdown();
 
 void RegisterMMIO(MMIO::Mapping* mmio, u32 base);
@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <vector>
+
 #include "Common/FileUtil.h"
 #include "Common/MathUtil.h"
 
@@ -387,43 +389,59 @@ void AXUCode::ProcessPBList(u32 pb_addr)
 	// 32KHz to 48KHz, but AX always process at 32KHz.
 	const u32 spms = 32;
 
+	// Gather the voices first. Updates can change next_pb, so the list is
+	// followed as it looks once all updates have been applied.
+	std::vector<u32> pb_addrs;
+	std::vector<AXPB> pbs;
 	AXPB pb;
-
 	while (pb_addr)
 	{
-		AXBuffers buffers = {{
-			m_samples_left,
-			m_samples_right,
-			m_samples_surround,
-			m_samples_auxA_left,
-			m_samples_auxA_right,
-			m_samples_auxA_surround,
-			m_samples_auxB_left,
-			m_samples_auxB_right,
-			m_samples_auxB_surround
-		}};
-
 		if (!ReadPB(pb_addr, pb))
 			break;
 
-		u32 updates_addr = HILO_TO_32(pb.updates.data);
+		pb_addrs.push_back(pb_addr);
+		pbs.push_back(pb);
+
+		u16* updates = (u16*)HLEMemory_Get_Pointer(HILO_TO_32(pb.updates.data));
+		for (int curr_ms = 0; curr_ms < 5; ++curr_ms)
+			ApplyUpdatesForMs(curr_ms, (u16*)&pb, pb.updates.num_updates, updates);
+
+		pb_addr = HILO_TO_32(pb.next_pb);
+	}
+
+	AXBuffers buffers = {{
+		m_samples_left,
+		m_samples_right,
+		m_samples_surround,
+		m_samples_auxA_left,
+		m_samples_auxA_right,
+		m_samples_auxA_surround,
+		m_samples_auxB_left,
+		m_samples_auxB_right,
+		m_samples_auxB_surround
+	}};
+
+	ProcessVoices(m_voice_workers, buffers, (u32)pbs.size(), [&](u32 voice, AXBuffers worker_buffers) {
+		AXPB& voice_pb = pbs[voice];
+
+		u32 updates_addr = HILO_TO_32(voice_pb.updates.data);
 		u16* updates = (u16*)HLEMemory_Get_Pointer(updates_addr);
 
 		for (int curr_ms = 0; curr_ms < 5; ++curr_ms)
 		{
-			ApplyUpdatesForMs(curr_ms, (u16*)&pb, pb.updates.num_updates, updates);
+			ApplyUpdatesForMs(curr_ms, (u16*)&voice_pb, voice_pb.updates.num_updates, updates);
 
-			ProcessVoice(pb, buffers, spms, ConvertMixerControl(pb.mixer_control),
+			ProcessVoice(voice_pb, worker_buffers, spms, ConvertMixerControl(voice_pb.mixer_control),
 			             m_coeffs_available ? m_coeffs : nullptr);
 
 			// Forward the buffers
-			for (u32 i = 0; i < sizeof (buffers.ptrs) / sizeof (buffers.ptrs[0]); ++i)
-				buffers.ptrs[i] += spms;
+			for (u32 i = 0; i < sizeof (worker_buffers.ptrs) / sizeof (worker_buffers.ptrs[0]); ++i)
+				worker_buffers.ptrs[i] += spms;
 		}
+	});
 
-		WritePB(pb_addr, pb);
-		pb_addr = HILO_TO_32(pb.next_pb);
-	}
+	for (size_t i = 0; i < pbs.size(); ++i)
+		WritePB(pb_addrs[i], pbs[i]);
 }
 
 void AXUCode::MixAUXSamples(int aux_id, u32 write_addr, u32 read_addr)
@@ -96,6 +96,8 @@ protected:
 	bool m_coeffs_available;
 	s16 m_coeffs[0x800];
 
+	VoiceWorkerPool m_voice_workers;
+
 	void LoadResamplingCoefficients();
 
 	// Copy a command list from memory to our temp buffer
@@ -12,7 +12,9 @@
 #error AXVoice.h included without specifying version
 #endif
 
-#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/MathUtil.h"
@@ -21,6 +23,13 @@
 #include "Core/HW/DSPHLE/UCodes/AX.h"
 #include "Core/HW/DSPHLE/UCodes/AXStructs.h"
 
+#if _M_SSE >= 0x200
+#include <emmintrin.h>
+#elif defined(_M_ARM) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define AX_NEON
+#include <arm_neon.h>
+#endif
+
 #ifdef AX_GC
 # define PB_TYPE AXPB
 # define MAX_SAMPLES_PER_FRAME 32
@@ -77,6 +86,73 @@ union AXBuffers
 #endif
 };
 
+// Number of samples in each of the buffers, in the order of AXBuffers::ptrs.
+#ifdef AX_GC
+static const u32 s_buffer_sizes[9] = {
+	32 * 5, 32 * 5, 32 * 5,
+	32 * 5, 32 * 5, 32 * 5,
+	32 * 5, 32 * 5, 32 * 5,
+};
+#else
+static const u32 s_buffer_sizes[20] = {
+	32 * 3, 32 * 3, 32 * 3,
+	32 * 3, 32 * 3, 32 * 3,
+	32 * 3, 32 * 3, 32 * 3,
+	32 * 3, 32 * 3, 32 * 3,
+	6 * 3, 6 * 3, 6 * 3, 6 * 3, 6 * 3, 6 * 3, 6 * 3, 6 * 3,
+};
+#endif
+
+// Output buffers of the voice workers, see ProcessVoices.
+static std::vector<int> s_worker_samples;
+
+// Calls process_voice(voice, buffers) for all voices, using the voice workers
+// if there are enough voices. Every worker mixes into its own zeroed copy of
+// the output buffers, and the copies are added to the real buffers in thread
+// order afterwards.
+template <typename F>
+void ProcessVoices(VoiceWorkerPool& pool, const AXBuffers& buffers, u32 num_voices, const F& process_voice)
+{
+	const u32 num_buffers = sizeof (buffers.ptrs) / sizeof (buffers.ptrs[0]);
+
+	u32 num_threads = num_voices >= MIN_PARALLEL_VOICES ? pool.GetNumThreads() : 1;
+	if (num_threads == 1)
+	{
+		for (u32 voice = 0; voice < num_voices; ++voice)
+			process_voice(voice, buffers);
+		return;
+	}
+
+	u32 samples_per_thread = 0;
+	for (u32 size : s_buffer_sizes)
+		samples_per_thread += size;
+	s_worker_samples.assign((num_threads - 1) * samples_per_thread, 0);
+
+	std::vector<AXBuffers> thread_buffers(num_threads, buffers);
+	int* samples = s_worker_samples.data();
+	for (u32 thread = 1; thread < num_threads; ++thread)
+	{
+		for (u32 i = 0; i < num_buffers; ++i)
+		{
+			thread_buffers[thread].ptrs[i] = samples;
+			samples += s_buffer_sizes[i];
+		}
+	}
+
+	pool.Run(num_voices, [&](u32 voice, u32 thread) {
+		process_voice(voice, thread_buffers[thread]);
+	});
+
+	for (u32 thread = 1; thread < num_threads; ++thread)
+	{
+		for (u32 i = 0; i < num_buffers; ++i)
+		{
+			for (u32 j = 0; j < s_buffer_sizes[i]; ++j)
+				buffers.ptrs[i][j] += thread_buffers[thread].ptrs[i][j];
+		}
+	}
+}
+
 // Read a PB from MRAM/ARAM
 bool ReadPB(u32 addr, PB_TYPE& pb)
 {
@@ -127,87 +203,91 @@ void DumpPB(const PB_TYPE& pb)
 }
 #endif
 
-// Simulated accelerator state.
-static u32 acc_loop_addr, acc_end_addr;
-static u32* acc_cur_addr;
-static PB_TYPE* acc_pb;
-static bool acc_end_reached;
+// Simulated accelerator state. Kept per voice so that voices can be
+// processed on several threads.
+struct AcceleratorState
+{
+	u32 loop_addr, end_addr;
+	u32* cur_addr;
+	PB_TYPE* pb;
+	bool end_reached;
+};
 
 // Sets up the simulated accelerator.
-void AcceleratorSetup(PB_TYPE* pb, u32* cur_addr)
+void AcceleratorSetup(AcceleratorState* acc, PB_TYPE* pb, u32* cur_addr)
 {
-	acc_pb = pb;
-	acc_loop_addr = HILO_TO_32(pb->audio_addr.loop_addr);
-	acc_end_addr = HILO_TO_32(pb->audio_addr.end_addr);
-	acc_cur_addr = cur_addr;
-	acc_end_reached = false;
+	acc->pb = pb;
+	acc->loop_addr = HILO_TO_32(pb->audio_addr.loop_addr);
+	acc->end_addr = HILO_TO_32(pb->audio_addr.end_addr);
+	acc->cur_addr = cur_addr;
+	acc->end_reached = false;
 }
 
 // Reads a sample from the simulated accelerator. Also handles looping and
 // disabling streams that reached the end (this is done by an exception raised
 // by the accelerator on real hardware).
-u16 AcceleratorGetSample()
+u16 AcceleratorGetSample(AcceleratorState* acc)
 {
 	u16 ret;
 	u8 step_size_bytes = 0;
 
-	// See below for explanations about acc_end_reached.
-	if (acc_end_reached)
+	// See below for explanations about acc->end_reached.
+	if (acc->end_reached)
 		return 0;
 
-	switch (acc_pb->audio_addr.sample_format)
+	switch (acc->pb->audio_addr.sample_format)
 	{
 		case 0x00: // ADPCM
 		{
 			// ADPCM decoding, not much to explain here.
-			if ((*acc_cur_addr & 15) == 0)
+			if ((*acc->cur_addr & 15) == 0)
 			{
-				acc_pb->adpcm.pred_scale = DSP::ReadARAM((*acc_cur_addr & ~15) >> 1);
-				*acc_cur_addr += 2;
+				acc->pb->adpcm.pred_scale = DSP::ReadARAM((*acc->cur_addr & ~15) >> 1);
+				*acc->cur_addr += 2;
 			}
 
-			int scale = 1 << (acc_pb->adpcm.pred_scale & 0xF);
-			int coef_idx = (acc_pb->adpcm.pred_scale >> 4) & 0x7;
+			int scale = 1 << (acc->pb->adpcm.pred_scale & 0xF);
+			int coef_idx = (acc->pb->adpcm.pred_scale >> 4) & 0x7;
 
-			s32 coef1 = acc_pb->adpcm.coefs[coef_idx * 2 + 0];
-			s32 coef2 = acc_pb->adpcm.coefs[coef_idx * 2 + 1];
+			s32 coef1 = acc->pb->adpcm.coefs[coef_idx * 2 + 0];
+			s32 coef2 = acc->pb->adpcm.coefs[coef_idx * 2 + 1];
 
-			int temp = (*acc_cur_addr & 1) ?
-					(DSP::ReadARAM(*acc_cur_addr >> 1) & 0xF) :
-					(DSP::ReadARAM(*acc_cur_addr >> 1) >> 4);
+			int temp = (*acc->cur_addr & 1) ?
+					(DSP::ReadARAM(*acc->cur_addr >> 1) & 0xF) :
+					(DSP::ReadARAM(*acc->cur_addr >> 1) >> 4);
 
 			if (temp >= 8)
 				temp -= 16;
 
-			int val = (scale * temp) + ((0x400 + coef1 * acc_pb->adpcm.yn1 + coef2 * acc_pb->adpcm.yn2) >> 11);
+			int val = (scale * temp) + ((0x400 + coef1 * acc->pb->adpcm.yn1 + coef2 * acc->pb->adpcm.yn2) >> 11);
 			MathUtil::Clamp(&val, -0x7FFF, 0x7FFF);
 
-			acc_pb->adpcm.yn2 = acc_pb->adpcm.yn1;
-			acc_pb->adpcm.yn1 = val;
+			acc->pb->adpcm.yn2 = acc->pb->adpcm.yn1;
+			acc->pb->adpcm.yn1 = val;
 			step_size_bytes = 2;
-			*acc_cur_addr += 1;
+			*acc->cur_addr += 1;
 			ret = val;
 			break;
 		}
 
 		case 0x0A: // 16-bit PCM audio
-			ret = (DSP::ReadARAM(*acc_cur_addr * 2) << 8) | DSP::ReadARAM(*acc_cur_addr * 2 + 1);
-			acc_pb->adpcm.yn2 = acc_pb->adpcm.yn1;
-			acc_pb->adpcm.yn1 = ret;
+			ret = (DSP::ReadARAM(*acc->cur_addr * 2) << 8) | DSP::ReadARAM(*acc->cur_addr * 2 + 1);
+			acc->pb->adpcm.yn2 = acc->pb->adpcm.yn1;
+			acc->pb->adpcm.yn1 = ret;
 			step_size_bytes = 2;
-			*acc_cur_addr += 1;
+			*acc->cur_addr += 1;
 			break;
 
 		case 0x19: // 8-bit PCM audio
-			ret = DSP::ReadARAM(*acc_cur_addr) << 8;
-			acc_pb->adpcm.yn2 = acc_pb->adpcm.yn1;
-			acc_pb->adpcm.yn1 = ret;
+			ret = DSP::ReadARAM(*acc->cur_addr) << 8;
+			acc->pb->adpcm.yn2 = acc->pb->adpcm.yn1;
+			acc->pb->adpcm.yn1 = ret;
 			step_size_bytes = 1;
-			*acc_cur_addr += 1;
+			*acc->cur_addr += 1;
 			break;
 
 		default:
-			ERROR_LOG(DSPHLE, "Unknown sample format: %d", acc_pb->audio_addr.sample_format);
+			ERROR_LOG(DSPHLE, "Unknown sample format: %d", acc->pb->audio_addr.sample_format);
 			return 0;
 	}
 
@@ -215,29 +295,29 @@ u16 AcceleratorGetSample()
 	//
 	// On real hardware, this would raise an interrupt that is handled by the
 	// UCode. We simulate what this interrupt does here.
-	if (*acc_cur_addr == (acc_end_addr + step_size_bytes - 1))
+	if (*acc->cur_addr == (acc->end_addr + step_size_bytes - 1))
 	{
 		// loop back to loop_addr.
-		*acc_cur_addr = acc_loop_addr;
+		*acc->cur_addr = acc->loop_addr;
 
-		if (acc_pb->audio_addr.looping)
+		if (acc->pb->audio_addr.looping)
 		{
 			// Set the ADPCM infos to continue processing at loop_addr.
 			//
 			// For some reason, yn1 and yn2 aren't set if the voice is not of
 			// stream type. This is what the AX UCode does and I don't really
 			// know why.
-			acc_pb->adpcm.pred_scale = acc_pb->adpcm_loop_info.pred_scale;
-			if (!acc_pb->is_stream)
+			acc->pb->adpcm.pred_scale = acc->pb->adpcm_loop_info.pred_scale;
+			if (!acc->pb->is_stream)
 			{
-				acc_pb->adpcm.yn1 = acc_pb->adpcm_loop_info.yn1;
-				acc_pb->adpcm.yn2 = acc_pb->adpcm_loop_info.yn2;
+				acc->pb->adpcm.yn1 = acc->pb->adpcm_loop_info.yn1;
+				acc->pb->adpcm.yn2 = acc->pb->adpcm_loop_info.yn2;
 			}
 		}
 		else
 		{
 			// Non looping voice reached the end -> running = 0.
-			acc_pb->running = 0;
+			acc->pb->running = 0;
 
 #ifdef AX_WII
 			// One of the few meaningful differences between AXGC and AXWii:
@@ -245,7 +325,7 @@ u16 AcceleratorGetSample()
 			// samples at the loop address, AXWii has the 0000 samples
 			// internally in DRAM and use an internal pointer to it (loop addr
 			// does not contain 0000 samples on AXWii!).
-			acc_end_reached = true;
+			acc->end_reached = true;
 #endif
 		}
 	}
@@ -253,8 +333,72 @@ u16 AcceleratorGetSample()
 	return ret;
 }
 
-// Reads samples from the input callback, resamples them to <count> samples at
-// the wanted sample rate (computed from the ratio, see below).
+// Reads <count> samples from the simulated accelerator. The inside of ADPCM
+// frames is decoded in one go. Frame headers, the sample at the end address
+// and other formats go through AcceleratorGetSample.
+void AcceleratorGetSamples(AcceleratorState* acc, s16* samples, u32 count)
+{
+	u32 i = 0;
+	while (i < count)
+	{
+		u32 addr = *acc->cur_addr;
+		u32 n = 0;
+		if (!acc->end_reached && acc->pb->audio_addr.sample_format == 0x00 && (addr & 15) != 0)
+		{
+			n = std::min(16 - (addr & 15), count - i);
+
+			// The nibble at the end address triggers looping.
+			if (acc->end_addr >= addr && acc->end_addr - addr < n)
+				n = acc->end_addr - addr;
+		}
+
+		if (n == 0)
+		{
+			samples[i++] = AcceleratorGetSample(acc);
+			continue;
+		}
+
+		PB_TYPE* pb = acc->pb;
+		int scale = 1 << (pb->adpcm.pred_scale & 0xF);
+		int coef_idx = (pb->adpcm.pred_scale >> 4) & 0x7;
+
+		s32 coef1 = pb->adpcm.coefs[coef_idx * 2 + 0];
+		s32 coef2 = pb->adpcm.coefs[coef_idx * 2 + 1];
+		s32 yn1 = pb->adpcm.yn1;
+		s32 yn2 = pb->adpcm.yn2;
+
+		for (u32 end = addr + n; addr != end; ++addr)
+		{
+			u8 byte = DSP::ReadARAM(addr >> 1);
+			int temp = (addr & 1) ? (byte & 0xF) : (byte >> 4);
+			if (temp >= 8)
+				temp -= 16;
+
+			int val = (scale * temp) + ((0x400 + coef1 * yn1 + coef2 * yn2) >> 11);
+			MathUtil::Clamp(&val, -0x7FFF, 0x7FFF);
+
+			yn2 = yn1;
+			yn1 = val;
+			samples[i++] = val;
+		}
+
+		pb->adpcm.yn1 = yn1;
+		pb->adpcm.yn2 = yn2;
+		*acc->cur_addr = addr;
+	}
+}
+
+// Number of input samples ResampleAudio consumes to produce <count> samples.
+u32 GetResampleInputCount(u32 count, u32 curr_pos, u32 ratio, int srctype)
+{
+	if (srctype == SRCTYPE_LINEAR || srctype == SRCTYPE_POLYPHASE)
+		return (u32)((curr_pos + (u64)ratio * count) >> 16);
+	return count;
+}
+
+// Resamples input samples to <count> samples at the wanted sample rate
+// (computed from the ratio, see below). <input> starts with the four
+// <last_samples>, followed by GetResampleInputCount new samples.
 //
 // If srctype is SRCTYPE_POLYPHASE, coefficients need to be provided as well
 // (or the srctype will automatically be changed to LINEAR).
@@ -273,7 +417,7 @@ u16 AcceleratorGetSample()
 // We start getting samples not from sample 0, but 0.<curr_pos_frac>. This
 // avoids discontinuities in the audio stream, especially with very low ratios
 // which interpolate a lot of values between two "real" samples.
-u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count,
+u32 ResampleAudio(const s16* input, s16* output, u32 count,
                   s16* last_samples, u32 curr_pos, u32 ratio, int srctype,
                   const s16* coeffs)
 {
@@ -298,7 +442,7 @@ u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count
 			curr_pos += ratio;
 			while (curr_pos >= 0x10000)
 			{
-				temp[idx++ & 3] = input_callback(read_samples_count++);
+				temp[idx++ & 3] = input[4 + read_samples_count++];
 				curr_pos -= 0x10000;
 			}
 
@@ -322,66 +466,32 @@ u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count
 	}
 	else if (srctype == SRCTYPE_LINEAR || srctype == SRCTYPE_POLYPHASE)
 	{
-		// This is the circular buffer containing samples to use for the
-		// interpolation. It is initialized with the values from the PB, and it
-		// will be stored back to the PB at the end.
-		s16 temp[4];
-		u32 idx = 0;
-
-		temp[idx++ & 3] = last_samples[0];
-		temp[idx++ & 3] = last_samples[1];
-		temp[idx++ & 3] = last_samples[2];
-		temp[idx++ & 3] = last_samples[3];
-
+		// The input is the history of the last four samples followed by the
+		// new ones. Each output sample interpolates between the oldest two
+		// samples of the history at that point. Once every input sample up to
+		// the current position has been pushed, the oldest history sample is
+		// input[pos >> 16].
+		u64 pos = curr_pos;
 		for (u32 i = 0; i < count; ++i)
 		{
-			curr_pos += ratio;
-
-			// While our current position is >= 1.0, push new samples to the
-			// circular buffer.
-			while (curr_pos >= 0x10000)
-			{
-				temp[idx++ & 3] = input_callback(read_samples_count++);
-				curr_pos -= 0x10000;
-			}
-
-			// Get our current fractional position, used to know how much of
-			// curr0 and how much of curr1 the output sample should be.
-			u16 curr_frac = curr_pos & 0xFFFF;
-			u16 inv_curr_frac = -curr_frac;
+			pos += ratio;
 
-			// Interpolate! If curr_frac is 0, we can simply take the last
-			// sample without any multiplying.
-			s16 sample;
-			if (curr_frac)
-			{
-				s32 s0 = temp[idx++ & 3];
-				s32 s1 = temp[idx++ & 3];
-
-				sample = ((s0 * inv_curr_frac) + (s1 * curr_frac)) >> 16;
-				idx += 2;
-			}
-			else
-			{
-				sample = temp[idx++ & 3];
-				idx += 3;
-			}
+			const s16* s = &input[pos >> 16];
+			s32 curr_frac = pos & 0xFFFF;
 
-			output[i] = sample;
+			// Equal to the oldest sample if curr_frac is 0.
+			output[i] = ((s[0] * (0x10000 - curr_frac)) + (s[1] * curr_frac)) >> 16;
 		}
 
 		// Update the four last_samples values.
-		last_samples[3] = temp[--idx & 3];
-		last_samples[2] = temp[--idx & 3];
-		last_samples[1] = temp[--idx & 3];
-		last_samples[0] = temp[--idx & 3];
+		memcpy(last_samples, &input[pos >> 16], 4 * sizeof (s16));
+		curr_pos = pos & 0xFFFF;
 	}
 	else // SRCTYPE_NEAREST
 	{
-		// No sample rate conversion here: simply read samples from the
-		// accelerator to the output buffer.
-		for (u32 i = 0; i < count; ++i)
-			output[i] = input_callback(i);
+		// No sample rate conversion here: simply copy the input samples to
+		// the output buffer.
+		memcpy(output, input + 4, count * sizeof (s16));
 
 		memcpy(last_samples, output + count - 4, 4 * sizeof (u16));
 	}
@@ -394,13 +504,29 @@ u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count
 void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 {
 	u32 cur_addr = HILO_TO_32(pb.audio_addr.cur_addr);
-	AcceleratorSetup(&pb, &cur_addr);
+	AcceleratorState acc;
+	AcceleratorSetup(&acc, &pb, &cur_addr);
+
+	// Decode all the samples needed by the resampler up front. Ratios above
+	// 4.0 are out of spec but still handled.
+	u32 ratio = HILO_TO_32(pb.src.ratio);
+	u32 input_count = GetResampleInputCount(count, pb.src.cur_addr_frac, ratio, pb.src_type);
+
+	s16 input_buffer[4 + 4 * MAX_SAMPLES_PER_FRAME];
+	std::vector<s16> large_input;
+	s16* input = input_buffer;
+	if (4 + input_count > sizeof (input_buffer) / sizeof (input_buffer[0]))
+	{
+		large_input.resize(4 + input_count);
+		input = large_input.data();
+	}
+	memcpy(input, pb.src.last_samples, 4 * sizeof (s16));
+	AcceleratorGetSamples(&acc, input + 4, input_count);
 
 	if (coeffs)
 		coeffs += pb.coef_select * 0x200;
-	u32 curr_pos = ResampleAudio([](u32) { return AcceleratorGetSample(); },
-	                             samples, count, pb.src.last_samples,
-	                             pb.src.cur_addr_frac, HILO_TO_32(pb.src.ratio),
+	u32 curr_pos = ResampleAudio(input, samples, count, pb.src.last_samples,
+	                             pb.src.cur_addr_frac, ratio,
 	                             pb.src_type, coeffs);
 	pb.src.cur_addr_frac = (curr_pos & 0xFFFF);
 
@@ -409,6 +535,82 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 	pb.audio_addr.cur_addr_lo = (u16)(cur_addr & 0xFFFF);
 }
 
+#if _M_SSE >= 0x200
+// Computes (s16)((sample * volume) >> 15) for eight signed samples and
+// unsigned volumes, returned as two vectors of four 32-bit values.
+inline void MultiplyVolumes(__m128i samples, __m128i volumes, __m128i* lo, __m128i* hi)
+{
+	// The products fit in 32 bits. mulhi_epi16 treats the volumes as signed,
+	// which is off by sample << 16 for volumes >= 0x8000.
+	__m128i prod_lo = _mm_mullo_epi16(samples, volumes);
+	__m128i prod_hi = _mm_mulhi_epi16(samples, volumes);
+	prod_hi = _mm_add_epi16(prod_hi, _mm_and_si128(samples, _mm_srai_epi16(volumes, 15)));
+
+	*lo = _mm_srai_epi32(_mm_slli_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(prod_lo, prod_hi), 15), 16), 16);
+	*hi = _mm_srai_epi32(_mm_slli_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(prod_lo, prod_hi), 15), 16), 16);
+}
+
+// Volumes of eight consecutive samples starting at <volume>.
+inline __m128i RampVolumes(u16 volume, u16 volume_delta)
+{
+	return _mm_add_epi16(_mm_set1_epi16(volume),
+	                     _mm_mullo_epi16(_mm_set1_epi16(volume_delta), _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7)));
+}
+#elif defined(AX_NEON)
+// Computes (s16)((sample * volume) >> 15) for eight signed samples and
+// unsigned volumes.
+inline int16x8_t MultiplyVolumes(int16x8_t samples, uint16x8_t volumes)
+{
+	// The volumes are widened as unsigned, so that the products fit in 32
+	// bits. The narrowing shift keeps the low 16 bits, like the cast.
+	int32x4_t lo = vmulq_s32(vmovl_s16(vget_low_s16(samples)), vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(volumes))));
+	int32x4_t hi = vmulq_s32(vmovl_s16(vget_high_s16(samples)), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(volumes))));
+	return vcombine_s16(vshrn_n_s32(lo, 15), vshrn_n_s32(hi, 15));
+}
+
+// Volumes of eight consecutive samples starting at <volume>.
+inline uint16x8_t RampVolumes(u16 volume, u16 volume_delta)
+{
+	static const u16 steps[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+	return vmlaq_n_u16(vdupq_n_u16(volume), vld1q_u16(steps), volume_delta);
+}
+#endif
+
+// Multiply samples by a volume which is ramped by <volume_delta> per sample.
+void ApplyVolumeRamp(s16* samples, u32 count, u16* pvol, u16 volume_delta)
+{
+	u16& volume = *pvol;
+	u32 i = 0;
+
+#if _M_SSE >= 0x200
+	__m128i volumes = RampVolumes(volume, volume_delta);
+	const __m128i volume_step = _mm_set1_epi16(volume_delta * 8);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i lo, hi;
+		MultiplyVolumes(_mm_loadu_si128((const __m128i*)&samples[i]), volumes, &lo, &hi);
+		_mm_storeu_si128((__m128i*)&samples[i], _mm_packs_epi32(lo, hi));
+		volumes = _mm_add_epi16(volumes, volume_step);
+	}
+	volume += volume_delta * i;
+#elif defined(AX_NEON)
+	uint16x8_t volumes = RampVolumes(volume, volume_delta);
+	const uint16x8_t volume_step = vdupq_n_u16(volume_delta * 8);
+	for (; i + 8 <= count; i += 8)
+	{
+		vst1q_s16(&samples[i], MultiplyVolumes(vld1q_s16(&samples[i]), volumes));
+		volumes = vaddq_u16(volumes, volume_step);
+	}
+	volume += volume_delta * i;
+#endif
+
+	for (; i < count; ++i)
+	{
+		samples[i] = ((s32)samples[i] * volume) >> 15;
+		volume += volume_delta;
+	}
+}
+
 // Add samples to an output buffer, with optional volume ramping.
 void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
 {
@@ -421,7 +623,44 @@ void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ra
 	if (!ramp)
 		volume_delta = 0;
 
-	for (u32 i = 0; i < count; ++i)
+	u32 i = 0;
+
+#if _M_SSE >= 0x200
+	__m128i volumes = RampVolumes(volume, volume_delta);
+	const __m128i volume_step = _mm_set1_epi16(volume_delta * 8);
+	__m128i hi = _mm_setzero_si128();
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i lo;
+		MultiplyVolumes(_mm_loadu_si128((const __m128i*)&input[i]), volumes, &lo, &hi);
+		_mm_storeu_si128((__m128i*)&out[i], _mm_add_epi32(_mm_loadu_si128((const __m128i*)&out[i]), lo));
+		_mm_storeu_si128((__m128i*)&out[i + 4], _mm_add_epi32(_mm_loadu_si128((const __m128i*)&out[i + 4]), hi));
+		volumes = _mm_add_epi16(volumes, volume_step);
+	}
+	if (i)
+	{
+		volume += volume_delta * i;
+		*dpop = (s16)_mm_cvtsi128_si32(_mm_srli_si128(hi, 12));
+	}
+#elif defined(AX_NEON)
+	uint16x8_t volumes = RampVolumes(volume, volume_delta);
+	const uint16x8_t volume_step = vdupq_n_u16(volume_delta * 8);
+	int16x8_t mixed = vdupq_n_s16(0);
+	for (; i + 8 <= count; i += 8)
+	{
+		mixed = MultiplyVolumes(vld1q_s16(&input[i]), volumes);
+		vst1q_s32(&out[i], vaddw_s16(vld1q_s32(&out[i]), vget_low_s16(mixed)));
+		vst1q_s32(&out[i + 4], vaddw_s16(vld1q_s32(&out[i + 4]), vget_high_s16(mixed)));
+		volumes = vaddq_u16(volumes, volume_step);
+	}
+	if (i)
+	{
+		volume += volume_delta * i;
+		*dpop = vgetq_lane_s16(mixed, 7);
+	}
+#endif
+
+	for (; i < count; ++i)
 	{
 		s64 sample = input[i];
 		sample *= volume;
@@ -456,11 +695,7 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 	GetInputSamples(pb, samples, count, coeffs);
 
 	// Apply a global volume ramp using the volume envelope parameters.
-	for (u32 i = 0; i < count; ++i)
-	{
-		samples[i] = ((s32)samples[i] * pb.vol_env.cur_volume) >> 15;
-		pb.vol_env.cur_volume += pb.vol_env.cur_volume_delta;
-	}
+	ApplyVolumeRamp(samples, count, &pb.vol_env.cur_volume, pb.vol_env.cur_volume_delta);
 
 	// Optionally, execute a low pass filter
 	// TODO: LPF code is currently broken, causing Super Monkey Ball sound
@@ -527,8 +762,11 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 
 		// We use ratio 0x55555 == (5 * 65536 + 21845) / 65536 == 5.3333 which
 		// is the nearest we can get to 96/18
-		u32 curr_pos = ResampleAudio([&samples](u32 i) { return samples[i]; },
-		                             wm_samples, wm_count, pb.remote_src.last_samples,
+		s16 wm_input[4 + MAX_SAMPLES_PER_FRAME];
+		memcpy(wm_input, pb.remote_src.last_samples, 4 * sizeof (s16));
+		memcpy(wm_input + 4, samples, count * sizeof (s16));
+
+		u32 curr_pos = ResampleAudio(wm_input, wm_samples, wm_count, pb.remote_src.last_samples,
 		                             pb.remote_src.cur_addr_frac, 0x55555,
 		                             SRCTYPE_POLYPHASE, coeffs);
 		pb.remote_src.cur_addr_frac = curr_pos & 0xFFFF;
@@ -427,64 +427,86 @@ void AXWiiUCode::ReinjectUpdatesFields(AXPBWii& pb, u16* num_updates, u32 update
 
 void AXWiiUCode::ProcessPBList(u32 pb_addr)
 {
+	// Gather the voices first. Updates can change next_pb, so the list is
+	// followed as it looks once all updates have been applied.
+	std::vector<u32> pb_addrs;
+	std::vector<AXPBWii> pbs;
 	AXPBWii pb;
-
 	while (pb_addr)
 	{
-		AXBuffers buffers = {{
-			m_samples_left,
-			m_samples_right,
-			m_samples_surround,
-			m_samples_auxA_left,
-			m_samples_auxA_right,
-			m_samples_auxA_surround,
-			m_samples_auxB_left,
-			m_samples_auxB_right,
-			m_samples_auxB_surround,
-			m_samples_auxC_left,
-			m_samples_auxC_right,
-			m_samples_auxC_surround,
-			m_samples_wm0,
-			m_samples_aux0,
-			m_samples_wm1,
-			m_samples_aux1,
-			m_samples_wm2,
-			m_samples_aux2,
-			m_samples_wm3,
-			m_samples_aux3
-		}};
-
 		if (!ReadPB(pb_addr, pb))
 			break;
 
+		pb_addrs.push_back(pb_addr);
+		pbs.push_back(pb);
+
 		u16 num_updates[3];
 		u16 updates[1024];
 		u32 updates_addr;
 		if (ExtractUpdatesFields(pb, num_updates, updates, &updates_addr))
 		{
 			for (int curr_ms = 0; curr_ms < 3; ++curr_ms)
-			{
 				ApplyUpdatesForMs(curr_ms, (u16*)&pb, num_updates, updates);
-				ProcessVoice(pb, buffers, 32,
-				             ConvertMixerControl(HILO_TO_32(pb.mixer_control)),
+			ReinjectUpdatesFields(pb, num_updates, updates_addr);
+		}
+
+		pb_addr = HILO_TO_32(pb.next_pb);
+	}
+
+	AXBuffers buffers = {{
+		m_samples_left,
+		m_samples_right,
+		m_samples_surround,
+		m_samples_auxA_left,
+		m_samples_auxA_right,
+		m_samples_auxA_surround,
+		m_samples_auxB_left,
+		m_samples_auxB_right,
+		m_samples_auxB_surround,
+		m_samples_auxC_left,
+		m_samples_auxC_right,
+		m_samples_auxC_surround,
+		m_samples_wm0,
+		m_samples_aux0,
+		m_samples_wm1,
+		m_samples_aux1,
+		m_samples_wm2,
+		m_samples_aux2,
+		m_samples_wm3,
+		m_samples_aux3
+	}};
+
+	ProcessVoices(m_voice_workers, buffers, (u32)pbs.size(), [&](u32 voice, AXBuffers worker_buffers) {
+		AXPBWii& voice_pb = pbs[voice];
+
+		u16 num_updates[3];
+		u16 updates[1024];
+		u32 updates_addr;
+		if (ExtractUpdatesFields(voice_pb, num_updates, updates, &updates_addr))
+		{
+			for (int curr_ms = 0; curr_ms < 3; ++curr_ms)
+			{
+				ApplyUpdatesForMs(curr_ms, (u16*)&voice_pb, num_updates, updates);
+				ProcessVoice(voice_pb, worker_buffers, 32,
+				             ConvertMixerControl(HILO_TO_32(voice_pb.mixer_control)),
 				             m_coeffs_available ? m_coeffs : nullptr);
 
 				// Forward the buffers
-				for (u32 i = 0; i < sizeof (buffers.ptrs) / sizeof (buffers.ptrs[0]); ++i)
-					buffers.ptrs[i] += 32;
+				for (u32 i = 0; i < sizeof (worker_buffers.ptrs) / sizeof (worker_buffers.ptrs[0]); ++i)
+					worker_buffers.ptrs[i] += 32;
 			}
-			ReinjectUpdatesFields(pb, num_updates, updates_addr);
+			ReinjectUpdatesFields(voice_pb, num_updates, updates_addr);
 		}
 		else
 		{
-			ProcessVoice(pb, buffers, 96,
-			             ConvertMixerControl(HILO_TO_32(pb.mixer_control)),
+			ProcessVoice(voice_pb, worker_buffers, 96,
+			             ConvertMixerControl(HILO_TO_32(voice_pb.mixer_control)),
 			             m_coeffs_available ? m_coeffs : nullptr);
 		}
+	});
 
-		WritePB(pb_addr, pb);
-		pb_addr = HILO_TO_32(pb.next_pb);
-	}
+	for (size_t i = 0; i < pbs.size(); ++i)
+		WritePB(pb_addrs[i], pbs[i]);
 }
 
 void AXWiiUCode::MixAUXSamples(int aux_id, u32 write_addr, u32 read_addr, u16 volume)
@@ -18,6 +18,82 @@
 #include "Core/HW/DSPHLE/UCodes/UCodes.h"
 #include "Core/HW/DSPHLE/UCodes/Zelda.h"
 
+VoiceWorkerPool::VoiceWorkerPool(u32 num_threads)
+	: m_num_threads(num_threads)
+	, m_process(nullptr)
+	, m_count(0)
+{
+}
+
+VoiceWorkerPool::~VoiceWorkerPool()
+{
+	m_running.Clear();
+	for (auto& worker : m_workers)
+	{
+		worker->start.Set();
+		worker->thread.join();
+	}
+}
+
+u32 VoiceWorkerPool::GetNumThreads()
+{
+	if (!m_running.IsSet())
+		StartWorkers();
+	return (u32)m_workers.size() + 1;
+}
+
+void VoiceWorkerPool::Run(u32 count, const std::function<void(u32, u32)>& process)
+{
+	if (!m_running.IsSet())
+		StartWorkers();
+
+	m_process = &process;
+	m_count = count;
+	m_next_item.store(0);
+
+	for (auto& worker : m_workers)
+		worker->start.Set();
+	ProcessItems(0);
+	for (auto& worker : m_workers)
+		worker->done.Wait();
+}
+
+void VoiceWorkerPool::StartWorkers()
+{
+	// The calling thread counts as one of them.
+	u32 num_threads = m_num_threads ? m_num_threads : Common::GetHelperThreadCount();
+	u32 num_workers = num_threads - 1;
+	m_running.Set();
+	for (u32 i = 0; i < num_workers; ++i)
+	{
+		Worker* worker = new Worker;
+		worker->thread = std::thread(&VoiceWorkerPool::WorkerThread, this, worker, i + 1);
+		m_workers.emplace_back(worker);
+	}
+}
+
+void VoiceWorkerPool::WorkerThread(Worker* worker, u32 thread)
+{
+	Common::SetCurrentThreadName("HLE voice worker");
+
+	while (true)
+	{
+		worker->start.Wait();
+		if (!m_running.IsSet())
+			break;
+
+		ProcessItems(thread);
+		worker->done.Set();
+	}
+}
+
+void VoiceWorkerPool::ProcessItems(u32 thread)
+{
+	u32 item;
+	while ((item = m_next_item.fetch_add(1)) < m_count)
+		(*m_process)(item, thread);
+}
+
 UCodeInterface* UCodeFactory(u32 crc, DSPHLE *dsphle, bool wii)
 {
 	switch (crc)
@@ -4,8 +4,16 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/Flag.h"
 #include "Common/Thread.h"
 
 #include "Core/HW/Memmap.h"
@@ -57,6 +65,50 @@ inline void* HLEMemory_Get_Pointer(u32 address)
 		return &Memory::m_pRAM[address & Memory::RAM_MASK];
 }
 
+// Worker threads used by the audio ucodes to render the voices of a frame
+// in parallel. Each thread mixes into its own output buffers, which are
+// added up afterwards. Integer sums don't depend on the order of the
+// additions, so the output is bit-identical to rendering the voices one by
+// one.
+class VoiceWorkerPool
+{
+public:
+	// num_threads includes the calling thread. 0 picks it from the number
+	// of host threads.
+	explicit VoiceWorkerPool(u32 num_threads = 0);
+	~VoiceWorkerPool();
+
+	// Number of threads taking part in Run, including the calling thread.
+	u32 GetNumThreads();
+
+	// Calls process(item, thread) for every item in [0, count) and returns
+	// once all of them are done. The calling thread is thread 0.
+	void Run(u32 count, const std::function<void(u32, u32)>& process);
+
+private:
+	struct Worker
+	{
+		std::thread thread;
+		Common::Event start;
+		Common::Event done;
+	};
+
+	void StartWorkers();
+	void WorkerThread(Worker* worker, u32 thread);
+	void ProcessItems(u32 thread);
+
+	u32 m_num_threads;
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	Common::Flag m_running;
+
+	const std::function<void(u32, u32)>* m_process;
+	u32 m_count;
+	std::atomic<u32> m_next_item;
+};
+
+// Below this, waking up the voice workers costs more than it saves.
+static const u32 MIN_PARALLEL_VOICES = 8;
+
 class UCodeInterface
 {
 public:
@@ -53,11 +53,6 @@ ZeldaUCode::ZeldaUCode(DSPHLE *dsphle, u32 crc)
 		m_mail_handler.PushMail(0xF3551111); // handshake
 	}
 
-	m_voice_buffer = new s32[256 * 1024];
-	m_resample_buffer = new s16[256 * 1024];
-	m_left_buffer = new s32[256 * 1024];
-	m_right_buffer = new s32[256 * 1024];
-
 	memset(m_buffer, 0, sizeof(m_buffer));
 	memset(m_sync_flags, 0, sizeof(m_sync_flags));
 	memset(m_afc_coef_table, 0, sizeof(m_afc_coef_table));
@@ -67,11 +62,6 @@ ZeldaUCode::ZeldaUCode(DSPHLE *dsphle, u32 crc)
 ZeldaUCode::~ZeldaUCode()
 {
 	m_mail_handler.Clear();
-
-	delete [] m_voice_buffer;
-	delete [] m_resample_buffer;
-	delete [] m_left_buffer;
-	delete [] m_right_buffer;
 }
 
 u8 *ZeldaUCode::GetARAMPointer(u32 address)
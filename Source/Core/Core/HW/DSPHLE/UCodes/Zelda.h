@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Core/HW/DSPHLE/UCodes/UCodes.h"
 
@@ -132,6 +134,14 @@ public:
 
 	void DoState(PointerWrap &p) override;
 
+	// Samples mixed per MixAudio call.
+	static const int MIX_BUFFER_SAMPLES = 5 * 16;
+
+	// Renders the voices and sums them into left_mix and right_mix, which
+	// hold MIX_BUFFER_SAMPLES each. Without a pool, the voices are rendered
+	// one by one on the calling thread. The output is the same either way.
+	void RenderVoices(std::vector<ZeldaVoicePB>& pbs, VoiceWorkerPool* pool, s32* left_mix, s32* right_mix);
+
 	int *templbuffer;
 	int *temprbuffer;
 
@@ -197,11 +207,19 @@ private:
 		}
 	}
 
+	// Scratch and mix buffers of one voice rendering thread. The mixes of
+	// all threads are added together at the end of a frame.
 	// These are the only dynamically allocated things allowed in the ucode.
-	s32* m_voice_buffer;
-	s16* m_resample_buffer;
-	s32* m_left_buffer;
-	s32* m_right_buffer;
+	struct RenderBuffers
+	{
+		std::vector<s32> voice;
+		std::vector<s16> resample;
+		std::vector<s32> left;
+		std::vector<s32> right;
+	};
+	std::vector<RenderBuffers> m_render_buffers;
+
+	VoiceWorkerPool m_voice_workers;
 
 	// If you add variables, remember to keep DoState() and the constructor up to date.
 
@@ -287,8 +305,9 @@ private:
 	int ConvertRatio(int pb_ratio);
 	int SizeForResampling(ZeldaVoicePB &PB, int size);
 
-	// Renders a voice and mixes it into LeftBuffer, RightBuffer
-	void RenderAddVoice(ZeldaVoicePB& PB, s32* _LeftBuffer, s32* _RightBuffer, int _Size);
+	// Renders a voice and mixes it into LeftBuffer, RightBuffer, using
+	// VoiceBuffer and ResampleBuffer as scratch space.
+	void RenderAddVoice(ZeldaVoicePB& PB, s32* _LeftBuffer, s32* _RightBuffer, s32* _VoiceBuffer, s16* _ResampleBuffer, int _Size);
 
 	void MixAudio();
 };
@@ -20,7 +20,7 @@ void ZeldaUCode::RenderSynth_RectWave(ZeldaVoicePB &PB, s32* _Buffer, int _Size)
 	int i = 0;
 
 	if (PB.KeyOff != 0)
-		return;
+		goto clear_buffer;
 
 	if (PB.NeedsReset)
 	{
@@ -39,6 +39,12 @@ _lRestart:
 			PB.KeyOff = 1;
 			PB.RemLength = 0;
 			PB.CurAddr = PB.StartAddr + (PB.RestartPos << 1) + PB.Length;
+
+			// The buffer still holds whatever voice was rendered into it
+			// before, which depends on the voice worker thread.
+clear_buffer:
+			while (i < _Size)
+				_Buffer[i++] = 0;
 			return;
 		}
 		else
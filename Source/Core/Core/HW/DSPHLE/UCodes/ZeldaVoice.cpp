@@ -2,7 +2,9 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 #include "Common/MathUtil.h"
 
@@ -333,11 +335,17 @@ restart:
 	u32 SamplePosition = PB.Length - PB.RemLength;
 	while (sampleCount < _RealSize)
 	{
-		_Buffer[sampleCount] = outbuf[SamplePosition & 15];
-		sampleCount++;
-
-		SamplePosition++;
-		PB.RemLength--;
+		// Copy up to the end of the decoded block, the end of the sample or
+		// the end of the buffer, whichever comes first. A RemLength of 0
+		// only runs out after wrapping around.
+		u32 run = std::min<u32>(16 - (SamplePosition & 15), _RealSize - sampleCount);
+		if (PB.RemLength != 0)
+			run = std::min<u32>(run, PB.RemLength);
+		memcpy(&_Buffer[sampleCount], &outbuf[SamplePosition & 15], run * sizeof(short));
+		sampleCount += run;
+
+		SamplePosition += run;
+		PB.RemLength -= run;
 		if (PB.RemLength == 0)
 		{
 			PB.ReachedEnd = 1;
@@ -473,13 +481,13 @@ void Decoder21_ReadAudio(ZeldaVoicePB &PB, int size, s16 *_Buffer)
 }
 
 
-void ZeldaUCode::RenderAddVoice(ZeldaVoicePB &PB, s32* _LeftBuffer, s32* _RightBuffer, int _Size)
+void ZeldaUCode::RenderAddVoice(ZeldaVoicePB &PB, s32* _LeftBuffer, s32* _RightBuffer, s32* _VoiceBuffer, s16* _ResampleBuffer, int _Size)
 {
 	if (PB.IsBlank)
 	{
 		s32 sample = (s32)(s16)PB.FixedSample;
 		for (int i = 0; i < _Size; i++)
-			m_voice_buffer[i] = sample;
+			_VoiceBuffer[i] = sample;
 
 		goto ContinueWithBlock;  // Yes, a goto. Yes, it's evil, but it makes the flow look much more like the DSP code.
 	}
@@ -501,18 +509,18 @@ void ZeldaUCode::RenderAddVoice(ZeldaVoicePB &PB, s32* _LeftBuffer, s32* _RightB
 	{
 	case 0x0005: // AFC with extra low bitrate (32:5 compression).
 	case 0x0009: // AFC with normal bitrate (32:9 compression).
-		RenderVoice_AFC(PB, m_resample_buffer + 4, _Size);
-		Resample(PB, _Size, m_resample_buffer + 4, m_voice_buffer, true);
+		RenderVoice_AFC(PB, _ResampleBuffer + 4, _Size);
+		Resample(PB, _Size, _ResampleBuffer + 4, _VoiceBuffer, true);
 		break;
 
 	case 0x0008: // PCM8 - normal PCM 8-bit audio. Used in Mario Kart DD + very little in Zelda WW.
-		RenderVoice_PCM8(PB, m_resample_buffer + 4, _Size);
-		Resample(PB, _Size, m_resample_buffer + 4, m_voice_buffer, true);
+		RenderVoice_PCM8(PB, _ResampleBuffer + 4, _Size);
+		Resample(PB, _Size, _ResampleBuffer + 4, _VoiceBuffer, true);
 		break;
 
 	case 0x0010: // PCM16 - normal PCM 16-bit audio.
-		RenderVoice_PCM16(PB, m_resample_buffer + 4, _Size);
-		Resample(PB, _Size, m_resample_buffer + 4, m_voice_buffer, true);
+		RenderVoice_PCM16(PB, _ResampleBuffer + 4, _Size);
+		Resample(PB, _Size, _ResampleBuffer + 4, _VoiceBuffer, true);
 		break;
 
 	case 0x0020:
@@ -520,15 +528,15 @@ void ZeldaUCode::RenderAddVoice(ZeldaVoicePB &PB, s32* _LeftBuffer, s32* _RightB
 		// to the output buffer. However, (if we ever see this sound type), we'll
 		// have to resample anyway since we're running at a different sample rate.
 
-		RenderVoice_Raw(PB, m_resample_buffer + 4, _Size);
-		Resample(PB, _Size, m_resample_buffer + 4, m_voice_buffer, true);
+		RenderVoice_Raw(PB, _ResampleBuffer + 4, _Size);
+		Resample(PB, _Size, _ResampleBuffer + 4, _VoiceBuffer, true);
 		break;
 
 	case 0x0021:
 		// Raw sound from RAM. Important for Zelda WW. Cutscenes use the music
 		// to let the game know they ended
-		RenderVoice_Raw(PB, m_resample_buffer + 4, _Size);
-		Resample(PB, _Size, m_resample_buffer + 4, m_voice_buffer, true);
+		RenderVoice_Raw(PB, _ResampleBuffer + 4, _Size);
+		Resample(PB, _Size, _ResampleBuffer + 4, _VoiceBuffer, true);
 		break;
 
 	default:
@@ -543,16 +551,16 @@ void ZeldaUCode::RenderAddVoice(ZeldaVoicePB &PB, s32* _LeftBuffer, s32* _RightB
 		// Synthesized sounds
 		case 0x0003: WARN_LOG(DSPHLE, "PB Format 0x03 used!");
 		case 0x0000: // Example: Magic meter filling up in ZWW
-			RenderSynth_RectWave(PB, m_voice_buffer, _Size);
+			RenderSynth_RectWave(PB, _VoiceBuffer, _Size);
 			break;
 
 		case 0x0001: // Example: "Denied" sound when trying to pull out a sword indoors in ZWW
-			RenderSynth_SawWave(PB, m_voice_buffer, _Size);
+			RenderSynth_SawWave(PB, _VoiceBuffer, _Size);
 			break;
 
 		case 0x0006:
 			WARN_LOG(DSPHLE, "Synthesizing 0x0006 (constant sound)");
-			RenderSynth_Constant(PB, m_voice_buffer, _Size);
+			RenderSynth_Constant(PB, _VoiceBuffer, _Size);
 			break;
 
 		// These are more "synth" formats - square wave, saw wave etc.
@@ -564,12 +572,12 @@ void ZeldaUCode::RenderAddVoice(ZeldaVoicePB &PB, s32* _LeftBuffer, s32* _RightB
 		case 0x0007: // Example: "success" SFX in Pikmin 1, Pikmin 2 in a cave, not sure what sound it is.
 		case 0x000b: // Example: SFX in area selection menu in Pikmin
 		case 0x000c: // Example: beam of death/yellow force-field in Temple of the Gods, ZWW
-			RenderSynth_WaveTable(PB, m_voice_buffer, _Size);
+			RenderSynth_WaveTable(PB, _VoiceBuffer, _Size);
 			break;
 
 		default:
 			// TODO: Implement general decoder here
-			memset(m_voice_buffer, 0, _Size * sizeof(s32));
+			memset(_VoiceBuffer, 0, _Size * sizeof(s32));
 			ERROR_LOG(DSPHLE, "Unknown MixAddVoice format in zelda %04x", PB.Format);
 			break;
 		}
@@ -644,22 +652,19 @@ ContinueWithBlock:
 			b00[i + 0x10] = (s16)b00[i + 0xc] * PB.raw[0x29];
 		}
 
-		for (int count = 0; count < 8; count++)
+		// The 8 buffers to mix to: 0d00, 0d60, 0f40 0ca0 0e80 0ee0 0c00 0c50
+		// We just mix to the first two and call it stereo :p
+		for (int count = 0; count < 2; count++)
 		{
-			// The 8 buffers to mix to: 0d00, 0d60, 0f40 0ca0 0e80 0ee0 0c00 0c50
-			// We just mix to the first two and call it stereo :p
 			int value = b00[0x4 + count];
 			//int delta = b00[0xC + count] << 11; // Unused?
 
 			int ramp = value << 16;
+			s32* buffer = count == 0 ? _LeftBuffer : _RightBuffer;
 			for (int i = 0; i < _Size; i++)
 			{
-				int unmixed_audio = m_voice_buffer[i];
-				switch (count)
-				{
-				case 0: _LeftBuffer[i] += (u64)unmixed_audio * ramp >> 29; break;
-				case 1: _RightBuffer[i] += (u64)unmixed_audio * ramp >> 29; break;
-				}
+				int unmixed_audio = _VoiceBuffer[i];
+				buffer[i] += (u64)unmixed_audio * ramp >> 29;
 			}
 		}
 	}
@@ -707,23 +712,29 @@ ContinueWithBlock:
 			if (mix)
 			{
 				// 0ca9_RampedMultiplyAddBuffer
-				for (int i = 0; i < _Size; i++)
+				// TODO - add to buffer specified by dest_buffer_address
+				// Only the first two buffers are mixed. The others just need
+				// the ramp, which goes up once every two samples.
+				s32* buffer = count == 0 ? _LeftBuffer : (count == 1 ? _RightBuffer : nullptr);
+				if (buffer)
 				{
-					int value = m_voice_buffer[i];
-
-					// TODO - add to buffer specified by dest_buffer_address
-					switch (count)
+					for (int i = 0; i < _Size; i++)
 					{
+						int value = _VoiceBuffer[i];
+
 						// These really should be 32.
-						case 0: _LeftBuffer[i] += (u64)value * ramp >> 29; break;
-						case 1: _RightBuffer[i] += (u64)value * ramp >> 29; break;
-					}
+						buffer[i] += (u64)value * ramp >> 29;
 
-					if (((i & 1) == 0) && i < 64)
-					{
-						ramp += delta;
+						if (((i & 1) == 0) && i < 64)
+						{
+							ramp += delta;
+						}
 					}
 				}
+				else
+				{
+					ramp += (u32)delta * (u32)((std::min(_Size, 64) + 1) / 2);
+				}
 				if (_Size < 32)
 				{
 					ramp += delta * (_Size - 32);
@@ -742,15 +753,61 @@ ContinueWithBlock:
 	}
 }
 
-void ZeldaUCode::MixAudio()
+void ZeldaUCode::RenderVoices(std::vector<ZeldaVoicePB>& pbs, VoiceWorkerPool* pool, s32* left_mix, s32* right_mix)
 {
-	const int BufferSamples = 5 * 16;
+	u32 num_threads = pool ? pool->GetNumThreads() : 1;
+	if (m_render_buffers.size() < num_threads)
+		m_render_buffers.resize(num_threads);
+	for (u32 thread = 0; thread < num_threads; thread++)
+	{
+		RenderBuffers& buffers = m_render_buffers[thread];
+		if (buffers.voice.empty())
+		{
+			buffers.voice.resize(256 * 1024);
+			buffers.resample.resize(256 * 1024);
+		}
+		buffers.left.assign(MIX_BUFFER_SAMPLES, 0);
+		buffers.right.assign(MIX_BUFFER_SAMPLES, 0);
+	}
 
-	// Final mix buffers
-	memset(m_left_buffer, 0, BufferSamples * sizeof(s32));
-	memset(m_right_buffer, 0, BufferSamples * sizeof(s32));
+	auto render_voice = [&](u32 voice, u32 thread) {
+		RenderBuffers& buffers = m_render_buffers[thread];
+		RenderAddVoice(pbs[voice], buffers.left.data(), buffers.right.data(),
+		               buffers.voice.data(), buffers.resample.data(), MIX_BUFFER_SAMPLES);
+	};
+	if (pool)
+	{
+		pool->Run((u32)pbs.size(), render_voice);
+	}
+	else
+	{
+		for (u32 voice = 0; voice < pbs.size(); voice++)
+			render_voice(voice, 0);
+	}
 
-	// For each PB...
+	for (int i = 0; i < MIX_BUFFER_SAMPLES; i++)
+	{
+		left_mix[i] = m_render_buffers[0].left[i];
+		right_mix[i] = m_render_buffers[0].right[i];
+	}
+	for (u32 thread = 1; thread < num_threads; thread++)
+	{
+		for (int i = 0; i < MIX_BUFFER_SAMPLES; i++)
+		{
+			left_mix[i] += m_render_buffers[thread].left[i];
+			right_mix[i] += m_render_buffers[thread].right[i];
+		}
+	}
+}
+
+void ZeldaUCode::MixAudio()
+{
+	// Gather the voices to render. Their PBs don't overlap and a voice only
+	// reads its own PB, so they can all be read before any is written back.
+	std::vector<u32> voices;
+	std::vector<ZeldaVoicePB> pbs;
+	voices.reserve(m_num_voices);
+	pbs.reserve(m_num_voices);
 	for (u32 i = 0; i < m_num_voices; i++)
 	{
 		if (!IsLightVersion())
@@ -768,19 +825,26 @@ void ZeldaUCode::MixAudio()
 		if (pb.KeyOff != 0)
 			continue;
 
-		RenderAddVoice(pb, m_left_buffer, m_right_buffer, BufferSamples);
-		WritebackVoicePB(m_voice_pbs_addr + (i * 0x180), pb);
+		voices.push_back(i);
+		pbs.push_back(pb);
 	}
 
+	s32 left_mix[MIX_BUFFER_SAMPLES];
+	s32 right_mix[MIX_BUFFER_SAMPLES];
+	RenderVoices(pbs, pbs.size() >= MIN_PARALLEL_VOICES ? &m_voice_workers : nullptr, left_mix, right_mix);
+
+	for (size_t i = 0; i < pbs.size(); i++)
+		WritebackVoicePB(m_voice_pbs_addr + (voices[i] * 0x180), pbs[i]);
+
 	// Post processing, final conversion.
 	s16* left_buffer = (s16*)HLEMemory_Get_Pointer(m_left_buffers_addr);
 	s16* right_buffer = (s16*)HLEMemory_Get_Pointer(m_right_buffers_addr);
-	left_buffer += m_current_buffer * BufferSamples;
-	right_buffer += m_current_buffer * BufferSamples;
-	for (int i = 0; i < BufferSamples; i++)
+	left_buffer += m_current_buffer * MIX_BUFFER_SAMPLES;
+	right_buffer += m_current_buffer * MIX_BUFFER_SAMPLES;
+	for (int i = 0; i < MIX_BUFFER_SAMPLES; i++)
 	{
-		s32 left = m_left_buffer[i];
-		s32 right = m_right_buffer[i];
+		s32 left = left_mix[i];
+		s32 right = right_mix[i];
 
 		MathUtil::Clamp(&left, -32768, 32767);
 		left_buffer[i] = Common::swap16((short)left);
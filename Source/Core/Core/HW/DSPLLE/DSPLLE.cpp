@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <mutex>
 #include <thread>
 
@@ -35,7 +36,9 @@
 DSPLLE::DSPLLE()
 {
 	m_bIsRunning = false;
-	m_cycle_count = 0;
+	m_cycles_granted = 0;
+	m_cycles_done = 0;
+	m_max_skew = 0;
 }
 
 static Common::Event dspEvent;
@@ -78,7 +81,14 @@ void DSPLLE::DoState(PointerWrap &p)
 	p.DoArray(g_dsp.dram, DSP_DRAM_SIZE);
 	p.Do(cyclesLeft);
 	p.Do(init_hax);
-	p.Do(m_cycle_count);
+
+	u32 cycle_count = m_cycles_granted - m_cycles_done;
+	p.Do(cycle_count);
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		m_cycles_granted = cycle_count;
+		m_cycles_done = 0;
+	}
 }
 
 // Regular thread
@@ -88,28 +98,55 @@ void DSPLLE::dsp_thread(DSPLLE *dsp_lle)
 
 	while (dsp_lle->m_bIsRunning)
 	{
-		int cycles = (int)dsp_lle->m_cycle_count;
-		if (cycles > 0)
+		if (Common::AtomicLoadAcquire(dsp_lle->m_cycles_granted) != dsp_lle->m_cycles_done)
 		{
+			// Only contended while the emulation is paused, so the counters
+			// are read again under the lock in case a savestate was loaded.
 			std::lock_guard<std::mutex> lk(dsp_lle->m_csDSPThreadActive);
+			u32 done = dsp_lle->m_cycles_done;
+			int cycles = (int)(Common::AtomicLoadAcquire(dsp_lle->m_cycles_granted) - done);
+			if (cycles <= 0)
+				continue;
+			cycles = std::min(cycles, (int)MAX_CYCLES_PER_RUN);
+
+			u32 cycles_run;
 			if (dspjit)
 			{
-				DSPCore_RunCycles(cycles);
+				u16 cycles_left = DSPCore_RunCycles(cycles);
+				// The flag is only cleared by the next DSPCore_RunCycles, so it
+				// is still set if the JIT stopped to take the interrupt.
+				bool interrupted = Common::AtomicLoadAcquire(g_dsp.external_interrupt_waiting) &&
+				                   !(g_dsp.cr & CR_HALT);
+				cycles_run = CyclesRun(cycles, cycles_left, interrupted);
 			}
 			else
 			{
 				DSPInterpreter::RunCyclesThread(cycles);
+				cycles_run = cycles;
 			}
-			Common::AtomicStore(dsp_lle->m_cycle_count, 0);
+
+			Common::AtomicStoreRelease(dsp_lle->m_cycles_done, done + cycles_run);
+			ppcEvent.Set();
 		}
 		else
 		{
-			ppcEvent.Set();
 			dspEvent.Wait();
 		}
 	}
 }
 
+u32 DSPLLE::CyclesRun(u32 cycles, u16 cycles_left, bool interrupted)
+{
+	// The JIT runs whole blocks, so the last one usually overshoots and
+	// wraps cycles_left around. Cycles are only left over when the JIT
+	// returns early to take an external interrupt; those are run on the
+	// next pass, unless there is less than a block's worth, which would
+	// only make the thread go around again for nothing.
+	if (!interrupted || cycles_left > cycles || cycles_left < MAX_BLOCK_SIZE)
+		return cycles;
+	return cycles - cycles_left;
+}
+
 static bool LoadDSPRom(u16* rom, const std::string& filename, u32 size_in_bytes)
 {
 	std::string bytes;
@@ -147,6 +184,7 @@ static bool FillDSPInitOptions(DSPInitOptions* opts)
 
 	opts->core_type = SConfig::GetInstance().m_DSPEnableJIT ?
 		DSPInitOptions::CORE_JIT : DSPInitOptions::CORE_INTERPRETER;
+	opts->jit_stats = SConfig::GetInstance().m_DSPJITStats;
 
 	if (SConfig::GetInstance().m_DSPCaptureLog)
 	{
@@ -172,6 +210,13 @@ bool DSPLLE::Initialize(bool bWii, bool bDSPThread)
 	DSPCore_Reset();
 
 	m_bIsRunning = true;
+	m_cycles_granted = 0;
+	m_cycles_done = 0;
+	// The skew is configured in CPU cycles. Allow at least one update worth,
+	// and no more than the JIT can run in one go.
+	m_max_skew = std::max(SConfig::GetInstance().m_DSPThreadMaxSkew, (int)DSP_UpdateRate()) / 6;
+	if (m_max_skew > MAX_CYCLES_PER_RUN)
+		m_max_skew = MAX_CYCLES_PER_RUN;
 
 	InitInstructionTable();
 
@@ -312,11 +357,18 @@ void DSPLLE::DSP_Update(int cycles)
 	}
 	else
 	{
-		// Wait for dsp thread to complete its cycle. Note: this logic should be thought through.
-		ppcEvent.Wait();
-		Common::AtomicStore(m_cycle_count, dsp_cycles);
+		// Hand the cycles to the DSP thread, and only wait for it when it
+		// falls further behind than the configured skew.
+		u32 granted = m_cycles_granted;
+		while (m_bIsRunning)
+		{
+			u32 pending = granted - Common::AtomicLoadAcquire(m_cycles_done);
+			if (pending == 0 || pending + dsp_cycles <= m_max_skew)
+				break;
+			ppcEvent.Wait();
+		}
+		Common::AtomicStoreRelease(m_cycles_granted, granted + dsp_cycles);
 		dspEvent.Set();
-
 	}
 }
 
@@ -31,6 +31,15 @@ public:
 	virtual void DSP_StopSoundStream() override;
 	virtual u32 DSP_UpdateRate() override;
 
+	// The JIT counts the cycles it was handed in a u16, which wraps around
+	// when the last block overshoots. Handing it no more than half of the
+	// range tells the two apart.
+	static const u32 MAX_CYCLES_PER_RUN = 0x8000;
+
+	// How many of the cycles handed to DSPCore_RunCycles on the DSP thread
+	// count as run, given the cyclesLeft it returned.
+	static u32 CyclesRun(u32 cycles, u16 cycles_left, bool interrupted);
+
 private:
 	static void dsp_thread(DSPLLE* lpParameter);
 
@@ -39,5 +48,12 @@ private:
 	bool m_bWii;
 	bool m_bDSPThread;
 	bool m_bIsRunning;
-	volatile u32 m_cycle_count;
+
+	// Cycles handed to the DSP thread and cycles it has run. Each counter is
+	// written by one thread only, so their difference is the DSP's backlog
+	// without a lock. The CPU thread waits once the backlog would exceed
+	// m_max_skew.
+	volatile u32 m_cycles_granted;
+	volatile u32 m_cycles_done;
+	u32 m_max_skew;
 };
@@ -20,6 +20,7 @@
 #include "Core/HW/MMIO.h"
 #include "Core/HW/ProcessorInterface.h"
 #include "Core/HW/StreamADPCM.h"
+#include "Core/HW/StreamPrefetcher.h"
 #include "Core/HW/SystemTimers.h"
 #include "Core/PowerPC/PowerPC.h"
 
@@ -292,16 +293,14 @@ static u32 ProcessDTKSamples(short *tempPCM, u32 num_samples)
 
 		u8 tempADPCM[NGCADPCM::ONE_BLOCK_SIZE];
 		// TODO: What if we can't read from AudioPos?
-		VolumeHandler::ReadToPtr(tempADPCM, AudioPos, sizeof(tempADPCM));
+		StreamPrefetcher::ReadToPtr(tempADPCM, AudioPos, sizeof(tempADPCM));
 		AudioPos += sizeof(tempADPCM);
 		NGCADPCM::DecodeBlock(tempPCM + samples_processed * 2, tempADPCM);
 		samples_processed += NGCADPCM::SAMPLES_PER_BLOCK;
 	} while (samples_processed < num_samples);
-	for (unsigned i = 0; i < samples_processed * 2; ++i)
-	{
-		// TODO: Fix the mixer so it can accept non-byte-swapped samples.
-		tempPCM[i] = Common::swap16(tempPCM[i]);
-	}
+
+	if (g_bStream)
+		StreamPrefetcher::SetStreamPosition(AudioPos, NextStart);
 	return samples_processed;
 }
 
@@ -356,10 +355,13 @@ void Init()
 	dtk = CoreTiming::RegisterEvent("StreamingTimer", DTKStreamingCallback);
 
 	CoreTiming::ScheduleEvent(0, dtk);
+
+	StreamPrefetcher::Init();
 }
 
 void Shutdown()
 {
+	StreamPrefetcher::Shutdown();
 }
 
 void SetDiscInside(bool _DiscInside)
@@ -382,6 +384,7 @@ void EjectDiscCallback(u64 userdata, int cyclesLate)
 	SetDiscInside(false);
 	SetLidOpen();
 	VolumeHandler::EjectVolume();
+	StreamPrefetcher::Invalidate();
 }
 
 void InsertDiscCallback(u64 userdata, int cyclesLate)
@@ -397,6 +400,7 @@ void InsertDiscCallback(u64 userdata, int cyclesLate)
 	}
 	SetLidOpen(false);
 	SetDiscInside(VolumeHandler::IsValid());
+	StreamPrefetcher::Invalidate();
 	delete _FileName;
 }
 
@@ -969,6 +973,7 @@ void ExecuteCommand()
 						NGCADPCM::InitFilter();
 						g_bStream = true;
 					}
+					StreamPrefetcher::SetStreamPosition(AudioPos, NextStart);
 				}
 			}
 
@@ -42,7 +42,7 @@ namespace HW
 		ProcessorInterface::Init();
 		ExpansionInterface::Init(); // Needs to be initialized before Memory
 		Memory::Init();
-		DSP::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.bDSPHLE);
+		DSP::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.bDSPHLE, SConfig::GetInstance().m_LocalCoreStartupParameter.bWii);
 		DVDInterface::Init();
 		GPFifo::Init();
 		CCPU::Init(SConfig::GetInstance().m_LocalCoreStartupParameter.iCPUCore);
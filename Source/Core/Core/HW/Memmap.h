@@ -138,7 +138,11 @@ enum XCheckTLBFlag
 	FLAG_OPCODE,
 };
 u32 TranslateAddress(u32 _Address, XCheckTLBFlag _Flag);
+// The TLB caches page table translations in two-way sets, by page.
+bool LookupTLBPageAddress(XCheckTLBFlag _Flag, u32 vpa, u32 *paddr);
+void UpdateTLBEntry(XCheckTLBFlag _Flag, u32 vpa, u32 paddr);
 void InvalidateTLBEntry(u32 _Address);
+void InvalidateTLB();
 extern u32 pagetable_base;
 extern u32 pagetable_hashmask;
 };
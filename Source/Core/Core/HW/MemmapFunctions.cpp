@@ -15,6 +15,8 @@
 // Official Git repository and contact information can be found at
 // http://code.google.com/p/dolphin-emu/
 
+#include <cstring>
+
 #include "Common/Atomic.h"
 #include "Common/CommonTypes.h"
 
@@ -601,156 +603,67 @@ void SDRUpdated()
 
 
 // TLB cache
-//#define FAST_TLB_CACHE
-
-#define TLB_SIZE 128
-#define TLB_WAYS 2
-#define NUM_TLBS 2
-
 #define HW_PAGE_SIZE 4096
 #define HW_PAGE_INDEX_SHIFT 12
-#define HW_PAGE_INDEX_MASK 0x3f
-#define HW_PAGE_TAG_SHIFT 18
-
-#define TLB_FLAG_MOST_RECENT 0x01
-#define TLB_FLAG_INVALID 0x02
+#define HW_PAGE_MASK (HW_PAGE_SIZE - 1)
 
-struct tlb_entry
+bool LookupTLBPageAddress(const XCheckTLBFlag _Flag, const u32 vpa, u32 *paddr)
 {
-	u32 tag;
-	u32 paddr;
-	u8 flags;
-};
+	const u32 tag = vpa & ~HW_PAGE_MASK;
+	// An invalid way has tag 0. Page 0 is never translated, see ReadFromHardware.
+	if (tag == 0)
+		return false;
 
-// TODO: tlb needs to be in ppcState for save-state purposes.
-#ifdef FAST_TLB_CACHE
-static tlb_entry tlb[NUM_TLBS][TLB_SIZE/TLB_WAYS][TLB_WAYS];
-#endif
+	const int tlb_index = (_Flag == FLAG_OPCODE) ? PowerPC::TLB_INSTRUCTION : PowerPC::TLB_DATA;
+	const u32 set_index = (vpa >> HW_PAGE_INDEX_SHIFT) & (PowerPC::TLB_SETS - 1);
+	const PowerPC::TLBSet& set = PowerPC::ppcState.tlb[tlb_index][set_index];
 
-static u32 LookupTLBPageAddress(const XCheckTLBFlag _Flag, const u32 vpa, u32 *paddr)
-{
-#ifdef FAST_TLB_CACHE
-	tlb_entry *tlbe = tlb[_Flag == FLAG_OPCODE][(vpa>>HW_PAGE_INDEX_SHIFT)&HW_PAGE_INDEX_MASK];
-	if (tlbe[0].tag == (vpa & ~0xfff) && !(tlbe[0].flags & TLB_FLAG_INVALID))
-	{
-		tlbe[0].flags |= TLB_FLAG_MOST_RECENT;
-		tlbe[1].flags &= ~TLB_FLAG_MOST_RECENT;
-		*paddr = tlbe[0].paddr | (vpa & 0xfff);
-		return 1;
-	}
-	if (tlbe[1].tag == (vpa & ~0xfff) && !(tlbe[1].flags & TLB_FLAG_INVALID))
-	{
-		tlbe[1].flags |= TLB_FLAG_MOST_RECENT;
-		tlbe[0].flags &= ~TLB_FLAG_MOST_RECENT;
-		*paddr = tlbe[1].paddr | (vpa & 0xfff);
-		return 1;
-	}
-	return 0;
-#else
-	u32 _Address = vpa;
-	if (_Flag == FLAG_OPCODE)
-	{
-		for (u32 i = (PowerPC::ppcState.itlb_last); i > (PowerPC::ppcState.itlb_last - 128); i--)
-		{
-			if ((_Address & ~0xfff) == (PowerPC::ppcState.itlb_va[i & 127]))
-			{
-				*paddr = PowerPC::ppcState.itlb_pa[i & 127] | (_Address & 0xfff);
-				PowerPC::ppcState.itlb_last = i;
-				return 1;
-			}
-		}
-	}
-	else
+	for (u32 way = 0; way < PowerPC::TLB_WAYS; way++)
 	{
-		for (u32 i = (PowerPC::ppcState.dtlb_last); i > (PowerPC::ppcState.dtlb_last - 128); i--)
+		if (set.tag[way] == tag)
 		{
-			if ((_Address & ~0xfff) == (PowerPC::ppcState.dtlb_va[i & 127]))
-			{
-				*paddr = PowerPC::ppcState.dtlb_pa[i & 127] | (_Address & 0xfff);
-				PowerPC::ppcState.dtlb_last = i;
-				return 1;
-			}
+			*paddr = set.paddr[way] | (vpa & HW_PAGE_MASK);
+			PowerPC::ppcState.tlb_recent[tlb_index][set_index] = way;
+			return true;
 		}
 	}
-	return 0;
-#endif
+	return false;
 }
 
-static void UpdateTLBEntry(const XCheckTLBFlag _Flag, UPTE2 PTE2, const u32 vpa)
+void UpdateTLBEntry(const XCheckTLBFlag _Flag, const u32 vpa, const u32 paddr)
 {
-#ifdef FAST_TLB_CACHE
-	tlb_entry *tlbe = tlb[_Flag == FLAG_OPCODE][(vpa>>HW_PAGE_INDEX_SHIFT)&HW_PAGE_INDEX_MASK];
-	if ((tlbe[0].flags & TLB_FLAG_MOST_RECENT) == 0)
-	{
-		tlbe[0].flags = TLB_FLAG_MOST_RECENT;
-		tlbe[1].flags &= ~TLB_FLAG_MOST_RECENT;
-		tlbe[0].paddr = PTE2.RPN << HW_PAGE_INDEX_SHIFT;
-		tlbe[0].tag = vpa & ~0xfff;
-	}
-	else
-	{
-		tlbe[1].flags = TLB_FLAG_MOST_RECENT;
-		tlbe[0].flags &= ~TLB_FLAG_MOST_RECENT;
-		tlbe[1].paddr = PTE2.RPN << HW_PAGE_INDEX_SHIFT;
-		tlbe[1].tag = vpa & ~0xfff;
-	}
-#else
-	if (_Flag == FLAG_OPCODE)
-	{
-		// ITLB cache
-		PowerPC::ppcState.itlb_last++;
-		PowerPC::ppcState.itlb_last &= 127;
-		PowerPC::ppcState.itlb_pa[PowerPC::ppcState.itlb_last] = PTE2.RPN << HW_PAGE_INDEX_SHIFT;
-		PowerPC::ppcState.itlb_va[PowerPC::ppcState.itlb_last] = vpa & ~0xfff;
-	}
-	else
-	{
-		// DTLB cache
-		PowerPC::ppcState.dtlb_last++;
-		PowerPC::ppcState.dtlb_last &= 127;
-		PowerPC::ppcState.dtlb_pa[PowerPC::ppcState.dtlb_last] = PTE2.RPN << HW_PAGE_INDEX_SHIFT;
-		PowerPC::ppcState.dtlb_va[PowerPC::ppcState.dtlb_last] = vpa & ~0xfff;
-	}
-#endif
+	const int tlb_index = (_Flag == FLAG_OPCODE) ? PowerPC::TLB_INSTRUCTION : PowerPC::TLB_DATA;
+	const u32 set_index = (vpa >> HW_PAGE_INDEX_SHIFT) & (PowerPC::TLB_SETS - 1);
+	PowerPC::TLBSet& set = PowerPC::ppcState.tlb[tlb_index][set_index];
+
+	// Replace the way that was not used last.
+	u16& recent = PowerPC::ppcState.tlb_recent[tlb_index][set_index];
+	recent ^= 1;
+	set.tag[recent] = vpa & ~HW_PAGE_MASK;
+	set.paddr[recent] = paddr & ~HW_PAGE_MASK;
 }
 
 void InvalidateTLBEntry(u32 vpa)
 {
-#ifdef FAST_TLB_CACHE
-	tlb_entry *tlbe = tlb[0][(vpa>>HW_PAGE_INDEX_SHIFT)&HW_PAGE_INDEX_MASK];
-	if (tlbe[0].tag == (vpa & ~0xfff))
-	{
-		tlbe[0].flags |= TLB_FLAG_INVALID;
-	}
-	if (tlbe[1].tag == (vpa & ~0xfff))
-	{
-		tlbe[1].flags |= TLB_FLAG_INVALID;
-	}
-	tlb_entry *tlbe_i = tlb[1][(vpa>>HW_PAGE_INDEX_SHIFT)&HW_PAGE_INDEX_MASK];
-	if (tlbe_i[0].tag == (vpa & ~0xfff))
-	{
-		tlbe_i[0].flags |= TLB_FLAG_INVALID;
-	}
-	if (tlbe_i[1].tag == (vpa & ~0xfff))
+	const u32 tag = vpa & ~HW_PAGE_MASK;
+	const u32 set_index = (vpa >> HW_PAGE_INDEX_SHIFT) & (PowerPC::TLB_SETS - 1);
+	for (auto& tlb : PowerPC::ppcState.tlb)
 	{
-		tlbe_i[1].flags |= TLB_FLAG_INVALID;
-	}
-#else
-	u32 _Address = vpa;
-	for (int i = 0; i < 128; i++)
-	{
-		if ((_Address & ~0xfff) == (PowerPC::ppcState.dtlb_va[(PowerPC::ppcState.dtlb_last + i) & 127]))
-		{
-			PowerPC::ppcState.dtlb_pa[(PowerPC::ppcState.dtlb_last + i) & 127] = 0;
-			PowerPC::ppcState.dtlb_va[(PowerPC::ppcState.dtlb_last + i) & 127] = 0;
-		}
-		if ((_Address & ~0xfff) == (PowerPC::ppcState.itlb_va[(PowerPC::ppcState.itlb_last + i) & 127]))
+		PowerPC::TLBSet& set = tlb[set_index];
+		for (u32 way = 0; way < PowerPC::TLB_WAYS; way++)
 		{
-			PowerPC::ppcState.itlb_pa[(PowerPC::ppcState.itlb_last + i) & 127] = 0;
-			PowerPC::ppcState.itlb_va[(PowerPC::ppcState.itlb_last + i) & 127] = 0;
+			if (set.tag[way] == tag)
+			{
+				set.tag[way] = 0;
+				set.paddr[way] = 0;
+			}
 		}
 	}
-#endif
+}
+
+void InvalidateTLB()
+{
+	memset(PowerPC::ppcState.tlb, 0, sizeof(PowerPC::ppcState.tlb));
 }
 
 // Page Address Translation
@@ -787,7 +700,7 @@ static u32 TranslatePageAddress(const u32 _Address, const XCheckTLBFlag _Flag)
 				UPTE2 PTE2;
 				PTE2.Hex = bswap((*(u32*)&pRAM[(pteg_addr + 4)]));
 
-				UpdateTLBEntry(_Flag, PTE2, _Address);
+				UpdateTLBEntry(_Flag, _Address, PTE2.RPN << 12);
 
 				// set the access bits
 				switch (_Flag)
@@ -818,7 +731,7 @@ static u32 TranslatePageAddress(const u32 _Address, const XCheckTLBFlag _Flag)
 				UPTE2 PTE2;
 				PTE2.Hex = bswap((*(u32*)&pRAM[(pteg_addr + 4)]));
 
-				UpdateTLBEntry(_Flag, PTE2, _Address);
+				UpdateTLBEntry(_Flag, _Address, PTE2.RPN << 12);
 
 				switch (_Flag)
 				{
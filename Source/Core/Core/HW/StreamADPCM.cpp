@@ -13,28 +13,21 @@ static s32 histl2;
 static s32 histr1;
 static s32 histr2;
 
-static s16 ADPDecodeSample(s32 bits, s32 q, s32& hist1, s32& hist2)
+// Filter coefficients for the history, selected by the high nibble of the
+// block header. Undefined filters ignore the history.
+static const s32 filter_coefs[16][2] = {
+	{ 0x00, 0x00 },
+	{ 0x3c, 0x00 },
+	{ 0x73, -0x34 },
+	{ 0x62, -0x37 },
+};
+
+static s16 ADPDecodeSample(s32 bits, s32 shift, s32 coef1, s32 coef2, s32& hist1, s32& hist2)
 {
-	s32 hist = 0;
-	switch (q >> 4)
-	{
-	case 0:
-		hist = 0;
-		break;
-	case 1:
-		hist = (hist1 * 0x3c);
-		break;
-	case 2:
-		hist = (hist1 * 0x73) - (hist2 * 0x34);
-		break;
-	case 3:
-		hist = (hist1 * 0x62) - (hist2 * 0x37);
-		break;
-	}
-	hist = (hist + 0x20) >> 6;
+	s32 hist = (hist1 * coef1 + hist2 * coef2 + 0x20) >> 6;
 	MathUtil::Clamp(&hist, -0x200000, 0x1fffff);
 
-	s32 cur = (((s16)(bits << 12) >> (q & 0xf)) << 6) + hist;
+	s32 cur = (((s16)(bits << 12) >> shift) << 6) + hist;
 
 	hist2 = hist1;
 	hist1 = cur;
@@ -55,9 +48,24 @@ void NGCADPCM::InitFilter()
 
 void NGCADPCM::DecodeBlock(s16 *pcm, const u8 *adpcm)
 {
+	// The filter and shift only change per block, so they are looked up once
+	// instead of for every sample. Each channel's filter depends on the
+	// previous output, so the two channels are interleaved in one loop.
+	const s32* coefs_l = filter_coefs[adpcm[0] >> 4];
+	const s32* coefs_r = filter_coefs[adpcm[1] >> 4];
+	const s32 shift_l = adpcm[0] & 0xf;
+	const s32 shift_r = adpcm[1] & 0xf;
+	const u8* data = adpcm + (ONE_BLOCK_SIZE - SAMPLES_PER_BLOCK);
+
+	s32 l1 = histl1, l2 = histl2;
+	s32 r1 = histr1, r2 = histr2;
 	for (int i = 0; i < SAMPLES_PER_BLOCK; i++)
 	{
-		pcm[i * 2]     = ADPDecodeSample(adpcm[i + (ONE_BLOCK_SIZE - SAMPLES_PER_BLOCK)] & 0xf, adpcm[0], histl1, histl2);
-		pcm[i * 2 + 1] = ADPDecodeSample(adpcm[i + (ONE_BLOCK_SIZE - SAMPLES_PER_BLOCK)] >> 4,  adpcm[1], histr1, histr2);
+		pcm[i * 2]     = ADPDecodeSample(data[i] & 0xf, shift_l, coefs_l[0], coefs_l[1], l1, l2);
+		pcm[i * 2 + 1] = ADPDecodeSample(data[i] >> 4,  shift_r, coefs_r[0], coefs_r[1], r1, r2);
 	}
+	histl1 = l1;
+	histl2 = l2;
+	histr1 = r1;
+	histr2 = r2;
 }
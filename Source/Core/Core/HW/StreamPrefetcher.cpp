@@ -0,0 +1,209 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "Common/Atomic.h"
+#include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/Flag.h"
+#include "Common/Thread.h"
+
+#include "Core/VolumeHandler.h"
+#include "Core/HW/StreamPrefetcher.h"
+
+namespace StreamPrefetcher
+{
+
+// Streamed ADPCM takes 32 bytes per 28 stereo samples at 48kHz, so one chunk
+// is over half a second of audio.
+static const u32 CHUNK_SIZE = 32 * 1024;
+static const u32 NUM_CHUNKS = 8;
+// The other chunks hold the start of the next track, so that looping music
+// does not miss.
+static const u32 NUM_CHUNKS_AHEAD = NUM_CHUNKS - 2;
+static const u32 SECTOR_SIZE = 2048;
+
+struct Chunk
+{
+	// Generation in the high word and disc offset in the low word, or 0 while
+	// the chunk is empty.
+	u64 tag;
+	u8 data[CHUNK_SIZE];
+};
+
+// Guards the chunks. The I/O thread reads the disc into s_fill_buffer without
+// holding it, and only takes it to copy the finished chunk in.
+static std::mutex s_chunks_lock;
+static Chunk s_chunks[NUM_CHUNKS];
+static u8 s_fill_buffer[CHUNK_SIZE];
+
+// Written by the CPU thread only.
+static volatile u32 s_generation;
+static volatile u32 s_position;
+static volatile u32 s_next_start;
+static volatile bool s_active;
+
+static std::thread s_thread;
+static Common::Event s_wake;
+static Common::Flag s_quit;
+
+static u64 MakeTag(u32 generation, u32 offset)
+{
+	return ((u64)generation << 32) | offset;
+}
+
+static bool FindChunk(u64 tag)
+{
+	for (Chunk& chunk : s_chunks)
+	{
+		if (chunk.tag == tag)
+			return true;
+	}
+	return false;
+}
+
+// Picks a missing chunk of the wanted ones, and a chunk nobody is going to
+// read to replace. Returns nullptr if they are all there.
+static Chunk* FindChunkToFill(const u64* wanted, u64* tag)
+{
+	std::lock_guard<std::mutex> lk(s_chunks_lock);
+	for (u32 i = 0; i < NUM_CHUNKS; ++i)
+	{
+		if (FindChunk(wanted[i]))
+			continue;
+
+		for (Chunk& chunk : s_chunks)
+		{
+			if (std::find(wanted, wanted + NUM_CHUNKS, chunk.tag) == wanted + NUM_CHUNKS)
+			{
+				*tag = wanted[i];
+				return &chunk;
+			}
+		}
+	}
+	return nullptr;
+}
+
+// Fills one missing chunk of the wanted ones. Returns false if they are
+// all there, or if the disc can't be read.
+static bool FillNextChunk()
+{
+	u32 generation = Common::AtomicLoad(s_generation);
+	u32 position = Common::AtomicLoad(s_position) & ~(CHUNK_SIZE - 1);
+	u32 next_start = Common::AtomicLoad(s_next_start) & ~(CHUNK_SIZE - 1);
+
+	u64 wanted[NUM_CHUNKS];
+	for (u32 i = 0; i < NUM_CHUNKS_AHEAD; ++i)
+		wanted[i] = MakeTag(generation, position + i * CHUNK_SIZE);
+	wanted[NUM_CHUNKS_AHEAD] = MakeTag(generation, next_start);
+	wanted[NUM_CHUNKS_AHEAD + 1] = MakeTag(generation, next_start + CHUNK_SIZE);
+
+	u64 tag;
+	Chunk* chunk = FindChunkToFill(wanted, &tag);
+	if (!chunk)
+		return false;
+
+	// Each read holds the volume lock. Going a sector at a time keeps the CPU
+	// thread from waiting for a whole chunk when it reads the disc meanwhile.
+	for (u32 i = 0; i < CHUNK_SIZE; i += SECTOR_SIZE)
+	{
+		if (!VolumeHandler::ReadToPtr(s_fill_buffer + i, (u32)tag + i, SECTOR_SIZE))
+			return false;
+	}
+
+	// Only this thread changes the chunks. If the stream moved meanwhile,
+	// this may replace a chunk that just became wanted, which costs a miss.
+	std::lock_guard<std::mutex> lk(s_chunks_lock);
+	memcpy(chunk->data, s_fill_buffer, CHUNK_SIZE);
+	chunk->tag = tag;
+	return true;
+}
+
+static void PrefetchThread()
+{
+	Common::SetCurrentThreadName("DTK prefetch thread");
+
+	while (!s_quit.IsSet())
+	{
+		if (!Common::AtomicLoad(s_active) || !FillNextChunk())
+			s_wake.Wait();
+	}
+}
+
+void Init()
+{
+	for (Chunk& chunk : s_chunks)
+		chunk.tag = 0;
+	s_generation = 1;
+	s_position = 0;
+	s_next_start = 0;
+	s_active = false;
+
+	s_quit.Clear();
+	s_thread = std::thread(PrefetchThread);
+}
+
+void Shutdown()
+{
+	s_quit.Set();
+	s_wake.Set();
+	if (s_thread.joinable())
+		s_thread.join();
+}
+
+void SetStreamPosition(u32 position, u32 next_start)
+{
+	if (position / CHUNK_SIZE == s_position / CHUNK_SIZE && next_start == s_next_start && s_active)
+		return;
+
+	Common::AtomicStore(s_position, position);
+	Common::AtomicStore(s_next_start, next_start);
+	Common::AtomicStoreRelease(s_active, true);
+	s_wake.Set();
+}
+
+void Invalidate()
+{
+	Common::AtomicStoreRelease(s_generation, s_generation + 1);
+	s_wake.Set();
+}
+
+static bool ReadFromChunk(u8* ptr, u32 offset, u32 length)
+{
+	u32 chunk_offset = offset & ~(CHUNK_SIZE - 1);
+	u64 tag = MakeTag(s_generation, chunk_offset);
+
+	std::lock_guard<std::mutex> lk(s_chunks_lock);
+	for (Chunk& chunk : s_chunks)
+	{
+		if (chunk.tag != tag)
+			continue;
+
+		memcpy(ptr, chunk.data + (offset - chunk_offset), length);
+		return true;
+	}
+	return false;
+}
+
+bool ReadToPtr(u8* ptr, u32 offset, u32 length)
+{
+	while (length)
+	{
+		u32 chunk_length = std::min(length, CHUNK_SIZE - (offset & (CHUNK_SIZE - 1)));
+		if (!ReadFromChunk(ptr, offset, chunk_length) &&
+		    !VolumeHandler::ReadToPtr(ptr, offset, chunk_length))
+			return false;
+
+		ptr += chunk_length;
+		offset += chunk_length;
+		length -= chunk_length;
+	}
+	return true;
+}
+
+}  // namespace StreamPrefetcher
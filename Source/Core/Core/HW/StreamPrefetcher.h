@@ -0,0 +1,29 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Reads disc-streamed (DTK) audio ahead of the play position on a separate
+// thread, so that the CPU thread does not wait on the disc while streaming.
+// The emulated stream state stays on the CPU thread; this only caches the
+// bytes it is going to read, and falls back to reading the disc on a miss.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+namespace StreamPrefetcher
+{
+
+void Init();
+void Shutdown();
+
+// Where the stream plays from, and where it continues after the current track.
+void SetStreamPosition(u32 position, u32 next_start);
+
+// Forgets all prefetched data, e.g. because the disc was changed.
+void Invalidate();
+
+// Called from the CPU thread.
+bool ReadToPtr(u8* ptr, u32 offset, u32 length);
+
+}  // namespace StreamPrefetcher
@@ -350,6 +350,16 @@ void Interpreter::mtspr(UGeckoInstruction _inst)
 	case SPR_SDR:
 		Memory::SDRUpdated();
 		break;
+
+	// The JIT looks data addresses up in the TLB before checking the BATs, so
+	// don't leave pages there that a BAT now covers.
+	case SPR_DBAT0U: case SPR_DBAT0L: case SPR_DBAT1U: case SPR_DBAT1L:
+	case SPR_DBAT2U: case SPR_DBAT2L: case SPR_DBAT3U: case SPR_DBAT3L:
+	case SPR_DBAT4U: case SPR_DBAT4L: case SPR_DBAT5U: case SPR_DBAT5L:
+	case SPR_DBAT6U: case SPR_DBAT6L: case SPR_DBAT7U: case SPR_DBAT7L:
+		if (oldValue != rSPR(iIndex))
+			Memory::InvalidateTLB();
+		break;
 	}
 }
 
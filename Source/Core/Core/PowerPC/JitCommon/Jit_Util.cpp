@@ -7,6 +7,7 @@
 #include "Common/CommonTypes.h"
 #include "Common/MathUtil.h"
 
+#include "Core/HW/Memmap.h"
 #include "Core/HW/MMIO.h"
 #include "Core/PowerPC/JitCommon/Jit_Util.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
@@ -247,6 +248,65 @@ void EmuCodeBlock::MMIOLoadToReg(MMIO::Mapping* mmio, Gen::X64Reg reg_value,
 	}
 }
 
+bool EmuCodeBlock::TranslateAddressInline(const OpArg& opAddress, u32 registersInUse, u32 excluded, X64Reg* host_offset, FixupBranch* miss)
+{
+	if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU)
+		return false;
+
+#ifdef ENABLE_MEM_CHECK
+	// Memory breakpoints are checked in Memory, which a hit doesn't call.
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
+		return false;
+#endif
+
+	// The slow path call would clobber any caller saved register that isn't
+	// in use anyway.
+	u32 free_regs = ABI_ALL_CALLER_SAVED & 0xFFFF & ~registersInUse & ~excluded;
+	X64Reg regs[2];
+	int num_regs = 0;
+	for (int r = 0; r < 16 && num_regs < 2; r++)
+	{
+		if (free_regs & (1 << r))
+			regs[num_regs++] = (X64Reg)r;
+	}
+	if (num_regs < 2)
+		return false;
+
+	X64Reg set = regs[0];
+	X64Reg offset = regs[1];
+	const int tlb = (int)((u8*)&PowerPC::ppcState.tlb[PowerPC::TLB_DATA] - (u8*)&PowerPC::ppcState) - 0x80;
+	const int recent = (int)((u8*)&PowerPC::ppcState.tlb_recent[PowerPC::TLB_DATA] - (u8*)&PowerPC::ppcState) - 0x80;
+
+	// Twice the set number, so that a scale of 8 addresses the 16 byte sets
+	// and a scale of 1 the u16 recent ways.
+	MOV(32, R(set), opAddress);
+	SHR(32, R(set), Imm8(12 - 1));
+	AND(32, R(set), Imm32((PowerPC::TLB_SETS - 1) << 1));
+
+	// Matching tags leave just the offset into the page.
+	MOV(32, R(offset), opAddress);
+	XOR(32, R(offset), MComplex(RPPCSTATE, set, SCALE_8, tlb + offsetof(PowerPC::TLBSet, tag[0])));
+	CMP(32, R(offset), Imm32(0xFFF));
+	FixupBranch not_way0 = J_CC(CC_A);
+	OR(32, R(offset), MComplex(RPPCSTATE, set, SCALE_8, tlb + offsetof(PowerPC::TLBSet, paddr[0])));
+	MOV(16, MComplex(RPPCSTATE, set, SCALE_1, recent), Imm16(0));
+	FixupBranch hit_way0 = J();
+
+	SetJumpTarget(not_way0);
+	MOV(32, R(offset), opAddress);
+	XOR(32, R(offset), MComplex(RPPCSTATE, set, SCALE_8, tlb + offsetof(PowerPC::TLBSet, tag[1])));
+	CMP(32, R(offset), Imm32(0xFFF));
+	*miss = J_CC(CC_A, true);
+	OR(32, R(offset), MComplex(RPPCSTATE, set, SCALE_8, tlb + offsetof(PowerPC::TLBSet, paddr[1])));
+	MOV(16, MComplex(RPPCSTATE, set, SCALE_1, recent), Imm16(1));
+
+	SetJumpTarget(hit_way0);
+	// Same as ReadFromHardware/WriteToHardware.
+	AND(32, R(offset), Imm32(Memory::RAM_MASK));
+	*host_offset = offset;
+	return true;
+}
+
 void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress, int accessSize, s32 offset, u32 registersInUse, bool signExtend, int flags)
 {
 	if (!jit->js.memcheck)
@@ -350,6 +410,19 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 
 			FixupBranch fast = J_CC(CC_Z, true);
 
+			u32 excluded = 1 << reg_value;
+			if (addr_loc.IsSimpleReg())
+				excluded |= 1 << addr_loc.GetSimpleReg();
+			X64Reg host_offset;
+			FixupBranch tlb_miss, tlb_hit;
+			bool tlb_lookup = TranslateAddressInline(addr_loc, registersInUse, excluded, &host_offset, &tlb_miss);
+			if (tlb_lookup)
+			{
+				UnsafeLoadToReg(reg_value, R(host_offset), accessSize, 0, signExtend);
+				tlb_hit = J(true);
+				SetJumpTarget(tlb_miss);
+			}
+
 			ABI_PushRegistersAndAdjustStack(registersInUse, 0);
 			switch (accessSize)
 			{
@@ -386,6 +459,8 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 			SetJumpTarget(fast);
 			UnsafeLoadToReg(reg_value, addr_loc, accessSize, 0, signExtend);
 			SetJumpTarget(exit);
+			if (tlb_lookup)
+				SetJumpTarget(tlb_hit);
 		}
 	}
 }
@@ -468,10 +543,23 @@ void EmuCodeBlock::SafeWriteRegToReg(X64Reg reg_value, X64Reg reg_addr, int acce
 
 	TEST(32, R(reg_addr), Imm32(mem_mask));
 	FixupBranch fast = J_CC(CC_Z, true);
+
+	bool swap = !(flags & SAFE_LOADSTORE_NO_SWAP);
+	X64Reg host_offset;
+	FixupBranch tlb_miss, tlb_hit;
+	// The common asm routines don't pass an accurate registersInUse.
+	bool tlb_lookup = !(flags & SAFE_LOADSTORE_NO_PROLOG) &&
+		TranslateAddressInline(R(reg_addr), registersInUse, (1 << reg_value) | (1 << reg_addr), &host_offset, &tlb_miss);
+	if (tlb_lookup)
+	{
+		UnsafeWriteRegToReg(reg_value, host_offset, accessSize, 0, swap);
+		tlb_hit = J(true);
+		SetJumpTarget(tlb_miss);
+	}
+
 	// PC is used by memory watchpoints (if enabled) or to print accurate PC locations in debug logs
 	MOV(32, PPCSTATE(pc), Imm32(jit->js.compilerPC));
 	size_t rsp_alignment = (flags & SAFE_LOADSTORE_NO_PROLOG) ? 8 : 0;
-	bool swap = !(flags & SAFE_LOADSTORE_NO_SWAP);
 	ABI_PushRegistersAndAdjustStack(registersInUse, rsp_alignment);
 	switch (accessSize)
 	{
@@ -493,6 +581,8 @@ void EmuCodeBlock::SafeWriteRegToReg(X64Reg reg_value, X64Reg reg_addr, int acce
 	SetJumpTarget(fast);
 	UnsafeWriteRegToReg(reg_value, reg_addr, accessSize, 0, swap);
 	SetJumpTarget(exit);
+	if (tlb_lookup)
+		SetJumpTarget(tlb_hit);
 }
 
 // Destroys the same as SafeWrite plus RSCRATCH.  TODO: see if we can avoid temporaries here
@@ -57,6 +57,13 @@ public:
 		SAFE_LOADSTORE_CLOBBER_RSCRATCH_INSTEAD_OF_ADDR = 8
 	};
 
+	// For MMU titles, looks a data address up in the software TLB so that the
+	// slow path only calls into Memory on a miss. On a hit, host_offset holds
+	// the address to access relative to RMEM, and otherwise the miss branch is
+	// taken. Emits nothing and returns false if no caller saved register is free,
+	// or if memory breakpoints may be set, as hits don't check them.
+	bool TranslateAddressInline(const Gen::OpArg& opAddress, u32 registersInUse, u32 excluded, Gen::X64Reg* host_offset, Gen::FixupBranch* miss);
+
 	void SafeLoadToReg(Gen::X64Reg reg_value, const Gen::OpArg & opAddress, int accessSize, s32 offset, u32 registersInUse, bool signExtend, int flags = 0);
 	// Clobbers RSCRATCH or reg_addr depending on the relevant flag.  Preserves
 	// reg_value if the load fails and js.memcheck is enabled.
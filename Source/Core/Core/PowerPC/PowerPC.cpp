@@ -117,12 +117,8 @@ void Init(int cpu_core)
 	FPURoundMode::SetPrecisionMode(FPURoundMode::PREC_53);
 
 	memset(ppcState.sr, 0, sizeof(ppcState.sr));
-	ppcState.dtlb_last = 0;
-	memset(ppcState.dtlb_va, 0, sizeof(ppcState.dtlb_va));
-	memset(ppcState.dtlb_pa, 0, sizeof(ppcState.dtlb_pa));
-	ppcState.itlb_last = 0;
-	memset(ppcState.itlb_va, 0, sizeof(ppcState.itlb_va));
-	memset(ppcState.itlb_pa, 0, sizeof(ppcState.itlb_pa));
+	memset(ppcState.tlb, 0, sizeof(ppcState.tlb));
+	memset(ppcState.tlb_recent, 0, sizeof(ppcState.tlb_recent));
 	ppcState.pagetable_base = 0;
 	ppcState.pagetable_hashmask = 0;
 
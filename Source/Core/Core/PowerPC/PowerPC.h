@@ -27,6 +27,28 @@ enum CoreMode
 	MODE_JIT,
 };
 
+// Like Gekko's, the software TLBs are two way set associative with 64 sets.
+// Each way holds the effective page address as its tag, or 0 while it is
+// invalid, and the physical page address.
+enum
+{
+	TLB_SETS = 64,
+	TLB_WAYS = 2,
+};
+
+enum
+{
+	TLB_DATA,
+	TLB_INSTRUCTION,
+	NUM_TLBS
+};
+
+struct TLBSet
+{
+	u32 tag[TLB_WAYS];
+	u32 paddr[TLB_WAYS];
+};
+
 // This contains the entire state of the emulated PowerPC "Gekko" CPU.
 struct GC_ALIGNED64(PowerPCState)
 {
@@ -81,13 +103,11 @@ struct GC_ALIGNED64(PowerPCState)
 	// also for power management, but we don't care about that.
 	u32 spr[1024];
 
-	u32 dtlb_last;
-	u32 dtlb_va[128];
-	u32 dtlb_pa[128];
-
-	u32 itlb_last;
-	u32 itlb_va[128];
-	u32 itlb_pa[128];
+	// See MemmapFunctions.cpp. The JIT looks up data addresses inline.
+	TLBSet tlb[NUM_TLBS][TLB_SETS];
+	// The way of each set that was used last. u16 so that the JIT can index
+	// it with twice the set number.
+	u16 tlb_recent[NUM_TLBS][TLB_SETS];
 
 	u32 pagetable_base;
 	u32 pagetable_hashmask;
@@ -97,6 +117,7 @@ struct GC_ALIGNED64(PowerPCState)
 
 #if _M_X86_64
 static_assert(offsetof(PowerPC::PowerPCState, above_fits_in_first_0x100) <= 0x100, "top of PowerPCState too big");
+static_assert(sizeof(TLBSet) == 16, "The JIT indexes TLB sets with twice the set number and a scale of 8");
 #endif
 
 enum CPUState
@@ -2,6 +2,10 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "Core/VolumeHandler.h"
 #include "DiscIO/VolumeCreator.h"
 
@@ -10,13 +14,118 @@ namespace VolumeHandler
 
 static DiscIO::IVolume* g_pVolume = nullptr;
 
+// Streamed audio is read ahead on its own thread, so reads and volume
+// changes are serialized here. Blob readers are not thread safe.
+static std::mutex s_volume_lock;
+
+// What GetVolume() hands out, so that code reading the volume directly, like
+// the file systems of the Wii DI device, takes the lock too. Like the volume
+// itself, it must not be used after the volume was changed.
+class LockedVolume : public DiscIO::IVolume
+{
+public:
+	bool Read(u64 _Offset, u64 _Length, u8* _pBuffer) const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->Read(_Offset, _Length, _pBuffer);
+	}
+	bool RAWRead(u64 _Offset, u64 _Length, u8* _pBuffer) const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->RAWRead(_Offset, _Length, _pBuffer);
+	}
+	bool GetTitleID(u8* _pBuffer) const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->GetTitleID(_pBuffer);
+	}
+	void GetTMD(u8* _pBuffer, u32* _sz) const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		g_pVolume->GetTMD(_pBuffer, _sz);
+	}
+	std::string GetUniqueID() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->GetUniqueID();
+	}
+	std::string GetRevisionSpecificUniqueID() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->GetRevisionSpecificUniqueID();
+	}
+	std::string GetMakerID() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->GetMakerID();
+	}
+	int GetRevision() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->GetRevision();
+	}
+	std::string GetName() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->GetName();
+	}
+	std::vector<std::string> GetNames() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->GetNames();
+	}
+	u32 GetFSTSize() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->GetFSTSize();
+	}
+	std::string GetApploaderDate() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->GetApploaderDate();
+	}
+	bool SupportsIntegrityCheck() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->SupportsIntegrityCheck();
+	}
+	bool CheckIntegrity() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->CheckIntegrity();
+	}
+	bool IsDiscTwo() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->IsDiscTwo();
+	}
+	ECountry GetCountry() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->GetCountry();
+	}
+	u64 GetSize() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->GetSize();
+	}
+	u64 GetRawSize() const override
+	{
+		std::lock_guard<std::mutex> lk(s_volume_lock);
+		return g_pVolume->GetRawSize();
+	}
+};
+
+static LockedVolume s_locked_volume;
+
 DiscIO::IVolume *GetVolume()
 {
-	return g_pVolume;
+	return g_pVolume ? &s_locked_volume : nullptr;
 }
 
 void EjectVolume()
 {
+	std::lock_guard<std::mutex> lk(s_volume_lock);
 	if (g_pVolume)
 	{
 		// This code looks scary. Can the try/catch stuff be removed?
@@ -30,6 +139,7 @@ void EjectVolume()
 
 bool SetVolumeName(const std::string& _rFullPath)
 {
+	std::lock_guard<std::mutex> lk(s_volume_lock);
 	if (g_pVolume)
 	{
 		delete g_pVolume;
@@ -43,6 +153,7 @@ bool SetVolumeName(const std::string& _rFullPath)
 
 void SetVolumeDirectory(const std::string& _rFullPath, bool _bIsWii, const std::string& _rApploader, const std::string& _rDOL)
 {
+	std::lock_guard<std::mutex> lk(s_volume_lock);
 	if (g_pVolume)
 	{
 		delete g_pVolume;
@@ -54,6 +165,7 @@ void SetVolumeDirectory(const std::string& _rFullPath, bool _bIsWii, const std::
 
 u32 Read32(u64 _Offset)
 {
+	std::lock_guard<std::mutex> lk(s_volume_lock);
 	if (g_pVolume != nullptr)
 	{
 		u32 Temp;
@@ -65,6 +177,7 @@ u32 Read32(u64 _Offset)
 
 bool ReadToPtr(u8* ptr, u64 _dwOffset, u64 _dwLength)
 {
+	std::lock_guard<std::mutex> lk(s_volume_lock);
 	if (g_pVolume != nullptr && ptr)
 	{
 		g_pVolume->Read(_dwOffset, _dwLength, ptr);
@@ -75,6 +188,7 @@ bool ReadToPtr(u8* ptr, u64 _dwOffset, u64 _dwLength)
 
 bool RAWReadToPtr( u8* ptr, u64 _dwOffset, u64 _dwLength )
 {
+	std::lock_guard<std::mutex> lk(s_volume_lock);
 	if (g_pVolume != nullptr && ptr)
 	{
 		g_pVolume->RAWRead(_dwOffset, _dwLength, ptr);
@@ -91,7 +205,7 @@ bool IsValid()
 bool IsWii()
 {
 	if (g_pVolume)
-		return IsVolumeWiiDisc(g_pVolume);
+		return IsVolumeWiiDisc(&s_locked_volume);
 
 	return false;
 }
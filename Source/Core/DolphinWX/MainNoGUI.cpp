@@ -5,12 +5,15 @@
 #include <cstdarg>
 #include <cstddef>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <getopt.h>
 #include <string>
+#include <unistd.h>
 
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
+#include "Common/FileUtil.h"
 #include "Common/Logging/LogManager.h"
 
 #include "Core/BootManager.h"
@@ -19,9 +22,12 @@
 #include "Core/CoreParameter.h"
 #include "Core/Host.h"
 #include "Core/State.h"
+#include "Core/FifoPlayer/FifoPlayer.h"
 #include "Core/HW/Wiimote.h"
 #include "Core/PowerPC/PowerPC.h"
 
+#include "VideoBackends/Software/SWVideoConfig.h"
+
 #include "VideoCommon/VideoBackendBase.h"
 
 static bool rendererHasFocus = true;
@@ -125,6 +131,28 @@ void Host_SetWiiMoteConnectionState(int _State) {}
 
 void Host_ShowVideoConfig(void*, const std::string&, const std::string&) {}
 
+// Replays FIFO logs on the software renderer without a window, for benchmarking
+class PlatformHeadless : public Platform
+{
+	void Init() override
+	{
+	}
+
+	void SetTitle(const std::string &string) override
+	{
+	}
+
+	void MainLoop() override
+	{
+		while (running)
+			usleep(100000);
+	}
+
+	void Shutdown() override
+	{
+	}
+};
+
 #if HAVE_X11
 #include <X11/keysym.h>
 #include "DolphinWX/X11Utils.h"
@@ -295,8 +323,10 @@ class PlatformX11 : public Platform
 };
 #endif
 
-static Platform* GetPlatform()
+static Platform* GetPlatform(bool headless)
 {
+	if (headless)
+		return new PlatformHeadless();
 #if HAVE_X11
 	return new PlatformX11();
 #endif
@@ -306,19 +336,34 @@ static Platform* GetPlatform()
 int main(int argc, char* argv[])
 {
 	int ch, help = 0;
+	bool headless = false;
+	u32 loops = 0;
+	std::string dump_path;
 	struct option longopts[] = {
-		{ "exec",    no_argument, nullptr, 'e' },
-		{ "help",    no_argument, nullptr, 'h' },
-		{ "version", no_argument, nullptr, 'v' },
-		{ nullptr,      0,           nullptr,  0  }
+		{ "exec",        no_argument,       nullptr, 'e' },
+		{ "headless",    no_argument,       nullptr, 'H' },
+		{ "loops",       required_argument, nullptr, 'l' },
+		{ "dump-frames", required_argument, nullptr, 'd' },
+		{ "help",        no_argument,       nullptr, 'h' },
+		{ "version",     no_argument,       nullptr, 'v' },
+		{ nullptr,       0,                 nullptr,  0  }
 	};
 
-	while ((ch = getopt_long(argc, argv, "eh?v", longopts, 0)) != -1)
+	while ((ch = getopt_long(argc, argv, "eHl:d:h?v", longopts, 0)) != -1)
 	{
 		switch (ch)
 		{
 		case 'e':
 			break;
+		case 'H':
+			headless = true;
+			break;
+		case 'l':
+			loops = (u32)strtoul(optarg, nullptr, 10);
+			break;
+		case 'd':
+			dump_path = optarg;
+			break;
 		case 'h':
 		case '?':
 			help = 1;
@@ -333,14 +378,19 @@ int main(int argc, char* argv[])
 	{
 		fprintf(stderr, "%s\n\n", scm_rev_str);
 		fprintf(stderr, "A multi-platform GameCube/Wii emulator\n\n");
-		fprintf(stderr, "Usage: %s [-e <file>] [-h] [-v]\n", argv[0]);
-		fprintf(stderr, "  -e, --exec   Load the specified file\n");
-		fprintf(stderr, "  -h, --help   Show this help message\n");
-		fprintf(stderr, "  -v, --help   Print version and exit\n");
+		fprintf(stderr, "Usage: %s [-e <file>] [-H [-l <loops>] [-d <dir>]] [-h] [-v]\n", argv[0]);
+		fprintf(stderr, "  -e, --exec          Load the specified file\n");
+		fprintf(stderr, "  -H, --headless      Replay a FIFO log on the software renderer\n");
+		fprintf(stderr, "                      without a window, printing a hash and\n");
+		fprintf(stderr, "                      timings for every frame\n");
+		fprintf(stderr, "  -l, --loops         Stop after replaying the FIFO log this often\n");
+		fprintf(stderr, "  -d, --dump-frames   Write every headless frame to a PNG in <dir>\n");
+		fprintf(stderr, "  -h, --help          Show this help message\n");
+		fprintf(stderr, "  -v, --help          Print version and exit\n");
 		return 1;
 	}
 
-	platform = GetPlatform();
+	platform = GetPlatform(headless);
 	if (!platform)
 	{
 		fprintf(stderr, "No platform found\n");
@@ -349,6 +399,29 @@ int main(int argc, char* argv[])
 
 	LogManager::Init();
 	SConfig::Init();
+
+	SCoreStartupParameter& StartUp = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	const bool saved_cpu_thread = StartUp.bCPUThread;
+	const std::string saved_video_backend = StartUp.m_strVideoBackend;
+
+	if (headless)
+	{
+		// Single core keeps the GPU in lockstep with the replay, so every frame
+		// is drawn before the player stops.
+		StartUp.bCPUThread = false;
+		StartUp.m_strVideoBackend = "Software Renderer";
+
+		g_SWVideoConfig.bHeadless = true;
+		g_SWVideoConfig.sHeadlessDumpPath = dump_path;
+		if (!dump_path.empty())
+			File::CreateFullPath(dump_path + "/");
+		FifoPlayer::GetInstance().SetLoopCount(loops ? loops : 1);
+	}
+	else if (loops)
+	{
+		FifoPlayer::GetInstance().SetLoopCount(loops);
+	}
+
 	VideoBackend::PopulateList();
 	VideoBackend::ActivateBackend(SConfig::GetInstance().
 		m_LocalCoreStartupParameter.m_strVideoBackend);
@@ -374,6 +447,10 @@ int main(int argc, char* argv[])
 	Core::Shutdown();
 	WiimoteReal::Shutdown();
 	VideoBackend::ClearList();
+
+	// The headless overrides are not meant to end up in the user's configuration
+	StartUp.bCPUThread = saved_cpu_thread;
+	StartUp.m_strVideoBackend = saved_video_backend;
 	SConfig::Shutdown();
 	LogManager::Shutdown();
 
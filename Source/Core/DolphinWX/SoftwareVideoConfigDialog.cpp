@@ -81,6 +81,19 @@ SoftwareVideoConfigDialog::SoftwareVideoConfigDialog(wxWindow* parent, const std
 
 	// xfb
 	szr_rendering->Add(new SettingCheckBox(page_general, _("Bypass XFB"), "", vconfig.bBypassXFB));
+
+	// threads
+	wxStaticText* const label_threads = new wxStaticText(page_general, wxID_ANY, _("Rasterizer threads:"));
+	U32Setting* const spin_threads = new U32Setting(page_general, "", vconfig.rasterizerThreads, 1, 64);
+	szr_rendering->Add(label_threads, 1, wxALIGN_CENTER_VERTICAL, 5);
+	szr_rendering->Add(spin_threads, 1, 0, 0);
+
+	// The workers are only started with the backend.
+	if (Core::GetState() != Core::CORE_UNINITIALIZED)
+	{
+		label_threads->Disable();
+		spin_threads->Disable();
+	}
 	}
 
 	// - info
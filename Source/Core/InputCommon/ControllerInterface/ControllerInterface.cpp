@@ -53,10 +53,14 @@ void ControllerInterface::Initialize()
 	ciface::XInput::Init(m_devices);
 #endif
 #ifdef CIFACE_USE_XLIB
-	ciface::Xlib::Init(m_devices, m_hwnd);
+	// Keyboard and mouse input needs a window, headless replays don't have one
+	if (m_hwnd)
+	{
+		ciface::Xlib::Init(m_devices, m_hwnd);
 	#ifdef CIFACE_USE_X11_XINPUT2
-	ciface::XInput2::Init(m_devices, m_hwnd);
+		ciface::XInput2::Init(m_devices, m_hwnd);
 	#endif
+	}
 #endif
 #ifdef CIFACE_USE_OSX
 	ciface::OSX::Init(m_devices, m_hwnd);
@@ -1149,6 +1149,17 @@ u32 Renderer::AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data)
 	return 0;
 }
 
+bool Renderer::PeekEFBRect(EFBAccessType type, const EFBRectangle& rc, u32* values)
+{
+	// The first peek reads back the whole cache block, which is as large as the
+	// rectangles VideoCommon asks for, and the rest are answered from it.
+	for (int y = rc.top; y < rc.bottom; ++y)
+		for (int x = rc.left; x < rc.right; ++x)
+			*values++ = AccessEFB(type, x, y, 0);
+
+	return true;
+}
+
 void Renderer::SetViewport()
 {
 	// reversed gxsetviewport(xorig, yorig, width, height, nearz, farz)
@@ -70,6 +70,7 @@ public:
 	void FlipImageData(u8 *data, int w, int h, int pixel_width = 3);
 
 	u32 AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data) override;
+	bool PeekEFBRect(EFBAccessType type, const EFBRectangle& rc, u32* values) override;
 
 	void ResetAPIState() override;
 	void RestoreAPIState() override;
@@ -22,6 +22,7 @@
 #include "VideoBackends/OGL/GLInterfaceBase.h"
 #include "VideoBackends/OGL/ProgramShaderCache.h"
 #include "VideoBackends/OGL/Render.h"
+#include "VideoBackends/OGL/StreamBuffer.h"
 #include "VideoBackends/OGL/TextureCache.h"
 #include "VideoBackends/OGL/TextureConverter.h"
 
@@ -47,6 +48,29 @@ static u32 s_DepthCbufid;
 static u32 s_Textures[8];
 static u32 s_ActiveTexture;
 
+// Decoded textures are staged in a pixel unpack buffer, so glTexImage2D only
+// queues a copy on the GPU instead of reading from client memory before it
+// returns. The stream buffer fences its chunks and only waits when it wraps
+// around onto data the GPU hasn't consumed yet.
+static const u32 TEXTURE_UPLOAD_BUFFER_SIZE = 32 * 1024 * 1024;
+static StreamBuffer* s_texture_upload_buffer;
+
+static u32 GetPixelSize(PC_TexFormat pcfmt)
+{
+	switch (pcfmt)
+	{
+	case PC_TEX_FMT_I4_AS_I8:
+	case PC_TEX_FMT_I8:
+		return 1;
+	case PC_TEX_FMT_IA4_AS_IA8:
+	case PC_TEX_FMT_IA8:
+	case PC_TEX_FMT_RGB565:
+		return 2;
+	default:
+		return 4;
+	}
+}
+
 bool SaveTexture(const std::string& filename, u32 textarget, u32 tex, int virtual_width, int virtual_height, unsigned int level)
 {
 	if (GLInterface->GetMode() != GLInterfaceMode::MODE_OPENGL)
@@ -204,7 +228,21 @@ void TextureCache::TCacheEntry::Load(unsigned int width, unsigned int height,
 		if (expanded_width != width)
 			glPixelStorei(GL_UNPACK_ROW_LENGTH, expanded_width);
 
-		glTexImage2D(GL_TEXTURE_2D, level, gl_iformat, width, height, 0, gl_format, gl_type, temp);
+		const u32 upload_size = expanded_width * height * GetPixelSize(pcfmt);
+		if (s_texture_upload_buffer && upload_size <= TEXTURE_UPLOAD_BUFFER_SIZE / 4)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_texture_upload_buffer->m_buffer);
+			auto buffer = s_texture_upload_buffer->Map(upload_size, 16);
+			memcpy(buffer.first, temp, upload_size);
+			s_texture_upload_buffer->Unmap(upload_size);
+
+			glTexImage2D(GL_TEXTURE_2D, level, gl_iformat, width, height, 0, gl_format, gl_type, (void*)(uintptr_t)buffer.second);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, level, gl_iformat, width, height, 0, gl_format, gl_type, temp);
+		}
 
 		if (expanded_width != width)
 			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
@@ -411,6 +449,16 @@ TextureCache::TextureCache()
 	s_ActiveTexture = -1;
 	for (auto& gtex : s_Textures)
 		gtex = -1;
+
+	// Without sync objects the stream buffer can't tell when the GPU is done
+	// with the staged data, so it wouldn't be any faster than uploading directly.
+	if (g_ogl_config.bSupportsGLSync)
+	{
+		s_texture_upload_buffer = StreamBuffer::Create(GL_PIXEL_UNPACK_BUFFER, TEXTURE_UPLOAD_BUFFER_SIZE);
+		// Stream buffers keep themselves bound, but a bound unpack buffer
+		// would redirect every other texture upload into it.
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
 }
 
 
@@ -418,6 +466,14 @@ TextureCache::~TextureCache()
 {
 	s_ColorMatrixProgram.Destroy();
 	s_DepthMatrixProgram.Destroy();
+
+	if (s_texture_upload_buffer)
+	{
+		// Some stream buffers unmap themselves on deletion, which needs them bound.
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_texture_upload_buffer->m_buffer);
+		delete s_texture_upload_buffer;
+		s_texture_upload_buffer = nullptr;
+	}
 }
 
 void TextureCache::DisableStage(unsigned int stage)
@@ -11,6 +11,7 @@
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/Rasterizer.h"
 #include "VideoBackends/Software/Tev.h"
+#include "VideoBackends/Software/TextureSampler.h"
 
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/TextureDecoder.h"
@@ -21,6 +22,8 @@ void InitBPMemory()
 {
 	memset(&bpmem, 0, sizeof(bpmem));
 	bpmem.bpMask = 0xFFFFFF;
+	Tev::InvalidateConfig();
+	TextureSampler::InvalidateCache();
 }
 
 void SWLoadBPReg(u32 value)
@@ -39,8 +42,24 @@ void SWLoadBPReg(u32 value)
 	SWBPWritten(address, newval);
 }
 
+// Registers which are baked into the cached Tev configuration
+static bool IsTevConfigRegister(int address)
+{
+	return address == BPMEM_GENMODE ||
+	       address == BPMEM_RAS1_SS0 ||
+	       address == BPMEM_RAS1_SS1 ||
+	       address == BPMEM_IREF ||
+	       (address >= BPMEM_TREF && address < BPMEM_TREF + 8) ||
+	       (address >= BPMEM_TEV_COLOR_ENV && address < BPMEM_TEV_COLOR_ENV + 32) ||
+	       address == BPMEM_ALPHACOMPARE ||
+	       (address >= BPMEM_TEV_KSEL && address < BPMEM_TEV_KSEL + 8);
+}
+
 void SWBPWritten(int address, int newvalue)
 {
+	if (IsTevConfigRegister(address))
+		Tev::InvalidateConfig();
+
 	switch (address)
 	{
 	case BPMEM_SCISSORTL:
@@ -71,6 +90,8 @@ void SWBPWritten(int address, int newvalue)
 		break;
 	case BPMEM_TRIGGER_EFB_COPY:
 		EfbCopy::CopyEfb();
+		// the copy may have overwritten a texture
+		TextureSampler::InvalidateCache();
 		break;
 	case BPMEM_CLEARBBOX1:
 		PixelEngine::bbox[0] = newvalue >> 10;
@@ -103,6 +124,8 @@ void SWBPWritten(int address, int newvalue)
 				memcpy(texMem + tlutTMemAddr, ptr, tlutXferCount);
 			else
 				PanicAlert("Invalid palette pointer %08x %08x %08x", bpmem.tmem_config.tlut_src, bpmem.tmem_config.tlut_src << 5, (bpmem.tmem_config.tlut_src & 0xFFFFF)<< 5);
+
+			TextureSampler::InvalidateCache();
 			break;
 		}
 
@@ -142,9 +165,16 @@ void SWBPWritten(int address, int newvalue)
 					src_ptr += TMEM_LINE_SIZE * 2;
 				}
 			}
+
+			TextureSampler::InvalidateCache();
 		}
 		break;
 
+	case BPMEM_TEXINVALIDATE:
+		// the game changed texture data in RAM
+		TextureSampler::InvalidateCache();
+		break;
+
 	case BPMEM_TEV_REGISTER_L:   // Reg 1
 	case BPMEM_TEV_REGISTER_L+2: // Reg 2
 	case BPMEM_TEV_REGISTER_L+4: // Reg 3
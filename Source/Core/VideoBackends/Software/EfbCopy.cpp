@@ -29,6 +29,22 @@ namespace EfbCopy
 {
 	static void CopyToXfb(u32 xfbAddr, u32 fbWidth, u32 fbHeight, const EFBRectangle& sourceRc, float Gamma)
 	{
+		if (g_SWVideoConfig.bHeadless)
+		{
+			EfbInterface::yuv422_packed* xfb_in_ram = (EfbInterface::yuv422_packed *) Memory::GetPointer(xfbAddr);
+
+			{
+				TIMESTAT(swstats.thisFrame.efbCopyTime);
+				EfbInterface::CopyToXFB(xfb_in_ram, fbWidth, fbHeight, sourceRc, Gamma);
+			}
+
+			// Nothing presents the XFB without a window, so the copy ends the frame.
+			SWRenderer::SwapHeadless(xfbAddr, fbWidth, fbHeight);
+			return;
+		}
+
+		TIMESTAT(swstats.thisFrame.efbCopyTime);
+
 		GLInterface->Update(); // update the render window position and the backbuffer size
 
 		if (!g_SWVideoConfig.bHwRasterizer)
@@ -66,6 +82,8 @@ namespace EfbCopy
 
 	static void CopyToRam()
 	{
+		TIMESTAT(swstats.thisFrame.efbCopyTime);
+
 		if (!g_SWVideoConfig.bHwRasterizer)
 		{
 			u8 *dest_ptr = Memory::GetPointer(bpmem.copyTexDest << 5);
@@ -76,6 +94,8 @@ namespace EfbCopy
 
 	static void ClearEfb()
 	{
+		TIMESTAT(swstats.thisFrame.efbCopyTime);
+
 		u32 clearColor = (bpmem.clearcolorAR & 0xff) << 24 | bpmem.clearcolorGB << 8 | (bpmem.clearcolorAR & 0xff00) >> 8;
 
 		int left   = bpmem.copyTexSrcXY.x;
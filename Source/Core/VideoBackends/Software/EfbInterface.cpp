@@ -35,6 +35,20 @@ namespace EfbInterface
 		p.DoArray(efb, EFB_WIDTH*EFB_HEIGHT*6);
 	}
 
+	// Pixels are packed into 3 bytes, so only access those and leave the first
+	// byte of the next pixel alone. It may be drawn by another rasterizer thread.
+	static inline u32 GetPixel24(u32 offset)
+	{
+		return efb[offset] | (efb[offset + 1] << 8) | (efb[offset + 2] << 16);
+	}
+
+	static inline void SetPixel24(u32 offset, u32 val)
+	{
+		efb[offset] = val & 0xff;
+		efb[offset + 1] = (val >> 8) & 0xff;
+		efb[offset + 2] = (val >> 16) & 0xff;
+	}
+
 	static void SetPixelAlphaOnly(u32 offset, u8 a)
 	{
 		switch (bpmem.zcontrol.pixel_format)
@@ -47,10 +61,9 @@ namespace EfbInterface
 		case PEControl::RGBA6_Z24:
 			{
 				u32 a32 = a;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xffffffc0;
+				u32 val = GetPixel24(offset) & 0x00ffffc0;
 				val |= (a32 >> 2) & 0x0000003f;
-				*dst = val;
+				SetPixel24(offset, val);
 			}
 			break;
 		default:
@@ -66,31 +79,26 @@ namespace EfbInterface
 		case PEControl::Z24:
 			{
 				u32 src = *(u32*)rgb;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= src >> 8;
-				*dst = val;
+				u32 val = src >> 8;
+				SetPixel24(offset, val);
 			}
 			break;
 		case PEControl::RGBA6_Z24:
 			{
 				u32 src = *(u32*)rgb;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff00003f;
+				u32 val = GetPixel24(offset) & 0x0000003f;
 				val |= (src >> 4) & 0x00000fc0; // blue
 				val |= (src >> 6) & 0x0003f000; // green
 				val |= (src >> 8) & 0x00fc0000; // red
-				*dst = val;
+				SetPixel24(offset, val);
 			}
 			break;
 		case PEControl::RGB565_Z16:
 			{
 				INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
 				u32 src = *(u32*)rgb;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= src >> 8;
-				*dst = val;
+				u32 val = src >> 8;
+				SetPixel24(offset, val);
 			}
 			break;
 		default:
@@ -106,32 +114,26 @@ namespace EfbInterface
 		case PEControl::Z24:
 			{
 				u32 src = *(u32*)color;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= src >> 8;
-				*dst = val;
+				u32 val = src >> 8;
+				SetPixel24(offset, val);
 			}
 			break;
 		case PEControl::RGBA6_Z24:
 			{
 				u32 src = *(u32*)color;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= (src >> 2) & 0x0000003f; // alpha
+				u32 val = (src >> 2) & 0x0000003f; // alpha
 				val |= (src >> 4) & 0x00000fc0; // blue
 				val |= (src >> 6) & 0x0003f000; // green
 				val |= (src >> 8) & 0x00fc0000; // red
-				*dst = val;
+				SetPixel24(offset, val);
 			}
 			break;
 		case PEControl::RGB565_Z16:
 			{
 				INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
 				u32 src = *(u32*)color;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= src >> 8;
-				*dst = val;
+				u32 val = src >> 8;
+				SetPixel24(offset, val);
 			}
 			break;
 		default:
@@ -183,19 +185,15 @@ namespace EfbInterface
 		case PEControl::RGBA6_Z24:
 		case PEControl::Z24:
 			{
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= depth & 0x00ffffff;
-				*dst = val;
+				u32 val = depth & 0x00ffffff;
+				SetPixel24(offset, val);
 			}
 			break;
 		case PEControl::RGB565_Z16:
 			{
 				INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= depth & 0x00ffffff;
-				*dst = val;
+				u32 val = depth & 0x00ffffff;
+				SetPixel24(offset, val);
 			}
 			break;
 		default:
@@ -436,12 +434,6 @@ namespace EfbInterface
 		{
 			SetPixelAlphaOnly(offset, dstClrPtr[ALP_C]);
 		}
-
-		// branchless bounding box update
-		PixelEngine::bbox[0] = std::min(x, PixelEngine::bbox[0]);
-		PixelEngine::bbox[1] = std::max(x, PixelEngine::bbox[1]);
-		PixelEngine::bbox[2] = std::min(y, PixelEngine::bbox[2]);
-		PixelEngine::bbox[3] = std::max(y, PixelEngine::bbox[3]);
 	}
 
 	void SetColor(u16 x, u16 y, u8 *color)
@@ -9,6 +9,7 @@
 #include "VideoBackends/Software/CPMemLoader.h"
 #include "VideoBackends/Software/DebugUtil.h"
 #include "VideoBackends/Software/OpcodeDecoder.h"
+#include "VideoBackends/Software/Rasterizer.h"
 #include "VideoBackends/Software/SWCommandProcessor.h"
 #include "VideoBackends/Software/SWStatistics.h"
 #include "VideoBackends/Software/SWVertexLoader.h"
@@ -64,12 +65,17 @@ static void DecodePrimitiveStream(u32 iBufferSize)
 	}
 	else
 	{
+		TIMESTAT(swstats.thisFrame.primitiveTime);
+
 		while (streamSize > 0 && iBufferSize >= vertexSize)
 		{
 			vertexLoader.LoadVertex();
 			iBufferSize -= vertexSize;
 			streamSize--;
 		}
+
+		// Nothing may touch the EFB or the draw state until the binned triangles are drawn
+		Rasterizer::Flush();
 	}
 
 	if (streamSize == 0)
@@ -3,8 +3,15 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/Flag.h"
+#include "Common/Thread.h"
 #include "VideoBackends/Software/BPMemLoader.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/HwRasterizer.h"
@@ -13,7 +20,9 @@
 #include "VideoBackends/Software/SWStatistics.h"
 #include "VideoBackends/Software/SWVideoConfig.h"
 #include "VideoBackends/Software/Tev.h"
+#include "VideoBackends/Software/TextureSampler.h"
 #include "VideoBackends/Software/XFMemLoader.h"
+#include "VideoCommon/PixelEngine.h"
 
 
 #define BLOCK_SIZE 2
@@ -33,54 +42,144 @@ static inline s32 FixedLog2(float f)
 
 namespace Rasterizer
 {
-static Slope ZSlope;
-static Slope WSlope;
-static Slope ColorSlopes[2][4];
-static Slope TexSlopes[8][3];
+// Everything needed to draw one triangle after setup, so that triangles can be
+// queued and drawn later by the tile workers.
+struct Triangle
+{
+	Slope ZSlope;
+	Slope WSlope;
+	Slope ColorSlopes[2][4];
+	Slope TexSlopes[8][3];
+
+	s32 vertex0X;
+	s32 vertex0Y;
+	float vertexOffsetX;
+	float vertexOffsetY;
+
+	// Half-edge constants and deltas in 28.4 fixed point
+	s32 C1, C2, C3;
+	s32 DX12, DX23, DX31;
+	s32 DY12, DY23, DY31;
+
+	// Bounding rectangle, scissored and aligned to BLOCK_SIZE
+	s32 minx, maxx, miny, maxy;
+};
+
+// State used while shading, one per thread drawing pixels.
+struct RasterContext
+{
+	Tev tev;
+	RasterBlock rasterBlock;
+	u32 rasterizedPixels;
+};
 
-static s32 vertex0X;
-static s32 vertex0Y;
-static float vertexOffsetX;
-static float vertexOffsetY;
+// Tiles must be a multiple of BLOCK_SIZE so that no block crosses a tile.
+static const s32 TILE_SIZE = 64;
+static const s32 TILES_X = (EFB_WIDTH + TILE_SIZE - 1) / TILE_SIZE;
+static const s32 TILES_Y = (EFB_HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+
+// The triangle currently being set up. ZSlope is kept across triangles for zfreeze.
+static Triangle setup;
 
 static s32 scissorLeft = 0;
 static s32 scissorTop = 0;
 static s32 scissorRight = 0;
 static s32 scissorBottom = 0;
 
-static Tev tev;
-static RasterBlock rasterBlock;
+static RasterContext context;
+
+// Triangles binned since the last Flush(). Each tile draws its triangles in
+// submission order, so the EFB sees the same sequence of writes per pixel.
+static std::vector<Triangle> queuedTriangles;
+static std::vector<u32> tileBins[TILES_X * TILES_Y];
+static std::atomic<int> nextTile;
+
+struct RasterWorker
+{
+	std::thread thread;
+	Common::Event start;
+	Common::Event done;
+	RasterContext context;
+};
+
+static std::vector<std::unique_ptr<RasterWorker>> workers;
+static Common::Flag workersRunning;
 
 void DoState(PointerWrap &p)
 {
-	ZSlope.DoState(p);
-	WSlope.DoState(p);
-	for (auto& color_slopes_1d : ColorSlopes)
+	setup.ZSlope.DoState(p);
+	setup.WSlope.DoState(p);
+	for (auto& color_slopes_1d : setup.ColorSlopes)
 		for (Slope& color_slope : color_slopes_1d)
 			color_slope.DoState(p);
-	for (auto& tex_slopes_1d : TexSlopes)
+	for (auto& tex_slopes_1d : setup.TexSlopes)
 		for (Slope& tex_slope : tex_slopes_1d)
 			tex_slope.DoState(p);
-	p.Do(vertex0X);
-	p.Do(vertex0Y);
-	p.Do(vertexOffsetX);
-	p.Do(vertexOffsetY);
+	p.Do(setup.vertex0X);
+	p.Do(setup.vertex0Y);
+	p.Do(setup.vertexOffsetX);
+	p.Do(setup.vertexOffsetY);
 	p.Do(scissorLeft);
 	p.Do(scissorTop);
 	p.Do(scissorRight);
 	p.Do(scissorBottom);
-	tev.DoState(p);
-	p.Do(rasterBlock);
+	context.tev.DoState(p);
+	p.Do(context.rasterBlock);
+}
+
+static void DrawTiles(RasterContext& ctx);
+
+static void WorkerThread(RasterWorker* worker)
+{
+	Common::SetCurrentThreadName("SW rasterizer");
+
+	while (true)
+	{
+		worker->start.Wait();
+		if (!workersRunning.IsSet())
+			break;
+
+		DrawTiles(worker->context);
+		worker->done.Set();
+	}
 }
 
 void Init()
 {
-	tev.Init();
+	context.tev.Init();
+	context.rasterizedPixels = 0;
 
 	// Set initial z reference plane in the unlikely case that zfreeze is enabled when drawing the first primitive.
 	// TODO: This is just a guess!
-	ZSlope.dfdx = ZSlope.dfdy = 0.f;
-	ZSlope.f0 = 1.f;
+	setup.ZSlope.dfdx = setup.ZSlope.dfdy = 0.f;
+	setup.ZSlope.f0 = 1.f;
+
+	// The video thread draws tiles as well, so it counts as one of the threads.
+	u32 num_workers = std::max(g_SWVideoConfig.rasterizerThreads, 1u) - 1;
+	workersRunning.Set();
+	for (u32 i = 0; i < num_workers; ++i)
+	{
+		RasterWorker* worker = new RasterWorker;
+		worker->context.tev.Init();
+		worker->context.rasterizedPixels = 0;
+		worker->thread = std::thread(WorkerThread, worker);
+		workers.emplace_back(worker);
+	}
+}
+
+void Shutdown()
+{
+	workersRunning.Clear();
+	for (auto& worker : workers)
+	{
+		worker->start.Set();
+		worker->thread.join();
+	}
+	workers.clear();
+
+	queuedTriangles.clear();
+	for (auto& bin : tileBins)
+		bin.clear();
 }
 
 static inline int iround(float x)
@@ -116,34 +215,36 @@ void SetScissor()
 
 void SetTevReg(int reg, int comp, bool konst, s16 color)
 {
-	tev.SetRegColor(reg, comp, konst, color);
+	context.tev.SetRegColor(reg, comp, konst, color);
 }
 
-inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
+inline void Draw(RasterContext& ctx, const Triangle& tri, s32 x, s32 y, s32 xi, s32 yi)
 {
-	INCSTAT(swstats.thisFrame.rasterizedPixels);
+	Tev& tev = ctx.tev;
+	ctx.rasterizedPixels++;
 
-	float dx = vertexOffsetX + (float)(x - vertex0X);
-	float dy = vertexOffsetY + (float)(y - vertex0Y);
+	float dx = tri.vertexOffsetX + (float)(x - tri.vertex0X);
+	float dy = tri.vertexOffsetY + (float)(y - tri.vertex0Y);
 
-	s32 z = (s32)ZSlope.GetValue(dx, dy);
+	s32 z = (s32)tri.ZSlope.GetValue(dx, dy);
 	if (z < 0 || z > 0x00ffffff)
 		return;
 
 	if (bpmem.UseEarlyDepthTest() && g_SWVideoConfig.bZComploc)
 	{
 		// TODO: Test if perf regs are incremented even if test is disabled
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT_ZCOMPLOC);
+		tev.PerfCounters[PQ_ZCOMP_INPUT_ZCOMPLOC]++;
 		if (bpmem.zmode.testenable)
 		{
 			// early z
 			if (!EfbInterface::ZCompare(x, y, z))
 				return;
 		}
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT_ZCOMPLOC);
+		tev.PerfCounters[PQ_ZCOMP_OUTPUT_ZCOMPLOC]++;
 	}
 
-	RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
+	const RasterBlock& rasterBlock = ctx.rasterBlock;
+	const RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
 	tev.Position[0] = x;
 	tev.Position[1] = y;
@@ -154,7 +255,7 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 	{
 		for (int comp = 0; comp < 4; comp++)
 		{
-			u16 color = (u16)ColorSlopes[i][comp].GetValue(dx, dy);
+			u16 color = (u16)tri.ColorSlopes[i][comp].GetValue(dx, dy);
 
 			// clamp color value to 0
 			u16 mask = ~(color >> 8);
@@ -188,14 +289,14 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 
 static void InitTriangle(float X1, float Y1, s32 xi, s32 yi)
 {
-	vertex0X = xi;
-	vertex0Y = yi;
+	setup.vertex0X = xi;
+	setup.vertex0Y = yi;
 
 	// adjust a little less than 0.5
 	const float adjust = 0.495f;
 
-	vertexOffsetX = ((float)xi - X1) + adjust;
-	vertexOffsetY = ((float)yi - Y1) + adjust;
+	setup.vertexOffsetX = ((float)xi - X1) + adjust;
+	setup.vertexOffsetY = ((float)yi - Y1) + adjust;
 }
 
 static void InitSlope(Slope *slope, float f1, float f2, float f3, float DX31, float DX12, float DY12, float DY31)
@@ -210,7 +311,7 @@ static void InitSlope(Slope *slope, float f1, float f2, float f3, float DX31, fl
 	slope->f0 = f1;
 }
 
-static inline void CalculateLOD(s32 &lod, bool &linear, u32 texmap, u32 texcoord)
+static inline void CalculateLOD(const RasterBlock& rasterBlock, s32 &lod, bool &linear, u32 texmap, u32 texcoord)
 {
 	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
 	u8 subTexmap = texmap & 3;
@@ -223,17 +324,17 @@ static inline void CalculateLOD(s32 &lod, bool &linear, u32 texmap, u32 texcoord
 	float sDelta, tDelta;
 	if (tm0.diag_lod)
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
+		const float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+		const float *uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
 
 		sDelta = fabsf(uv0[0] - uv1[0]);
 		tDelta = fabsf(uv0[1] - uv1[1]);
 	}
 	else
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
-		float *uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
+		const float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+		const float *uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
+		const float *uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
 
 		sDelta = std::max(fabsf(uv0[0] - uv1[0]), fabsf(uv0[0] - uv2[0]));
 		tDelta = std::max(fabsf(uv0[1] - uv1[1]), fabsf(uv0[1] - uv2[1]));
@@ -256,7 +357,7 @@ static inline void CalculateLOD(s32 &lod, bool &linear, u32 texmap, u32 texcoord
 	lod = CLAMP(lod, (s32)tm1.min_lod, (s32)tm1.max_lod);
 }
 
-static void BuildBlock(s32 blockX, s32 blockY)
+static void BuildBlock(RasterBlock& rasterBlock, const Triangle& tri, s32 blockX, s32 blockY)
 {
 	for (s32 yi = 0; yi < BLOCK_SIZE; yi++)
 	{
@@ -264,10 +365,10 @@ static void BuildBlock(s32 blockX, s32 blockY)
 		{
 			RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
-			float dx = vertexOffsetX + (float)(xi + blockX - vertex0X);
-			float dy = vertexOffsetY + (float)(yi + blockY - vertex0Y);
+			float dx = tri.vertexOffsetX + (float)(xi + blockX - tri.vertex0X);
+			float dy = tri.vertexOffsetY + (float)(yi + blockY - tri.vertex0Y);
 
-			float invW = 1.0f / WSlope.GetValue(dx, dy);
+			float invW = 1.0f / tri.WSlope.GetValue(dx, dy);
 			pixel.InvW = invW;
 
 			// tex coords
@@ -276,13 +377,13 @@ static void BuildBlock(s32 blockX, s32 blockY)
 				float projection = invW;
 				if (xfmem.texMtxInfo[i].projection)
 				{
-					float q = TexSlopes[i][2].GetValue(dx, dy) * invW;
+					float q = tri.TexSlopes[i][2].GetValue(dx, dy) * invW;
 					if (q != 0.0f)
 						projection = invW / q;
 				}
 
-				pixel.Uv[i][0] = TexSlopes[i][0].GetValue(dx, dy) * projection;
-				pixel.Uv[i][1] = TexSlopes[i][1].GetValue(dx, dy) * projection;
+				pixel.Uv[i][0] = tri.TexSlopes[i][0].GetValue(dx, dy) * projection;
+				pixel.Uv[i][1] = tri.TexSlopes[i][1].GetValue(dx, dy) * projection;
 			}
 		}
 	}
@@ -295,7 +396,7 @@ static void BuildBlock(s32 blockX, s32 blockY)
 		u32 texcoord = indref & 3;
 		indref >>= 3;
 
-		CalculateLOD(rasterBlock.IndirectLod[i], rasterBlock.IndirectLinear[i], texmap, texcoord);
+		CalculateLOD(rasterBlock, rasterBlock.IndirectLod[i], rasterBlock.IndirectLinear[i], texmap, texcoord);
 	}
 
 	for (unsigned int i = 0; i <= bpmem.genMode.numtevstages; i++)
@@ -307,41 +408,17 @@ static void BuildBlock(s32 blockX, s32 blockY)
 			u32 texmap = order.getTexMap(stageOdd);
 			u32 texcoord = order.getTexCoord(stageOdd);
 
-			CalculateLOD(rasterBlock.TextureLod[i], rasterBlock.TextureLinear[i], texmap, texcoord);
+			CalculateLOD(rasterBlock, rasterBlock.TextureLod[i], rasterBlock.TextureLinear[i], texmap, texcoord);
 		}
 	}
 }
 
-void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2)
+// Draws the part of a triangle inside the given rectangle, which must be aligned to BLOCK_SIZE.
+static void DrawTriangle(RasterContext& ctx, const Triangle& tri, s32 left, s32 top, s32 right, s32 bottom)
 {
-	INCSTAT(swstats.thisFrame.numTrianglesDrawn);
-
-	if (g_SWVideoConfig.bHwRasterizer)
-	{
-		HwRasterizer::DrawTriangleFrontFace(v0, v1, v2);
-		return;
-	}
-
-	// adapted from http://devmaster.net/posts/6145/advanced-rasterization
-
-	// 28.4 fixed-pou32 coordinates. rounded to nearest and adjusted to match hardware output
-	// could also take floor and adjust -8
-	const s32 Y1 = iround(16.0f * v0->screenPosition[1]) - 9;
-	const s32 Y2 = iround(16.0f * v1->screenPosition[1]) - 9;
-	const s32 Y3 = iround(16.0f * v2->screenPosition[1]) - 9;
-
-	const s32 X1 = iround(16.0f * v0->screenPosition[0]) - 9;
-	const s32 X2 = iround(16.0f * v1->screenPosition[0]) - 9;
-	const s32 X3 = iround(16.0f * v2->screenPosition[0]) - 9;
-
-	// Deltas
-	const s32 DX12 = X1 - X2;
-	const s32 DX23 = X2 - X3;
-	const s32 DX31 = X3 - X1;
-
-	const s32 DY12 = Y1 - Y2;
-	const s32 DY23 = Y2 - Y3;
-	const s32 DY31 = Y3 - Y1;
+	const s32 C1 = tri.C1, C2 = tri.C2, C3 = tri.C3;
+	const s32 DX12 = tri.DX12, DX23 = tri.DX23, DX31 = tri.DX31;
+	const s32 DY12 = tri.DY12, DY23 = tri.DY23, DY31 = tri.DY31;
 
 	// Fixed-pos32 deltas
 	const s32 FDX12 = DX12 << 4;
@@ -352,66 +429,10 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	const s32 FDY23 = DY23 << 4;
 	const s32 FDY31 = DY31 << 4;
 
-	// Bounding rectangle
-	s32 minx = (std::min(std::min(X1, X2), X3) + 0xF) >> 4;
-	s32 maxx = (std::max(std::max(X1, X2), X3) + 0xF) >> 4;
-	s32 miny = (std::min(std::min(Y1, Y2), Y3) + 0xF) >> 4;
-	s32 maxy = (std::max(std::max(Y1, Y2), Y3) + 0xF) >> 4;
-
-	// scissor
-	minx = std::max(minx, scissorLeft);
-	maxx = std::min(maxx, scissorRight);
-	miny = std::max(miny, scissorTop);
-	maxy = std::min(maxy, scissorBottom);
-
-	if (minx >= maxx || miny >= maxy)
-		return;
-
-	// Setup slopes
-	float fltx1 = v0->screenPosition.x;
-	float flty1 = v0->screenPosition.y;
-	float fltdx31 = v2->screenPosition.x - fltx1;
-	float fltdx12 = fltx1 - v1->screenPosition.x;
-	float fltdy12 = flty1 - v1->screenPosition.y;
-	float fltdy31 = v2->screenPosition.y - flty1;
-
-	InitTriangle(fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
-
-	float w[3] = { 1.0f / v0->projectedPosition.w, 1.0f / v1->projectedPosition.w, 1.0f / v2->projectedPosition.w };
-	InitSlope(&WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
-
-	// TODO: The zfreeze emulation is not quite correct, yet!
-	// Many things might prevent us from reaching this line (culling, clipping, scissoring).
-	// However, the zslope is always guaranteed to be calculated unless all vertices are trivially rejected during clipping!
-	// We're currently sloppy at this since we abort early if any of the culling/clipping/scissoring tests fail.
-	if (!bpmem.genMode.zfreeze || !g_SWVideoConfig.bZFreeze)
-		InitSlope(&ZSlope, v0->screenPosition[2], v1->screenPosition[2], v2->screenPosition[2], fltdx31, fltdx12, fltdy12, fltdy31);
-
-	for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
-	{
-		for (int comp = 0; comp < 4; comp++)
-			InitSlope(&ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp], v2->color[i][comp], fltdx31, fltdx12, fltdy12, fltdy31);
-	}
-
-	for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
-	{
-		for (int comp = 0; comp < 3; comp++)
-			InitSlope(&TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
-	}
-
-	// Start in corner of 8x8 block
-	minx &= ~(BLOCK_SIZE - 1);
-	miny &= ~(BLOCK_SIZE - 1);
-
-	// Half-edge constants
-	s32 C1 = DY12 * X1 - DX12 * Y1;
-	s32 C2 = DY23 * X2 - DX23 * Y2;
-	s32 C3 = DY31 * X3 - DX31 * Y3;
-
-	// Correct for fill convention
-	if (DY12 < 0 || (DY12 == 0 && DX12 > 0)) C1++;
-	if (DY23 < 0 || (DY23 == 0 && DX23 > 0)) C2++;
-	if (DY31 < 0 || (DY31 == 0 && DX31 > 0)) C3++;
+	const s32 minx = std::max(tri.minx, left);
+	const s32 maxx = std::min(tri.maxx, right);
+	const s32 miny = std::max(tri.miny, top);
+	const s32 maxy = std::min(tri.maxy, bottom);
 
 	// Loop through blocks
 	for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
@@ -447,7 +468,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 			if (a == 0x0 || b == 0x0 || c == 0x0)
 				continue;
 
-			BuildBlock(x, y);
+			BuildBlock(ctx.rasterBlock, tri, x, y);
 
 			// Accept whole block when totally covered
 			if (a == 0xF && b == 0xF && c == 0xF)
@@ -456,7 +477,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 				{
 					for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
 					{
-						Draw(x + ix, y + iy, ix, iy);
+						Draw(ctx, tri, x + ix, y + iy, ix, iy);
 					}
 				}
 			}
@@ -476,7 +497,7 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 					{
 						if (CX1 > 0 && CX2 > 0 && CX3 > 0)
 						{
-							Draw(x + ix, y + iy, ix, iy);
+							Draw(ctx, tri, x + ix, y + iy, ix, iy);
 						}
 
 						CX1 -= FDY12;
@@ -493,5 +514,221 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	}
 }
 
+static void DrawTiles(RasterContext& ctx)
+{
+	int tile;
+	while ((tile = nextTile++) < TILES_X * TILES_Y)
+	{
+		const s32 left = (tile % TILES_X) * TILE_SIZE;
+		const s32 top = (tile / TILES_X) * TILE_SIZE;
+
+		for (u32 index : tileBins[tile])
+			DrawTriangle(ctx, queuedTriangles[index], left, top, left + TILE_SIZE, top + TILE_SIZE);
+	}
+}
+
+static void AddCounters(RasterContext& ctx)
+{
+	ADDSTAT(swstats.thisFrame.rasterizedPixels, ctx.rasterizedPixels);
+	ADDSTAT(swstats.thisFrame.tevPixelsIn, ctx.tev.PixelsIn);
+	ADDSTAT(swstats.thisFrame.tevPixelsOut, ctx.tev.PixelsOut);
+
+	for (int i = 0; i < PQ_NUM_MEMBERS; ++i)
+	{
+		if (ctx.tev.PerfCounters[i])
+			EfbInterface::IncPerfCounterQuadCount((PerfQueryType)i, ctx.tev.PerfCounters[i]);
+	}
+
+	const u16* bbox = ctx.tev.BoundingBox;
+	if (bbox[0] <= bbox[1])
+	{
+		PixelEngine::bbox[0] = std::min(bbox[0], PixelEngine::bbox[0]);
+		PixelEngine::bbox[1] = std::max(bbox[1], PixelEngine::bbox[1]);
+		PixelEngine::bbox[2] = std::min(bbox[2], PixelEngine::bbox[2]);
+		PixelEngine::bbox[3] = std::max(bbox[3], PixelEngine::bbox[3]);
+	}
+
+	ctx.rasterizedPixels = 0;
+	ctx.tev.ResetCounters();
+}
+
+// The tev dumps write to shared debug buffers, so they need the serial path.
+// Without workers, triangles are still queued so that Flush() draws and times
+// each batch in one go on the video thread.
+static bool CanQueueTriangles()
+{
+	return !g_SWVideoConfig.bDumpTevStages && !g_SWVideoConfig.bDumpTevTextureFetches;
+}
+
+void Flush()
+{
+	if (!queuedTriangles.empty())
+	{
+		TIMESTAT(swstats.thisFrame.rasterTime);
+
+		int usedTiles = 0;
+		for (auto& bin : tileBins)
+			usedTiles += !bin.empty();
+
+		nextTile = 0;
+
+		// Waking up the workers isn't worth it when everything lands in one tile.
+		if (usedTiles > 1)
+		{
+			for (auto& worker : workers)
+			{
+				worker->context.tev.CopyRegisters(context.tev);
+				worker->start.Set();
+			}
+
+			DrawTiles(context);
+
+			for (auto& worker : workers)
+			{
+				worker->done.Wait();
+				AddCounters(worker->context);
+			}
+		}
+		else
+		{
+			DrawTiles(context);
+		}
+
+		queuedTriangles.clear();
+		for (auto& bin : tileBins)
+			bin.clear();
+	}
+
+	AddCounters(context);
+}
+
+void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2)
+{
+	INCSTAT(swstats.thisFrame.numTrianglesDrawn);
+
+	if (g_SWVideoConfig.bHwRasterizer)
+	{
+		HwRasterizer::DrawTriangleFrontFace(v0, v1, v2);
+		return;
+	}
+
+	Tev::UpdateConfig();
+	TextureSampler::UpdateCache(Tev::GetTexmapMask());
+
+	// adapted from http://devmaster.net/posts/6145/advanced-rasterization
+
+	// 28.4 fixed-pou32 coordinates. rounded to nearest and adjusted to match hardware output
+	// could also take floor and adjust -8
+	const s32 Y1 = iround(16.0f * v0->screenPosition[1]) - 9;
+	const s32 Y2 = iround(16.0f * v1->screenPosition[1]) - 9;
+	const s32 Y3 = iround(16.0f * v2->screenPosition[1]) - 9;
+
+	const s32 X1 = iround(16.0f * v0->screenPosition[0]) - 9;
+	const s32 X2 = iround(16.0f * v1->screenPosition[0]) - 9;
+	const s32 X3 = iround(16.0f * v2->screenPosition[0]) - 9;
+
+	// Deltas
+	const s32 DX12 = X1 - X2;
+	const s32 DX23 = X2 - X3;
+	const s32 DX31 = X3 - X1;
+
+	const s32 DY12 = Y1 - Y2;
+	const s32 DY23 = Y2 - Y3;
+	const s32 DY31 = Y3 - Y1;
+
+	// Bounding rectangle
+	s32 minx = (std::min(std::min(X1, X2), X3) + 0xF) >> 4;
+	s32 maxx = (std::max(std::max(X1, X2), X3) + 0xF) >> 4;
+	s32 miny = (std::min(std::min(Y1, Y2), Y3) + 0xF) >> 4;
+	s32 maxy = (std::max(std::max(Y1, Y2), Y3) + 0xF) >> 4;
+
+	// scissor
+	minx = std::max(minx, scissorLeft);
+	maxx = std::min(maxx, scissorRight);
+	miny = std::max(miny, scissorTop);
+	maxy = std::min(maxy, scissorBottom);
+
+	if (minx >= maxx || miny >= maxy)
+		return;
+
+	// Setup slopes
+	float fltx1 = v0->screenPosition.x;
+	float flty1 = v0->screenPosition.y;
+	float fltdx31 = v2->screenPosition.x - fltx1;
+	float fltdx12 = fltx1 - v1->screenPosition.x;
+	float fltdy12 = flty1 - v1->screenPosition.y;
+	float fltdy31 = v2->screenPosition.y - flty1;
+
+	InitTriangle(fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
+
+	float w[3] = { 1.0f / v0->projectedPosition.w, 1.0f / v1->projectedPosition.w, 1.0f / v2->projectedPosition.w };
+	InitSlope(&setup.WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+
+	// TODO: The zfreeze emulation is not quite correct, yet!
+	// Many things might prevent us from reaching this line (culling, clipping, scissoring).
+	// However, the zslope is always guaranteed to be calculated unless all vertices are trivially rejected during clipping!
+	// We're currently sloppy at this since we abort early if any of the culling/clipping/scissoring tests fail.
+	if (!bpmem.genMode.zfreeze || !g_SWVideoConfig.bZFreeze)
+		InitSlope(&setup.ZSlope, v0->screenPosition[2], v1->screenPosition[2], v2->screenPosition[2], fltdx31, fltdx12, fltdy12, fltdy31);
+
+	for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
+	{
+		for (int comp = 0; comp < 4; comp++)
+			InitSlope(&setup.ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp], v2->color[i][comp], fltdx31, fltdx12, fltdy12, fltdy31);
+	}
+
+	for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
+	{
+		for (int comp = 0; comp < 3; comp++)
+			InitSlope(&setup.TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+	}
+
+	// Start in corner of 8x8 block
+	minx &= ~(BLOCK_SIZE - 1);
+	miny &= ~(BLOCK_SIZE - 1);
+
+	setup.minx = minx;
+	setup.maxx = maxx;
+	setup.miny = miny;
+	setup.maxy = maxy;
+
+	setup.DX12 = DX12;
+	setup.DX23 = DX23;
+	setup.DX31 = DX31;
+	setup.DY12 = DY12;
+	setup.DY23 = DY23;
+	setup.DY31 = DY31;
+
+	// Half-edge constants
+	setup.C1 = DY12 * X1 - DX12 * Y1;
+	setup.C2 = DY23 * X2 - DX23 * Y2;
+	setup.C3 = DY31 * X3 - DX31 * Y3;
+
+	// Correct for fill convention
+	if (DY12 < 0 || (DY12 == 0 && DX12 > 0)) setup.C1++;
+	if (DY23 < 0 || (DY23 == 0 && DX23 > 0)) setup.C2++;
+	if (DY31 < 0 || (DY31 == 0 && DX31 > 0)) setup.C3++;
+
+	if (!CanQueueTriangles())
+	{
+		if (!queuedTriangles.empty())
+			Flush();
+
+		TIMESTAT(swstats.thisFrame.rasterTime);
+		DrawTriangle(context, setup, 0, 0, EFB_WIDTH, EFB_HEIGHT);
+		return;
+	}
+
+	// Bin the triangle into every tile its bounding rectangle touches
+	const u32 index = (u32)queuedTriangles.size();
+	queuedTriangles.push_back(setup);
+
+	for (s32 ty = miny / TILE_SIZE; ty <= (maxy - 1) / TILE_SIZE; ty++)
+	{
+		for (s32 tx = minx / TILE_SIZE; tx <= (maxx - 1) / TILE_SIZE; tx++)
+			tileBins[ty * TILES_X + tx].push_back(index);
+	}
+}
+
 
 }
@@ -18,6 +18,7 @@
 
 #include "VideoBackends/Software/OpcodeDecoder.h"
 #include "VideoBackends/Software/SWCommandProcessor.h"
+#include "VideoBackends/Software/SWStatistics.h"
 #include "VideoBackends/Software/VideoBackend.h"
 
 #include "VideoCommon/DataReader.h"
@@ -315,16 +316,23 @@ bool RunBuffer()
 
 	u32 availableBytes = writePos - readPos;
 
-	while (OpcodeDecoder::CommandRunnable(availableBytes))
+	if (OpcodeDecoder::CommandRunnable(availableBytes))
 	{
-		cpreg.status.CommandIdle = 0;
+		StartGpuTimer();
 
-		OpcodeDecoder::Run(availableBytes);
+		do
+		{
+			cpreg.status.CommandIdle = 0;
+
+			OpcodeDecoder::Run(availableBytes);
+
+			// if data was read by the opcode decoder then the video data pointer changed
+			readPos = (u32)(g_pVideoData - &commandBuffer[0]);
+			_dbg_assert_(VIDEO, writePos >= readPos);
+			availableBytes = writePos - readPos;
+		} while (OpcodeDecoder::CommandRunnable(availableBytes));
 
-		// if data was read by the opcode decoder then the video data pointer changed
-		readPos = (u32)(g_pVideoData - &commandBuffer[0]);
-		_dbg_assert_(VIDEO, writePos >= readPos);
-		availableBytes = writePos - readPos;
+		StopGpuTimer();
 	}
 
 	cpreg.status.CommandIdle = 1;
@@ -3,17 +3,21 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstdio>
 #include <string>
 
 #include "Common/CommonTypes.h"
+#include "Common/Hash.h"
 #include "Common/StringUtil.h"
 #include "Core/Core.h"
+#include "Core/HW/Memmap.h"
 #include "VideoBackends/OGL/GLInterfaceBase.h"
 #include "VideoBackends/OGL/GLUtil.h"
 #include "VideoBackends/Software/RasterFont.h"
 #include "VideoBackends/Software/SWCommandProcessor.h"
 #include "VideoBackends/Software/SWRenderer.h"
 #include "VideoBackends/Software/SWStatistics.h"
+#include "VideoBackends/Software/SWVideoConfig.h"
 #include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/OnScreenDisplay.h"
 
@@ -30,6 +34,9 @@ static volatile bool s_bScreenshot;
 static std::mutex s_criticalScreenshot;
 static std::string s_sScreenshotName;
 
+// Totals over all headless frames, in nanoseconds
+static SWStatistics::ThisFrame s_headlessTotals;
+static u32 s_headlessFrames;
 
 // Rasterfont isn't compatible with GLES
 // degasus: I think it does, but I can't test it
@@ -38,12 +45,36 @@ static RasterFont* s_pfont = nullptr;
 void SWRenderer::Init()
 {
 	s_bScreenshot = false;
+
+	memset(&s_headlessTotals, 0, sizeof(s_headlessTotals));
+	s_headlessFrames = 0;
+}
+
+static void PrintFrameTimes(const char* label, const SWStatistics::ThisFrame& times, double scale)
+{
+	// Every counter includes the ones nested below it
+	u64 efbCopy = times.efbCopyTime;
+	u64 raster = times.rasterTime;
+	u64 vertex = times.primitiveTime - std::min(times.primitiveTime, times.rasterTime);
+	u64 decode = times.gpuTime - std::min(times.gpuTime, times.primitiveTime + times.efbCopyTime);
+
+	printf("%s total %.3f decode %.3f vertex %.3f raster %.3f efbcopy %.3f ms\n", label,
+		times.gpuTime * scale, decode * scale, vertex * scale, raster * scale, efbCopy * scale);
 }
 
 void SWRenderer::Shutdown()
 {
 	delete [] s_xfbColorTexture[0];
 	delete [] s_xfbColorTexture[1];
+
+	if (g_SWVideoConfig.bHeadless)
+	{
+		if (s_headlessFrames)
+			PrintFrameTimes(StringFromFormat("average over %u frames:", s_headlessFrames).c_str(),
+				s_headlessTotals, 1e-6 / s_headlessFrames);
+		return;
+	}
+
 	glDeleteProgram(program);
 	glDeleteTextures(1, &s_RenderTarget);
 	if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGL)
@@ -92,6 +123,9 @@ void SWRenderer::Prepare()
 
 	s_currentColorTexture = 0;
 
+	if (g_SWVideoConfig.bHeadless)
+		return;
+
 	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);  // 4-byte pixel alignment
 	glGenTextures(1, &s_RenderTarget);
@@ -218,6 +252,41 @@ void SWRenderer::Swap(u32 fbWidth, u32 fbHeight)
 	Core::Callback_VideoCopiedToXFB(true); // FIXME: should this function be called FrameRendered?
 }
 
+// Called on the GPU thread instead of Swap when there is no window
+void SWRenderer::SwapHeadless(u32 xfbAddr, u32 fbWidth, u32 fbHeight)
+{
+	// Finish this frame's GPU time before spending any on the output
+	bool gpuTimerRunning = StopGpuTimer();
+
+	EfbInterface::yuv422_packed *xfb = (EfbInterface::yuv422_packed *) Memory::GetPointer(xfbAddr);
+	u64 hash = GetHash64((const u8*)xfb, fbWidth * fbHeight * sizeof(EfbInterface::yuv422_packed), 0);
+
+	if (!g_SWVideoConfig.sHeadlessDumpPath.empty())
+	{
+		UpdateColorTexture(xfb, fbWidth, fbHeight);
+		TextureToPng(GetCurrentColorTexture(), fbWidth * 4,
+			StringFromFormat("%s/frame%05u.png", g_SWVideoConfig.sHeadlessDumpPath.c_str(), swstats.frameCount),
+			fbWidth, fbHeight, false);
+	}
+
+	const SWStatistics::ThisFrame& frame = swstats.thisFrame;
+	PrintFrameTimes(StringFromFormat("frame %u hash %016llx:", swstats.frameCount, (unsigned long long)hash).c_str(),
+		frame, 1e-6);
+
+	s_headlessTotals.gpuTime += frame.gpuTime;
+	s_headlessTotals.primitiveTime += frame.primitiveTime;
+	s_headlessTotals.rasterTime += frame.rasterTime;
+	s_headlessTotals.efbCopyTime += frame.efbCopyTime;
+	s_headlessFrames++;
+
+	swstats.frameCount++;
+	swstats.ResetFrame();
+	Core::Callback_VideoCopiedToXFB(true);
+
+	if (gpuTimerRunning)
+		StartGpuTimer();
+}
+
 void SWRenderer::DrawTexture(u8 *texture, int width, int height)
 {
 	// FIXME: This should add black bars when the game has set the VI to render less than the full xfb.
@@ -25,5 +25,6 @@ namespace SWRenderer
 	void DrawTexture(u8 *texture, int width, int height);
 
 	void Swap(u32 fbWidth, u32 fbHeight);
+	void SwapHeadless(u32 xfbAddr, u32 fbWidth, u32 fbHeight);
 	void SwapBuffer();
 }
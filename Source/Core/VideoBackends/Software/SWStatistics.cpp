@@ -6,6 +6,9 @@
 
 SWStatistics swstats;
 
+static bool s_gpuTimerRunning;
+static std::chrono::steady_clock::time_point s_gpuTimerStart;
+
 SWStatistics::SWStatistics()
 {
 	frameCount = 0;
@@ -15,3 +18,21 @@ void SWStatistics::ResetFrame()
 {
 	memset(&thisFrame, 0, sizeof(ThisFrame));
 }
+
+void StartGpuTimer()
+{
+#if (STATISTICS)
+	s_gpuTimerStart = std::chrono::steady_clock::now();
+	s_gpuTimerRunning = true;
+#endif
+}
+
+bool StopGpuTimer()
+{
+	if (!s_gpuTimerRunning)
+		return false;
+
+	swstats.thisFrame.gpuTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_gpuTimerStart).count();
+	s_gpuTimerRunning = false;
+	return true;
+}
@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <chrono>
+
 #include "Common/CommonTypes.h"
 #include "VideoBackends/Software/SWVideoConfig.h"
 
@@ -25,6 +27,13 @@ struct SWStatistics
 		u32 rasterizedPixels;
 		u32 tevPixelsIn;
 		u32 tevPixelsOut;
+
+		// Nanoseconds spent on the video thread. Each counter includes the ones
+		// nested below it, so the exclusive times are differences.
+		u64 gpuTime;        // running the opcode decoder
+		u64 primitiveTime;  // loading and transforming vertices, and everything below
+		u64 rasterTime;     // drawing binned triangles: TEV and waiting for the tile workers
+		u64 efbCopyTime;    // EFB copies and clears
 	};
 
 	u32 frameCount;
@@ -36,12 +45,36 @@ struct SWStatistics
 
 extern SWStatistics swstats;
 
+// Adds the time spent in the enclosing scope to a counter
+class SWStatTimer
+{
+public:
+	SWStatTimer(u64& counter) : m_counter(counter), m_start(std::chrono::steady_clock::now()) {}
+	~SWStatTimer()
+	{
+		m_counter += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+	}
+
+private:
+	u64& m_counter;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+// Times the opcode decoder into swstats.thisFrame.gpuTime. Unlike TIMESTAT
+// it can be stopped from further down, so that a headless frame output from
+// inside the decoder is not counted as GPU time. StopGpuTimer() returns
+// whether the timer was running.
+void StartGpuTimer();
+bool StopGpuTimer();
+
 #if (STATISTICS)
 #define INCSTAT(a) (a)++;
 #define ADDSTAT(a,b) (a)+=(b);
 #define SETSTAT(a,x) (a)=(int)(x);
+#define TIMESTAT(a) SWStatTimer stat_timer(a);
 #else
 #define INCSTAT(a) ;
 #define ADDSTAT(a,b) ;
 #define SETSTAT(a,x) ;
+#define TIMESTAT(a) ;
 #endif
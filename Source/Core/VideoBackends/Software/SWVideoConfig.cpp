@@ -16,6 +16,7 @@ SWVideoConfig::SWVideoConfig()
 
 	bHwRasterizer = false;
 	bBypassXFB = false;
+	rasterizerThreads = 1;
 
 	bShowStats = false;
 
@@ -31,6 +32,8 @@ SWVideoConfig::SWVideoConfig()
 
 	drawStart = 0;
 	drawEnd = 100000;
+
+	bHeadless = false;
 }
 
 void SWVideoConfig::Load(const char* ini_file)
@@ -45,6 +48,7 @@ void SWVideoConfig::Load(const char* ini_file)
 	IniFile::Section* rendering = iniFile.GetOrCreateSection("Rendering");
 	rendering->Get("HwRasterizer", &bHwRasterizer, false);
 	rendering->Get("BypassXFB", &bBypassXFB, false);
+	rendering->Get("RasterizerThreads", &rasterizerThreads, 1);
 	rendering->Get("ZComploc", &bZComploc, true);
 	rendering->Get("ZFreeze", &bZFreeze, true);
 
@@ -75,6 +79,7 @@ void SWVideoConfig::Save(const char* ini_file)
 	IniFile::Section* rendering = iniFile.GetOrCreateSection("Rendering");
 	rendering->Set("HwRasterizer", bHwRasterizer);
 	rendering->Set("BypassXFB", bBypassXFB);
+	rendering->Set("RasterizerThreads", rasterizerThreads);
 	rendering->Set("ZComploc", bZComploc);
 	rendering->Set("ZFreeze", bZFreeze);
 
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <string>
+
 #include "Common/CommonTypes.h"
 
 #define STATISTICS 1
@@ -23,6 +25,10 @@ struct SWVideoConfig : NonCopyable
 	bool bHwRasterizer;
 	bool bBypassXFB;
 
+	// Threads shading pixels, including the video thread. 1 draws every triangle
+	// immediately, more bin them into screen tiles that are drawn in parallel.
+	u32 rasterizerThreads;
+
 	// Emulation features
 	bool bZComploc;
 	bool bZFreeze;
@@ -39,6 +45,12 @@ struct SWVideoConfig : NonCopyable
 
 	u32 drawStart;
 	u32 drawEnd;
+
+	// Set from the command line for benchmarking FIFO log replays, never saved.
+	// Renders without a window and reports a hash and timings for every XFB copy,
+	// dumping it to a PNG when a dump path is given.
+	bool bHeadless;
+	std::string sHeadlessDumpPath;
 };
 
 extern SWVideoConfig g_SWVideoConfig;
@@ -30,6 +30,8 @@
 #include "VideoBackends/Software/SWStatistics.h"
 #include "VideoBackends/Software/SWVertexLoader.h"
 #include "VideoBackends/Software/SWVideoConfig.h"
+#include "VideoBackends/Software/Tev.h"
+#include "VideoBackends/Software/TextureSampler.h"
 #include "VideoBackends/Software/VideoBackend.h"
 #include "VideoBackends/Software/XFMemLoader.h"
 
@@ -75,12 +77,21 @@ bool VideoSoftware::Initialize(void *window_handle)
 {
 	g_SWVideoConfig.Load((File::GetUserPath(D_CONFIG_IDX) + "gfx_software.ini").c_str());
 
-	InitInterface();
-	GLInterface->SetMode(GLInterfaceMode::MODE_DETECT);
-	if (!GLInterface->Create(window_handle))
+	if (g_SWVideoConfig.bHeadless)
 	{
-		INFO_LOG(VIDEO, "GLInterface::Create failed.");
-		return false;
+		// Without a window there is no OpenGL context to rasterize or present with.
+		g_SWVideoConfig.bHwRasterizer = false;
+		g_SWVideoConfig.bBypassXFB = false;
+	}
+	else
+	{
+		InitInterface();
+		GLInterface->SetMode(GLInterfaceMode::MODE_DETECT);
+		if (!GLInterface->Create(window_handle))
+		{
+			INFO_LOG(VIDEO, "GLInterface::Create failed.");
+			return false;
+		}
 	}
 
 	InitBPMemory();
@@ -113,6 +124,11 @@ void VideoSoftware::DoState(PointerWrap& p)
 	Clipper::DoState(p);
 	p.Do(xfmem);
 	p.Do(bpmem);
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		Tev::InvalidateConfig();
+		TextureSampler::InvalidateCache();
+	}
 	p.DoPOD(swstats);
 
 	// CP Memory
@@ -161,10 +177,15 @@ void VideoSoftware::EmuStateChange(EMUSTATE_CHANGE newState)
 void VideoSoftware::Shutdown()
 {
 	// TODO: should be in Video_Cleanup
-	HwRasterizer::Shutdown();
+	Rasterizer::Shutdown();
 	SWRenderer::Shutdown();
 	DebugUtil::Shutdown();
 
+	if (g_SWVideoConfig.bHeadless)
+		return;
+
+	HwRasterizer::Shutdown();
+
 	// Do our OSD callbacks
 	OSD::DoCallbacks(OSD::OSD_SHUTDOWN);
 
@@ -173,12 +194,20 @@ void VideoSoftware::Shutdown()
 
 void VideoSoftware::Video_Cleanup()
 {
-	GLInterface->ClearCurrent();
+	if (!g_SWVideoConfig.bHeadless)
+		GLInterface->ClearCurrent();
 }
 
 // This is called after Video_Initialize() from the Core
 void VideoSoftware::Video_Prepare()
 {
+	if (g_SWVideoConfig.bHeadless)
+	{
+		SWRenderer::Prepare();
+		INFO_LOG(VIDEO, "Video backend initialized without a window.");
+		return;
+	}
+
 	GLInterface->MakeCurrent();
 
 	// Init extension support.
@@ -215,6 +244,10 @@ void VideoSoftware::Video_EndField()
 	// BeginField and EndFeild, We could possibly get away with copying out the whole thing
 	// at BeginField for less lag, but for the safest emulation we run it here.
 
+	// Headless replays end their frames on the XFB copy (cf. EfbCopy::CopyEfb).
+	if (g_SWVideoConfig.bHeadless)
+		return;
+
 	if (g_bSkipCurrentFrame || s_beginFieldArgs.xfbAddr == 0)
 	{
 		swstats.frameCount++;
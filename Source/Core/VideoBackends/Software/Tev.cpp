@@ -2,13 +2,16 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <unordered_map>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Hash.h"
 #include "VideoBackends/Software/DebugUtil.h"
 #include "VideoBackends/Software/EfbInterface.h"
-#include "VideoBackends/Software/SWStatistics.h"
 #include "VideoBackends/Software/SWVideoConfig.h"
 #include "VideoBackends/Software/Tev.h"
 #include "VideoBackends/Software/TextureSampler.h"
@@ -121,6 +124,23 @@ void Tev::Init()
 	m_ScaleRShiftLUT[1] = 0;
 	m_ScaleRShiftLUT[2] = 0;
 	m_ScaleRShiftLUT[3] = 1;
+
+	ResetCounters();
+}
+
+void Tev::ResetCounters()
+{
+	PixelsIn = 0;
+	PixelsOut = 0;
+	memset(PerfCounters, 0, sizeof(PerfCounters));
+	BoundingBox[0] = BoundingBox[2] = 0xffff;
+	BoundingBox[1] = BoundingBox[3] = 0;
+}
+
+void Tev::CopyRegisters(const Tev& other)
+{
+	memcpy(Reg, other.Reg, sizeof(Reg));
+	memcpy(KonstantColors, other.KonstantColors, sizeof(KonstantColors));
 }
 
 static inline s16 Clamp255(s16 in)
@@ -133,28 +153,26 @@ static inline s16 Clamp1024(s16 in)
 	return in>1023?1023:(in<-1024?-1024:in);
 }
 
-void Tev::SetRasColor(int colorChan, int swaptable)
+void Tev::SetRasColor(int colorChan, const u8 swap[4])
 {
 	switch (colorChan)
 	{
 	case 0: // Color0
 		{
 			u8 *color = Color[0];
-			RasColor[RED_C] = color[bpmem.tevksel[swaptable].swap1];
-			RasColor[GRN_C] = color[bpmem.tevksel[swaptable].swap2];
-			swaptable++;
-			RasColor[BLU_C] = color[bpmem.tevksel[swaptable].swap1];
-			RasColor[ALP_C] = color[bpmem.tevksel[swaptable].swap2];
+			RasColor[RED_C] = color[swap[RED_C]];
+			RasColor[GRN_C] = color[swap[GRN_C]];
+			RasColor[BLU_C] = color[swap[BLU_C]];
+			RasColor[ALP_C] = color[swap[ALP_C]];
 		}
 		break;
 	case 1: // Color1
 		{
 			u8 *color = Color[1];
-			RasColor[RED_C] = color[bpmem.tevksel[swaptable].swap1];
-			RasColor[GRN_C] = color[bpmem.tevksel[swaptable].swap2];
-			swaptable++;
-			RasColor[BLU_C] = color[bpmem.tevksel[swaptable].swap1];
-			RasColor[ALP_C] = color[bpmem.tevksel[swaptable].swap2];
+			RasColor[RED_C] = color[swap[RED_C]];
+			RasColor[GRN_C] = color[swap[GRN_C]];
+			RasColor[BLU_C] = color[swap[BLU_C]];
+			RasColor[ALP_C] = color[swap[ALP_C]];
 		}
 		break;
 		case 5: // alpha bump
@@ -185,8 +203,15 @@ void Tev::SetRasColor(int colorChan, int swaptable)
 	}
 }
 
-void Tev::DrawColorRegular(TevStageCombiner::ColorCombiner &cc, const InputRegType inputs[4])
+// The combiners are specialized on the operation, scale and bias of the stage.
+// The values match m_ScaleLShiftLUT, m_ScaleRShiftLUT and m_BiasLUT.
+template <bool sub, int shift, int bias>
+void Tev::DrawColorRegular(int dest, const InputRegType inputs[4])
 {
+	const int lshift = (shift == 3) ? 0 : shift;
+	const int rshift = (shift == 3) ? 1 : 0;
+	const s16 biasValue = (bias == 1) ? 128 : (bias == 2) ? -128 : 0;
+
 	for (int i = 0; i < 3; i++)
 	{
 		const InputRegType& InputReg = inputs[BLU_C + i];
@@ -194,37 +219,38 @@ void Tev::DrawColorRegular(TevStageCombiner::ColorCombiner &cc, const InputRegTy
 		u16 c = InputReg.c + (InputReg.c >> 7);
 
 		s32 temp = InputReg.a * (256 - c) + (InputReg.b * c);
-		temp <<= m_ScaleLShiftLUT[cc.shift];
-		temp += (cc.shift == 3) ? 0 : (cc.op == 1) ? 127 : 128;
+		temp <<= lshift;
+		temp += (shift == 3) ? 0 : sub ? 127 : 128;
 		temp >>= 8;
-		temp = cc.op ? -temp : temp;
+		temp = sub ? -temp : temp;
 
-		s32 result = ((InputReg.d + m_BiasLUT[cc.bias]) << m_ScaleLShiftLUT[cc.shift]) + temp;
-		result = result >> m_ScaleRShiftLUT[cc.shift];
+		s32 result = ((InputReg.d + biasValue) << lshift) + temp;
+		result = result >> rshift;
 
-		Reg[cc.dest][BLU_C + i] = result;
+		Reg[dest][BLU_C + i] = result;
 	}
 }
 
-void Tev::DrawColorCompare(TevStageCombiner::ColorCombiner &cc, const InputRegType inputs[4])
+template <int mode>
+void Tev::DrawColorCompare(int dest, const InputRegType inputs[4])
 {
 	for (int i = BLU_C; i <= RED_C; i++)
 	{
-		switch ((cc.shift<<1)|cc.op|8)  // encoded compare mode
+		switch (mode)
 		{
 		case TEVCMP_R8_GT:
-			Reg[cc.dest][i] = inputs[i].d + ((inputs[RED_C].a > inputs[RED_C].b) ? inputs[i].c : 0);
+			Reg[dest][i] = inputs[i].d + ((inputs[RED_C].a > inputs[RED_C].b) ? inputs[i].c : 0);
 			break;
 
 		case TEVCMP_R8_EQ:
-			Reg[cc.dest][i] = inputs[i].d + ((inputs[RED_C].a == inputs[RED_C].b) ? inputs[i].c : 0);
+			Reg[dest][i] = inputs[i].d + ((inputs[RED_C].a == inputs[RED_C].b) ? inputs[i].c : 0);
 			break;
 
 		case TEVCMP_GR16_GT:
 			{
 				u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
 				u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-				Reg[cc.dest][i] = inputs[i].d + ((a > b) ? inputs[i].c : 0);
+				Reg[dest][i] = inputs[i].d + ((a > b) ? inputs[i].c : 0);
 			}
 			break;
 
@@ -232,7 +258,7 @@ void Tev::DrawColorCompare(TevStageCombiner::ColorCombiner &cc, const InputRegTy
 			{
 				u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
 				u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-				Reg[cc.dest][i] = inputs[i].d + ((a == b) ? inputs[i].c : 0);
+				Reg[dest][i] = inputs[i].d + ((a == b) ? inputs[i].c : 0);
 			}
 			break;
 
@@ -240,7 +266,7 @@ void Tev::DrawColorCompare(TevStageCombiner::ColorCombiner &cc, const InputRegTy
 			{
 				u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
 				u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-				Reg[cc.dest][i] = inputs[i].d + ((a > b) ? inputs[i].c : 0);
+				Reg[dest][i] = inputs[i].d + ((a > b) ? inputs[i].c : 0);
 			}
 			break;
 
@@ -248,55 +274,61 @@ void Tev::DrawColorCompare(TevStageCombiner::ColorCombiner &cc, const InputRegTy
 			{
 				u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
 				u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-				Reg[cc.dest][i] = inputs[i].d + ((a == b) ? inputs[i].c : 0);
+				Reg[dest][i] = inputs[i].d + ((a == b) ? inputs[i].c : 0);
 			}
 			break;
 
 		case TEVCMP_RGB8_GT:
-			Reg[cc.dest][i] = inputs[i].d + ((inputs[i].a > inputs[i].b) ? inputs[i].c : 0);
+			Reg[dest][i] = inputs[i].d + ((inputs[i].a > inputs[i].b) ? inputs[i].c : 0);
 			break;
 
 		case TEVCMP_RGB8_EQ:
-			Reg[cc.dest][i] = inputs[i].d + ((inputs[i].a == inputs[i].b) ? inputs[i].c : 0);
+			Reg[dest][i] = inputs[i].d + ((inputs[i].a == inputs[i].b) ? inputs[i].c : 0);
 			break;
 		}
 	}
 }
 
-void Tev::DrawAlphaRegular(TevStageCombiner::AlphaCombiner &ac, const InputRegType inputs[4])
+template <bool sub, int shift, int bias>
+void Tev::DrawAlphaRegular(int dest, const InputRegType inputs[4])
 {
+	const int lshift = (shift == 3) ? 0 : shift;
+	const int rshift = (shift == 3) ? 1 : 0;
+	const s16 biasValue = (bias == 1) ? 128 : (bias == 2) ? -128 : 0;
+
 	const InputRegType& InputReg = inputs[ALP_C];
 
 	u16 c = InputReg.c + (InputReg.c >> 7);
 
 	s32 temp = InputReg.a * (256 - c) + (InputReg.b * c);
-	temp <<= m_ScaleLShiftLUT[ac.shift];
-	temp += (ac.shift != 3) ? 0 : (ac.op == 1) ? 127 : 128;
-	temp = ac.op ? (-temp >> 8) : (temp >> 8);
+	temp <<= lshift;
+	temp += (shift != 3) ? 0 : sub ? 127 : 128;
+	temp = sub ? (-temp >> 8) : (temp >> 8);
 
-	s32 result = ((InputReg.d + m_BiasLUT[ac.bias]) << m_ScaleLShiftLUT[ac.shift]) + temp;
-	result = result >> m_ScaleRShiftLUT[ac.shift];
+	s32 result = ((InputReg.d + biasValue) << lshift) + temp;
+	result = result >> rshift;
 
-	Reg[ac.dest][ALP_C] = result;
+	Reg[dest][ALP_C] = result;
 }
 
-void Tev::DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4])
+template <int mode>
+void Tev::DrawAlphaCompare(int dest, const InputRegType inputs[4])
 {
-	switch ((ac.shift<<1)|ac.op|8)  // encoded compare mode
+	switch (mode)
 	{
 	case TEVCMP_R8_GT:
-		Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((inputs[RED_C].a > inputs[RED_C].b) ? inputs[ALP_C].c : 0);
+		Reg[dest][ALP_C] = inputs[ALP_C].d + ((inputs[RED_C].a > inputs[RED_C].b) ? inputs[ALP_C].c : 0);
 		break;
 
 	case TEVCMP_R8_EQ:
-		Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((inputs[RED_C].a == inputs[RED_C].b) ? inputs[ALP_C].c : 0);
+		Reg[dest][ALP_C] = inputs[ALP_C].d + ((inputs[RED_C].a == inputs[RED_C].b) ? inputs[ALP_C].c : 0);
 		break;
 
 	case TEVCMP_GR16_GT:
 		{
 			u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
 			u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-			Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((a > b) ? inputs[ALP_C].c : 0);
+			Reg[dest][ALP_C] = inputs[ALP_C].d + ((a > b) ? inputs[ALP_C].c : 0);
 		}
 		break;
 
@@ -304,7 +336,7 @@ void Tev::DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegTy
 		{
 			u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
 			u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-			Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((a == b) ? inputs[ALP_C].c : 0);
+			Reg[dest][ALP_C] = inputs[ALP_C].d + ((a == b) ? inputs[ALP_C].c : 0);
 		}
 		break;
 
@@ -312,7 +344,7 @@ void Tev::DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegTy
 		{
 			u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
 			u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-			Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((a > b) ? inputs[ALP_C].c : 0);
+			Reg[dest][ALP_C] = inputs[ALP_C].d + ((a > b) ? inputs[ALP_C].c : 0);
 		}
 		break;
 
@@ -320,16 +352,16 @@ void Tev::DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegTy
 		{
 			u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
 			u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-			Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((a == b) ? inputs[ALP_C].c : 0);
+			Reg[dest][ALP_C] = inputs[ALP_C].d + ((a == b) ? inputs[ALP_C].c : 0);
 		}
 		break;
 
 	case TEVCMP_A8_GT:
-		Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((inputs[ALP_C].a > inputs[ALP_C].b) ? inputs[ALP_C].c : 0);
+		Reg[dest][ALP_C] = inputs[ALP_C].d + ((inputs[ALP_C].a > inputs[ALP_C].b) ? inputs[ALP_C].c : 0);
 		break;
 
 	case TEVCMP_A8_EQ:
-		Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((inputs[ALP_C].a == inputs[ALP_C].b) ? inputs[ALP_C].c : 0);
+		Reg[dest][ALP_C] = inputs[ALP_C].d + ((inputs[ALP_C].a == inputs[ALP_C].b) ? inputs[ALP_C].c : 0);
 		break;
 	}
 }
@@ -366,6 +398,179 @@ static bool TevAlphaTest(int alpha)
 	return true;
 }
 
+const Tev::Config* Tev::s_config = nullptr;
+bool Tev::s_configDirty = true;
+
+static void GetSwapTable(int swaptable, u8 swap[4])
+{
+	swap[Tev::RED_C] = bpmem.tevksel[swaptable].swap1;
+	swap[Tev::GRN_C] = bpmem.tevksel[swaptable].swap2;
+	swaptable++;
+	swap[Tev::BLU_C] = bpmem.tevksel[swaptable].swap1;
+	swap[Tev::ALP_C] = bpmem.tevksel[swaptable].swap2;
+}
+
+void Tev::BuildConfig(Config& config)
+{
+#define REGULAR_COMBINERS(func, sub, shift) \
+		{ &Tev::func<sub, shift, 0>, &Tev::func<sub, shift, 1>, &Tev::func<sub, shift, 2> }
+
+	// indexed by [op][shift][bias], bias 3 selects the compare combiners
+	static const CombinerFunc s_colorRegular[2][4][3] = {
+		{ REGULAR_COMBINERS(DrawColorRegular, false, 0), REGULAR_COMBINERS(DrawColorRegular, false, 1),
+		  REGULAR_COMBINERS(DrawColorRegular, false, 2), REGULAR_COMBINERS(DrawColorRegular, false, 3) },
+		{ REGULAR_COMBINERS(DrawColorRegular, true, 0), REGULAR_COMBINERS(DrawColorRegular, true, 1),
+		  REGULAR_COMBINERS(DrawColorRegular, true, 2), REGULAR_COMBINERS(DrawColorRegular, true, 3) },
+	};
+
+	static const CombinerFunc s_alphaRegular[2][4][3] = {
+		{ REGULAR_COMBINERS(DrawAlphaRegular, false, 0), REGULAR_COMBINERS(DrawAlphaRegular, false, 1),
+		  REGULAR_COMBINERS(DrawAlphaRegular, false, 2), REGULAR_COMBINERS(DrawAlphaRegular, false, 3) },
+		{ REGULAR_COMBINERS(DrawAlphaRegular, true, 0), REGULAR_COMBINERS(DrawAlphaRegular, true, 1),
+		  REGULAR_COMBINERS(DrawAlphaRegular, true, 2), REGULAR_COMBINERS(DrawAlphaRegular, true, 3) },
+	};
+
+#undef REGULAR_COMBINERS
+
+	// indexed by the encoded compare mode minus TEVCMP_R8_GT
+	static const CombinerFunc s_colorCompare[8] = {
+		&Tev::DrawColorCompare<TEVCMP_R8_GT>, &Tev::DrawColorCompare<TEVCMP_R8_EQ>,
+		&Tev::DrawColorCompare<TEVCMP_GR16_GT>, &Tev::DrawColorCompare<TEVCMP_GR16_EQ>,
+		&Tev::DrawColorCompare<TEVCMP_BGR24_GT>, &Tev::DrawColorCompare<TEVCMP_BGR24_EQ>,
+		&Tev::DrawColorCompare<TEVCMP_RGB8_GT>, &Tev::DrawColorCompare<TEVCMP_RGB8_EQ>,
+	};
+
+	static const CombinerFunc s_alphaCompare[8] = {
+		&Tev::DrawAlphaCompare<TEVCMP_R8_GT>, &Tev::DrawAlphaCompare<TEVCMP_R8_EQ>,
+		&Tev::DrawAlphaCompare<TEVCMP_GR16_GT>, &Tev::DrawAlphaCompare<TEVCMP_GR16_EQ>,
+		&Tev::DrawAlphaCompare<TEVCMP_BGR24_GT>, &Tev::DrawAlphaCompare<TEVCMP_BGR24_EQ>,
+		&Tev::DrawAlphaCompare<TEVCMP_A8_GT>, &Tev::DrawAlphaCompare<TEVCMP_A8_EQ>,
+	};
+
+	config.texmapMask = 0;
+
+	config.numIndStages = bpmem.genMode.numindstages;
+	for (unsigned int stageNum = 0; stageNum < config.numIndStages; stageNum++)
+	{
+		IndirectStageConfig& ind = config.indStages[stageNum];
+		const TEXSCALE& texscale = bpmem.texscale[stageNum >> 1];
+		bool stageOdd = stageNum & 1;
+
+		ind.texcoord = bpmem.tevindref.getTexCoord(stageNum);
+		ind.texmap = bpmem.tevindref.getTexMap(stageNum);
+		ind.scaleS = stageOdd ? texscale.ss1 : texscale.ss0;
+		ind.scaleT = stageOdd ? texscale.ts1 : texscale.ts0;
+
+		config.texmapMask |= 1 << ind.texmap;
+	}
+
+	config.numStages = bpmem.genMode.numtevstages + 1;
+	for (unsigned int stageNum = 0; stageNum < config.numStages; stageNum++)
+	{
+		StageConfig& stage = config.stages[stageNum];
+		int stageOdd = stageNum & 1;
+		TwoTevStageOrders& order = bpmem.tevorders[stageNum >> 1];
+		TevKSel& kSel = bpmem.tevksel[stageNum >> 1];
+		const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
+		const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
+
+		if (cc.bias != 3)
+			stage.colorCombiner = s_colorRegular[cc.op][cc.shift][cc.bias];
+		else
+			stage.colorCombiner = s_colorCompare[((cc.shift << 1) | cc.op | 8) - TEVCMP_R8_GT];
+
+		if (ac.bias != 3)
+			stage.alphaCombiner = s_alphaRegular[ac.op][ac.shift][ac.bias];
+		else
+			stage.alphaCombiner = s_alphaCompare[((ac.shift << 1) | ac.op | 8) - TEVCMP_R8_GT];
+
+		stage.colorInputs[0] = cc.a;
+		stage.colorInputs[1] = cc.b;
+		stage.colorInputs[2] = cc.c;
+		stage.colorInputs[3] = cc.d;
+		stage.alphaInputs[0] = ac.a;
+		stage.alphaInputs[1] = ac.b;
+		stage.alphaInputs[2] = ac.c;
+		stage.alphaInputs[3] = ac.d;
+		stage.colorDest = cc.dest;
+		stage.alphaDest = ac.dest;
+		stage.colorClamp = cc.clamp;
+		stage.alphaClamp = ac.clamp;
+
+		stage.textureEnable = order.getEnable(stageOdd) != 0;
+		stage.texmap = order.getTexMap(stageOdd);
+		stage.texcoord = order.getTexCoord(stageOdd);
+		GetSwapTable(ac.tswap * 2, stage.texSwap);
+
+		if (stage.textureEnable)
+			config.texmapMask |= 1 << stage.texmap;
+
+		stage.colorChan = order.getColorChan(stageOdd);
+		GetSwapTable(ac.rswap * 2, stage.rasSwap);
+
+		stage.konstColor = kSel.getKC(stageOdd);
+		stage.konstAlpha = kSel.getKA(stageOdd);
+	}
+
+	// the results of the last tev stage are put onto the screen,
+	// regardless of the used destination register - TODO: Verify!
+	config.colorIndex = bpmem.combiners[bpmem.genMode.numtevstages].colorC.dest;
+	config.alphaIndex = bpmem.combiners[bpmem.genMode.numtevstages].alphaC.dest;
+
+	for (int alpha = 0; alpha < 256; alpha++)
+		config.alphaTest[alpha] = TevAlphaTest(alpha);
+}
+
+void Tev::UpdateConfig()
+{
+	if (!s_configDirty)
+		return;
+
+	// Only a handful of distinct setups are used per frame, so keep every
+	// decoded one around instead of rebuilding on each state change.
+	static std::unordered_map<u32, Config> s_configCache;
+
+	u32 key[CONFIG_KEY_SIZE];
+	u32* k = key;
+	*k++ = bpmem.genMode.hex;
+	*k++ = bpmem.texscale[0].hex;
+	*k++ = bpmem.texscale[1].hex;
+	*k++ = bpmem.tevindref.hex;
+	for (const TwoTevStageOrders& order : bpmem.tevorders)
+		*k++ = order.hex;
+	for (const TevStageCombiner& combiner : bpmem.combiners)
+	{
+		*k++ = combiner.colorC.hex;
+		*k++ = combiner.alphaC.hex;
+	}
+	for (const TevKSel& kSel : bpmem.tevksel)
+		*k++ = kSel.hex;
+	*k++ = bpmem.alpha_test.hex;
+	_assert_(k == key + CONFIG_KEY_SIZE);
+
+	u32 hash = HashFletcher((const u8*)key, sizeof(key));
+	auto it = s_configCache.find(hash);
+	if (it == s_configCache.end() || memcmp(it->second.key, key, sizeof(key)) != 0)
+	{
+		if (s_configCache.size() >= 4096)
+		{
+			s_configCache.clear();
+			it = s_configCache.end();
+		}
+
+		Config& config = (it == s_configCache.end()) ? s_configCache[hash] : it->second;
+		memcpy(config.key, key, sizeof(key));
+		BuildConfig(config);
+		s_config = &config;
+	}
+	else
+	{
+		s_config = &it->second;
+	}
+
+	s_configDirty = false;
+}
+
 static inline s32 WrapIndirectCoord(s32 coord, int wrapMode)
 {
 	switch (wrapMode)
@@ -508,22 +713,16 @@ void Tev::Draw()
 	_assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
 	_assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
 
-	INCSTAT(swstats.thisFrame.tevPixelsIn);
-
-	for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages; stageNum++)
-	{
-		int stageNum2 = stageNum >> 1;
-		int stageOdd = stageNum&1;
+	PixelsIn++;
 
-		u32 texcoordSel = bpmem.tevindref.getTexCoord(stageNum);
-		u32 texmap = bpmem.tevindref.getTexMap(stageNum);
+	const Config& config = *s_config;
 
-		const TEXSCALE& texscale = bpmem.texscale[stageNum2];
-		s32 scaleS = stageOdd ? texscale.ss1:texscale.ss0;
-		s32 scaleT = stageOdd ? texscale.ts1:texscale.ts0;
+	for (unsigned int stageNum = 0; stageNum < config.numIndStages; stageNum++)
+	{
+		const IndirectStageConfig& ind = config.indStages[stageNum];
 
-		TextureSampler::Sample(Uv[texcoordSel].s >> scaleS, Uv[texcoordSel].t >> scaleT,
-			IndirectLod[stageNum], IndirectLinear[stageNum], texmap, IndirectTex[stageNum]);
+		TextureSampler::Sample(Uv[ind.texcoord].s >> ind.scaleS, Uv[ind.texcoord].t >> ind.scaleT,
+			IndirectLod[stageNum], IndirectLinear[stageNum], ind.texmap, IndirectTex[stageNum]);
 
 #if ALLOW_TEV_DUMPS
 		if (g_SWVideoConfig.bDumpTevStages)
@@ -539,114 +738,90 @@ void Tev::Draw()
 #endif
 	}
 
-	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+	for (unsigned int stageNum = 0; stageNum < config.numStages; stageNum++)
 	{
-		int stageNum2 = stageNum >> 1;
-		int stageOdd = stageNum&1;
-		TwoTevStageOrders &order = bpmem.tevorders[stageNum2];
-		TevKSel &kSel = bpmem.tevksel[stageNum2];
-
-		// stage combiners
-		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
-		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
+		const StageConfig& stage = config.stages[stageNum];
 
-		int texcoordSel = order.getTexCoord(stageOdd);
-		int texmap = order.getTexMap(stageOdd);
-
-		Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
+		Indirect(stageNum, Uv[stage.texcoord].s, Uv[stage.texcoord].t);
 
 		// sample texture
-		if (order.getEnable(stageOdd))
+		if (stage.textureEnable)
 		{
 			// RGBA
 			u8 texel[4];
 
-			TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum], texmap, texel);
+			TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum], stage.texmap, texel);
 
 #if ALLOW_TEV_DUMPS
 			if (g_SWVideoConfig.bDumpTevTextureFetches)
 				DebugUtil::DrawTempBuffer(texel, DIRECT_TFETCH + stageNum);
 #endif
 
-			int swaptable = ac.tswap * 2;
-
-			TexColor[RED_C] = texel[bpmem.tevksel[swaptable].swap1];
-			TexColor[GRN_C] = texel[bpmem.tevksel[swaptable].swap2];
-			swaptable++;
-			TexColor[BLU_C] = texel[bpmem.tevksel[swaptable].swap1];
-			TexColor[ALP_C] = texel[bpmem.tevksel[swaptable].swap2];
+			TexColor[RED_C] = texel[stage.texSwap[RED_C]];
+			TexColor[GRN_C] = texel[stage.texSwap[GRN_C]];
+			TexColor[BLU_C] = texel[stage.texSwap[BLU_C]];
+			TexColor[ALP_C] = texel[stage.texSwap[ALP_C]];
 		}
 
 		// set konst for this stage
-		int kc = kSel.getKC(stageOdd);
-		int ka = kSel.getKA(stageOdd);
-		StageKonst[RED_C] = *(m_KonstLUT[kc][RED_C]);
-		StageKonst[GRN_C] = *(m_KonstLUT[kc][GRN_C]);
-		StageKonst[BLU_C] = *(m_KonstLUT[kc][BLU_C]);
-		StageKonst[ALP_C] = *(m_KonstLUT[ka][ALP_C]);
+		StageKonst[RED_C] = *(m_KonstLUT[stage.konstColor][RED_C]);
+		StageKonst[GRN_C] = *(m_KonstLUT[stage.konstColor][GRN_C]);
+		StageKonst[BLU_C] = *(m_KonstLUT[stage.konstColor][BLU_C]);
+		StageKonst[ALP_C] = *(m_KonstLUT[stage.konstAlpha][ALP_C]);
 
 		// set color
-		SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
+		SetRasColor(stage.colorChan, stage.rasSwap);
 
 		// combine inputs
 		InputRegType inputs[4];
 		for (int i = 0; i < 3; i++)
 		{
-			inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
-			inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
-			inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
-			inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
+			inputs[BLU_C + i].a = *m_ColorInputLUT[stage.colorInputs[0]][i];
+			inputs[BLU_C + i].b = *m_ColorInputLUT[stage.colorInputs[1]][i];
+			inputs[BLU_C + i].c = *m_ColorInputLUT[stage.colorInputs[2]][i];
+			inputs[BLU_C + i].d = *m_ColorInputLUT[stage.colorInputs[3]][i];
 		}
-		inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
-		inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
-		inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
-		inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
+		inputs[ALP_C].a = *m_AlphaInputLUT[stage.alphaInputs[0]];
+		inputs[ALP_C].b = *m_AlphaInputLUT[stage.alphaInputs[1]];
+		inputs[ALP_C].c = *m_AlphaInputLUT[stage.alphaInputs[2]];
+		inputs[ALP_C].d = *m_AlphaInputLUT[stage.alphaInputs[3]];
 
-		if (cc.bias != 3)
-			DrawColorRegular(cc, inputs);
-		else
-			DrawColorCompare(cc, inputs);
+		(this->*stage.colorCombiner)(stage.colorDest, inputs);
 
-		if (cc.clamp)
+		s16* colorDest = Reg[stage.colorDest];
+		if (stage.colorClamp)
 		{
-			Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
+			colorDest[RED_C] = Clamp255(colorDest[RED_C]);
+			colorDest[GRN_C] = Clamp255(colorDest[GRN_C]);
+			colorDest[BLU_C] = Clamp255(colorDest[BLU_C]);
 		}
 		else
 		{
-			Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
+			colorDest[RED_C] = Clamp1024(colorDest[RED_C]);
+			colorDest[GRN_C] = Clamp1024(colorDest[GRN_C]);
+			colorDest[BLU_C] = Clamp1024(colorDest[BLU_C]);
 		}
 
-		if (ac.bias != 3)
-			DrawAlphaRegular(ac, inputs);
-		else
-			DrawAlphaCompare(ac, inputs);
+		(this->*stage.alphaCombiner)(stage.alphaDest, inputs);
 
-		if (ac.clamp)
-			Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
+		if (stage.alphaClamp)
+			Reg[stage.alphaDest][ALP_C] = Clamp255(Reg[stage.alphaDest][ALP_C]);
 		else
-			Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+			Reg[stage.alphaDest][ALP_C] = Clamp1024(Reg[stage.alphaDest][ALP_C]);
 
 #if ALLOW_TEV_DUMPS
 		if (g_SWVideoConfig.bDumpTevStages)
 		{
-			u8 stage[4] = {(u8)Reg[0][RED_C], (u8)Reg[0][GRN_C], (u8)Reg[0][BLU_C], (u8)Reg[0][ALP_C]};
-			DebugUtil::DrawTempBuffer(stage, DIRECT + stageNum);
+			u8 result[4] = {(u8)Reg[0][RED_C], (u8)Reg[0][GRN_C], (u8)Reg[0][BLU_C], (u8)Reg[0][ALP_C]};
+			DebugUtil::DrawTempBuffer(result, DIRECT + stageNum);
 		}
 #endif
 	}
 
 	// convert to 8 bits per component
-	// the results of the last tev stage are put onto the screen,
-	// regardless of the used destination register - TODO: Verify!
-	u32 color_index = bpmem.combiners[bpmem.genMode.numtevstages].colorC.dest;
-	u32 alpha_index = bpmem.combiners[bpmem.genMode.numtevstages].alphaC.dest;
-	u8 output[4] = {(u8)Reg[alpha_index][ALP_C], (u8)Reg[color_index][BLU_C], (u8)Reg[color_index][GRN_C], (u8)Reg[color_index][RED_C]};
+	u8 output[4] = {(u8)Reg[config.alphaIndex][ALP_C], (u8)Reg[config.colorIndex][BLU_C], (u8)Reg[config.colorIndex][GRN_C], (u8)Reg[config.colorIndex][RED_C]};
 
-	if (!TevAlphaTest(output[ALP_C]))
+	if (!config.alphaTest[output[ALP_C]])
 		return;
 
 	// z texture
@@ -757,12 +932,12 @@ void Tev::Draw()
 	if (late_ztest && bpmem.zmode.testenable)
 	{
 		// TODO: Check against hw if these values get incremented even if depth testing is disabled
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT);
+		PerfCounters[PQ_ZCOMP_INPUT]++;
 
 		if (!EfbInterface::ZCompare(Position[0], Position[1], Position[2]))
 			return;
 
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT);
+		PerfCounters[PQ_ZCOMP_OUTPUT]++;
 	}
 
 #if ALLOW_TEV_DUMPS
@@ -785,10 +960,18 @@ void Tev::Draw()
 	}
 #endif
 
-	INCSTAT(swstats.thisFrame.tevPixelsOut);
-	EfbInterface::IncPerfCounterQuadCount(PQ_BLEND_INPUT);
+	PixelsOut++;
+	PerfCounters[PQ_BLEND_INPUT]++;
 
 	EfbInterface::BlendTev(Position[0], Position[1], output);
+
+	// branchless bounding box update
+	u16 x = (u16)Position[0];
+	u16 y = (u16)Position[1];
+	BoundingBox[0] = std::min(x, BoundingBox[0]);
+	BoundingBox[1] = std::max(x, BoundingBox[1]);
+	BoundingBox[2] = std::min(y, BoundingBox[2]);
+	BoundingBox[3] = std::max(y, BoundingBox[3]);
 }
 
 void Tev::SetRegColor(int reg, int comp, bool konst, s16 color)
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "VideoBackends/Software/BPMemLoader.h"
+#include "VideoCommon/PerfQueryBase.h"
 
 class PointerWrap;
 
@@ -59,12 +60,76 @@ class Tev
 		INDIRECT = 32
 	};
 
-	void SetRasColor(int colorChan, int swaptable);
+	typedef void (Tev::*CombinerFunc)(int dest, const InputRegType inputs[4]);
 
-	void DrawColorRegular(TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4]);
-	void DrawColorCompare(TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4]);
-	void DrawAlphaRegular(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
-	void DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
+	// Per-stage state decoded from bpmem, so that Draw() doesn't have to
+	// pick apart the registers for every pixel.
+	struct StageConfig
+	{
+		CombinerFunc colorCombiner;
+		CombinerFunc alphaCombiner;
+		u8 colorInputs[4]; // a, b, c, d
+		u8 alphaInputs[4];
+		u8 colorDest;
+		u8 alphaDest;
+		bool colorClamp;
+		bool alphaClamp;
+
+		bool textureEnable;
+		u8 texmap;
+		u8 texcoord;
+		u8 texSwap[4]; // source component for each of ALP_C..RED_C
+
+		u8 colorChan;
+		u8 rasSwap[4];
+
+		u8 konstColor;
+		u8 konstAlpha;
+	};
+
+	struct IndirectStageConfig
+	{
+		u8 texcoord;
+		u8 texmap;
+		u8 scaleS;
+		u8 scaleT;
+	};
+
+	// bpmem words that make up a TEV configuration, see UpdateConfig()
+	enum { CONFIG_KEY_SIZE = 53 };
+
+	struct Config
+	{
+		u32 key[CONFIG_KEY_SIZE];
+
+		u32 numIndStages;
+		IndirectStageConfig indStages[4];
+
+		u32 numStages;
+		StageConfig stages[16];
+
+		u8 colorIndex;
+		u8 alphaIndex;
+		bool alphaTest[256];
+
+		u8 texmapMask; // texmaps sampled by the direct and indirect stages
+	};
+
+	static const Config* s_config;
+	static bool s_configDirty;
+
+	static void BuildConfig(Config& config);
+
+	void SetRasColor(int colorChan, const u8 swap[4]);
+
+	template <bool sub, int shift, int bias>
+	void DrawColorRegular(int dest, const InputRegType inputs[4]);
+	template <int mode>
+	void DrawColorCompare(int dest, const InputRegType inputs[4]);
+	template <bool sub, int shift, int bias>
+	void DrawAlphaRegular(int dest, const InputRegType inputs[4]);
+	template <int mode>
+	void DrawAlphaCompare(int dest, const InputRegType inputs[4]);
 
 	void Indirect(unsigned int stageNum, s32 s, s32 t);
 
@@ -77,6 +142,15 @@ public:
 	s32 TextureLod[16];
 	bool TextureLinear[16];
 
+	// Pixel counts since the last ResetCounters(). Each rasterizer thread has
+	// its own Tev, the rasterizer adds these to the global counters.
+	u32 PixelsIn;
+	u32 PixelsOut;
+	u32 PerfCounters[PQ_NUM_MEMBERS];
+	// Left, right, top and bottom of the pixels blended since then, merged
+	// into PixelEngine::bbox the same way. Left is above right while empty.
+	u16 BoundingBox[4];
+
 	enum
 	{
 		ALP_C,
@@ -89,6 +163,16 @@ public:
 
 	void Draw();
 
+	void ResetCounters();
+	void CopyRegisters(const Tev& other);
+
+	// Draw() uses a decoded copy of the TEV setup, cached per configuration.
+	// UpdateConfig() must run on the video thread before drawing whenever
+	// InvalidateConfig() has been called since the last draw.
+	static void UpdateConfig();
+	static void InvalidateConfig() { s_configDirty = true; }
+	static u32 GetTexmapMask() { return s_config->texmapMask; }
+
 	void SetRegColor(int reg, int comp, bool konst, s16 color);
 
 	void DoState(PointerWrap &p);
@@ -4,7 +4,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <vector>
 
+#include "Common/Hash.h"
 #include "Core/HW/Memmap.h"
 #include "VideoBackends/Software/BPMemLoader.h"
 #include "VideoBackends/Software/TextureSampler.h"
@@ -54,59 +57,22 @@ static inline void AddTexel(u8 *inTexel, u32 *outTexel, u32 fract)
 	outTexel[3] += inTexel[3] * fract;
 }
 
-void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8 *sample)
+// Source data of one mip level of a texmap
+struct MipSource
 {
-	int baseMip = 0;
-	bool mipLinear = false;
-
-#if (ALLOW_MIPMAP)
-	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
-	TexMode0& tm0 = texUnit.texMode0[texmap & 3];
-
-	s32 lodFract = lod & 0xf;
-
-	if (lod > 0 && tm0.min_filter & 3)
-	{
-		// use mipmap
-		baseMip = lod >> 4;
-		mipLinear = (lodFract && tm0.min_filter & 2);
-
-		// if using nearest mip filter and lodFract >= 0.5 round up to next mip
-		baseMip += (lodFract >> 3) & (tm0.min_filter & 1);
-	}
-
-	if (mipLinear)
-	{
-		u8 sampledTex[4];
-		u32 texel[4];
-
-		SampleMip(s, t, baseMip, linear, texmap, sampledTex);
-		SetTexel(sampledTex, texel, (16 - lodFract));
-
-		SampleMip(s, t, baseMip + 1, linear, texmap, sampledTex);
-		AddTexel(sampledTex, texel, lodFract);
-
-		sample[0] = (u8)(texel[0] >> 4);
-		sample[1] = (u8)(texel[1] >> 4);
-		sample[2] = (u8)(texel[2] >> 4);
-		sample[3] = (u8)(texel[3] >> 4);
-	}
-	else
-#endif
-	{
-		SampleMip(s, t, baseMip, linear, texmap, sample);
-	}
-}
-
-void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
+	const u8 *src;
+	const u8 *srcOdd; // only used for RGBA8 textures preloaded into TMEM
+	int width; // highest texel index, not the texel count
+	int height;
+	u32 size; // raw size of this level in bytes
+};
+
+static void GetMipSource(u8 texmap, s32 mip, MipSource &source)
 {
 	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
 	u8 subTexmap = texmap & 3;
 
-	TexMode0& tm0 = texUnit.texMode0[subTexmap];
 	TexImage0& ti0 = texUnit.texImage0[subTexmap];
-	TexTLUT& texTlut = texUnit.texTlut[subTexmap];
-	TlutFormat tlutfmt = (TlutFormat) texTlut.tlut_format;
 
 	u8 *imageSrc, *imageSrcOdd = nullptr;
 	if (texUnit.texImage1[subTexmap].image_type)
@@ -121,41 +87,45 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		imageSrc = Memory::GetPointer(imageBase);
 	}
 
-	int imageWidth = ti0.width;
-	int imageHeight = ti0.height;
+	int fmtWidth = TexDecoder_GetBlockWidthInTexels(ti0.format);
+	int fmtHeight = TexDecoder_GetBlockHeightInTexels(ti0.format);
+	int fmtDepth = TexDecoder_GetTexelSizeInNibbles(ti0.format);
 
-	int tlutAddress = texTlut.tmem_offset << 9;
-	const u8* tlut = &texMem[tlutAddress];
-
-	// reduce sample location and texture size to mip level
 	// move texture pointer to mip location
-	if (mip)
-	{
-		int mipWidth = imageWidth + 1;
-		int mipHeight = imageHeight + 1;
-
-		int fmtWidth = TexDecoder_GetBlockWidthInTexels(ti0.format);
-		int fmtHeight = TexDecoder_GetBlockHeightInTexels(ti0.format);
-		int fmtDepth = TexDecoder_GetTexelSizeInNibbles(ti0.format);
+	int mipWidth = ti0.width + 1;
+	int mipHeight = ti0.height + 1;
 
-		imageWidth >>= mip;
-		imageHeight >>= mip;
-		s >>= mip;
-		t >>= mip;
-
-		while (mip)
-		{
-			mipWidth = std::max(mipWidth, fmtWidth);
-			mipHeight = std::max(mipHeight, fmtHeight);
-			u32 size = (mipWidth * mipHeight * fmtDepth) >> 1;
+	for (s32 i = 0; i < mip; i++)
+	{
+		mipWidth = std::max(mipWidth, fmtWidth);
+		mipHeight = std::max(mipHeight, fmtHeight);
+		u32 size = (mipWidth * mipHeight * fmtDepth) >> 1;
 
+		if (imageSrc)
 			imageSrc += size;
-			mipWidth >>= 1;
-			mipHeight >>= 1;
-			mip--;
-		}
+		mipWidth >>= 1;
+		mipHeight >>= 1;
 	}
 
+	source.src = imageSrc;
+	source.srcOdd = imageSrcOdd;
+	source.width = ti0.width >> mip;
+	source.height = ti0.height >> mip;
+	source.size = (std::max(mipWidth, fmtWidth) * std::max(mipHeight, fmtHeight) * fmtDepth) >> 1;
+}
+
+static inline void DecodeTexel(u8 *dst, const MipSource &source, int s, int t, int format, const u8 *tlut, TlutFormat tlutfmt)
+{
+	if (!source.srcOdd)
+		TexDecoder_DecodeTexel(dst, source.src, s, t, source.width, format, tlut, tlutfmt);
+	else
+		TexDecoder_DecodeTexelRGBA8FromTmem(dst, source.src, source.srcOdd, s, t, source.width);
+}
+
+// Point or bilinear filtering of one mip level, fetch(dst, s, t) reads a single texel.
+template <typename FetchTexel>
+static inline void FilterMip(s32 s, s32 t, bool linear, const TexMode0& tm0, int imageWidth, int imageHeight, const FetchTexel& fetch, u8 *sample)
+{
 	if (linear)
 	{
 		// offset linear sampling
@@ -181,34 +151,17 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		WrapCoord(imageSPlus1, tm0.wrap_s, imageWidth);
 		WrapCoord(imageTPlus1, tm0.wrap_t, imageHeight);
 
-		if (!(ti0.format == GX_TF_RGBA8 && texUnit.texImage1[subTexmap].image_type))
-		{
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageT, imageWidth, ti0.format, tlut, tlutfmt);
-			SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
+		fetch(sampledTex, imageS, imageT);
+		SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
 
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageT, imageWidth, ti0.format, tlut, tlutfmt);
-			AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
+		fetch(sampledTex, imageSPlus1, imageT);
+		AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
 
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageTPlus1, imageWidth, ti0.format, tlut, tlutfmt);
-			AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
+		fetch(sampledTex, imageS, imageTPlus1);
+		AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
 
-			TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageTPlus1, imageWidth, ti0.format, tlut, tlutfmt);
-			AddTexel(sampledTex, texel, (fractS) * (fractT));
-		}
-		else
-		{
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageT, imageWidth);
-			SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1, imageT, imageWidth);
-			AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageTPlus1, imageWidth);
-			AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
-
-			TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1, imageTPlus1, imageWidth);
-			AddTexel(sampledTex, texel, (fractS) * (fractT));
-		}
+		fetch(sampledTex, imageSPlus1, imageTPlus1);
+		AddTexel(sampledTex, texel, (fractS) * (fractT));
 
 		sample[0] = (u8)(texel[0] >> 14);
 		sample[1] = (u8)(texel[1] >> 14);
@@ -225,11 +178,266 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
 		WrapCoord(imageS, tm0.wrap_s, imageWidth);
 		WrapCoord(imageT, tm0.wrap_t, imageHeight);
 
-		if (!(ti0.format == GX_TF_RGBA8 && texUnit.texImage1[subTexmap].image_type))
-			TexDecoder_DecodeTexel(sample, imageSrc, imageS, imageT, imageWidth, ti0.format, tlut, tlutfmt);
-		else
-			TexDecoder_DecodeTexelRGBA8FromTmem(sample, imageSrc, imageSrcOdd, imageS, imageT, imageWidth);
+		fetch(sample, imageS, imageT);
+	}
+}
+
+// Decoded texture cache
+//
+// Decoding a texel from its GX format is by far the most expensive part of
+// sampling, and bilinear filtering and mip blending do it up to eight times per
+// sample. So the mip levels of every texmap in use are decoded to RGBA8 once and
+// then sampled by plain indexing. Entries are keyed on the texmap registers and
+// a hash of the texture and TLUT data, which is rechecked once per primitive,
+// so TMEM and TLUT loads, EFB copies and CPU writes are all picked up.
+
+enum
+{
+	MAX_CACHED_LEVELS = 11, // 1024x1024 down to 1x1
+	CACHE_KEY_SIZE = 7,
+};
+
+struct CachedLevel
+{
+	int width; // highest texel index, as in MipSource
+	int height;
+	u32 offset;
+};
+
+struct CacheEntry
+{
+	u32 key[CACHE_KEY_SIZE];
+	u64 hash;
+	bool validated;
+	int numLevels;
+	CachedLevel levels[MAX_CACHED_LEVELS];
+	std::vector<u32> texels;
+};
+
+static CacheEntry s_cache[8];
+
+void InvalidateCache()
+{
+	for (CacheEntry& entry : s_cache)
+		entry.validated = false;
+}
+
+// The registers that select what a texmap's cached levels contain
+static void GetCacheKey(u8 texmap, u32 *key)
+{
+	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
+	u8 subTexmap = texmap & 3;
+
+	key[0] = texUnit.texImage0[subTexmap].hex;
+	key[1] = texUnit.texImage1[subTexmap].hex;
+	key[2] = texUnit.texImage2[subTexmap].hex;
+	key[3] = texUnit.texImage3[subTexmap].hex;
+	key[4] = texUnit.texTlut[subTexmap].hex;
+	key[5] = texUnit.texMode1[subTexmap].hex;
+	key[6] = texUnit.texMode0[subTexmap].min_filter & 3;
+}
+
+static void UpdateCacheEntry(u8 texmap)
+{
+	CacheEntry& entry = s_cache[texmap];
+
+	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
+	u8 subTexmap = texmap & 3;
+	TexMode0& tm0 = texUnit.texMode0[subTexmap];
+	TexMode1& tm1 = texUnit.texMode1[subTexmap];
+	TexImage0& ti0 = texUnit.texImage0[subTexmap];
+	TexTLUT& texTlut = texUnit.texTlut[subTexmap];
+
+	u32 key[CACHE_KEY_SIZE];
+	GetCacheKey(texmap, key);
+
+	// Sample() never goes further than one level beyond max_lod
+	int numLevels = 1;
+	if (tm0.min_filter & 3)
+	{
+		int maxSize = std::max(ti0.width, ti0.height);
+		int chainLevels = 1;
+		while (maxSize >>= 1)
+			chainLevels++;
+
+		numLevels = std::min(std::min((tm1.max_lod >> 4) + 2, chainLevels), (int)MAX_CACHED_LEVELS);
 	}
+
+	MipSource lastLevel;
+	GetMipSource(texmap, numLevels - 1, lastLevel);
+
+	MipSource source;
+	GetMipSource(texmap, 0, source);
+	if (!source.src)
+	{
+		// invalid address, leave it to SampleMip
+		memcpy(entry.key, key, sizeof(key));
+		entry.numLevels = 0;
+		entry.validated = true;
+		return;
+	}
+
+	// hash all cached levels, they are stored back to back
+	u32 totalSize = (u32)(lastLevel.src - source.src) + lastLevel.size;
+	if (source.src >= texMem && source.src < texMem + TMEM_SIZE)
+		totalSize = std::min(totalSize, (u32)(texMem + TMEM_SIZE - source.src));
+
+	u64 hash = GetHash64(source.src, totalSize, 0);
+	if (source.srcOdd)
+		hash ^= GetHash64(source.srcOdd, std::min(source.size, (u32)(texMem + TMEM_SIZE - source.srcOdd)), 0) * 3;
+
+	const u8* tlut = &texMem[texTlut.tmem_offset << 9];
+	int paletteSize = TexDecoder_GetPaletteSize(ti0.format);
+	if (paletteSize)
+		hash ^= GetHash64(tlut, std::min(paletteSize, (int)(texMem + TMEM_SIZE - tlut)), 0) * 5;
+
+	if (entry.numLevels == numLevels && entry.hash == hash && memcmp(entry.key, key, sizeof(key)) == 0)
+	{
+		entry.validated = true;
+		return;
+	}
+
+	TlutFormat tlutfmt = (TlutFormat) texTlut.tlut_format;
+
+	u32 offset = 0;
+	for (int mip = 0; mip < numLevels; mip++)
+	{
+		GetMipSource(texmap, mip, source);
+		entry.levels[mip].width = source.width;
+		entry.levels[mip].height = source.height;
+		entry.levels[mip].offset = offset;
+		offset += (source.width + 1) * (source.height + 1);
+	}
+	entry.texels.resize(offset);
+
+	for (int mip = 0; mip < numLevels; mip++)
+	{
+		GetMipSource(texmap, mip, source);
+		u32 *dst = &entry.texels[entry.levels[mip].offset];
+
+		for (int t = 0; t <= source.height; t++)
+		{
+			for (int s = 0; s <= source.width; s++)
+			{
+				u8 texel[4];
+				DecodeTexel(texel, source, s, t, ti0.format, tlut, tlutfmt);
+				memcpy(dst++, texel, sizeof(u32));
+			}
+		}
+	}
+
+	memcpy(entry.key, key, sizeof(key));
+	entry.hash = hash;
+	entry.numLevels = numLevels;
+	entry.validated = true;
+}
+
+void UpdateCache(u32 texmapMask)
+{
+	for (u8 texmap = 0; texmap < 8; texmap++)
+	{
+		if (!(texmapMask & (1 << texmap)))
+			continue;
+
+		// The data is only rehashed after InvalidateCache(), a texmap that
+		// just points somewhere else is caught by its registers.
+		CacheEntry& entry = s_cache[texmap];
+		if (entry.validated)
+		{
+			u32 key[CACHE_KEY_SIZE];
+			GetCacheKey(texmap, key);
+			if (memcmp(entry.key, key, sizeof(key)) == 0)
+				continue;
+		}
+
+		UpdateCacheEntry(texmap);
+	}
+}
+
+static void SampleLevel(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
+{
+	const CacheEntry& entry = s_cache[texmap];
+	if (!entry.validated || mip >= entry.numLevels)
+	{
+		SampleMip(s, t, mip, linear, texmap, sample);
+		return;
+	}
+
+	const CachedLevel& level = entry.levels[mip];
+	const u32 *texels = &entry.texels[level.offset];
+	int stride = level.width + 1;
+
+	FilterMip(s >> mip, t >> mip, linear, bpmem.tex[(texmap >> 2) & 1].texMode0[texmap & 3], level.width, level.height,
+		[texels, stride](u8 *dst, int imageS, int imageT) {
+			memcpy(dst, &texels[imageT * stride + imageS], sizeof(u32));
+		}, sample);
+}
+
+void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8 *sample)
+{
+	int baseMip = 0;
+	bool mipLinear = false;
+
+#if (ALLOW_MIPMAP)
+	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
+	TexMode0& tm0 = texUnit.texMode0[texmap & 3];
+
+	s32 lodFract = lod & 0xf;
+
+	if (lod > 0 && tm0.min_filter & 3)
+	{
+		// use mipmap
+		baseMip = lod >> 4;
+		mipLinear = (lodFract && tm0.min_filter & 2);
+
+		// if using nearest mip filter and lodFract >= 0.5 round up to next mip
+		baseMip += (lodFract >> 3) & (tm0.min_filter & 1);
+	}
+
+	if (mipLinear)
+	{
+		u8 sampledTex[4];
+		u32 texel[4];
+
+		SampleLevel(s, t, baseMip, linear, texmap, sampledTex);
+		SetTexel(sampledTex, texel, (16 - lodFract));
+
+		SampleLevel(s, t, baseMip + 1, linear, texmap, sampledTex);
+		AddTexel(sampledTex, texel, lodFract);
+
+		sample[0] = (u8)(texel[0] >> 4);
+		sample[1] = (u8)(texel[1] >> 4);
+		sample[2] = (u8)(texel[2] >> 4);
+		sample[3] = (u8)(texel[3] >> 4);
+	}
+	else
+#endif
+	{
+		SampleLevel(s, t, baseMip, linear, texmap, sample);
+	}
+}
+
+void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample)
+{
+	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
+	u8 subTexmap = texmap & 3;
+
+	TexMode0& tm0 = texUnit.texMode0[subTexmap];
+	TexImage0& ti0 = texUnit.texImage0[subTexmap];
+	TexTLUT& texTlut = texUnit.texTlut[subTexmap];
+	TlutFormat tlutfmt = (TlutFormat) texTlut.tlut_format;
+
+	int tlutAddress = texTlut.tmem_offset << 9;
+	const u8* tlut = &texMem[tlutAddress];
+
+	// reduce sample location and texture size to mip level
+	MipSource source;
+	GetMipSource(texmap, mip, source);
+
+	FilterMip(s >> mip, t >> mip, linear, tm0, source.width, source.height,
+		[&](u8 *dst, int imageS, int imageT) {
+			DecodeTexel(dst, source, imageS, imageT, ti0.format, tlut, tlutfmt);
+		}, sample);
 }
 
 }
@@ -10,8 +10,17 @@ namespace TextureSampler
 {
 	void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8 *sample);
 
+	// Decodes the mip level directly from the texture data, bypassing the cache
 	void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8 *sample);
 
+	// Marks all cached textures for revalidation, their data might have changed.
+	// Called for TMEM and TLUT loads, texture cache invalidation and EFB copies.
+	void InvalidateCache();
+
+	// Makes sure the decoded textures for the texmaps in the mask are up to date.
+	// Must run on the video thread before any of those texmaps are sampled.
+	void UpdateCache(u32 texmapMask);
+
 	enum
 	{
 		RED_SMP,
@@ -208,6 +208,17 @@ bool AVIDump::SetVideoFormat()
 
 #else
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/Thread.h"
+#include "VideoCommon/Statistics.h"
+
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
@@ -230,6 +241,29 @@ static int s_width;
 static int s_height;
 static int s_size;
 
+// Frames are copied into a fixed pool of buffers on the video thread and
+// converted and encoded in order on the encoder thread. When the pool runs
+// out, AddFrame either waits for the encoder or drops the frame.
+enum { FRAME_POOL_SIZE = 8 };
+
+struct QueuedFrame
+{
+	std::vector<u8> data;
+	int width;
+	int height;
+};
+
+static QueuedFrame s_frame_pool[FRAME_POOL_SIZE];
+static std::deque<QueuedFrame*> s_free_frames;
+static std::deque<QueuedFrame*> s_queued_frames;
+static std::mutex s_queue_mutex;
+static std::condition_variable s_frame_queued;
+static std::condition_variable s_frame_freed;
+static std::thread s_encoder_thread;
+static bool s_stop_encoder;
+static int s_frames_dropped;
+static float s_encode_time_ms;
+
 static void InitAVCodec()
 {
 	static bool first_run = true;
@@ -240,6 +274,8 @@ static void InitAVCodec()
 	}
 }
 
+static void EncoderThread();
+
 bool AVIDump::Start(int w, int h)
 {
 	s_width = w;
@@ -248,8 +284,21 @@ bool AVIDump::Start(int w, int h)
 	InitAVCodec();
 	bool success = CreateFile();
 	if (!success)
+	{
 		CloseFile();
-	return success;
+		return false;
+	}
+
+	s_free_frames.clear();
+	s_queued_frames.clear();
+	for (QueuedFrame& frame : s_frame_pool)
+		s_free_frames.push_back(&frame);
+	s_stop_encoder = false;
+	s_frames_dropped = 0;
+	s_encode_time_ms = 0.0f;
+
+	s_encoder_thread = std::thread(EncoderThread);
+	return true;
 }
 
 bool AVIDump::CreateFile()
@@ -276,6 +325,8 @@ bool AVIDump::CreateFile()
 	s_stream->codec->time_base = (AVRational){1, static_cast<int>(VideoInterface::TargetRefreshRate)};
 	s_stream->codec->gop_size = 12;
 	s_stream->codec->pix_fmt = g_Config.bUseFFV1 ? AV_PIX_FMT_BGRA : AV_PIX_FMT_YUV420P;
+	// Let the codec spread the work over the spare cores
+	s_stream->codec->thread_count = std::max(1u, std::thread::hardware_concurrency());
 
 	if (!(codec = avcodec_find_encoder(s_stream->codec->codec_id)) ||
 	    (avcodec_open2(s_stream->codec, codec, nullptr) < 0))
@@ -318,19 +369,43 @@ static void PreparePacket(AVPacket* pkt)
 	pkt->stream_index = s_stream->index;
 }
 
-void AVIDump::AddFrame(const u8* data, int width, int height)
+// Encodes a frame and writes out whatever the codec has finished. Passing
+// nullptr flushes the frames the codec is still holding on to.
+static void EncodeFrame(AVFrame* frame)
+{
+	AVPacket pkt;
+	PreparePacket(&pkt);
+	int got_packet;
+	int error = avcodec_encode_video2(s_stream->codec, &pkt, frame, &got_packet);
+	while (!error && got_packet)
+	{
+		// Write the compressed frame in the media file.
+		av_interleaved_write_frame(s_format_context, &pkt);
+
+		if (frame)
+			break;
+
+		// Handle delayed frames.
+		PreparePacket(&pkt);
+		error = avcodec_encode_video2(s_stream->codec, &pkt, nullptr, &got_packet);
+	}
+	if (error)
+		ERROR_LOG(VIDEO, "Error while encoding video: %d", error);
+}
+
+static void ConvertAndEncode(const QueuedFrame& queued)
 {
-	avpicture_fill((AVPicture*)s_src_frame, const_cast<u8*>(data), AV_PIX_FMT_BGR24, width, height);
+	avpicture_fill((AVPicture*)s_src_frame, const_cast<u8*>(queued.data.data()), AV_PIX_FMT_BGR24, queued.width, queued.height);
 
 	// Convert image from BGR24 to desired pixel format, and scale to initial
 	// width and height
 	if ((s_sws_context = sws_getCachedContext(s_sws_context,
-	                                          width, height, AV_PIX_FMT_BGR24,
+	                                          queued.width, queued.height, AV_PIX_FMT_BGR24,
 	                                          s_width, s_height, s_stream->codec->pix_fmt,
 	                                          SWS_BICUBIC, nullptr, nullptr, nullptr)))
 	{
 		sws_scale(s_sws_context, s_src_frame->data, s_src_frame->linesize, 0,
-		          height, s_scaled_frame->data, s_scaled_frame->linesize);
+		          queued.height, s_scaled_frame->data, s_scaled_frame->linesize);
 	}
 
 	s_scaled_frame->format = s_stream->codec->pix_fmt;
@@ -338,28 +413,98 @@ void AVIDump::AddFrame(const u8* data, int width, int height)
 	s_scaled_frame->height = s_height;
 
 	// Encode and write the image.
-	AVPacket pkt;
-	PreparePacket(&pkt);
-	int got_packet;
-	int error = avcodec_encode_video2(s_stream->codec, &pkt, s_scaled_frame, &got_packet);
-	while (!error && got_packet)
+	EncodeFrame(s_scaled_frame);
+}
+
+static void EncoderThread()
+{
+	Common::SetCurrentThreadName("Frame dump encoder");
+
+	while (true)
 	{
-		// Write the compressed frame in the media file.
-		av_interleaved_write_frame(s_format_context, &pkt);
+		QueuedFrame* frame;
+		{
+			std::unique_lock<std::mutex> lk(s_queue_mutex);
+			s_frame_queued.wait(lk, [] { return s_stop_encoder || !s_queued_frames.empty(); });
+			if (s_queued_frames.empty())
+				break;
 
-		// Handle delayed frames.
-		PreparePacket(&pkt);
-		error = avcodec_encode_video2(s_stream->codec, &pkt, nullptr, &got_packet);
+			frame = s_queued_frames.front();
+			s_queued_frames.pop_front();
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		ConvertAndEncode(*frame);
+		float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		{
+			std::lock_guard<std::mutex> lk(s_queue_mutex);
+			s_free_frames.push_back(frame);
+			// moving average, so the overlay doesn't flicker
+			s_encode_time_ms += (elapsed - s_encode_time_ms) * 0.1f;
+		}
+		s_frame_freed.notify_one();
 	}
-	if (error)
-		ERROR_LOG(VIDEO, "Error while encoding video: %d", error);
+}
+
+void AVIDump::AddFrame(const u8* data, int width, int height)
+{
+	QueuedFrame* frame;
+	{
+		std::unique_lock<std::mutex> lk(s_queue_mutex);
+		if (s_free_frames.empty())
+		{
+			if (g_ActiveConfig.bDropDumpFrames)
+			{
+				s_frames_dropped++;
+				SETSTAT(stats.numDumpFramesDropped, s_frames_dropped);
+				return;
+			}
+
+			s_frame_freed.wait(lk, [] { return !s_free_frames.empty(); });
+		}
+
+		frame = s_free_frames.front();
+		s_free_frames.pop_front();
+	}
+
+	frame->data.assign(data, data + avpicture_get_size(AV_PIX_FMT_BGR24, width, height));
+	frame->width = width;
+	frame->height = height;
+
+	{
+		std::lock_guard<std::mutex> lk(s_queue_mutex);
+		s_queued_frames.push_back(frame);
+
+		SETSTAT(stats.numDumpFramesQueued, s_queued_frames.size());
+		SETSTAT(stats.numDumpFramesDropped, s_frames_dropped);
+		SETSTAT_FT(stats.dumpFrameEncodeTime, s_encode_time_ms);
+	}
+	s_frame_queued.notify_one();
 }
 
 void AVIDump::Stop()
 {
+	{
+		std::lock_guard<std::mutex> lk(s_queue_mutex);
+		s_stop_encoder = true;
+	}
+	s_frame_queued.notify_one();
+	// the encoder finishes all queued frames before it exits
+	if (s_encoder_thread.joinable())
+		s_encoder_thread.join();
+
+	EncodeFrame(nullptr);
+	if (s_frames_dropped)
+		WARN_LOG(VIDEO, "Dropped %d frames because the encoder fell behind", s_frames_dropped);
+
 	av_write_trailer(s_format_context);
 	CloseFile();
 	NOTICE_LOG(VIDEO, "Stopping frame dump");
+
+	for (QueuedFrame& frame : s_frame_pool)
+		std::vector<u8>().swap(frame.data);
+	SETSTAT(stats.numDumpFramesQueued, 0);
 }
 
 void AVIDump::CloseFile()
@@ -8,6 +8,7 @@
 #include "Core/HW/Memmap.h"
 
 #include "VideoCommon/BPFunctions.h"
+#include "VideoCommon/MainBase.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VertexManagerBase.h"
@@ -22,9 +23,9 @@ namespace BPFunctions
 // ----------------------------------------------
 
 
-void FlushPipeline()
+void FlushPipeline(FlushReason reason)
 {
-	VertexManager::Flush();
+	VertexManager::Flush(reason);
 }
 
 void SetGenerationMode()
@@ -149,6 +150,7 @@ void ClearScreen(const EFBRectangle &rc)
 			z = Z24ToZ16ToZ24(z);
 		}
 		g_renderer->ClearScreen(rc, colorEnable, alphaEnable, zEnable, color, z);
+		InvalidateEFBPeekCache();
 	}
 }
 
@@ -217,6 +219,7 @@ void OnPixelFormatChange()
 	}
 
 	g_renderer->ReinterpretPixelData(convtype);
+	InvalidateEFBPeekCache();
 
 skip:
 	DEBUG_LOG(VIDEO, "pixelfmt: pixel=%d, zc=%d", static_cast<int>(new_format), static_cast<int>(bpmem.zcontrol.zformat));
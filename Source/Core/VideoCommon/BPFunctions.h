@@ -10,12 +10,13 @@
 #pragma once
 
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VideoCommon.h"
 
 namespace BPFunctions
 {
 
-void FlushPipeline();
+void FlushPipeline(FlushReason reason);
 void SetGenerationMode();
 void SetScissor();
 void SetLineWidth();
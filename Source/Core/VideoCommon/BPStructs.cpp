@@ -13,13 +13,16 @@
 #include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/BPStructs.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/MainBase.h"
 #include "VideoCommon/PerfQueryBase.h"
 #include "VideoCommon/PixelEngine.h"
+#include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VertexLoader.h"
+#include "VideoCommon/VertexShaderGen.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/VideoConfig.h"
@@ -38,6 +41,53 @@ void BPInit()
 {
 	memset(&bpmem, 0, sizeof(bpmem));
 	bpmem.bpMask = 0xFFFFFF;
+
+	InvalidatePixelShaderUid();
+	InvalidateVertexShaderUid();
+}
+
+// Registers which GetPixelShaderUid reads
+static bool IsPixelShaderUidRegister(u32 address)
+{
+	return address == BPMEM_GENMODE ||
+	       (address >= BPMEM_IND_CMD && address < BPMEM_IND_CMD + 16) ||
+	       address == BPMEM_IREF ||
+	       (address >= BPMEM_TREF && address < BPMEM_TREF + 8) ||
+	       address == BPMEM_ZMODE ||
+	       address == BPMEM_ZCOMPARE ||
+	       (address >= BPMEM_TEV_COLOR_ENV && address < BPMEM_TEV_COLOR_ENV + 32) ||
+	       (address >= BPMEM_FOGRANGE && address <= BPMEM_FOGCOLOR) ||
+	       (address >= BPMEM_ALPHACOMPARE && address < BPMEM_TEV_KSEL + 8);
+}
+
+// Registers which only hold parameters for a later trigger (EFB copies,
+// clears, TMEM preloads, TLUT loads) or which aren't emulated. The geometry
+// queued in the vertex manager doesn't depend on them, so they are written
+// without a flush and draws around them end up in the same batch.
+static bool IsDeferredRegister(u32 address)
+{
+	return (address >= BPMEM_DISPLAYCOPYFILTER && address < BPMEM_DISPLAYCOPYFILTER + 4) ||
+	       address == BPMEM_IND_IMASK ||
+	       address == BPMEM_BUSCLOCK0 ||
+	       (address >= BPMEM_EFB_TL && address <= BPMEM_CLEAR_Z) ||
+	       address == BPMEM_COPYFILTER0 ||
+	       address == BPMEM_COPYFILTER1 ||
+	       address == BPMEM_REVBITS ||
+	       (address >= BPMEM_PRELOAD_ADDR && address <= BPMEM_PRELOAD_TMEMODD) ||
+	       address == BPMEM_LOADTLUT0 ||
+	       address == BPMEM_BUSCLOCK1 ||
+	       address == BPMEM_BP_MASK;
+}
+
+static FlushReason GetFlushReason(u32 address)
+{
+	if ((address >= BPMEM_TX_SETMODE0 && address < BPMEM_TX_SETTLUT_4 + 4) ||
+	    (address >= BPMEM_PRELOAD_MODE && address <= BPMEM_TEXINVALIDATE))
+		return FLUSH_TEXTURE;
+	if (IsPixelShaderUidRegister(address) ||
+	    (address >= BPMEM_TEV_REGISTER_L && address < BPMEM_TEV_REGISTER_L + 8))
+		return FLUSH_TEV;
+	return FLUSH_PIXEL_STATE;
 }
 
 static void BPWritten(const BPCmd& bp)
@@ -80,10 +130,16 @@ static void BPWritten(const BPCmd& bp)
 		}
 	}
 
-	FlushPipeline();
+	if (!IsDeferredRegister(bp.address))
+		FlushPipeline(GetFlushReason(bp.address));
 
 	((u32*)&bpmem)[bp.address] = bp.newvalue;
 
+	if (IsPixelShaderUidRegister(bp.address))
+		InvalidatePixelShaderUid();
+	if (bp.address == BPMEM_GENMODE)
+		InvalidateVertexShaderUid();
+
 	switch (bp.address)
 	{
 	case BPMEM_GENMODE: // Set the Generation Mode
@@ -212,6 +268,9 @@ static void BPWritten(const BPCmd& bp)
 
 			UPE_Copy PE_copy = bpmem.triggerEFBCopy;
 
+			// Pokes the CPU queued before this copy must show up in it
+			VideoFifo_CheckEFBAccess();
+
 			// Check if we are to copy from the EFB or draw to the XFB
 			if (PE_copy.copy_to_xfb == 0)
 			{
@@ -10,6 +10,8 @@ extern u8* g_pVideoData;
 
 #if _M_SSE >= 0x301 && !(defined __GNUC__ && !defined __SSSE3__)
 #include <tmmintrin.h>
+#elif _M_SSE >= 0x200
+#include <emmintrin.h>
 #endif
 
 __forceinline void DataSkip(u32 skip)
@@ -125,3 +127,38 @@ private:
 	u8 *buffer;
 	int offset;
 };
+
+#if _M_SSE >= 0x200
+// Widens the big endian components in the low bytes of val to one per lane.
+// SSE2 has neither a byte shuffle nor sign extending moves, so this is done
+// with unpacks and shifts.
+template <typename T> __m128i DataWiden_SSE2(__m128i val);
+
+template <>
+__forceinline __m128i DataWiden_SSE2<u8>(__m128i val)
+{
+	const __m128i zero = _mm_setzero_si128();
+	return _mm_unpacklo_epi16(_mm_unpacklo_epi8(val, zero), zero);
+}
+
+template <>
+__forceinline __m128i DataWiden_SSE2<s8>(__m128i val)
+{
+	val = _mm_unpacklo_epi8(val, val);
+	return _mm_srai_epi32(_mm_unpacklo_epi16(val, val), 24);
+}
+
+template <>
+__forceinline __m128i DataWiden_SSE2<u16>(__m128i val)
+{
+	val = _mm_or_si128(_mm_slli_epi16(val, 8), _mm_srli_epi16(val, 8));
+	return _mm_unpacklo_epi16(val, _mm_setzero_si128());
+}
+
+template <>
+__forceinline __m128i DataWiden_SSE2<s16>(__m128i val)
+{
+	val = _mm_or_si128(_mm_slli_epi16(val, 8), _mm_srli_epi16(val, 8));
+	return _mm_srai_epi32(_mm_unpacklo_epi16(val, val), 16);
+}
+#endif
@@ -9,6 +9,10 @@
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/VideoConfig.h"
 
+#if _M_SSE >= 0x200
+#include <emmintrin.h>
+#endif
+
 //Init
 u16 *IndexGenerator::index_buffer_current;
 u16 *IndexGenerator::BASEIptr;
@@ -18,8 +22,114 @@ static const u16 s_primitive_restart = -1;
 
 static u16* (*primitive_table[8])(u16*, u32, u32);
 
+// Long runs of primitives are written in blocks of whole vectors. A pattern
+// holds the indices of the first block relative to the first vertex of the
+// draw, and how much each index moves on from one block to the next. Restart
+// lanes are 0xFFFF with a step of 0, so saturating adds leave them alone.
+struct IndexPattern
+{
+	enum { MAX_INDICES = 40 };
+
+	u32 primitives; // per block
+	u32 num_indices;
+	u16 offsets[MAX_INDICES];
+	u16 steps[MAX_INDICES];
+};
+
+// Indexed by primitive restart support
+static IndexPattern s_list_pattern[2];
+static IndexPattern s_strip_pattern[2];
+static IndexPattern s_fan_pattern[2];
+static IndexPattern s_quad_pattern[2];
+static IndexPattern s_line_list_pattern;
+static IndexPattern s_line_strip_pattern;
+static IndexPattern s_point_pattern;
+
+// write_primitive(Iptr, n) writes the indices of the n-th primitive of a run.
+template <typename F>
+static void BuildPattern(IndexPattern& pattern, u32 primitives, F write_primitive)
+{
+	u16 first[IndexPattern::MAX_INDICES];
+	u16 second[IndexPattern::MAX_INDICES];
+	u16* a = first;
+	u16* b = second;
+	for (u32 n = 0; n < primitives; ++n)
+	{
+		a = write_primitive(a, n);
+		b = write_primitive(b, n + primitives);
+	}
+
+	pattern.primitives = primitives;
+	pattern.num_indices = (u32)(a - first);
+	_assert_(pattern.num_indices % 8 == 0 && pattern.num_indices <= IndexPattern::MAX_INDICES);
+	for (u32 i = 0; i < pattern.num_indices; ++i)
+	{
+		pattern.offsets[i] = first[i];
+		pattern.steps[i] = second[i] - first[i];
+	}
+}
+
+// Writes as many whole blocks of the pattern as fit into count primitives and
+// returns how many primitives were written.
+static u32 WriteBlocks(u16*& Iptr, const IndexPattern& pattern, u32 index, u32 count)
+{
+	const u32 blocks = count / pattern.primitives;
+	if (!blocks)
+		return 0;
+
+#if _M_SSE >= 0x200
+	const u32 num_vectors = pattern.num_indices / 8;
+	const __m128i base = _mm_set1_epi16((s16)index);
+	__m128i current[IndexPattern::MAX_INDICES / 8];
+	__m128i steps[IndexPattern::MAX_INDICES / 8];
+	for (u32 v = 0; v < num_vectors; ++v)
+	{
+		current[v] = _mm_adds_epu16(_mm_loadu_si128((const __m128i*)&pattern.offsets[v * 8]), base);
+		steps[v] = _mm_loadu_si128((const __m128i*)&pattern.steps[v * 8]);
+	}
+
+	for (u32 b = 0; b < blocks; ++b)
+	{
+		for (u32 v = 0; v < num_vectors; ++v)
+		{
+			_mm_storeu_si128((__m128i*)Iptr, current[v]);
+			current[v] = _mm_adds_epu16(current[v], steps[v]);
+			Iptr += 8;
+		}
+	}
+#else
+	for (u32 b = 0; b < blocks; ++b)
+	{
+		for (u32 i = 0; i < pattern.num_indices; ++i)
+		{
+			u32 value = pattern.offsets[i] + index + b * pattern.steps[i];
+			*Iptr++ = pattern.offsets[i] == s_primitive_restart ? s_primitive_restart : value;
+		}
+	}
+#endif
+
+	return blocks * pattern.primitives;
+}
+
 void IndexGenerator::Init()
 {
+	BuildPatterns<false>();
+	BuildPatterns<true>();
+	BuildPattern(s_line_list_pattern, 4, [](u16* Iptr, u32 n) {
+		*Iptr++ = 2 * n;
+		*Iptr++ = 2 * n + 1;
+		return Iptr;
+	});
+	BuildPattern(s_line_strip_pattern, 4, [](u16* Iptr, u32 n) {
+		*Iptr++ = n;
+		*Iptr++ = n + 1;
+		return Iptr;
+	});
+	BuildPattern(s_point_pattern, 8, [](u16* Iptr, u32 n) {
+		*Iptr++ = n;
+		return Iptr;
+	});
+
 	if (g_Config.backend_info.bSupportsPrimitiveRestart)
 	{
 		primitive_table[GX_DRAW_QUADS] = IndexGenerator::AddQuads<true>;
@@ -54,6 +164,71 @@ void IndexGenerator::AddIndices(int primitive, u32 numVerts)
 	base_index += numVerts;
 }
 
+template <bool pr> void IndexGenerator::BuildPatterns()
+{
+	// Block sizes are the smallest primitive counts filling whole vectors.
+	BuildPattern(s_list_pattern[pr], pr ? 2 : 8, [](u16* Iptr, u32 n) {
+		return WriteTriangle<pr>(Iptr, 3 * n, 3 * n + 1, 3 * n + 2);
+	});
+
+	if (pr)
+	{
+		// One primitive per vertex, the restart index follows the run
+		BuildPattern(s_strip_pattern[pr], 8, [](u16* Iptr, u32 n) {
+			*Iptr++ = n;
+			return Iptr;
+		});
+	}
+	else
+	{
+		// An even number of triangles keeps the winding of the next block
+		BuildPattern(s_strip_pattern[pr], 8, [](u16* Iptr, u32 n) {
+			u32 i = n + 2;
+			bool wind = (n & 1) != 0;
+			return WriteTriangle<pr>(Iptr, i - 2, i - !wind, i - wind);
+		});
+	}
+
+	if (pr)
+	{
+		// Three triangles per primitive, see AddFan
+		BuildPattern(s_fan_pattern[pr], 4, [](u16* Iptr, u32 n) {
+			u32 i = 3 * n + 2;
+			*Iptr++ = i - 1;
+			*Iptr++ = i + 0;
+			*Iptr++ = 0;
+			*Iptr++ = i + 1;
+			*Iptr++ = i + 2;
+			*Iptr++ = s_primitive_restart;
+			return Iptr;
+		});
+	}
+	else
+	{
+		BuildPattern(s_fan_pattern[pr], 8, [](u16* Iptr, u32 n) {
+			return WriteTriangle<pr>(Iptr, 0, n + 1, n + 2);
+		});
+	}
+
+	BuildPattern(s_quad_pattern[pr], pr ? 8 : 4, [](u16* Iptr, u32 n) {
+		u32 i = 4 * n + 3;
+		if (pr)
+		{
+			*Iptr++ = i - 2;
+			*Iptr++ = i - 1;
+			*Iptr++ = i - 3;
+			*Iptr++ = i - 0;
+			*Iptr++ = s_primitive_restart;
+		}
+		else
+		{
+			Iptr = WriteTriangle<pr>(Iptr, i - 3, i - 2, i - 1);
+			Iptr = WriteTriangle<pr>(Iptr, i - 3, i - 1, i - 0);
+		}
+		return Iptr;
+	});
+}
+
 // Triangles
 template <bool pr> __forceinline u16* IndexGenerator::WriteTriangle(u16 *Iptr, u32 index1, u32 index2, u32 index3)
 {
@@ -67,7 +242,8 @@ template <bool pr> __forceinline u16* IndexGenerator::WriteTriangle(u16 *Iptr, u
 
 template <bool pr> u16* IndexGenerator::AddList(u16 *Iptr, u32 const numVerts, u32 index)
 {
-	for (u32 i = 2; i < numVerts; i+=3)
+	u32 i = 2 + 3 * WriteBlocks(Iptr, s_list_pattern[pr], index, numVerts / 3);
+	for (; i < numVerts; i+=3)
 	{
 		Iptr = WriteTriangle<pr>(Iptr, index + i - 2, index + i - 1, index + i);
 	}
@@ -78,7 +254,8 @@ template <bool pr> u16* IndexGenerator::AddStrip(u16 *Iptr, u32 const numVerts,
 {
 	if (pr)
 	{
-		for (u32 i = 0; i < numVerts; ++i)
+		u32 i = WriteBlocks(Iptr, s_strip_pattern[pr], index, numVerts);
+		for (; i < numVerts; ++i)
 		{
 			*Iptr++ = index + i;
 		}
@@ -87,8 +264,11 @@ template <bool pr> u16* IndexGenerator::AddStrip(u16 *Iptr, u32 const numVerts,
 	}
 	else
 	{
-		bool wind = false;
-		for (u32 i = 2; i < numVerts; ++i)
+		u32 i = 2;
+		if (numVerts > 2)
+			i += WriteBlocks(Iptr, s_strip_pattern[pr], index, numVerts - 2);
+		bool wind = (i & 1) != 0;
+		for (; i < numVerts; ++i)
 		{
 			Iptr = WriteTriangle<pr>(Iptr,
 				index + i - 2,
@@ -126,6 +306,8 @@ template <bool pr> u16* IndexGenerator::AddFan(u16 *Iptr, u32 numVerts, u32 inde
 
 	if (pr)
 	{
+		if (numVerts > 2)
+			i += 3 * WriteBlocks(Iptr, s_fan_pattern[pr], index, (numVerts - 2) / 3);
 		for (; i+3<=numVerts; i+=3)
 		{
 			*Iptr++ = index + i - 1;
@@ -145,6 +327,10 @@ template <bool pr> u16* IndexGenerator::AddFan(u16 *Iptr, u32 numVerts, u32 inde
 			*Iptr++ = s_primitive_restart;
 		}
 	}
+	else if (numVerts > 2)
+	{
+		i += WriteBlocks(Iptr, s_fan_pattern[pr], index, numVerts - 2);
+	}
 
 	for (; i < numVerts; ++i)
 	{
@@ -172,7 +358,7 @@ template <bool pr> u16* IndexGenerator::AddFan(u16 *Iptr, u32 numVerts, u32 inde
  */
 template <bool pr> u16* IndexGenerator::AddQuads(u16 *Iptr, u32 numVerts, u32 index)
 {
-	u32 i = 3;
+	u32 i = 3 + 4 * WriteBlocks(Iptr, s_quad_pattern[pr], index, numVerts / 4);
 	for (; i < numVerts; i+=4)
 	{
 		if (pr)
@@ -207,7 +393,8 @@ template <bool pr> u16* IndexGenerator::AddQuads_nonstandard(u16 *Iptr, u32 numV
 // Lines
 u16* IndexGenerator::AddLineList(u16 *Iptr, u32 numVerts, u32 index)
 {
-	for (u32 i = 1; i < numVerts; i+=2)
+	u32 i = 1 + 2 * WriteBlocks(Iptr, s_line_list_pattern, index, numVerts / 2);
+	for (; i < numVerts; i+=2)
 	{
 		*Iptr++ = index + i - 1;
 		*Iptr++ = index + i;
@@ -220,7 +407,10 @@ u16* IndexGenerator::AddLineList(u16 *Iptr, u32 numVerts, u32 index)
 // so converting them to lists
 u16* IndexGenerator::AddLineStrip(u16 *Iptr, u32 numVerts, u32 index)
 {
-	for (u32 i = 1; i < numVerts; ++i)
+	u32 i = 1;
+	if (numVerts > 1)
+		i += WriteBlocks(Iptr, s_line_strip_pattern, index, numVerts - 1);
+	for (; i < numVerts; ++i)
 	{
 		*Iptr++ = index + i - 1;
 		*Iptr++ = index + i;
@@ -231,7 +421,8 @@ u16* IndexGenerator::AddLineStrip(u16 *Iptr, u32 numVerts, u32 index)
 // Points
 u16* IndexGenerator::AddPoints(u16 *Iptr, u32 numVerts, u32 index)
 {
-	for (u32 i = 0; i != numVerts; ++i)
+	u32 i = WriteBlocks(Iptr, s_point_pattern, index, numVerts);
+	for (; i != numVerts; ++i)
 	{
 		*Iptr++ = index + i;
 	}
@@ -26,6 +26,8 @@ public:
 	static u32 GetRemainingIndices();
 
 private:
+	template <bool pr> static void BuildPatterns();
+
 	// Triangles
 	template <bool pr> static u16* AddList(u16 *Iptr, u32 numVerts, u32 index);
 	template <bool pr> static u16* AddStrip(u16 *Iptr, u32 numVerts, u32 index);
@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "Common/Atomic.h"
 #include "Common/Event.h"
 #include "Core/ConfigManager.h"
 
@@ -42,6 +47,36 @@ static struct
 
 static u32 s_AccessEFBResult = 0;
 
+// EFB peeks are answered from tiles that are read back in one request and kept
+// until the video thread changes the EFB. Pokes are queued and applied by the
+// video thread before it draws or copies the EFB.
+static const u32 EFB_PEEK_TILE_SIZE = 64;
+static const u32 EFB_PEEK_TILES_WIDE = (EFB_WIDTH + EFB_PEEK_TILE_SIZE - 1) / EFB_PEEK_TILE_SIZE;
+static const u32 EFB_PEEK_TILES_HIGH = (EFB_HEIGHT + EFB_PEEK_TILE_SIZE - 1) / EFB_PEEK_TILE_SIZE;
+
+struct EFBPeekTile
+{
+	u32 generation; // s_efbGeneration when the tile was read, 0 if never
+	u32 alphaRead;  // PE alpha read mode the color values were read with
+	u32 values[EFB_PEEK_TILE_SIZE * EFB_PEEK_TILE_SIZE];
+};
+
+// Indexed by whether the tile holds color values
+static EFBPeekTile s_efbPeekTiles[2][EFB_PEEK_TILES_WIDE * EFB_PEEK_TILES_HIGH];
+static volatile u32 s_efbGeneration = 1;
+
+struct EFBPoke
+{
+	u32 type;
+	u32 x;
+	u32 y;
+	u32 data;
+};
+
+static std::mutex s_efbPokeLock;
+static std::vector<EFBPoke> s_efbPokes;
+static Common::Flag s_efbPokesQueued;
+
 void VideoBackendHardware::EmuStateChange(EMUSTATE_CHANGE newState)
 {
 	EmulatorState((newState == EMUSTATE_CHANGE_PLAY) ? true : false);
@@ -137,11 +172,81 @@ bool VideoBackendHardware::Video_Screenshot(const std::string& filename)
 	return true;
 }
 
+void InvalidateEFBPeekCache()
+{
+	Common::AtomicIncrement(s_efbGeneration);
+}
+
+static EFBRectangle GetEFBPeekTileRect(u32 x, u32 y)
+{
+	EFBRectangle rc;
+	rc.left = (x / EFB_PEEK_TILE_SIZE) * EFB_PEEK_TILE_SIZE;
+	rc.top = (y / EFB_PEEK_TILE_SIZE) * EFB_PEEK_TILE_SIZE;
+	rc.right = std::min(rc.left + EFB_PEEK_TILE_SIZE, (u32)EFB_WIDTH);
+	rc.bottom = std::min(rc.top + EFB_PEEK_TILE_SIZE, (u32)EFB_HEIGHT);
+	return rc;
+}
+
+static EFBPeekTile& GetEFBPeekTile(EFBAccessType type, u32 x, u32 y)
+{
+	u32 tile = (y / EFB_PEEK_TILE_SIZE) * EFB_PEEK_TILES_WIDE + x / EFB_PEEK_TILE_SIZE;
+	return s_efbPeekTiles[type == PEEK_COLOR][tile];
+}
+
+static u32 GetEFBPeekTileValue(const EFBPeekTile& tile, const EFBRectangle& rc, u32 x, u32 y)
+{
+	return tile.values[(y - rc.top) * rc.GetWidth() + (x - rc.left)];
+}
+
+// Run from the CPU thread
+static bool LookupEFBPeek(EFBAccessType type, u32 x, u32 y, u32* value)
+{
+	const EFBPeekTile& tile = GetEFBPeekTile(type, x, y);
+
+	if (Common::AtomicLoadAcquire(tile.generation) != Common::AtomicLoad(s_efbGeneration))
+		return false;
+	if (type == PEEK_COLOR && tile.alphaRead != PixelEngine::GetAlphaReadMode().Hex)
+		return false;
+
+	*value = GetEFBPeekTileValue(tile, GetEFBPeekTileRect(x, y), x, y);
+	return true;
+}
+
+static u32 VideoFifo_PeekEFB(EFBAccessType type, u32 x, u32 y)
+{
+	EFBPeekTile& tile = GetEFBPeekTile(type, x, y);
+	EFBRectangle rc = GetEFBPeekTileRect(x, y);
+
+	u32 generation = Common::AtomicLoad(s_efbGeneration);
+	if (!g_renderer->PeekEFBRect(type, rc, tile.values))
+		return g_renderer->AccessEFB(type, x, y, 0);
+
+	tile.alphaRead = PixelEngine::GetAlphaReadMode().Hex;
+	Common::AtomicStoreRelease(tile.generation, generation);
+
+	return GetEFBPeekTileValue(tile, rc, x, y);
+}
+
+static void ApplyEFBPokes()
+{
+	std::lock_guard<std::mutex> lk(s_efbPokeLock);
+
+	for (const EFBPoke& poke : s_efbPokes)
+		g_renderer->AccessEFB((EFBAccessType)poke.type, poke.x, poke.y, poke.data);
+
+	s_efbPokes.clear();
+	s_efbPokesQueued.Clear();
+	InvalidateEFBPeekCache();
+}
+
 void VideoFifo_CheckEFBAccess()
 {
+	if (s_efbPokesQueued.IsSet())
+		ApplyEFBPokes();
+
 	if (s_efbAccessRequested.IsSet())
 	{
-		s_AccessEFBResult = g_renderer->AccessEFB(s_accessEFBArgs.type, s_accessEFBArgs.x, s_accessEFBArgs.y, s_accessEFBArgs.Data);
+		s_AccessEFBResult = VideoFifo_PeekEFB(s_accessEFBArgs.type, s_accessEFBArgs.x, s_accessEFBArgs.y);
 		s_efbAccessRequested.Clear();
 		s_efbAccessReadyEvent.Set();
 	}
@@ -151,6 +256,26 @@ u32 VideoBackendHardware::Video_AccessEFB(EFBAccessType type, u32 x, u32 y, u32
 {
 	if (s_BackendInitialized && g_ActiveConfig.bEFBAccessEnable)
 	{
+		if (type == POKE_COLOR || type == POKE_Z)
+		{
+			EFBPoke poke = { (u32)type, x, y, InputData };
+			{
+				std::lock_guard<std::mutex> lk(s_efbPokeLock);
+				s_efbPokes.push_back(poke);
+				s_efbPokesQueued.Set();
+			}
+			InvalidateEFBPeekCache();
+
+			if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bCPUThread)
+				ApplyEFBPokes();
+
+			return 0;
+		}
+
+		u32 value;
+		if (LookupEFBPeek(type, x, y, &value))
+			return value;
+
 		s_accessEFBArgs.type = type;
 		s_accessEFBArgs.x = x;
 		s_accessEFBArgs.y = y;
@@ -221,6 +346,9 @@ void VideoBackendHardware::InitializeShared()
 	memset((void*)&s_beginFieldArgs, 0, sizeof(s_beginFieldArgs));
 	memset(&s_accessEFBArgs, 0, sizeof(s_accessEFBArgs));
 	s_AccessEFBResult = 0;
+	s_efbPokes.clear();
+	s_efbPokesQueued.Clear();
+	InvalidateEFBPeekCache();
 	m_invalid = false;
 }
 
@@ -244,6 +372,17 @@ void VideoBackendHardware::DoState(PointerWrap& p)
 	p.Do(s_beginFieldArgs);
 	p.Do(s_accessEFBArgs);
 	p.Do(s_AccessEFBResult);
+	{
+		std::lock_guard<std::mutex> lk(s_efbPokeLock);
+		p.Do(s_efbPokes);
+		if (p.GetMode() == PointerWrap::MODE_READ)
+		{
+			if (s_efbPokes.empty())
+				s_efbPokesQueued.Clear();
+			else
+				s_efbPokesQueued.Set();
+		}
+	}
 	p.DoMarker("VideoBackendHardware");
 
 	// Refresh state.
@@ -251,6 +390,7 @@ void VideoBackendHardware::DoState(PointerWrap& p)
 	{
 		m_invalid = true;
 		RecomputeCachedArraybases();
+		InvalidateEFBPeekCache();
 
 		// Clear all caches that touch RAM
 		// (? these don't appear to touch any emulation state that gets saved. moved to on load only.)
@@ -7,4 +7,8 @@ extern bool s_BackendInitialized;
 extern Common::Flag s_swapRequested;
 
 void VideoFifo_CheckEFBAccess();
+
+// Called whenever the video thread may have changed the EFB, so CPU peeks
+// aren't answered from tiles read back before
+void InvalidateEFBPeekCache();
 void VideoFifo_CheckSwapRequestAt(u32 xfbAddr, u32 fbWidth, u32 fbHeight);
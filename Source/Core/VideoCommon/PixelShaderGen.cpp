@@ -1052,9 +1052,49 @@ static inline void WriteFog(T& out, pixel_shader_uid_data& uid_data)
 	out.Write("\tprev.rgb = (prev.rgb * (256 - ifog) + " I_FOGCOLOR".rgb * ifog) >> 8;\n");
 }
 
+// The UID is only rebuilt after one of the registers it depends on was written
+// (see InvalidatePixelShaderUid) or when the arguments or config changed.
+static struct
+{
+	PixelShaderUid uid;
+	bool valid;
+	DSTALPHA_MODE dstAlphaMode;
+	API_TYPE ApiType;
+	u32 components;
+	bool enablePixelLighting;
+	bool fastDepthCalc;
+	bool supportsEarlyZ;
+} s_last_uid;
+
+void InvalidatePixelShaderUid()
+{
+	s_last_uid.valid = false;
+}
+
 void GetPixelShaderUid(PixelShaderUid& object, DSTALPHA_MODE dstAlphaMode, API_TYPE ApiType, u32 components)
 {
+	if (s_last_uid.valid &&
+	    s_last_uid.dstAlphaMode == dstAlphaMode &&
+	    s_last_uid.ApiType == ApiType &&
+	    s_last_uid.components == components &&
+	    s_last_uid.enablePixelLighting == g_ActiveConfig.bEnablePixelLighting &&
+	    s_last_uid.fastDepthCalc == g_ActiveConfig.bFastDepthCalc &&
+	    s_last_uid.supportsEarlyZ == g_ActiveConfig.backend_info.bSupportsEarlyZ)
+	{
+		object = s_last_uid.uid;
+		return;
+	}
+
 	GeneratePixelShader<PixelShaderUid>(object, dstAlphaMode, ApiType, components);
+
+	s_last_uid.uid = object;
+	s_last_uid.valid = true;
+	s_last_uid.dstAlphaMode = dstAlphaMode;
+	s_last_uid.ApiType = ApiType;
+	s_last_uid.components = components;
+	s_last_uid.enablePixelLighting = g_ActiveConfig.bEnablePixelLighting;
+	s_last_uid.fastDepthCalc = g_ActiveConfig.bFastDepthCalc;
+	s_last_uid.supportsEarlyZ = g_ActiveConfig.backend_info.bSupportsEarlyZ;
 }
 
 void GeneratePixelShaderCode(PixelShaderCode& object, DSTALPHA_MODE dstAlphaMode, API_TYPE ApiType, u32 components)
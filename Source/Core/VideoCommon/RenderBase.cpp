@@ -519,6 +519,9 @@ void Renderer::Swap(u32 xfbAddr, u32 fbWidth, u32 fbHeight, const EFBRectangle&
 	// TODO: merge more generic parts into VideoCommon
 	g_renderer->SwapImpl(xfbAddr, fbWidth, fbHeight, rc, Gamma);
 
+	// The EFB may have been resized
+	InvalidateEFBPeekCache();
+
 	if (XFBWrited)
 		g_renderer->m_fps_counter.Update();
 
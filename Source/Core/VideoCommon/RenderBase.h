@@ -104,6 +104,11 @@ public:
 
 	virtual u32 AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data) = 0;
 
+	// Peeks every pixel of rc into values, row by row, so CPU peeks can be answered
+	// without asking the video thread. Backends that read back single pixels
+	// return false and are asked for each peek instead.
+	virtual bool PeekEFBRect(EFBAccessType type, const EFBRectangle& rc, u32* values) { return false; }
+
 	// What's the real difference between these? Too similar names.
 	virtual void ResetAPIState() = 0;
 	virtual void RestoreAPIState() = 0;
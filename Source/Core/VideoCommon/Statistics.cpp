@@ -7,7 +7,9 @@
 
 #include "Common/StringUtil.h"
 #include "VideoCommon/Statistics.h"
+#include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VideoConfig.h"
 
 Statistics stats;
 
@@ -29,6 +31,10 @@ std::string Statistics::ToString()
 	std::string str;
 	str += StringFromFormat("Textures created: %i\n", stats.numTexturesCreated);
 	str += StringFromFormat("Textures alive: %i\n", stats.numTexturesAlive);
+	str += StringFromFormat("Texture cache hits: %i\n", stats.thisFrame.numTextureCacheHits);
+	str += StringFromFormat("Texture cache misses: %i\n", stats.thisFrame.numTextureCacheMisses);
+	str += StringFromFormat("Texture cache evictions: %i\n", stats.numTextureCacheEvictions);
+	str += StringFromFormat("Texture memory: %i kB\n", (int)(TextureCache::GetResidentBytes() / 1024));
 	str += StringFromFormat("pshaders created: %i\n", stats.numPixelShadersCreated);
 	str += StringFromFormat("pshaders alive: %i\n", stats.numPixelShadersAlive);
 	str += StringFromFormat("vshaders created: %i\n", stats.numVertexShadersCreated);
@@ -37,6 +43,13 @@ std::string Statistics::ToString()
 	str += StringFromFormat("dlists called: %i\n", stats.thisFrame.numDListsCalled);
 	str += StringFromFormat("Primitive joins: %i\n", stats.thisFrame.numPrimitiveJoins);
 	str += StringFromFormat("Draw calls: %i\n", stats.thisFrame.numDrawCalls);
+	str += StringFromFormat("Flushes (buffer full): %i\n", stats.thisFrame.numFlushes[FLUSH_BUFFER_FULL]);
+	str += StringFromFormat("Flushes (primitive type): %i\n", stats.thisFrame.numFlushes[FLUSH_PRIMITIVE_TYPE]);
+	str += StringFromFormat("Flushes (vertex format): %i\n", stats.thisFrame.numFlushes[FLUSH_VERTEX_FORMAT]);
+	str += StringFromFormat("Flushes (texture): %i\n", stats.thisFrame.numFlushes[FLUSH_TEXTURE]);
+	str += StringFromFormat("Flushes (TEV): %i\n", stats.thisFrame.numFlushes[FLUSH_TEV]);
+	str += StringFromFormat("Flushes (pixel state): %i\n", stats.thisFrame.numFlushes[FLUSH_PIXEL_STATE]);
+	str += StringFromFormat("Flushes (transform): %i\n", stats.thisFrame.numFlushes[FLUSH_TRANSFORM]);
 	str += StringFromFormat("Primitives: %i\n", stats.thisFrame.numPrims);
 	str += StringFromFormat("Primitives (DL): %i\n", stats.thisFrame.numDLPrims);
 	str += StringFromFormat("XF loads: %i\n", stats.thisFrame.numXFLoads);
@@ -49,6 +62,12 @@ std::string Statistics::ToString()
 	str += StringFromFormat("Index streamed: %i kB\n", stats.thisFrame.bytesIndexStreamed/1024);
 	str += StringFromFormat("Uniform streamed: %i kB\n", stats.thisFrame.bytesUniformStreamed/1024);
 	str += StringFromFormat("Vertex Loaders: %i\n", stats.numVertexLoaders);
+	if (g_ActiveConfig.bDumpFrames)
+	{
+		str += StringFromFormat("Frame dump queue: %i\n", stats.numDumpFramesQueued);
+		str += StringFromFormat("Frame dump dropped: %i\n", stats.numDumpFramesDropped);
+		str += StringFromFormat("Frame dump encode: %.2f ms\n", stats.dumpFrameEncodeTime);
+	}
 
 	std::string vertex_list;
 	VertexLoaderManager::AppendListToString(&vertex_list);
@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VideoCommon.h"
 
 struct Statistics
@@ -19,9 +20,14 @@ struct Statistics
 
 	int numTexturesCreated;
 	int numTexturesAlive;
+	int numTextureCacheEvictions;
 
 	int numVertexLoaders;
 
+	int numDumpFramesQueued;
+	int numDumpFramesDropped;
+	float dumpFrameEncodeTime;
+
 	float proj_0, proj_1, proj_2, proj_3, proj_4, proj_5;
 	float gproj_0, gproj_1, gproj_2, gproj_3, gproj_4, gproj_5;
 	float gproj_6, gproj_7, gproj_8, gproj_9, gproj_10, gproj_11, gproj_12, gproj_13, gproj_14, gproj_15;
@@ -47,9 +53,13 @@ struct Statistics
 
 		int numPrimitiveJoins;
 		int numDrawCalls;
+		int numFlushes[NUM_FLUSH_REASONS];
 
 		int numDListsCalled;
 
+		int numTextureCacheHits;
+		int numTextureCacheMisses;
+
 		int bytesVertexStreamed;
 		int bytesIndexStreamed;
 		int bytesUniformStreamed;
@@ -4,6 +4,8 @@
 
 #include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "Common/FileUtil.h"
 #include "Common/MemoryUtil.h"
@@ -22,6 +24,7 @@
 enum
 {
 	TEXTURE_KILL_THRESHOLD = 200,
+	TEXTURE_POOL_KILL_THRESHOLD = 3,
 	RENDER_TARGET_KILL_THRESHOLD = 3,
 };
 
@@ -31,7 +34,9 @@ GC_ALIGNED16(u8 *TextureCache::temp) = nullptr;
 unsigned int TextureCache::temp_size;
 
 TextureCache::TexCache TextureCache::textures;
+TextureCache::TexPool TextureCache::texture_pool;
 TextureCache::RenderTargetPool TextureCache::render_target_pool;
+u64 TextureCache::resident_bytes;
 
 TextureCache::BackupConfig TextureCache::backup_config;
 
@@ -39,6 +44,13 @@ static bool invalidate_texture_cache_requested;
 
 TextureCache::TCacheEntryBase::~TCacheEntryBase()
 {
+	resident_bytes -= memory_size;
+}
+
+void TextureCache::TCacheEntryBase::SetMemorySize(u32 _memory_size)
+{
+	resident_bytes += (s64)_memory_size - (s64)memory_size;
+	memory_size = _memory_size;
 }
 
 TextureCache::TextureCache()
@@ -70,6 +82,12 @@ void TextureCache::Invalidate()
 	}
 	textures.clear();
 
+	for (auto& tex : texture_pool)
+	{
+		delete tex.second;
+	}
+	texture_pool.clear();
+
 	for (auto& rt : render_target_pool)
 	{
 		delete rt;
@@ -138,8 +156,8 @@ void TextureCache::Cleanup()
             // EFB copies living on the host GPU are unrecoverable and thus shouldn't be deleted
 		    !iter->second->IsEfbCopy())
 		{
-			delete iter->second;
-			textures.erase(iter++);
+			FreeTexture(iter->second);
+			iter = textures.erase(iter);
 		}
 		else
 		{
@@ -147,6 +165,19 @@ void TextureCache::Cleanup()
 		}
 	}
 
+	for (TexPool::iterator it = texture_pool.begin(); it != texture_pool.end();)
+	{
+		if (frameCount > TEXTURE_POOL_KILL_THRESHOLD + it->second->frameCount)
+		{
+			delete it->second;
+			it = texture_pool.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
 	for (size_t i = 0; i < render_target_pool.size();)
 	{
 		auto rt = render_target_pool[i];
@@ -174,8 +205,8 @@ void TextureCache::InvalidateRange(u32 start_address, u32 size)
 		const int rangePosition = iter->second->IntersectsMemoryRange(start_address, size);
 		if (0 == rangePosition)
 		{
-			delete iter->second;
-			textures.erase(iter++);
+			FreeTexture(iter->second);
+			iter = textures.erase(iter);
 		}
 		else
 		{
@@ -186,28 +217,21 @@ void TextureCache::InvalidateRange(u32 start_address, u32 size)
 
 void TextureCache::MakeRangeDynamic(u32 start_address, u32 size)
 {
-	TexCache::iterator
-		iter = textures.lower_bound(start_address),
-		tcend = textures.upper_bound(start_address + size);
-
-	if (iter != textures.begin())
-		--iter;
-
-	for (; iter != tcend; ++iter)
+	for (auto& tex : textures)
 	{
-		const int rangePosition = iter->second->IntersectsMemoryRange(start_address, size);
+		const int rangePosition = tex.second->IntersectsMemoryRange(start_address, size);
 		if (0 == rangePosition)
 		{
-			iter->second->SetHashes(TEXHASH_INVALID);
+			tex.second->SetHashes(TEXHASH_INVALID);
 		}
 	}
 }
 
 bool TextureCache::Find(u32 start_address, u64 hash)
 {
-	TexCache::iterator iter = textures.lower_bound(start_address);
+	TexCache::iterator iter = textures.find(start_address);
 
-	if (iter->second->hash == hash)
+	if (iter != textures.end() && iter->second->hash == hash)
 		return true;
 
 	return false;
@@ -235,7 +259,7 @@ void TextureCache::ClearRenderTargets()
 		if (iter->second->type == TCET_EC_VRAM)
 		{
 			delete iter->second;
-			textures.erase(iter++);
+			iter = textures.erase(iter);
 		}
 		else
 		{
@@ -340,6 +364,37 @@ static u32 CalculateLevelSize(u32 level_0_size, u32 level)
 	return (level_0_size + ((1 << level) - 1)) >> level;
 }
 
+static u64 GetTextureLayout(u32 width, u32 height, u32 levels, PC_TexFormat pcfmt)
+{
+	return (u64)width | ((u64)height << 16) | ((u64)levels << 32) | ((u64)pcfmt << 40);
+}
+
+static u32 CalculateTextureMemorySize(u32 width, u32 height, u32 levels, PC_TexFormat pcfmt)
+{
+	u32 level_size;
+	switch (pcfmt)
+	{
+	case PC_TEX_FMT_I4_AS_I8:
+	case PC_TEX_FMT_I8:
+		level_size = width * height;
+		break;
+	case PC_TEX_FMT_IA4_AS_IA8:
+	case PC_TEX_FMT_IA8:
+	case PC_TEX_FMT_RGB565:
+		level_size = width * height * 2;
+		break;
+	case PC_TEX_FMT_DXT1:
+		level_size = width * height / 2;
+		break;
+	default:
+		level_size = width * height * 4;
+		break;
+	}
+
+	// A full mip chain adds another third of the first level
+	return levels > 1 ? level_size + level_size / 3 : level_size;
+}
+
 // Used by TextureCache::Load
 static TextureCache::TCacheEntryBase* ReturnEntry(unsigned int stage, TextureCache::TCacheEntryBase* entry)
 {
@@ -428,6 +483,7 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 			// TODO: Print a warning if the format changes! In this case,
 			// we could reinterpret the internal texture object data to the new pixel format
 			// (similar to what is already being done in Renderer::ReinterpretPixelFormat())
+			INCSTAT(stats.thisFrame.numTextureCacheHits);
 			return ReturnEntry(stage, entry);
 		}
 
@@ -435,6 +491,7 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		if (address == entry->addr && tex_hash == entry->hash && full_format == entry->format &&
 			entry->num_mipmaps > maxlevel && entry->native_width == nativeW && entry->native_height == nativeH)
 		{
+			INCSTAT(stats.thisFrame.numTextureCacheHits);
 			return ReturnEntry(stage, entry);
 		}
 
@@ -457,11 +514,13 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		else
 		{
 			// delete the texture and make a new one
-			delete entry;
+			FreeTexture(entry);
 			entry = nullptr;
 		}
 	}
 
+	INCSTAT(stats.thisFrame.numTextureCacheMisses);
+
 	bool using_custom_texture = false;
 
 	if (g_ActiveConfig.bHiresTextures)
@@ -478,7 +537,7 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 				// If we thought we could reuse the texture before, make sure to pool it now!
 				if (entry)
 				{
-					delete entry;
+					FreeTexture(entry);
 					entry = nullptr;
 				}
 			}
@@ -509,7 +568,19 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 	// create the entry/texture
 	if (nullptr == entry)
 	{
-		textures[texID] = entry = g_texture_cache->CreateTexture(width, height, expandedWidth, texLevels, pcfmt);
+		const u64 layout = GetTextureLayout(width, height, texLevels, pcfmt);
+		entry = AllocateTexture(layout);
+		if (entry)
+		{
+			entry->Load(width, height, expandedWidth, 0);
+		}
+		else
+		{
+			entry = g_texture_cache->CreateTexture(width, height, expandedWidth, texLevels, pcfmt);
+			entry->layout = layout;
+			entry->SetMemorySize(CalculateTextureMemorySize(width, height, texLevels, pcfmt));
+		}
+		textures[texID] = entry;
 
 		// Sometimes, we can get around recreating a texture if only the number of mip levels changes
 		// e.g. if our texture cache entry got too many mipmap levels we can limit the number of used levels by setting the appropriate render states
@@ -593,6 +664,13 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 	INCSTAT(stats.numTexturesCreated);
 	SETSTAT(stats.numTexturesAlive, textures.size());
 
+	if (g_ActiveConfig.iTextureCacheBudget > 0)
+	{
+		// Keep the texture we just loaded out of the eviction candidates
+		entry->frameCount = frameCount;
+		EvictToBudget();
+	}
+
 	return ReturnEntry(stage, entry);
 }
 
@@ -901,7 +979,7 @@ void TextureCache::CopyRenderTargetToTexture(u32 dstAddr, unsigned int dstFormat
 			else
 			{
 				// remove it and recreate it as a render target
-				delete entry;
+				FreeTexture(entry);
 			}
 
 			entry = nullptr;
@@ -912,6 +990,7 @@ void TextureCache::CopyRenderTargetToTexture(u32 dstAddr, unsigned int dstFormat
 	{
 		// create the texture
 		textures[dstAddr] = entry = AllocateRenderTarget(scaled_tex_w, scaled_tex_h);
+		entry->SetMemorySize(scaled_tex_w * scaled_tex_h * 4);
 
 		// TODO: Using the wrong dstFormat, dumb...
 		entry->SetGeneralParameters(dstAddr, 0, dstFormat, 1);
@@ -947,3 +1026,65 @@ void TextureCache::FreeRenderTarget(TCacheEntryBase* entry)
 {
 	render_target_pool.push_back(entry);
 }
+
+TextureCache::TCacheEntryBase* TextureCache::AllocateTexture(u64 layout)
+{
+	TexPool::iterator iter = texture_pool.find(layout);
+	if (iter == texture_pool.end())
+		return nullptr;
+
+	TCacheEntryBase* entry = iter->second;
+	texture_pool.erase(iter);
+	return entry;
+}
+
+void TextureCache::FreeTexture(TCacheEntryBase* entry)
+{
+	// Render targets have their own pool
+	if (entry->layout == 0)
+	{
+		delete entry;
+		return;
+	}
+
+	entry->frameCount = frameCount;
+	texture_pool.emplace(entry->layout, entry);
+}
+
+void TextureCache::EvictToBudget()
+{
+	const u64 budget = (u64)g_ActiveConfig.iTextureCacheBudget * 1024 * 1024;
+	if (resident_bytes <= budget)
+		return;
+
+	// Pooled textures go first, they aren't caching anything
+	for (auto& tex : texture_pool)
+		delete tex.second;
+	texture_pool.clear();
+
+	if (resident_bytes <= budget)
+		return;
+
+	// Then the least recently used textures. Textures used in the current frame
+	// may still be bound, and EFB copies living on the host GPU are unrecoverable.
+	std::vector<std::pair<int, u32>> candidates;
+	for (auto& tex : textures)
+	{
+		if (tex.second && tex.second->frameCount != frameCount && !tex.second->IsEfbCopy())
+			candidates.emplace_back(tex.second->frameCount, tex.first);
+	}
+	std::sort(candidates.begin(), candidates.end());
+
+	for (auto& candidate : candidates)
+	{
+		if (resident_bytes <= budget)
+			break;
+
+		TexCache::iterator iter = textures.find(candidate.second);
+		delete iter->second;
+		textures.erase(iter);
+		INCSTAT(stats.numTextureCacheEvictions);
+	}
+
+	SETSTAT(stats.numTexturesAlive, textures.size());
+}
@@ -4,7 +4,8 @@
 
 #pragma once
 
-#include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/Thread.h"
@@ -45,6 +46,14 @@ public:
 		// used to delete textures which haven't been used for TEXTURE_KILL_THRESHOLD frames
 		int frameCount;
 
+		// Dimensions, mip levels and format the host texture was created with, 0 for render targets.
+		// Freed textures are kept in a pool and handed out again for textures with the same layout.
+		u64 layout;
+
+		// Approximate host memory used by the texture, counted against the texture cache budget
+		u32 memory_size;
+
+		TCacheEntryBase() : layout(0), memory_size(0) {}
 
 		void SetGeneralParameters(u32 _addr, u32 _size, u32 _format, unsigned int _num_mipmaps)
 		{
@@ -68,6 +77,8 @@ public:
 			//pal_hash = _pal_hash;
 		}
 
+		void SetMemorySize(u32 _memory_size);
+
 
 		virtual ~TCacheEntryBase();
 
@@ -108,6 +119,9 @@ public:
 
 	static void RequestInvalidateTextureCache();
 
+	// Host memory used by all cached and pooled textures and render targets
+	static u64 GetResidentBytes() { return resident_bytes; }
+
 protected:
 	TextureCache();
 
@@ -122,11 +136,18 @@ private:
 	static TCacheEntryBase* AllocateRenderTarget(unsigned int width, unsigned int height);
 	static void FreeRenderTarget(TCacheEntryBase* entry);
 
-	typedef std::map<u32, TCacheEntryBase*> TexCache;
+	static TCacheEntryBase* AllocateTexture(u64 layout);
+	static void FreeTexture(TCacheEntryBase* entry);
+	static void EvictToBudget();
+
+	typedef std::unordered_map<u32, TCacheEntryBase*> TexCache;
+	typedef std::unordered_multimap<u64, TCacheEntryBase*> TexPool;
 	typedef std::vector<TCacheEntryBase*> RenderTargetPool;
 
 	static TexCache textures;
+	static TexPool texture_pool;
 	static RenderTargetPool render_target_pool;
+	static u64 resident_bytes;
 
 	// Backup configuration values
 	static struct BackupConfig
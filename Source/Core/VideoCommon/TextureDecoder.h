@@ -87,3 +87,7 @@ void TexDecoder_SetTexFmtOverlayOptions(bool enable, bool center);
 
 /* Internal method, implemented by TextureDecoder_Generic and TextureDecoder_x64. */
 PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int height, int texformat, const u8* tlut, TlutFormat tlutfmt);
+
+/* The portable decoder in TextureDecoder_Generic. It is built on all platforms, so that
+ * the optimized decoders can be tested against it. */
+PC_TexFormat _TexDecoder_DecodeImplGeneric(u32 * dst, const u8 * src, int width, int height, int texformat, const u8* tlut, TlutFormat tlutfmt);
@@ -3,22 +3,24 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 //#include "VideoCommon.h" // to get debug logs
 #include "Common/CPUDetect.h"
+#include "Common/Event.h"
+#include "Common/Flag.h"
+#include "Common/Thread.h"
 
 #include "VideoCommon/LookUpTables.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VideoConfig.h"
 
-#ifdef _OPENMP
-#include <omp.h>
-#elif defined __GNUC__
-#pragma GCC diagnostic ignored "-Wunknown-pragmas"
-#endif
-
 #if _M_SSE >= 0x401
 #include <smmintrin.h>
 #include <emmintrin.h>
@@ -81,68 +83,56 @@ struct DXTBlock
 	u8 lines[4];
 };
 
-static inline void DecodeBytes_C4_IA8(u32* dst, const u8* src, const u8* tlut_)
+// Palette lookups don't vectorize without a gather instruction, so the
+// palette is converted to RGBA once per texture instead, which leaves a
+// single load per texel.
+static void DecodeTlut(u32* palette, const u8* tlut_, TlutFormat tlutfmt, int count)
 {
 	const u16* tlut = (u16*) tlut_;
-	for (int x = 0; x < 4; x++)
+	switch (tlutfmt)
 	{
-		u8 val = src[x];
-		*dst++ = DecodePixel_IA8(tlut[val >> 4]);
-		*dst++ = DecodePixel_IA8(tlut[val & 0xF]);
+	case GX_TL_IA8:
+		for (int i = 0; i < count; i++)
+			palette[i] = DecodePixel_IA8(tlut[i]);
+		break;
+	case GX_TL_RGB565:
+		for (int i = 0; i < count; i++)
+			palette[i] = DecodePixel_RGB565(Common::swap16(tlut[i]));
+		break;
+	case GX_TL_RGB5A3:
+		for (int i = 0; i < count; i++)
+			palette[i] = DecodePixel_RGB5A3(Common::swap16(tlut[i]));
+		break;
+	default:
+		std::fill(palette, palette + count, 0);
+		break;
 	}
 }
 
-static inline void DecodeBytes_C4_RGB565(u32* dst, const u8* src, const u8* tlut_)
+static inline void DecodeBytes_C4(u32* dst, const u8* src, const u32* palette)
 {
-	const u16* tlut = (u16*) tlut_;
 	for (int x = 0; x < 4; x++)
 	{
 		u8 val = src[x];
-		*dst++ = DecodePixel_RGB565(Common::swap16(tlut[val >> 4]));
-		*dst++ = DecodePixel_RGB565(Common::swap16(tlut[val & 0xF]));
+		*dst++ = palette[val >> 4];
+		*dst++ = palette[val & 0xF];
 	}
 }
 
-static inline void DecodeBytes_C4_RGB5A3(u32 *dst, const u8 *src, const u8* tlut_)
+static inline void DecodeBytes_C8(u32* dst, const u8* src, const u32* palette)
 {
-	const u16* tlut = (u16*) tlut_;
-	for (int x = 0; x < 4; x++)
-	{
-		u8 val = src[x];
-		*dst++ = DecodePixel_RGB5A3(Common::swap16(tlut[val >> 4]));
-		*dst++ = DecodePixel_RGB5A3(Common::swap16(tlut[val & 0xF]));
-	}
-}
-
-static inline void DecodeBytes_C8_IA8(u32* dst, const u8* src, const u8* tlut_)
-{
-	const u16* tlut = (u16*) tlut_;
 	for (int x = 0; x < 8; x++)
-	{
-		*dst++ = DecodePixel_IA8(tlut[src[x]]);
-	}
+		*dst++ = palette[src[x]];
 }
 
-static inline void DecodeBytes_C8_RGB565(u32* dst, const u8* src, const u8* tlut_)
+static inline void DecodeBytes_C14X2(u32* dst, const u16* src, const u32* palette)
 {
-	const u16* tlut = (u16*) tlut_;
-	for (int x = 0; x < 8; x++)
-	{
-		u8 val = src[x];
-		*dst++ = DecodePixel_RGB565(Common::swap16(tlut[val]));
-	}
-}
-
-static inline void DecodeBytes_C8_RGB5A3(u32 *dst, const u8 *src, const u8* tlut_)
-{
-	const u16* tlut = (u16*) tlut_;
-	for (int x = 0; x < 8; x++)
-	{
-		u8 val = src[x];
-		*dst++ = DecodePixel_RGB5A3(Common::swap16(tlut[val]));
-	}
+	for (int x = 0; x < 4; x++)
+		*dst++ = palette[Common::swap16(src[x]) & 0x3FFF];
 }
 
+// Small textures only use a few of the 16384 colors, so they are converted
+// as they are read instead.
 static inline void DecodeBytes_C14X2_IA8(u32* dst, const u16* src, const u8* tlut_)
 {
 	const u16* tlut = (u16*) tlut_;
@@ -173,17 +163,6 @@ static inline void DecodeBytes_C14X2_RGB5A3(u32 *dst, const u16 *src, const u8*
 	}
 }
 
-static inline void DecodeBytes_IA4(u32 *dst, const u8 *src)
-{
-	for (int x = 0; x < 8; x++)
-	{
-		const u8 val = src[x];
-		u8 a = Convert4To8(val >> 4);
-		u8 l = Convert4To8(val & 0xF);
-		dst[x] = (a << 24) | l << 16 | l << 8 | l;
-	}
-}
-
 #ifdef CHECK
 static inline u32 makeRGBA(int r, int g, int b, int a)
 {
@@ -234,20 +213,118 @@ static void DecodeDXTBlock(u32 *dst, const DXTBlock *src, int pitch)
 }
 #endif
 
-static inline void SetOpenMPThreadCount(int width, int height)
+// Rows of blocks are handed out to a persistent set of decoder threads. The
+// calling thread decodes rows as well and waits for the others to finish.
+class DecoderThreadPool
+{
+public:
+	~DecoderThreadPool()
+	{
+		m_running.Clear();
+		for (auto& worker : m_workers)
+		{
+			worker->start.Set();
+			worker->thread.join();
+		}
+	}
+
+	template <typename F>
+	void DecodeBlockRows(int height, int block_height, const F& decode_row)
+	{
+		std::lock_guard<std::mutex> lk(m_lock);
+
+		if (!m_running.IsSet())
+			StartWorkers();
+
+		// The row loop is instantiated per decoder so that it gets inlined
+		// into the loop instead of being called through a pointer per row.
+		m_decode_rows = &DecodeRows<F>;
+		m_decoder = &decode_row;
+		m_height = height;
+		m_block_height = block_height;
+		m_next_row.store(0);
+
+		for (auto& worker : m_workers)
+			worker->start.Set();
+		DecodeRows<F>(this);
+		for (auto& worker : m_workers)
+			worker->done.Wait();
+	}
+
+private:
+	struct Worker
+	{
+		std::thread thread;
+		Common::Event start;
+		Common::Event done;
+	};
+
+	void StartWorkers()
+	{
+		// The calling thread counts as one of them.
+		u32 num_workers = Common::GetHelperThreadCount() - 1;
+		m_running.Set();
+		for (u32 i = 0; i < num_workers; ++i)
+		{
+			Worker* worker = new Worker;
+			worker->thread = std::thread(&DecoderThreadPool::WorkerThread, this, worker);
+			m_workers.emplace_back(worker);
+		}
+	}
+
+	void WorkerThread(Worker* worker)
+	{
+		Common::SetCurrentThreadName("Texture decoder");
+
+		while (true)
+		{
+			worker->start.Wait();
+			if (!m_running.IsSet())
+				break;
+
+			m_decode_rows(this);
+			worker->done.Set();
+		}
+	}
+
+	template <typename F>
+	static void DecodeRows(DecoderThreadPool* pool)
+	{
+		const F decode_row = *(const F*)pool->m_decoder;
+		const int height = pool->m_height;
+		const int block_height = pool->m_block_height;
+
+		int y;
+		while ((y = pool->m_next_row.fetch_add(block_height)) < height)
+			decode_row(y);
+	}
+
+	std::mutex m_lock;
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	Common::Flag m_running;
+
+	void (*m_decode_rows)(DecoderThreadPool* pool);
+	const void* m_decoder;
+	int m_height;
+	int m_block_height;
+	std::atomic<int> m_next_row;
+};
+
+static DecoderThreadPool s_decoder_threads;
+
+template <typename F>
+static inline void DecodeBlockRows(int width, int height, int block_height, const F& decode_row)
 {
-#ifdef _OPENMP
 	// Don't use multithreading in small Textures
 	if (g_ActiveConfig.bOMPDecoder && width > 127 && height > 127)
 	{
-		// don't span to many threads they will kill the rest of the emu :)
-		omp_set_num_threads((omp_get_num_procs() + 2) / 3);
+		s_decoder_threads.DecodeBlockRows(height, block_height, decode_row);
 	}
 	else
 	{
-		omp_set_num_threads(1);
+		for (int y = 0; y < height; y += block_height)
+			decode_row(y);
 	}
-#endif
 }
 
 // JSD 01/06/11:
@@ -260,38 +337,21 @@ static inline void SetOpenMPThreadCount(int width, int height)
 
 PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int height, int texformat, const u8* tlut, TlutFormat tlutfmt)
 {
-	SetOpenMPThreadCount(width, height);
-
 	const int Wsteps4 = (width + 3) / 4;
 	const int Wsteps8 = (width + 7) / 8;
 
 	switch (texformat)
 	{
 	case GX_TF_C4:
-		if (tlutfmt == GX_TL_RGB5A3)
 		{
-			#pragma omp parallel for
-			for (int y = 0; y < height; y += 8)
-				for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8,yStep++)
-					for (int iy = 0, xStep =  8 * yStep; iy < 8; iy++,xStep++)
-						DecodeBytes_C4_RGB5A3(dst + (y + iy) * width + x, src + 4 * xStep, tlut);
-		}
-		else if (tlutfmt == GX_TL_IA8)
-		{
-			#pragma omp parallel for
-			for (int y = 0; y < height; y += 8)
-				for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8,yStep++)
-					for (int iy = 0, xStep =  8 * yStep; iy < 8; iy++,xStep++)
-						DecodeBytes_C4_IA8(dst + (y + iy) * width + x, src + 4 * xStep, tlut);
-
-		}
-		else if (tlutfmt == GX_TL_RGB565)
-		{
-			#pragma omp parallel for
-			for (int y = 0; y < height; y += 8)
+			u32 palette[16];
+			DecodeTlut(palette, tlut, tlutfmt, 16);
+			DecodeBlockRows(width, height, 8, [&](int y)
+			{
 				for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8,yStep++)
 					for (int iy = 0, xStep =  8 * yStep; iy < 8; iy++,xStep++)
-						DecodeBytes_C4_RGB565(dst + (y + iy) * width + x, src  + 4 * xStep, tlut);
+						DecodeBytes_C4(dst + (y + iy) * width + x, src + 4 * xStep, palette);
+			});
 		}
 		break;
 	case GX_TF_I4:
@@ -307,8 +367,8 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 				const __m128i maskB3A2 = _mm_set_epi8(11,11,11,11,3,3,3,3,10,10,10,10,2,2,2,2);
 				const __m128i maskD5C4 = _mm_set_epi8(13,13,13,13,5,5,5,5,12,12,12,12,4,4,4,4);
 				const __m128i maskF7E6 = _mm_set_epi8(15,15,15,15,7,7,7,7,14,14,14,14,6,6,6,6);
-				#pragma omp parallel for
-				for (int y = 0; y < height; y += 8)
+				DecodeBlockRows(width, height, 8, [&](int y)
+				{
 					for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8,yStep++)
 						for (int iy = 0, xStep =  4 * yStep; iy < 8; iy += 2,xStep++)
 						{
@@ -337,14 +397,15 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 							_mm_storeu_si128( (__m128i*)( dst+(y + iy+1) * width + x ), o3 );
 							_mm_storeu_si128( (__m128i*)( dst+(y + iy+1) * width + x + 4 ), o4 );
 						}
+				});
 			}
 			else
 #endif
 			// JSD optimized with SSE2 intrinsics.
 			// Produces a ~76% speed improvement over reference C implementation.
 			{
-				#pragma omp parallel for
-				for (int y = 0; y < height; y += 8)
+				DecodeBlockRows(width, height, 8, [&](int y)
+				{
 					for (int x = 0, yStep = (y / 8) * Wsteps8 ; x < width; x += 8, yStep++)
 						for (int iy = 0, xStep = 4 * yStep; iy < 8; iy += 2, xStep++)
 						{
@@ -405,6 +466,7 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 							_mm_storeu_si128( (__m128i*)( dst+(y + iy+1) * width + x ), o3 );
 							_mm_storeu_si128( (__m128i*)( dst+(y + iy+1) * width + x + 4 ), o4 );
 						}
+				});
 			}
 		}
 		break;
@@ -415,8 +477,8 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 			// Produces a ~10% speed improvement over SSE2 implementation
 			if (cpu_info.bSSSE3)
 			{
-				#pragma omp parallel for
-				for (int y = 0; y < height; y += 4)
+				DecodeBlockRows(width, height, 4, [&](int y)
+				{
 					for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8,yStep++)
 						for (int iy = 0, xStep = 4 * yStep; iy < 4; ++iy, xStep++)
 						{
@@ -434,6 +496,7 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 							_mm_storeu_si128(quaddst, rgba0);
 							_mm_storeu_si128(quaddst+1, rgba1);
 						}
+				});
 
 			}
 			else
@@ -441,8 +504,8 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 			// JSD optimized with SSE2 intrinsics.
 			// Produces an ~86% speed improvement over reference C implementation.
 			{
-				#pragma omp parallel for
-				for (int y = 0; y < height; y += 4)
+				DecodeBlockRows(width, height, 4, [&](int y)
+				{
 					for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8,yStep++)
 					{
 						// Each loop iteration processes 4 rows from 4 64-bit reads.
@@ -521,44 +584,48 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 						_mm_storeu_si128(quaddst+1, rgba7);
 
 					}
+				});
 			}
 		}
 		break;
 	case GX_TF_C8:
-		if (tlutfmt == GX_TL_RGB5A3)
 		{
-			#pragma omp parallel for
-			for (int y = 0; y < height; y += 4)
-				for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
-					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
-						DecodeBytes_C8_RGB5A3((u32*)dst + (y + iy) * width + x, src + 8 * xStep, tlut);
-		}
-		else if (tlutfmt == GX_TL_IA8)
-		{
-			#pragma omp parallel for
-			for (int y = 0; y < height; y += 4)
-				for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
-					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
-						DecodeBytes_C8_IA8(dst + (y + iy) * width + x, src + 8 * xStep, tlut);
-
-		}
-		else if (tlutfmt == GX_TL_RGB565)
-		{
-			#pragma omp parallel for
-			for (int y = 0; y < height; y += 4)
+			u32 palette[256];
+			DecodeTlut(palette, tlut, tlutfmt, 256);
+			DecodeBlockRows(width, height, 4, [&](int y)
+			{
 				for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
 					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
-						DecodeBytes_C8_RGB565(dst + (y + iy) * width + x, src + 8 * xStep, tlut);
-
+						DecodeBytes_C8(dst + (y + iy) * width + x, src + 8 * xStep, palette);
+			});
 		}
 		break;
 	case GX_TF_IA4:
+		// Optimized with SSE2 intrinsics.
 		{
-			#pragma omp parallel for
-			for (int y = 0; y < height; y += 4)
+			const __m128i kMask_x0f = _mm_set1_epi32(0x0f0f0f0fL);
+			DecodeBlockRows(width, height, 4, [&](int y)
+			{
 				for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
 					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
-						DecodeBytes_IA4(dst + (y + iy) * width + x, src + 8 * xStep);
+					{
+						// Load 8x 8-bit IA4 samples from `src` into an __m128i with upper 64 bits zeroed: (0000 0000 hgfe dcba)
+						const __m128i r0 = _mm_loadl_epi64((const __m128i *)(src + 8 * xStep));
+						// Replicate the A nibbles to 8 bits: (Aa) -> (AA)
+						const __m128i a0 = _mm_and_si128(_mm_srli_epi16(r0, 4), kMask_x0f);
+						const __m128i a1 = _mm_or_si128(a0, _mm_slli_epi16(a0, 4));
+						// Replicate the I nibbles to 8 bits: (aI) -> (II)
+						const __m128i i0 = _mm_and_si128(r0, kMask_x0f);
+						const __m128i i1 = _mm_or_si128(i0, _mm_slli_epi16(i0, 4));
+						// Interleave to 16-bit (AI) and (II) pairs, then those to 32-bit (AIII):
+						const __m128i ai = _mm_unpacklo_epi8(i1, a1);
+						const __m128i ii = _mm_unpacklo_epi8(i1, i1);
+						const __m128i o1 = _mm_unpacklo_epi16(ii, ai);
+						const __m128i o2 = _mm_unpackhi_epi16(ii, ai);
+						_mm_storeu_si128( (__m128i*)(dst + (y + iy) * width + x), o1 );
+						_mm_storeu_si128( (__m128i*)(dst + (y + iy) * width + x + 4), o2 );
+					}
+			});
 		}
 		break;
 	case GX_TF_IA8:
@@ -568,8 +635,8 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 			// Produces an ~50% speed improvement over SSE2 implementation.
 			if (cpu_info.bSSSE3)
 			{
-				#pragma omp parallel for
-				for (int y = 0; y < height; y += 4)
+				DecodeBlockRows(width, height, 4, [&](int y)
+				{
 					for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
 						for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
 						{
@@ -580,6 +647,7 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 							const __m128i r1 = _mm_shuffle_epi8(r0, mask);
 							_mm_storeu_si128( (__m128i*)(dst + (y + iy) * width + x), r1 );
 						}
+				});
 			}
 			else
 #endif
@@ -590,8 +658,8 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 				const __m128i kMask_x0f = _mm_set_epi32(0x00000000L, 0x00000000L, 0x00ff00ffL, 0x00ff00ffL);
 				const __m128i kMask_xf000 = _mm_set_epi32(0xff000000L, 0xff000000L, 0xff000000L, 0xff000000L);
 				const __m128i kMask_x0fff = _mm_set_epi32(0x00ffffffL, 0x00ffffffL, 0x00ffffffL, 0x00ffffffL);
-				#pragma omp parallel for
-				for (int y = 0; y < height; y += 4)
+				DecodeBlockRows(width, height, 4, [&](int y)
+				{
 					for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
 						for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
 						{
@@ -633,33 +701,48 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 							// write out the 128-bit result:
 							_mm_storeu_si128( (__m128i*)(dst + (y + iy) * width + x), r1 );
 						}
+				});
 			}
 		}
 		break;
 	case GX_TF_C14X2:
-		if (tlutfmt == GX_TL_RGB5A3)
+		if (width * height >= 0x4000)
+		{
+			std::vector<u32> palette(0x4000);
+			DecodeTlut(palette.data(), tlut, tlutfmt, 0x4000);
+			DecodeBlockRows(width, height, 4, [&](int y)
+			{
+				for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+						DecodeBytes_C14X2(dst + (y + iy) * width + x, (u16*)(src + 8 * xStep), palette.data());
+			});
+		}
+		else if (tlutfmt == GX_TL_RGB5A3)
 		{
-			#pragma omp parallel for
-			for (int y = 0; y < height; y += 4)
+			DecodeBlockRows(width, height, 4, [&](int y)
+			{
 				for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
 					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
 						DecodeBytes_C14X2_RGB5A3(dst + (y + iy) * width + x, (u16*)(src + 8 * xStep), tlut);
+			});
 		}
 		else if (tlutfmt == GX_TL_IA8)
 		{
-			#pragma omp parallel for
-			for (int y = 0; y < height; y += 4)
+			DecodeBlockRows(width, height, 4, [&](int y)
+			{
 				for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
 					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
 						DecodeBytes_C14X2_IA8(dst + (y + iy) * width + x,  (u16*)(src + 8 * xStep), tlut);
+			});
 		}
 		else if (tlutfmt == GX_TL_RGB565)
 		{
-			#pragma omp parallel for
-			for (int y = 0; y < height; y += 4)
+			DecodeBlockRows(width, height, 4, [&](int y)
+			{
 				for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
 					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
 						DecodeBytes_C14X2_RGB565(dst + (y + iy) * width + x, (u16*)(src + 8 * xStep), tlut);
+			});
 		}
 		break;
 	case GX_TF_RGB565:
@@ -671,8 +754,8 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 			const __m128i kMaskG1 = _mm_set1_epi32(0x00000300);
 			const __m128i kMaskB0 = _mm_set1_epi32(0x00F80000);
 			const __m128i kAlpha  = _mm_set1_epi32(0xFF000000);
-			#pragma omp parallel for
-			for (int y = 0; y < height; y += 4)
+			DecodeBlockRows(width, height, 4, [&](int y)
+			{
 				for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
 					for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
 					{
@@ -732,6 +815,7 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 						__m128i *ptr = (__m128i *)(dst + (y + iy) * width + x);
 						_mm_storeu_si128(ptr, abgr888x4);
 					}
+			});
 		}
 		break;
 	case GX_TF_RGB5A3:
@@ -748,8 +832,8 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 			// Produces a ~10% speed improvement over SSE2 implementation
 			if (cpu_info.bSSSE3)
 			{
-				#pragma omp parallel for
-				for (int y = 0; y < height; y += 4)
+				DecodeBlockRows(width, height, 4, [&](int y)
+				{
 					for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
 						for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
 						{
@@ -835,14 +919,15 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 									}
 								}
 						}
+				});
 			}
 			else
 #endif
 			// JSD optimized with SSE2 intrinsics (2 in 4 cases)
 			// Produces a ~25% speed improvement over reference C implementation.
 			{
-				#pragma omp parallel for
-				for (int y = 0; y < height; y += 4)
+				DecodeBlockRows(width, height, 4, [&](int y)
+				{
 					for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
 						for (int iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
 						{
@@ -945,6 +1030,7 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 								}
 							}
 						}
+				});
 				}
 		}
 		break;
@@ -955,8 +1041,8 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 			// Produces a ~30% speed improvement over SSE2 implementation
 			if (cpu_info.bSSSE3)
 			{
-				#pragma omp parallel for
-				for (int y = 0; y < height; y += 4)
+				DecodeBlockRows(width, height, 4, [&](int y)
+				{
 					for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
 					{
 						const u8* src2 = src + 64 * yStep;
@@ -981,14 +1067,15 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 						dst128 = (__m128i*)( dst + (y + 3) * width + x );
 						_mm_storeu_si128(dst128, rgba11);
 					}
+				});
 			}
 			else
 #endif
 			// JSD optimized with SSE2 intrinsics
 			// Produces a ~68% speed improvement over reference C implementation.
 			{
-				#pragma omp parallel for
-				for (int y = 0; y < height; y += 4)
+				DecodeBlockRows(width, height, 4, [&](int y)
+				{
 					for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
 					{
 						// Input is divided up into 16-bit words. The texels are split up into AR and GB components where all
@@ -1081,6 +1168,7 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 						dst128 = (__m128i*)( dst + (y + 3) * width + x );
 						_mm_storeu_si128(dst128, rgba11);
 					}
+				});
 			}
 		}
 		break;
@@ -1091,8 +1179,7 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 			// Produces a ~50% improvement for x86 and a ~40% improvement for x64 in speed over reference C implementation.
 			// The x64 compiled reference C code is faster than the x86 compiled reference C code, but the SSE2 is
 			// faster than both.
-			#pragma omp parallel for
-			for (int y = 0; y < height; y += 8)
+			DecodeBlockRows(width, height, 8, [&](int y)
 			{
 				for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8,yStep++)
 				{
@@ -1315,7 +1402,7 @@ PC_TexFormat _TexDecoder_DecodeImpl(u32 * dst, const u8 * src, int width, int he
 #endif
 					}
 				}
-			}
+			});
 			break;
 		}
 	}
@@ -25,6 +25,9 @@ static NativeVertexFormat* s_current_vtx_fmt;
 
 typedef std::pair<VertexLoader*, NativeVertexFormat*> VertexLoaderCacheItem;
 static VertexLoaderCacheItem s_VertexLoaders[8];
+// UIDs of the loaders in s_VertexLoaders, so that a dirty VAT group whose
+// state ends up unchanged can skip the map lookup entirely.
+static VertexLoaderUID s_VertexLoaderUIDs[8];
 
 namespace std
 {
@@ -69,6 +72,11 @@ void Shutdown()
 	}
 	s_VertexLoaderMap.clear();
 	s_native_vertex_map.clear();
+	for (auto& map_entry : s_VertexLoaders)
+	{
+		map_entry.first = nullptr;
+		map_entry.second = nullptr;
+	}
 }
 
 namespace
@@ -129,22 +137,28 @@ static VertexLoaderCacheItem RefreshLoader(int vtx_attr_group)
 	if ((s_attr_dirty >> vtx_attr_group) & 1)
 	{
 		VertexLoaderUID uid(g_VtxDesc, g_VtxAttr[vtx_attr_group]);
-		VertexLoaderMap::iterator iter = s_VertexLoaderMap.find(uid);
-		if (iter != s_VertexLoaderMap.end())
+		// Most of the time only the fractional bits changed (or nothing at
+		// all), in which case the currently bound loader is still valid.
+		if (!s_VertexLoaders[vtx_attr_group].first || !(uid == s_VertexLoaderUIDs[vtx_attr_group]))
 		{
-			s_VertexLoaders[vtx_attr_group] = iter->second;
-		}
-		else
-		{
-			VertexLoader* loader = new VertexLoader(g_VtxDesc, g_VtxAttr[vtx_attr_group]);
-
-			NativeVertexFormat* vtx_fmt = GetNativeVertexFormat(
-				loader->GetNativeVertexDeclaration(),
-				loader->GetNativeComponents());
-
-			s_VertexLoaderMap[uid] = std::make_pair(loader, vtx_fmt);
-			s_VertexLoaders[vtx_attr_group] = std::make_pair(loader, vtx_fmt);
-			INCSTAT(stats.numVertexLoaders);
+			VertexLoaderMap::iterator iter = s_VertexLoaderMap.find(uid);
+			if (iter != s_VertexLoaderMap.end())
+			{
+				s_VertexLoaders[vtx_attr_group] = iter->second;
+			}
+			else
+			{
+				VertexLoader* loader = new VertexLoader(g_VtxDesc, g_VtxAttr[vtx_attr_group]);
+
+				NativeVertexFormat* vtx_fmt = GetNativeVertexFormat(
+					loader->GetNativeVertexDeclaration(),
+					loader->GetNativeComponents());
+
+				s_VertexLoaderMap[uid] = std::make_pair(loader, vtx_fmt);
+				s_VertexLoaders[vtx_attr_group] = std::make_pair(loader, vtx_fmt);
+				INCSTAT(stats.numVertexLoaders);
+			}
+			s_VertexLoaderUIDs[vtx_attr_group] = uid;
 		}
 	}
 	s_attr_dirty &= ~(1 << vtx_attr_group);
@@ -170,7 +184,7 @@ bool RunVertices(int vtx_attr_group, int primitive, int count, size_t buf_size,
 
 	// If the native vertex format changed, force a flush.
 	if (loader.second != s_current_vtx_fmt)
-		VertexManager::Flush();
+		VertexManager::Flush(FLUSH_VERTEX_FORMAT);
 	s_current_vtx_fmt = loader.second;
 
 	VertexManager::PrepareForAdditionalData(primitive, count,
@@ -209,34 +223,45 @@ void LoadCPReg(u32 sub_cmd, u32 value)
 		VertexShaderManager::SetTexMatrixChangedB(value);
 		break;
 
+	// Games tend to rewrite the same VCD/VAT values before every draw, so only
+	// mark loaders dirty if the register actually changed.
 	case 0x50:
-		g_VtxDesc.Hex &= ~0x1FFFF;  // keep the Upper bits
-		g_VtxDesc.Hex |= value;
-		s_attr_dirty = 0xFF;
+	{
+		u64 new_hex = (g_VtxDesc.Hex & ~0x1FFFFull) | value;  // keep the Upper bits
+		if (new_hex != g_VtxDesc.Hex)
+			s_attr_dirty = 0xFF;
+		g_VtxDesc.Hex = new_hex;
 		break;
+	}
 
 	case 0x60:
-		g_VtxDesc.Hex &= 0x1FFFF;  // keep the lower 17Bits
-		g_VtxDesc.Hex |= (u64)value << 17;
-		s_attr_dirty = 0xFF;
+	{
+		u64 new_hex = (g_VtxDesc.Hex & 0x1FFFF) | ((u64)value << 17);  // keep the lower 17Bits
+		if (new_hex != g_VtxDesc.Hex)
+			s_attr_dirty = 0xFF;
+		g_VtxDesc.Hex = new_hex;
 		break;
+	}
 
 	case 0x70:
 		_assert_((sub_cmd & 0x0F) < 8);
+		if (g_VtxAttr[sub_cmd & 7].g0.Hex != value)
+			s_attr_dirty |= 1 << (sub_cmd & 7);
 		g_VtxAttr[sub_cmd & 7].g0.Hex = value;
-		s_attr_dirty |= 1 << (sub_cmd & 7);
 		break;
 
 	case 0x80:
 		_assert_((sub_cmd & 0x0F) < 8);
+		if (g_VtxAttr[sub_cmd & 7].g1.Hex != value)
+			s_attr_dirty |= 1 << (sub_cmd & 7);
 		g_VtxAttr[sub_cmd & 7].g1.Hex = value;
-		s_attr_dirty |= 1 << (sub_cmd & 7);
 		break;
 
 	case 0x90:
 		_assert_((sub_cmd & 0x0F) < 8);
+		if (g_VtxAttr[sub_cmd & 7].g2.Hex != value)
+			s_attr_dirty |= 1 << (sub_cmd & 7);
 		g_VtxAttr[sub_cmd & 7].g2.Hex = value;
-		s_attr_dirty |= 1 << (sub_cmd & 7);
 		break;
 
 	// Pointers to vertex arrays in GC RAM
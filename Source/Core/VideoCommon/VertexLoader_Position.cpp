@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include <limits>
 
 #include "Common/CommonTypes.h"
@@ -118,7 +119,46 @@ void LOADERDECL Pos_ReadIndex_Float_SSSE3()
 }
 #endif
 
-static TPipelineFunction tableReadPosition[4][8][2] = {
+#if _M_SSE >= 0x200
+// Dequantizes all components of one position at once. XY positions are read
+// exactly, so the Z lane comes out as 0.f like in the scalar path. Like the
+// SSSE3 float loader above, XYZ positions may read a few bytes past the
+// attribute, and all of them write a full vector. The extra lane is
+// overwritten by the next attribute.
+template <typename T, bool three>
+__forceinline void Pos_Dequantize_SSE2(const u8* src)
+{
+	const int size = (three ? 3 : 2) * sizeof(T);
+	const __m128i raw = size <= 2 ? _mm_cvtsi32_si128(*(const u16*)src) :
+	                    size <= 4 ? _mm_cvtsi32_si128(*(const s32*)src) :
+	                                _mm_loadl_epi64((const __m128i*)src);
+	const __m128 scaled = _mm_mul_ps(_mm_cvtepi32_ps(DataWiden_SSE2<T>(raw)), _mm_load1_ps(&posScale));
+	_mm_storeu_ps((float*)VertexManager::s_pCurBufferPointer, scaled);
+	VertexManager::s_pCurBufferPointer += sizeof(float) * 3;
+}
+
+template <typename T, bool three>
+void LOADERDECL Pos_ReadDirect_SSE2()
+{
+	Pos_Dequantize_SSE2<T, three>(DataGetPosition());
+	DataSkip<(three ? 3 : 2) * sizeof(T)>();
+	LOG_VTX();
+}
+
+template <typename I, typename T, bool three>
+void LOADERDECL Pos_ReadIndex_SSE2()
+{
+	static_assert(!std::numeric_limits<I>::is_signed, "Only unsigned I is sane!");
+
+	auto const index = DataRead<I>();
+	Pos_Dequantize_SSE2<T, three>(cached_arraybases[ARRAY_POSITION] + (index * arraystrides[ARRAY_POSITION]));
+	LOG_VTX();
+}
+#endif
+
+// Init() starts over from these, so that the loaders follow cpu_info when it
+// changes.
+static const TPipelineFunction tableReadPositionPortable[4][8][2] = {
 	{
 		{nullptr, nullptr,},
 		{nullptr, nullptr,},
@@ -149,6 +189,8 @@ static TPipelineFunction tableReadPosition[4][8][2] = {
 	},
 };
 
+static TPipelineFunction tableReadPosition[4][8][2];
+
 static int tableReadPositionVertexSize[4][8][2] = {
 	{
 		{0, 0,}, {0, 0,}, {0, 0,}, {0, 0,}, {0, 0,},
@@ -167,6 +209,7 @@ static int tableReadPositionVertexSize[4][8][2] = {
 
 void VertexLoader_Position::Init()
 {
+	memcpy(tableReadPosition, tableReadPositionPortable, sizeof(tableReadPosition));
 
 #if _M_SSE >= 0x301
 
@@ -180,6 +223,40 @@ void VertexLoader_Position::Init()
 
 #endif
 
+#if _M_SSE >= 0x200
+
+	if (cpu_info.bSSE2)
+	{
+		tableReadPosition[1][0][0] = Pos_ReadDirect_SSE2<u8, false>;
+		tableReadPosition[1][0][1] = Pos_ReadDirect_SSE2<u8, true>;
+		tableReadPosition[1][1][0] = Pos_ReadDirect_SSE2<s8, false>;
+		tableReadPosition[1][1][1] = Pos_ReadDirect_SSE2<s8, true>;
+		tableReadPosition[1][2][0] = Pos_ReadDirect_SSE2<u16, false>;
+		tableReadPosition[1][2][1] = Pos_ReadDirect_SSE2<u16, true>;
+		tableReadPosition[1][3][0] = Pos_ReadDirect_SSE2<s16, false>;
+		tableReadPosition[1][3][1] = Pos_ReadDirect_SSE2<s16, true>;
+
+		tableReadPosition[2][0][0] = Pos_ReadIndex_SSE2<u8, u8, false>;
+		tableReadPosition[2][0][1] = Pos_ReadIndex_SSE2<u8, u8, true>;
+		tableReadPosition[2][1][0] = Pos_ReadIndex_SSE2<u8, s8, false>;
+		tableReadPosition[2][1][1] = Pos_ReadIndex_SSE2<u8, s8, true>;
+		tableReadPosition[2][2][0] = Pos_ReadIndex_SSE2<u8, u16, false>;
+		tableReadPosition[2][2][1] = Pos_ReadIndex_SSE2<u8, u16, true>;
+		tableReadPosition[2][3][0] = Pos_ReadIndex_SSE2<u8, s16, false>;
+		tableReadPosition[2][3][1] = Pos_ReadIndex_SSE2<u8, s16, true>;
+
+		tableReadPosition[3][0][0] = Pos_ReadIndex_SSE2<u16, u8, false>;
+		tableReadPosition[3][0][1] = Pos_ReadIndex_SSE2<u16, u8, true>;
+		tableReadPosition[3][1][0] = Pos_ReadIndex_SSE2<u16, s8, false>;
+		tableReadPosition[3][1][1] = Pos_ReadIndex_SSE2<u16, s8, true>;
+		tableReadPosition[3][2][0] = Pos_ReadIndex_SSE2<u16, u16, false>;
+		tableReadPosition[3][2][1] = Pos_ReadIndex_SSE2<u16, u16, true>;
+		tableReadPosition[3][3][0] = Pos_ReadIndex_SSE2<u16, s16, false>;
+		tableReadPosition[3][3][1] = Pos_ReadIndex_SSE2<u16, s16, true>;
+	}
+
+#endif
+
 }
 
 unsigned int VertexLoader_Position::GetSize(u64 _type, unsigned int _format, unsigned int _elements)
@@ -2,6 +2,9 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <cstring>
+#include <limits>
+
 #include "Common/CommonTypes.h"
 #include "Common/CPUDetect.h"
 
@@ -84,25 +87,35 @@ void LOADERDECL TexCoord_ReadIndex()
 	++tcIndex;
 }
 
-#if _M_SSE >= 0x401
-static const __m128i kMaskSwap16_2 = _mm_set_epi32(0xFFFFFFFFL, 0xFFFFFFFFL, 0xFFFFFFFFL, 0x02030001L);
+#if _M_SSE >= 0x200
+// Dequantizes S and T together and stores both with a single 64-bit write.
+template <typename T>
+__forceinline void TexCoord_Dequantize2_SSE2(const u8* src)
+{
+	const __m128i raw = _mm_cvtsi32_si128(sizeof(T) == 1 ? *(const u16*)src : *(const s32*)src);
+	const __m128i ints = DataWiden_SSE2<T>(raw);
+	const __m128 scaled = _mm_mul_ps(_mm_cvtepi32_ps(ints), _mm_load1_ps(&tcScale[tcIndex]));
+	_mm_storel_pi((__m64*)VertexManager::s_pCurBufferPointer, scaled);
+	VertexManager::s_pCurBufferPointer += sizeof(float) * 2;
+}
 
-template <typename I>
-void LOADERDECL TexCoord_ReadIndex_Short2_SSE4()
+template <typename T>
+void LOADERDECL TexCoord_ReadDirect2_SSE2()
+{
+	TexCoord_Dequantize2_SSE2<T>(DataGetPosition());
+	DataSkip<2 * sizeof(T)>();
+	LOG_TEX<2>();
+	tcIndex++;
+}
+
+template <typename I, typename T>
+void LOADERDECL TexCoord_ReadIndex2_SSE2()
 {
 	static_assert(!std::numeric_limits<I>::is_signed, "Only unsigned I is sane!");
 
 	// Heavy in ZWW
 	auto const index = DataRead<I>();
-	const s32 *pData = (const s32*)(cached_arraybases[ARRAY_TEXCOORD0+tcIndex] + (index * arraystrides[ARRAY_TEXCOORD0+tcIndex]));
-	const __m128i a = _mm_cvtsi32_si128(*pData);
-	const __m128i b = _mm_shuffle_epi8(a, kMaskSwap16_2);
-	const __m128i c = _mm_cvtepi16_epi32(b);
-	const __m128 d = _mm_cvtepi32_ps(c);
-	const __m128 e = _mm_load1_ps(&tcScale[tcIndex]);
-	const __m128 f = _mm_mul_ps(d, e);
-	_mm_storeu_ps((float*)VertexManager::s_pCurBufferPointer, f);
-	VertexManager::s_pCurBufferPointer += sizeof(float) * 2;
+	TexCoord_Dequantize2_SSE2<T>(cached_arraybases[ARRAY_TEXCOORD0+tcIndex] + (index * arraystrides[ARRAY_TEXCOORD0+tcIndex]));
 	LOG_TEX<2>();
 	tcIndex++;
 }
@@ -127,7 +140,9 @@ void LOADERDECL TexCoord_ReadIndex_Float2_SSSE3()
 }
 #endif
 
-static TPipelineFunction tableReadTexCoord[4][8][2] = {
+// Init() starts over from these, so that the loaders follow cpu_info when it
+// changes.
+static const TPipelineFunction tableReadTexCoordPortable[4][8][2] = {
 	{
 		{nullptr, nullptr,},
 		{nullptr, nullptr,},
@@ -158,6 +173,8 @@ static TPipelineFunction tableReadTexCoord[4][8][2] = {
 	},
 };
 
+static TPipelineFunction tableReadTexCoord[4][8][2];
+
 static int tableReadTexCoordVertexSize[4][8][2] = {
 	{
 		{0, 0,}, {0, 0,}, {0, 0,}, {0, 0,}, {0, 0,},
@@ -175,6 +192,7 @@ static int tableReadTexCoordVertexSize[4][8][2] = {
 
 void VertexLoader_TextCoord::Init()
 {
+	memcpy(tableReadTexCoord, tableReadTexCoordPortable, sizeof(tableReadTexCoord));
 
 #if _M_SSE >= 0x301
 
@@ -186,12 +204,24 @@ void VertexLoader_TextCoord::Init()
 
 #endif
 
-#if _M_SSE >= 0x401
+#if _M_SSE >= 0x200
 
-	if (cpu_info.bSSE4_1)
+	if (cpu_info.bSSE2)
 	{
-		tableReadTexCoord[2][3][1] = TexCoord_ReadIndex_Short2_SSE4<u8>;
-		tableReadTexCoord[3][3][1] = TexCoord_ReadIndex_Short2_SSE4<u16>;
+		tableReadTexCoord[1][0][1] = TexCoord_ReadDirect2_SSE2<u8>;
+		tableReadTexCoord[1][1][1] = TexCoord_ReadDirect2_SSE2<s8>;
+		tableReadTexCoord[1][2][1] = TexCoord_ReadDirect2_SSE2<u16>;
+		tableReadTexCoord[1][3][1] = TexCoord_ReadDirect2_SSE2<s16>;
+
+		tableReadTexCoord[2][0][1] = TexCoord_ReadIndex2_SSE2<u8, u8>;
+		tableReadTexCoord[2][1][1] = TexCoord_ReadIndex2_SSE2<u8, s8>;
+		tableReadTexCoord[2][2][1] = TexCoord_ReadIndex2_SSE2<u8, u16>;
+		tableReadTexCoord[2][3][1] = TexCoord_ReadIndex2_SSE2<u8, s16>;
+
+		tableReadTexCoord[3][0][1] = TexCoord_ReadIndex2_SSE2<u16, u8>;
+		tableReadTexCoord[3][1][1] = TexCoord_ReadIndex2_SSE2<u16, s8>;
+		tableReadTexCoord[3][2][1] = TexCoord_ReadIndex2_SSE2<u16, u16>;
+		tableReadTexCoord[3][3][1] = TexCoord_ReadIndex2_SSE2<u16, s16>;
 	}
 
 #endif
@@ -57,14 +57,14 @@ void VertexManager::PrepareForAdditionalData(int primitive, u32 count, u32 strid
 
 	// We can't merge different kinds of primitives, so we have to flush here
 	if (current_primitive_type != primitive_from_gx[primitive])
-		Flush();
+		Flush(FLUSH_PRIMITIVE_TYPE);
 	current_primitive_type = primitive_from_gx[primitive];
 
 	// Check for size in buffer, if the buffer gets full, call Flush()
 	if ( !IsFlushed && ( count > IndexGenerator::GetRemainingIndices() ||
 	     count > GetRemainingIndices(primitive) || needed_vertex_bytes > GetRemainingSize() ) )
 	{
-		Flush();
+		Flush(FLUSH_BUFFER_FULL);
 
 		if (count > IndexGenerator::GetRemainingIndices())
 			ERROR_LOG(VIDEO, "Too little remaining index values. Use 32-bit or reset them on flush.");
@@ -142,11 +142,13 @@ u32 VertexManager::GetRemainingIndices(int primitive)
 	}
 }
 
-void VertexManager::Flush()
+void VertexManager::Flush(FlushReason reason)
 {
 	if (IsFlushed)
 		return;
 
+	INCSTAT(stats.thisFrame.numFlushes[reason]);
+
 	// loading a state will invalidate BP, so check for it
 	g_video_backend->CheckInvalidState();
 
@@ -227,6 +229,7 @@ void VertexManager::Flush()
 	if (PerfQueryBase::ShouldEmulate())
 		g_perf_query->EnableQuery(bpmem.zcontrol.early_ztest ? PQG_ZCOMP_ZCOMPLOC : PQG_ZCOMP);
 	g_vertex_manager->vFlush(useDstAlpha);
+	InvalidateEFBPeekCache();
 	if (PerfQueryBase::ShouldEmulate())
 		g_perf_query->DisableQuery(bpmem.zcontrol.early_ztest ? PQG_ZCOMP_ZCOMPLOC : PQG_ZCOMP);
 
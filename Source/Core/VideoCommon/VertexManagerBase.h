@@ -12,6 +12,18 @@ enum PrimitiveType {
 	PRIMITIVE_TRIANGLES,
 };
 
+// Why queued geometry had to be drawn, counted in Statistics::ThisFrame
+enum FlushReason {
+	FLUSH_BUFFER_FULL,
+	FLUSH_PRIMITIVE_TYPE,
+	FLUSH_VERTEX_FORMAT,
+	FLUSH_TEXTURE,      // texture and TMEM registers
+	FLUSH_TEV,          // registers which are part of the pixel shader
+	FLUSH_PIXEL_STATE,  // other BP registers
+	FLUSH_TRANSFORM,    // XF registers and memory, matrix indices
+	NUM_FLUSH_REASONS
+};
+
 class VertexManager
 {
 private:
@@ -38,7 +50,7 @@ public:
 	static void PrepareForAdditionalData(int primitive, u32 count, u32 stride);
 	static u32 GetRemainingIndices(int primitive);
 
-	static void Flush();
+	static void Flush(FlushReason reason);
 
 	virtual ::NativeVertexFormat* CreateNativeVertexFormat() = 0;
 
@@ -464,9 +464,40 @@ static inline void GenerateVertexShader(T& out, u32 components, API_TYPE api_typ
 	}
 }
 
+// The UID is only rebuilt after one of the registers it depends on was written
+// (see InvalidateVertexShaderUid) or when the arguments or config changed.
+static struct
+{
+	VertexShaderUid uid;
+	bool valid;
+	u32 components;
+	API_TYPE api_type;
+	bool enablePixelLighting;
+} s_last_uid;
+
+void InvalidateVertexShaderUid()
+{
+	s_last_uid.valid = false;
+}
+
 void GetVertexShaderUid(VertexShaderUid& object, u32 components, API_TYPE api_type)
 {
+	if (s_last_uid.valid &&
+	    s_last_uid.components == components &&
+	    s_last_uid.api_type == api_type &&
+	    s_last_uid.enablePixelLighting == g_ActiveConfig.bEnablePixelLighting)
+	{
+		object = s_last_uid.uid;
+		return;
+	}
+
 	GenerateVertexShader<VertexShaderUid>(object, components, api_type);
+
+	s_last_uid.uid = object;
+	s_last_uid.valid = true;
+	s_last_uid.components = components;
+	s_last_uid.api_type = api_type;
+	s_last_uid.enablePixelLighting = g_ActiveConfig.bEnablePixelLighting;
 }
 
 void GenerateVertexShaderCode(VertexShaderCode& object, u32 components, API_TYPE api_type)
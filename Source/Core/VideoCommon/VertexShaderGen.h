@@ -63,5 +63,6 @@ typedef ShaderUid<vertex_shader_uid_data> VertexShaderUid;
 typedef ShaderCode VertexShaderCode; // TODO: Obsolete..
 
 void GetVertexShaderUid(VertexShaderUid& object, u32 components, API_TYPE api_type);
+void InvalidateVertexShaderUid();
 void GenerateVertexShaderCode(VertexShaderCode& object, u32 components, API_TYPE api_type);
 void GenerateVSOutputStructForGS(ShaderCode& object, API_TYPE api_type);
@@ -9,6 +9,7 @@
 #include "Common/MathUtil.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/CPMemory.h"
+#include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexManagerBase.h"
@@ -168,6 +169,8 @@ void VertexShaderManager::Init()
 	Dirty();
 
 	memset(&xfmem, 0, sizeof(xfmem));
+	InvalidateVertexShaderUid();
+	InvalidatePixelShaderUid();
 	memset(&constants, 0 , sizeof(constants));
 	ResetView();
 
@@ -630,7 +633,7 @@ void VertexShaderManager::SetTexMatrixChangedA(u32 Value)
 {
 	if (MatrixIndexA.Hex != Value)
 	{
-		VertexManager::Flush();
+		VertexManager::Flush(FLUSH_TRANSFORM);
 		if (MatrixIndexA.PosNormalMtxIdx != (Value&0x3f))
 			bPosNormalMatrixChanged = true;
 		bTexMatricesChanged[0] = true;
@@ -642,7 +645,7 @@ void VertexShaderManager::SetTexMatrixChangedB(u32 Value)
 {
 	if (MatrixIndexB.Hex != Value)
 	{
-		VertexManager::Flush();
+		VertexManager::Flush(FLUSH_TRANSFORM);
 		bTexMatricesChanged[1] = true;
 		MatrixIndexB.Hex = Value;
 	}
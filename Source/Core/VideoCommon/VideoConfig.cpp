@@ -56,6 +56,7 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("UseXFB", &bUseXFB, 0);
 	settings->Get("UseRealXFB", &bUseRealXFB, 0);
 	settings->Get("SafeTextureCacheColorSamples", &iSafeTextureCache_ColorSamples,128);
+	settings->Get("TextureCacheBudget", &iTextureCacheBudget, 0);
 	settings->Get("ShowFPS", &bShowFPS, false);
 	settings->Get("LogRenderTimeToFile", &bLogRenderTimeToFile, false);
 	settings->Get("ShowInputDisplay", &bShowInputDisplay, false);
@@ -68,6 +69,7 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("DumpFrames", &bDumpFrames, 0);
 	settings->Get("FreeLook", &bFreeLook, 0);
 	settings->Get("UseFFV1", &bUseFFV1, 0);
+	settings->Get("DropDumpFrames", &bDropDumpFrames, false);
 	settings->Get("AnaglyphStereo", &bAnaglyphStereo, false);
 	settings->Get("AnaglyphStereoSeparation", &iAnaglyphStereoSeparation, 200);
 	settings->Get("AnaglyphFocalAngle", &iAnaglyphFocalAngle, 0);
@@ -227,6 +229,7 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("UseXFB", bUseXFB);
 	settings->Set("UseRealXFB", bUseRealXFB);
 	settings->Set("SafeTextureCacheColorSamples", iSafeTextureCache_ColorSamples);
+	settings->Set("TextureCacheBudget", iTextureCacheBudget);
 	settings->Set("ShowFPS", bShowFPS);
 	settings->Set("LogRenderTimeToFile", bLogRenderTimeToFile);
 	settings->Set("ShowInputDisplay", bShowInputDisplay);
@@ -238,6 +241,7 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("DumpFrames", bDumpFrames);
 	settings->Set("FreeLook", bFreeLook);
 	settings->Set("UseFFV1", bUseFFV1);
+	settings->Set("DropDumpFrames", bDropDumpFrames);
 	settings->Set("AnaglyphStereo", bAnaglyphStereo);
 	settings->Set("AnaglyphStereoSeparation", iAnaglyphStereoSeparation);
 	settings->Set("AnaglyphFocalAngle", iAnaglyphFocalAngle);
@@ -65,7 +65,7 @@ struct VideoConfig final
 	bool bUseXFB;
 	bool bUseRealXFB;
 
-	// OpenMP
+	// Multithreaded texture decoding
 	bool bOMPDecoder;
 
 	// Enhancements
@@ -96,6 +96,7 @@ struct VideoConfig final
 	bool bDumpEFBTarget;
 	bool bDumpFrames;
 	bool bUseFFV1;
+	bool bDropDumpFrames;
 	bool bFreeLook;
 	bool bAnaglyphStereo;
 	int iAnaglyphStereoSeparation;
@@ -112,6 +113,7 @@ struct VideoConfig final
 	bool bCopyEFBToTexture;
 	bool bCopyEFBScaled;
 	int iSafeTextureCache_ColorSamples;
+	int iTextureCacheBudget; // MiB of host memory for cached textures, 0 for no limit
 	int iPhackvalue[3];
 	std::string sPhackvalue[2];
 	float fAspectRatioHackW, fAspectRatioHackH;
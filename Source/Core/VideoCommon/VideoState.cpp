@@ -8,9 +8,11 @@
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/PixelEngine.h"
+#include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VertexManagerBase.h"
+#include "VideoCommon/VertexShaderGen.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoState.h"
 #include "VideoCommon/XFMemory.h"
@@ -34,6 +36,12 @@ static void DoState(PointerWrap &p)
 	p.Do(xfmem);
 	p.DoMarker("XF Memory");
 
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		InvalidatePixelShaderUid();
+		InvalidateVertexShaderUid();
+	}
+
 	// Texture decoder
 	p.DoArray(texMem, TMEM_SIZE);
 	p.DoMarker("texMem");
@@ -2,22 +2,45 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "Common/CommonTypes.h"
 #include "Core/HW/Memmap.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
+#include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
+#include "VideoCommon/VertexShaderGen.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/XFMemory.h"
 
 static void XFMemWritten(u32 transferSize, u32 baseAddress)
 {
-	VertexManager::Flush();
+	VertexManager::Flush(FLUSH_TRANSFORM);
 	VertexShaderManager::InvalidateXFRange(baseAddress, baseAddress + transferSize);
 }
 
+// Lighting and texgen setup are part of both shader UIDs
+static void InvalidateShaderUids()
+{
+	InvalidateVertexShaderUid();
+	InvalidatePixelShaderUid();
+}
+
+// Whether a transfer starting at address changes any register before end
+static bool XFRegsChanged(int transferSize, u32 address, u32 end, u32 dataIndex)
+{
+	end = std::min(end, address + transferSize);
+	for (u32 i = address; i < end; ++i)
+	{
+		if (((u32*)&xfmem)[i] != DataPeek<u32>((dataIndex + i - address) * sizeof(u32)))
+			return true;
+	}
+	return false;
+}
+
 static void XFRegWritten(int transferSize, u32 baseAddress)
 {
 	u32 address = baseAddress;
@@ -50,7 +73,10 @@ static void XFRegWritten(int transferSize, u32 baseAddress)
 
 		case XFMEM_SETNUMCHAN:
 			if (xfmem.numChan.numColorChans != (newValue & 3))
-				VertexManager::Flush();
+			{
+				VertexManager::Flush(FLUSH_TRANSFORM);
+				InvalidateShaderUids();
+			}
 			break;
 
 		case XFMEM_SETCHAN0_AMBCOLOR: // Channel Ambient Color
@@ -59,7 +85,7 @@ static void XFRegWritten(int transferSize, u32 baseAddress)
 				u8 chan = address - XFMEM_SETCHAN0_AMBCOLOR;
 				if (xfmem.ambColor[chan] != newValue)
 				{
-					VertexManager::Flush();
+					VertexManager::Flush(FLUSH_TRANSFORM);
 					VertexShaderManager::SetMaterialColorChanged(chan, newValue);
 				}
 				break;
@@ -71,7 +97,7 @@ static void XFRegWritten(int transferSize, u32 baseAddress)
 				u8 chan = address - XFMEM_SETCHAN0_MATCOLOR;
 				if (xfmem.matColor[chan] != newValue)
 				{
-					VertexManager::Flush();
+					VertexManager::Flush(FLUSH_TRANSFORM);
 					VertexShaderManager::SetMaterialColorChanged(chan + 2, newValue);
 				}
 				break;
@@ -82,12 +108,18 @@ static void XFRegWritten(int transferSize, u32 baseAddress)
 		case XFMEM_SETCHAN0_ALPHA: // Channel Alpha
 		case XFMEM_SETCHAN1_ALPHA:
 			if (((u32*)&xfmem)[address] != (newValue & 0x7fff))
-				VertexManager::Flush();
+			{
+				VertexManager::Flush(FLUSH_TRANSFORM);
+				InvalidateShaderUids();
+			}
 			break;
 
 		case XFMEM_DUALTEX:
 			if (xfmem.dualTexTrans.enabled != (newValue & 1))
-				VertexManager::Flush();
+			{
+				VertexManager::Flush(FLUSH_TRANSFORM);
+				InvalidateShaderUids();
+			}
 			break;
 
 
@@ -106,9 +138,12 @@ static void XFRegWritten(int transferSize, u32 baseAddress)
 		case XFMEM_SETVIEWPORT+3:
 		case XFMEM_SETVIEWPORT+4:
 		case XFMEM_SETVIEWPORT+5:
-			VertexManager::Flush();
-			VertexShaderManager::SetViewportChanged();
-			PixelShaderManager::SetViewportChanged();
+			if (XFRegsChanged(transferSize, address, XFMEM_SETVIEWPORT + 6, dataIndex))
+			{
+				VertexManager::Flush(FLUSH_TRANSFORM);
+				VertexShaderManager::SetViewportChanged();
+				PixelShaderManager::SetViewportChanged();
+			}
 
 			nextAddress = XFMEM_SETVIEWPORT + 6;
 			break;
@@ -120,15 +155,21 @@ static void XFRegWritten(int transferSize, u32 baseAddress)
 		case XFMEM_SETPROJECTION+4:
 		case XFMEM_SETPROJECTION+5:
 		case XFMEM_SETPROJECTION+6:
-			VertexManager::Flush();
-			VertexShaderManager::SetProjectionChanged();
+			if (XFRegsChanged(transferSize, address, XFMEM_SETPROJECTION + 7, dataIndex))
+			{
+				VertexManager::Flush(FLUSH_TRANSFORM);
+				VertexShaderManager::SetProjectionChanged();
+			}
 
 			nextAddress = XFMEM_SETPROJECTION + 7;
 			break;
 
 		case XFMEM_SETNUMTEXGENS: // GXSetNumTexGens
 			if (xfmem.numTexGen.numTexGens != (newValue & 15))
-				VertexManager::Flush();
+			{
+				VertexManager::Flush(FLUSH_TRANSFORM);
+				InvalidateShaderUids();
+			}
 			break;
 
 		case XFMEM_SETTEXMTXINFO:
@@ -139,7 +180,11 @@ static void XFRegWritten(int transferSize, u32 baseAddress)
 		case XFMEM_SETTEXMTXINFO+5:
 		case XFMEM_SETTEXMTXINFO+6:
 		case XFMEM_SETTEXMTXINFO+7:
-			VertexManager::Flush();
+			if (XFRegsChanged(transferSize, address, XFMEM_SETTEXMTXINFO + 8, dataIndex))
+			{
+				VertexManager::Flush(FLUSH_TRANSFORM);
+				InvalidateShaderUids();
+			}
 
 			nextAddress = XFMEM_SETTEXMTXINFO + 8;
 			break;
@@ -152,7 +197,11 @@ static void XFRegWritten(int transferSize, u32 baseAddress)
 		case XFMEM_SETPOSMTXINFO+5:
 		case XFMEM_SETPOSMTXINFO+6:
 		case XFMEM_SETPOSMTXINFO+7:
-			VertexManager::Flush();
+			if (XFRegsChanged(transferSize, address, XFMEM_SETPOSMTXINFO + 8, dataIndex))
+			{
+				VertexManager::Flush(FLUSH_TRANSFORM);
+				InvalidateShaderUids();
+			}
 
 			nextAddress = XFMEM_SETPOSMTXINFO + 8;
 			break;
@@ -225,7 +274,18 @@ void LoadXFReg(u32 transferSize, u32 baseAddress)
 			transferSize = 0;
 		}
 
-		XFMemWritten(xfMemTransferSize, xfMemBase);
+		// Games upload the same matrices and lights over and over again, which
+		// doesn't need to end the current batch.
+		u32* currData = (u32*)&xfmem + xfMemBase;
+		for (u32 i = 0; i < xfMemTransferSize; i++)
+		{
+			if (currData[i] != DataPeek<u32>(i * sizeof(u32)))
+			{
+				XFMemWritten(xfMemTransferSize, xfMemBase);
+				break;
+			}
+		}
+
 		for (u32 i = 0; i < xfMemTransferSize; i++)
 		{
 			((u32*)&xfmem)[xfMemBase + i] = DataRead<u32>();
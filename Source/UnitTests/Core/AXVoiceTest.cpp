@@ -0,0 +1,322 @@
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/MathUtil.h"
+#include "Common/Timer.h"
+#include "Core/HW/DSP.h"
+
+#define AX_GC
+#include "Core/HW/DSPHLE/UCodes/AXVoice.h"
+
+#include <gtest/gtest.h>
+
+// The sample by sample implementations the batch kernels replace.
+namespace Reference
+{
+
+static void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
+{
+	u16& volume = pvol[0];
+	u16 volume_delta = pvol[1];
+	if (!ramp)
+		volume_delta = 0;
+
+	for (u32 i = 0; i < count; ++i)
+	{
+		s64 sample = input[i];
+		sample *= volume;
+		sample >>= 15;
+
+		out[i] += (s16)sample;
+		volume += volume_delta;
+
+		*dpop = (s16)sample;
+	}
+}
+
+static void ApplyVolumeRamp(s16* samples, u32 count, u16* volume, s16 volume_delta)
+{
+	for (u32 i = 0; i < count; ++i)
+	{
+		samples[i] = ((s32)samples[i] * *volume) >> 15;
+		*volume += volume_delta;
+	}
+}
+
+static u32 ResampleAudio(const s16* input, u32* read_count, s16* output, u32 count,
+                         s16* last_samples, u32 curr_pos, u32 ratio, int srctype)
+{
+	u32 read_samples_count = 0;
+	if (srctype == SRCTYPE_LINEAR || srctype == SRCTYPE_POLYPHASE)
+	{
+		s16 temp[4];
+		u32 idx = 0;
+
+		temp[idx++ & 3] = last_samples[0];
+		temp[idx++ & 3] = last_samples[1];
+		temp[idx++ & 3] = last_samples[2];
+		temp[idx++ & 3] = last_samples[3];
+
+		for (u32 i = 0; i < count; ++i)
+		{
+			curr_pos += ratio;
+			while (curr_pos >= 0x10000)
+			{
+				temp[idx++ & 3] = input[read_samples_count++];
+				curr_pos -= 0x10000;
+			}
+
+			u16 curr_frac = curr_pos & 0xFFFF;
+			u16 inv_curr_frac = -curr_frac;
+
+			s16 sample;
+			if (curr_frac)
+			{
+				s32 s0 = temp[idx++ & 3];
+				s32 s1 = temp[idx++ & 3];
+
+				sample = ((s0 * inv_curr_frac) + (s1 * curr_frac)) >> 16;
+				idx += 2;
+			}
+			else
+			{
+				sample = temp[idx++ & 3];
+				idx += 3;
+			}
+
+			output[i] = sample;
+		}
+
+		last_samples[3] = temp[--idx & 3];
+		last_samples[2] = temp[--idx & 3];
+		last_samples[1] = temp[--idx & 3];
+		last_samples[0] = temp[--idx & 3];
+	}
+	else
+	{
+		for (u32 i = 0; i < count; ++i)
+			output[i] = input[read_samples_count++];
+
+		memcpy(last_samples, output + count - 4, 4 * sizeof (u16));
+	}
+
+	*read_count = read_samples_count;
+	return curr_pos;
+}
+
+}  // namespace Reference
+
+static s16 RandomSample()
+{
+	return (s16)(rand() ^ (rand() << 8));
+}
+
+TEST(AXVoice, MixAddMatchesReference)
+{
+	srand(0xa0);
+	for (u32 count = 0; count < 100; ++count)
+	{
+		for (int ramp = 0; ramp < 2; ++ramp)
+		{
+			std::vector<s16> input(count);
+			for (s16& sample : input)
+				sample = RandomSample();
+
+			std::vector<int> out(count), expected_out(count);
+			for (u32 i = 0; i < count; ++i)
+				out[i] = expected_out[i] = rand() - RAND_MAX / 2;
+
+			u16 vol[2] = { (u16)rand(), (u16)rand() };
+			u16 expected_vol[2] = { vol[0], vol[1] };
+			s16 dpop = 0x1234, expected_dpop = 0x1234;
+
+			MixAdd(out.data(), input.data(), count, vol, &dpop, ramp != 0);
+			Reference::MixAdd(expected_out.data(), input.data(), count, expected_vol, &expected_dpop, ramp != 0);
+
+			ASSERT_TRUE(expected_out == out) << count << " samples, ramp " << ramp;
+			ASSERT_EQ(expected_vol[0], vol[0]);
+			ASSERT_EQ(expected_dpop, dpop);
+		}
+	}
+}
+
+TEST(AXVoice, VolumeRampMatchesReference)
+{
+	srand(0xa1);
+	for (u32 count = 0; count < 100; ++count)
+	{
+		std::vector<s16> samples(count);
+		for (s16& sample : samples)
+			sample = RandomSample();
+		std::vector<s16> expected = samples;
+
+		u16 volume = (u16)rand(), expected_volume = volume;
+		s16 delta = RandomSample();
+
+		ApplyVolumeRamp(samples.data(), count, &volume, delta);
+		Reference::ApplyVolumeRamp(expected.data(), count, &expected_volume, delta);
+
+		ASSERT_TRUE(expected == samples) << count << " samples";
+		ASSERT_EQ(expected_volume, volume);
+	}
+}
+
+TEST(AXVoice, ResampleMatchesReference)
+{
+	static const u32 ratios[] = { 0x200, 0x8000, 0xFFFF, 0x10000, 0x10001, 0x12345, 0x18000, 0x40000, 0x55555 };
+	static const int srctypes[] = { SRCTYPE_LINEAR, SRCTYPE_NEAREST };
+
+	srand(0xa2);
+	for (int srctype : srctypes)
+	{
+		for (u32 ratio : ratios)
+		{
+			for (int iteration = 0; iteration < 20; ++iteration)
+			{
+				const u32 count = iteration & 1 ? 32 : 96;
+				u32 curr_pos = iteration ? rand() & 0xFFFF : 0;
+
+				s16 last_samples[4], expected_last_samples[4];
+				for (int i = 0; i < 4; ++i)
+					last_samples[i] = expected_last_samples[i] = RandomSample();
+
+				u32 input_count = GetResampleInputCount(count, curr_pos, ratio, srctype);
+				std::vector<s16> input(4 + input_count);
+				memcpy(input.data(), last_samples, sizeof (last_samples));
+				for (u32 i = 4; i < input.size(); ++i)
+					input[i] = RandomSample();
+
+				s16 output[96], expected_output[96];
+				u32 pos = ResampleAudio(input.data(), output, count, last_samples, curr_pos, ratio, srctype, nullptr);
+
+				u32 read_count;
+				u32 expected_pos = Reference::ResampleAudio(input.data() + 4, &read_count, expected_output, count,
+				                                            expected_last_samples, curr_pos, ratio, srctype);
+
+				ASSERT_EQ(read_count, input_count) << "ratio " << ratio;
+				ASSERT_EQ(expected_pos, pos) << "ratio " << ratio;
+				ASSERT_EQ(0, memcmp(expected_output, output, count * sizeof (s16))) << "ratio " << ratio;
+				ASSERT_EQ(0, memcmp(expected_last_samples, last_samples, sizeof (last_samples))) << "ratio " << ratio;
+			}
+		}
+	}
+}
+
+class AXAcceleratorTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		DSP::Init(true, false);
+		srand(0xa3);
+		u8* aram = DSP::GetARAMPtr();
+		for (u32 i = 0; i < 0x1000; ++i)
+			aram[i] = (u8)rand();
+	}
+
+	void TearDown() override
+	{
+		DSP::Shutdown();
+	}
+
+	// Reads samples in batches and one by one from two copies of the same PB
+	// and checks that the samples and the final PBs match.
+	void ExpectMatchesSampleBySample(const AXPB& pb, u32 batch_size, u32 batches)
+	{
+		AXPB pb_batch = pb, pb_single = pb;
+		u32 addr_batch = HILO_TO_32(pb.audio_addr.cur_addr);
+		u32 addr_single = addr_batch;
+
+		AcceleratorState acc_batch, acc_single;
+		AcceleratorSetup(&acc_batch, &pb_batch, &addr_batch);
+		AcceleratorSetup(&acc_single, &pb_single, &addr_single);
+
+		std::vector<s16> samples(batch_size);
+		for (u32 b = 0; b < batches; ++b)
+		{
+			AcceleratorGetSamples(&acc_batch, samples.data(), batch_size);
+			for (u32 i = 0; i < batch_size; ++i)
+				ASSERT_EQ((s16)AcceleratorGetSample(&acc_single), samples[i]) << "batch " << b << ", sample " << i;
+			ASSERT_EQ(addr_single, addr_batch);
+		}
+		EXPECT_EQ(0, memcmp(&pb_single, &pb_batch, sizeof (AXPB)));
+	}
+
+	static AXPB MakePB(u16 format, u32 start, u32 loop, u32 end, bool looping)
+	{
+		AXPB pb;
+		memset(&pb, 0, sizeof (pb));
+		pb.running = 1;
+		pb.audio_addr.sample_format = format;
+		pb.audio_addr.looping = looping;
+		pb.audio_addr.cur_addr_hi = start >> 16;
+		pb.audio_addr.cur_addr_lo = start & 0xFFFF;
+		pb.audio_addr.loop_addr_hi = loop >> 16;
+		pb.audio_addr.loop_addr_lo = loop & 0xFFFF;
+		pb.audio_addr.end_addr_hi = end >> 16;
+		pb.audio_addr.end_addr_lo = end & 0xFFFF;
+		for (s16& coef : pb.adpcm.coefs)
+			coef = RandomSample() >> 4;
+		pb.adpcm.pred_scale = rand() & 0x7F;
+		pb.adpcm.yn1 = RandomSample();
+		pb.adpcm.yn2 = RandomSample();
+		pb.adpcm_loop_info.pred_scale = rand() & 0x7F;
+		pb.adpcm_loop_info.yn1 = RandomSample();
+		pb.adpcm_loop_info.yn2 = RandomSample();
+		return pb;
+	}
+};
+
+TEST_F(AXAcceleratorTest, ADPCMMatchesSampleBySample)
+{
+	for (u32 end = 0x202; end < 0x220; ++end)
+	{
+		for (int looping = 0; looping < 2; ++looping)
+		{
+			for (u32 batch_size : { 1u, 7u, 32u, 96u })
+			{
+				AXPB pb = MakePB(0x00, 0x102, 0x142 + (end & 7), end, looping != 0);
+				pb.is_stream = end & 1;
+				ExpectMatchesSampleBySample(pb, batch_size, 960 / batch_size);
+			}
+		}
+	}
+}
+
+TEST_F(AXAcceleratorTest, PCMMatchesSampleBySample)
+{
+	for (u16 format : { 0x0A, 0x19 })
+	{
+		for (int looping = 0; looping < 2; ++looping)
+		{
+			AXPB pb = MakePB(format, 0x100, 0x120, 0x17F, looping != 0);
+			ExpectMatchesSampleBySample(pb, 32, 20);
+		}
+	}
+}
+
+TEST_F(AXAcceleratorTest, DISABLED_VoiceSpeed)
+{
+	const int iterations = 200000;
+	int out[32 * 5] = {};
+	s16 samples[32];
+
+	AXPB pb = MakePB(0x00, 0x102, 0x102, 0x1F00, true);
+	pb.src_type = SRCTYPE_LINEAR;
+	pb.src.ratio_hi = 1;
+	pb.src.ratio_lo = 0x2345;
+	pb.mixer.left = 0x7000;
+
+	u32 start = Common::Timer::GetTimeMs();
+	for (int i = 0; i < iterations; ++i)
+	{
+		GetInputSamples(pb, samples, 32, nullptr);
+		ApplyVolumeRamp(samples, 32, &pb.vol_env.cur_volume, pb.vol_env.cur_volume_delta);
+		MixAdd(out, samples, 32, &pb.mixer.left, &pb.dpop.left, true);
+	}
+	u32 elapsed = Common::Timer::GetTimeMs() - start;
+
+	printf("%.3f us per voice per ms\n", elapsed * 1000.0 / iterations);
+}
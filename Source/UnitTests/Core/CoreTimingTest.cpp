@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+#include "Common/Timer.h"
+#include "Core/CoreTiming.h"
+#include "Core/PowerPC/PowerPC.h"
+
+#include <gtest/gtest.h>
+
+static std::vector<u64> s_fired;
+
+static void RecordCallback(u64 userdata, int cyclesLate)
+{
+	s_fired.push_back(userdata);
+}
+
+static void NopCallback(u64 userdata, int cyclesLate)
+{
+}
+
+class CoreTimingTest : public testing::Test
+{
+protected:
+	virtual void SetUp() override
+	{
+		s_fired.clear();
+		CoreTiming::Init();
+		m_type_a = CoreTiming::RegisterEvent("A", &RecordCallback);
+		m_type_b = CoreTiming::RegisterEvent("B", &RecordCallback);
+	}
+
+	virtual void TearDown() override
+	{
+		CoreTiming::Shutdown();
+	}
+
+	// Pretends the CPU ran for the given number of cycles.
+	void AdvanceBy(int cycles)
+	{
+		while (cycles > 0)
+		{
+			int step = std::min(cycles, PowerPC::ppcState.downcount);
+			PowerPC::ppcState.downcount -= step;
+			cycles -= step;
+			CoreTiming::Advance();
+		}
+	}
+
+	int m_type_a;
+	int m_type_b;
+};
+
+TEST_F(CoreTimingTest, RunsInTimeOrder)
+{
+	CoreTiming::ScheduleEvent(300, m_type_a, 3);
+	CoreTiming::ScheduleEvent(100, m_type_b, 1);
+	CoreTiming::ScheduleEvent(200, m_type_a, 2);
+
+	AdvanceBy(150);
+	EXPECT_EQ(std::vector<u64>({ 1 }), s_fired);
+	AdvanceBy(200);
+	EXPECT_EQ(std::vector<u64>({ 1, 2, 3 }), s_fired);
+}
+
+TEST_F(CoreTimingTest, SameTimeKeepsScheduleOrder)
+{
+	for (u64 i = 0; i < 50; ++i)
+		CoreTiming::ScheduleEvent(100, (i & 1) ? m_type_a : m_type_b, i);
+
+	AdvanceBy(100);
+	ASSERT_EQ(50u, s_fired.size());
+	for (u64 i = 0; i < 50; ++i)
+		EXPECT_EQ(i, s_fired[i]);
+}
+
+TEST_F(CoreTimingTest, RemoveEvent)
+{
+	for (u64 i = 0; i < 20; ++i)
+		CoreTiming::ScheduleEvent(100 + (int)(i * 37 % 20), (i & 1) ? m_type_a : m_type_b, i);
+
+	EXPECT_TRUE(CoreTiming::IsScheduled(m_type_a));
+	CoreTiming::RemoveEvent(m_type_a);
+	EXPECT_FALSE(CoreTiming::IsScheduled(m_type_a));
+	EXPECT_TRUE(CoreTiming::IsScheduled(m_type_b));
+
+	AdvanceBy(200);
+	ASSERT_EQ(10u, s_fired.size());
+	for (u64 userdata : s_fired)
+		EXPECT_EQ(0u, userdata & 1);
+	EXPECT_FALSE(CoreTiming::IsScheduled(m_type_b));
+}
+
+TEST_F(CoreTimingTest, ThreadsafeFromOtherThreads)
+{
+	std::vector<std::thread> threads;
+	for (u64 t = 0; t < 4; ++t)
+	{
+		threads.emplace_back([this, t] {
+			for (u64 i = 0; i < 1000; ++i)
+				CoreTiming::ScheduleEvent_Threadsafe(0, m_type_a, (t << 32) | i);
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	AdvanceBy(1);
+	ASSERT_EQ(4000u, s_fired.size());
+
+	// Each thread's events run in the order it scheduled them.
+	u64 next[4] = {};
+	for (u64 userdata : s_fired)
+		EXPECT_EQ(next[userdata >> 32]++, userdata & 0xFFFFFFFF);
+}
+
+TEST_F(CoreTimingTest, DoStateKeepsOrder)
+{
+	CoreTiming::ScheduleEvent(200, m_type_a, 1);
+	CoreTiming::ScheduleEvent(100, m_type_b, 2);
+	CoreTiming::ScheduleEvent(200, m_type_b, 3);
+	CoreTiming::ScheduleEvent_Threadsafe(300, m_type_a, 4);
+
+	u8* ptr = nullptr;
+	PointerWrap p_measure(&ptr, PointerWrap::MODE_MEASURE);
+	CoreTiming::DoState(p_measure);
+	std::vector<u8> buffer((size_t)ptr);
+
+	ptr = buffer.data();
+	PointerWrap p_write(&ptr, PointerWrap::MODE_WRITE);
+	CoreTiming::DoState(p_write);
+
+	CoreTiming::RemoveEvent(m_type_a);
+	CoreTiming::ScheduleEvent(50, m_type_a, 5);
+
+	ptr = buffer.data();
+	PointerWrap p_read(&ptr, PointerWrap::MODE_READ);
+	CoreTiming::DoState(p_read);
+	EXPECT_EQ(buffer.data() + buffer.size(), ptr);
+
+	AdvanceBy(400);
+	EXPECT_EQ(std::vector<u64>({ 2, 1, 3, 4 }), s_fired);
+}
+
+TEST_F(CoreTimingTest, DISABLED_ScheduleSpeed)
+{
+	const int iterations = 2000000;
+	const int num_types = 32;
+
+	int types[num_types];
+	for (int i = 0; i < num_types; ++i)
+	{
+		types[i] = CoreTiming::RegisterEvent(StringFromFormat("Speed%d", i), &NopCallback);
+		CoreTiming::ScheduleEvent(1000 + i * 997 % 20000, types[i]);
+	}
+
+	u32 start = Common::Timer::GetTimeMs();
+	for (int i = 0; i < iterations; ++i)
+	{
+		int type = types[i % num_types];
+		CoreTiming::RemoveEvent(type);
+		CoreTiming::ScheduleEvent(1000 + (int)((u32)i * 7919 % 20000), type);
+		if (!CoreTiming::IsScheduled(types[(i * 13) % num_types]))
+			CoreTiming::ScheduleEvent(i % 5000, types[(i * 13) % num_types]);
+		PowerPC::ppcState.downcount -= std::min(100, PowerPC::ppcState.downcount);
+		CoreTiming::Advance();
+	}
+	u32 elapsed = Common::Timer::GetTimeMs() - start;
+
+	printf("%.1f ns per reschedule\n", elapsed * 1000000.0 / iterations);
+}
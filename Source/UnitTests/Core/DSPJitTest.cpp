@@ -0,0 +1,158 @@
+#include <cstring>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/DSP/DSPAnalyzer.h"
+#include "Core/DSP/DSPCore.h"
+#include "Core/DSP/DSPEmitter.h"
+#include "Core/DSP/DSPTables.h"
+
+#include <gtest/gtest.h>
+
+// Runs a few hand assembled blocks that jump to each other in all the ways
+// that can be linked: a loop end going back to the start of its block, calls,
+// and conditional jumps.
+class DSPJitTest : public testing::Test
+{
+protected:
+	static void SetUpTestCase()
+	{
+		// The DSP host reads from the config whether the DSP runs on a thread.
+		// Loading and saving the config writes to the user directory, so use
+		// a scratch one.
+		File::CreateDir(USER_DIR);
+		File::GetUserPath(D_USER_IDX, USER_DIR);
+		SConfig::Init();
+
+		// Done by DSPLLE::Initialize in the emulator.
+		InitInstructionTable();
+	}
+
+	static void TearDownTestCase()
+	{
+		SConfig::Shutdown();
+		File::DeleteDirRecursively(USER_DIR);
+	}
+
+	void SetUp() override
+	{
+		m_iram.assign(DSP_IRAM_SIZE, 0x0021); // HALT
+		m_irom.assign(DSP_IROM_SIZE, 0x0021);
+		m_dram.assign(DSP_DRAM_SIZE, 0);
+		m_coef.assign(DSP_COEF_SIZE, 0);
+		g_dsp.iram = m_iram.data();
+		g_dsp.irom = m_irom.data();
+		g_dsp.dram = m_dram.data();
+		g_dsp.coef = m_coef.data();
+
+		static const u16 program[] = {
+			0x009c, 0x0040, // 0000 LRI $ac0.l, #64
+			0x1008,         // 0002 LOOPI #8
+			0x0008,         // 0003 IAR $ar0
+			0x02bf, 0x0010, // 0004 CALL 0x0010
+			0x7a00,         // 0006 DEC $acc0
+			0x0294, 0x0002, // 0007 JNZ 0x0002
+			0x0021,         // 0009 HALT
+		};
+		memcpy(m_iram.data(), program, sizeof(program));
+		m_iram[0x10] = 0x0009; // IAR $ar1
+		m_iram[0x11] = 0x02df; // RET
+	}
+
+	void TearDown() override
+	{
+		delete dspjit;
+		dspjit = nullptr;
+	}
+
+	// Resets the DSP and a JIT for it, like DSPCore_Init does.
+	void Reset(bool collect_stats)
+	{
+		memset(&g_dsp.r, 0, sizeof(g_dsp.r));
+		memset(g_dsp.reg_stack_ptr, 0, sizeof(g_dsp.reg_stack_ptr));
+		for (u16& wr : g_dsp.r.wr)
+			wr = 0xffff;
+		g_dsp.r.sr = SR_INT_ENABLE | SR_EXT_INT_ENABLE;
+		g_dsp.cr = 0x800;
+		g_dsp.pc = 0;
+		g_dsp.exceptions = 0;
+		g_dsp.external_interrupt_waiting = false;
+		DSPAnalyzer::Analyze();
+
+		delete dspjit;
+		dspjit = new DSPEmitter(collect_stats);
+	}
+
+	// Runs time slices until the program halts, and returns how many it took.
+	static int RunToHalt(int cycles_per_slice)
+	{
+		int slices = 0;
+		while (!(g_dsp.cr & CR_HALT) && slices < 100000)
+		{
+			int left = DSPCore_RunCycles(cycles_per_slice);
+			// At most the last block may go past the end of the slice.
+			EXPECT_GT((s16)left, -MAX_BLOCK_SIZE);
+			++slices;
+		}
+		return slices;
+	}
+
+	static const char USER_DIR[];
+
+	std::vector<u16> m_iram, m_irom, m_dram, m_coef;
+};
+
+const char DSPJitTest::USER_DIR[] = "DSPJitTestUser/";
+
+TEST_F(DSPJitTest, LinkedBlocksRunTheProgram)
+{
+	Reset(true);
+	RunToHalt(0x4000);
+	EXPECT_EQ(64 * 8, g_dsp.r.ar[0]);
+	EXPECT_EQ(64, g_dsp.r.ar[1]);
+	EXPECT_EQ(0, g_dsp.r.ac[0].l);
+
+	// Setting up and leaving the loop, and the returns go through the
+	// dispatcher. The loop's back edges, the calls and the conditional jumps
+	// are linked, apart from the first time, when their destinations are not
+	// compiled yet.
+	const DSPJitStats& stats = g_dsp_jit_stats;
+	EXPECT_LE(stats.dispatcher_exits, 64u * 3 + 4);
+	EXPECT_GE(stats.linked_jumps, 64u * 9 - 4);
+	EXPECT_GE(stats.link_checks, stats.linked_jumps);
+}
+
+TEST_F(DSPJitTest, LinksStayInTheTimeSlice)
+{
+	// The program takes about 900 cycles.
+	Reset(false);
+	EXPECT_GE(RunToHalt(100), 8);
+	EXPECT_EQ(64 * 8, g_dsp.r.ar[0]);
+	EXPECT_EQ(64, g_dsp.r.ar[1]);
+
+	// Nothing is counted unless asked for.
+	EXPECT_EQ(0u, g_dsp_jit_stats.dispatcher_exits);
+	EXPECT_EQ(0u, g_dsp_jit_stats.link_checks);
+	EXPECT_EQ(0u, g_dsp_jit_stats.linked_jumps);
+}
+
+TEST_F(DSPJitTest, ClearedIRAMIsNotLinkedTo)
+{
+	Reset(false);
+	RunToHalt(0x4000);
+
+	// Like a DMA of a new ucode into IRAM, after all the blocks were linked.
+	m_iram[0x10] = 0x000a; // IAR $ar2
+	dspjit->ClearIRAM();
+	memset(&g_dsp.r.ar, 0, sizeof(g_dsp.r.ar));
+	g_dsp.cr = 0x800;
+	g_dsp.pc = 0;
+	DSPAnalyzer::Analyze();
+
+	RunToHalt(0x4000);
+	EXPECT_EQ(64 * 8, g_dsp.r.ar[0]);
+	EXPECT_EQ(0, g_dsp.r.ar[1]);
+	EXPECT_EQ(64, g_dsp.r.ar[2]);
+}
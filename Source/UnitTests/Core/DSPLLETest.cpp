@@ -0,0 +1,35 @@
+#include "Common/CommonTypes.h"
+#include "Core/DSP/DSPEmitter.h"
+#include "Core/HW/DSPLLE/DSPLLE.h"
+
+#include <gtest/gtest.h>
+
+TEST(DSPLLE, CyclesRunWithoutInterrupt)
+{
+	EXPECT_EQ(2100u, DSPLLE::CyclesRun(2100, 0, false));
+	// Stopped early, but not for an interrupt (halted).
+	EXPECT_EQ(2100u, DSPLLE::CyclesRun(2100, 1000, false));
+}
+
+TEST(DSPLLE, CyclesRunOvershoot)
+{
+	// The last block ran 40 cycles past the end, which wraps the u16 count.
+	u16 wrapped = (u16)(0 - 40);
+	EXPECT_EQ(2100u, DSPLLE::CyclesRun(2100, wrapped, false));
+	// The interrupt flag may have been raised right after a normal exit.
+	EXPECT_EQ(2100u, DSPLLE::CyclesRun(2100, wrapped, true));
+	// An idle skip overshoots by far more than a block.
+	EXPECT_EQ(2100u, DSPLLE::CyclesRun(2100, (u16)(2100 - 0x1000), true));
+	const u32 most = DSPLLE::MAX_CYCLES_PER_RUN;
+	EXPECT_EQ(most, DSPLLE::CyclesRun(most, (u16)(0 - MAX_BLOCK_SIZE), true));
+	EXPECT_EQ(most, DSPLLE::CyclesRun(most, (u16)(0 - 0x1000), true));
+}
+
+TEST(DSPLLE, CyclesRunInterrupted)
+{
+	EXPECT_EQ(100u, DSPLLE::CyclesRun(2100, 2000, true));
+	EXPECT_EQ(0u, DSPLLE::CyclesRun(2100, 2100, true));
+	// Less than a block left isn't worth another pass.
+	EXPECT_EQ(2100u, DSPLLE::CyclesRun(2100, MAX_BLOCK_SIZE - 1, true));
+	EXPECT_EQ(2100u - MAX_BLOCK_SIZE, DSPLLE::CyclesRun(2100, MAX_BLOCK_SIZE, true));
+}
@@ -0,0 +1,148 @@
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <lzo/lzo1x.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+
+#include <gtest/gtest.h>
+
+class FifoDataFileTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		// Done by State::Init() in the emulator.
+		ASSERT_EQ(LZO_E_OK, lzo_init());
+		srand(0xf1f0);
+		m_filename = "FifoDataFileTest.dff";
+	}
+
+	void TearDown() override
+	{
+		File::Delete(m_filename);
+	}
+
+	// Frames with some random FIFO data, a texture that is uploaded again
+	// every frame, and a vertex stream that changes every frame. Random data
+	// doesn't compress, so the file size shows how often it was written.
+	void Record(FifoDataFile* file, u32 num_frames)
+	{
+		file->SetIsWii(true);
+		for (int i = 0; i < FifoDataFile::BP_MEM_SIZE; ++i)
+			file->GetBPMem()[i] = rand();
+		for (int i = 0; i < FifoDataFile::XF_REGS_SIZE; ++i)
+			file->GetXFRegs()[i] = rand();
+
+		std::vector<u8> texture(TEXTURE_SIZE);
+		for (u8& b : texture)
+			b = (u8)rand();
+
+		for (u32 frame = 0; frame < num_frames; ++frame)
+		{
+			FifoFrameInfo info;
+			info.fifoDataSize = 1000 + frame;
+			info.fifoData = new u8[info.fifoDataSize];
+			for (u32 i = 0; i < info.fifoDataSize; ++i)
+				info.fifoData[i] = (u8)rand();
+			info.fifoStart = 0x1000 * frame;
+			info.fifoEnd = info.fifoStart + info.fifoDataSize;
+
+			MemoryUpdate update;
+			update.fifoPosition = 32;
+			update.address = 0x00400000;
+			update.size = (u32)texture.size();
+			update.type = MemoryUpdate::TEXTURE_MAP;
+			update.data = file->StoreMemoryUpdateData(texture.data(), update.size);
+			info.memoryUpdates.push_back(update);
+
+			u8 vertices[96];
+			for (u8& b : vertices)
+				b = (u8)rand();
+			update.fifoPosition = 500;
+			update.address = 0x00800000 + frame * sizeof (vertices);
+			update.size = sizeof (vertices);
+			update.type = MemoryUpdate::VERTEX_STREAM;
+			update.data = file->StoreMemoryUpdateData(vertices, update.size);
+			info.memoryUpdates.push_back(update);
+
+			file->AddFrame(info);
+		}
+	}
+
+	static const u32 TEXTURE_SIZE = 0x10000;
+
+	std::string m_filename;
+};
+
+TEST_F(FifoDataFileTest, RoundTrip)
+{
+	FifoDataFile recorded;
+	Record(&recorded, 10);
+	ASSERT_TRUE(recorded.Save(m_filename));
+
+	std::unique_ptr<FifoDataFile> loaded(FifoDataFile::Load(m_filename, false));
+	ASSERT_TRUE(loaded != nullptr);
+
+	EXPECT_TRUE(loaded->GetIsWii());
+	EXPECT_EQ(0, memcmp(recorded.GetBPMem(), loaded->GetBPMem(), FifoDataFile::BP_MEM_SIZE * sizeof (u32)));
+	EXPECT_EQ(0, memcmp(recorded.GetXFRegs(), loaded->GetXFRegs(), FifoDataFile::XF_REGS_SIZE * sizeof (u32)));
+
+	ASSERT_EQ(recorded.GetFrameCount(), loaded->GetFrameCount());
+	for (u32 i = 0; i < recorded.GetFrameCount(); ++i)
+	{
+		const FifoFrameInfo& expected = recorded.GetFrame(i);
+		const FifoFrameInfo& frame = loaded->GetFrame(i);
+		EXPECT_EQ(expected.fifoStart, frame.fifoStart) << "frame " << i;
+		EXPECT_EQ(expected.fifoEnd, frame.fifoEnd) << "frame " << i;
+		ASSERT_EQ(expected.fifoDataSize, frame.fifoDataSize) << "frame " << i;
+		EXPECT_EQ(0, memcmp(expected.fifoData, frame.fifoData, frame.fifoDataSize)) << "frame " << i;
+
+		ASSERT_EQ(expected.memoryUpdates.size(), frame.memoryUpdates.size()) << "frame " << i;
+		for (size_t j = 0; j < frame.memoryUpdates.size(); ++j)
+		{
+			const MemoryUpdate& expected_update = expected.memoryUpdates[j];
+			const MemoryUpdate& update = frame.memoryUpdates[j];
+			EXPECT_EQ(expected_update.fifoPosition, update.fifoPosition);
+			EXPECT_EQ(expected_update.address, update.address);
+			EXPECT_EQ(expected_update.type, update.type);
+			ASSERT_EQ(expected_update.size, update.size);
+			EXPECT_EQ(0, memcmp(expected_update.data, update.data, update.size)) << "frame " << i << ", update " << j;
+		}
+	}
+}
+
+TEST_F(FifoDataFileTest, RepeatedUpdatesAreStoredOnce)
+{
+	FifoDataFile recorded;
+	Record(&recorded, 10);
+	ASSERT_TRUE(recorded.Save(m_filename));
+
+	// The texture is written only once.
+	EXPECT_LT(File::GetSize(m_filename), 2 * TEXTURE_SIZE);
+
+	std::unique_ptr<FifoDataFile> loaded(FifoDataFile::Load(m_filename, false));
+	ASSERT_TRUE(loaded != nullptr);
+	const u8* texture = loaded->GetFrame(0).memoryUpdates[0].data;
+	for (u32 i = 1; i < loaded->GetFrameCount(); ++i)
+	{
+		EXPECT_EQ(texture, loaded->GetFrame(i).memoryUpdates[0].data) << "frame " << i;
+		EXPECT_NE(loaded->GetFrame(i - 1).memoryUpdates[1].data, loaded->GetFrame(i).memoryUpdates[1].data) << "frame " << i;
+	}
+}
+
+TEST_F(FifoDataFileTest, FlagsOnly)
+{
+	FifoDataFile recorded;
+	Record(&recorded, 2);
+	ASSERT_TRUE(recorded.Save(m_filename));
+
+	std::unique_ptr<FifoDataFile> loaded(FifoDataFile::Load(m_filename, true));
+	ASSERT_TRUE(loaded != nullptr);
+	EXPECT_TRUE(loaded->GetIsWii());
+	EXPECT_EQ(0u, loaded->GetFrameCount());
+}
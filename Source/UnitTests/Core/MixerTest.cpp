@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "AudioCommon/Mixer.h"
+#include "Common/CommonFuncs.h"
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/PowerPC.h"
+
+#include <gtest/gtest.h>
+
+// By default, both the DMA input and the output run at 32 kHz, so the
+// resampler only drifts by the fifo level control.
+class TestMixer : public CMixer
+{
+public:
+	explicit TestMixer(unsigned int sample_rate = 32000) : CMixer(sample_rate) {}
+
+	using CMixer::ResampleSample;
+	using CMixer::ResampleSampleScalar;
+};
+
+class MixerTest : public testing::Test
+{
+protected:
+	virtual void SetUp() override
+	{
+		// Mix only outputs silence while the CPU isn't running.
+		PowerPC::Start();
+		m_pushed = 0;
+	}
+
+	virtual void TearDown() override
+	{
+		PowerPC::Stop();
+	}
+
+	// Pushes big endian DMA samples of a constant level.
+	void PushConstant(s16 left, s16 right, unsigned int num_samples)
+	{
+		std::vector<short> samples(num_samples * 2);
+		for (unsigned int i = 0; i < num_samples; ++i)
+		{
+			samples[i * 2] = Common::swap16(left);
+			samples[i * 2 + 1] = Common::swap16(right);
+		}
+		m_mixer.PushSamples(samples.data(), num_samples);
+		m_pushed += num_samples;
+	}
+
+	// Mixes num_samples and checks them from the first_checked one on.
+	void MixExpecting(s16 left, s16 right, unsigned int num_samples, unsigned int first_checked = 0)
+	{
+		std::vector<short> samples(num_samples * 2);
+		m_mixer.Mix(samples.data(), num_samples, false);
+		// The DMA fifo hands its pairs to the output swapped.
+		for (unsigned int i = first_checked; i < num_samples; ++i)
+		{
+			ASSERT_EQ(right, samples[i * 2]) << "sample " << i;
+			ASSERT_EQ(left, samples[i * 2 + 1]) << "sample " << i;
+		}
+	}
+
+	// Switches to a new level, then pushes and mixes it until both the
+	// reads and writes went past the end of the ring buffer. The writes
+	// either wrap around mid-push, or stop at the end and start over with
+	// a short push, so that they start both at and inside the region that
+	// is mirrored after the end.
+	void CrossRingEnd(s16 left, s16 right, bool wrap_mid_push)
+	{
+		// Running the fifo dry leaves less than a filter's worth of the old
+		// level behind.
+		std::vector<short> samples(256 * 2);
+		unsigned int underruns = m_mixer.GetUnderruns();
+		while (m_mixer.GetUnderruns() == underruns)
+			m_mixer.Mix(samples.data(), 256, false);
+
+		PushConstant(left, right, 300);
+		MixExpecting(left, right, 256, RESAMPLER_TAPS * 2);
+
+		unsigned int end = (m_pushed / MAX_SAMPLES + 1) * MAX_SAMPLES;
+		while (m_pushed < end + 1024)
+		{
+			unsigned int position = m_pushed % MAX_SAMPLES;
+			unsigned int count = 300;
+			if (position == 0)
+				count = 8;
+			else if (!wrap_mid_push)
+				count = std::min(count, MAX_SAMPLES - position);
+			PushConstant(left, right, count);
+			MixExpecting(left, right, count);
+		}
+		EXPECT_EQ(underruns + 1, m_mixer.GetUnderruns());
+	}
+
+	TestMixer m_mixer;
+	// Stereo samples pushed so far. Until the fifo fills up and drops a
+	// push, this is also where the next one starts.
+	unsigned int m_pushed;
+};
+
+TEST_F(MixerTest, DCPassesThrough)
+{
+	// Pushing a little more than is mixed keeps the fifo from running dry
+	// and goes around the ring buffer several times.
+	for (int i = 0; i < 64; ++i)
+	{
+		PushConstant(1000, -3000, 300);
+		MixExpecting(1000, -3000, 256);
+	}
+	EXPECT_EQ(0u, m_mixer.GetUnderruns());
+}
+
+TEST_F(MixerTest, StreamingVolume)
+{
+	// Streaming samples are in host byte order and come in at 48 kHz. Odd
+	// push sizes leave a few samples for the unbatched tail.
+	const short level[2] = { -20000, 30001 };
+	m_mixer.SetStreamingVolume(100, 255);
+	for (int i = 0; i < 32; ++i)
+	{
+		std::vector<short> samples(401 * 2);
+		for (size_t j = 0; j < samples.size(); ++j)
+			samples[j] = level[j & 1];
+		m_mixer.PushStreamingSamples(samples.data(), 401);
+
+		// The volume registers go up to 255, which is scaled to 256.
+		MixExpecting((level[0] * 100) >> 8, (level[1] * 256) >> 8, 263);
+	}
+}
+
+// Goertzel power of a tone in every other sample of the output.
+static double TonePower(const std::vector<short>& samples, double frequency, double sample_rate)
+{
+	double coef = 2 * cos(2 * M_PI * frequency / sample_rate);
+	double s1 = 0, s2 = 0;
+	for (size_t i = 0; i < samples.size(); i += 2)
+	{
+		double s0 = samples[i] + coef * s1 - s2;
+		s2 = s1;
+		s1 = s0;
+	}
+	return s1 * s1 + s2 * s2 - coef * s1 * s2;
+}
+
+TEST_F(MixerTest, ImagesAboveNyquistAreRejected)
+{
+	// Upsampling the 32 kHz DMA audio to 48 kHz mirrors a tone at 14 kHz to
+	// 18 kHz, just above the input's Nyquist frequency.
+	TestMixer mixer(48000);
+	const double tone = 14000, image = 32000 - tone;
+
+	// The fifo starts at the level that the level control aims for, and
+	// then gets 2/3 of what is mixed, so that the level control doesn't
+	// shift the frequencies.
+	std::vector<short> output;
+	u32 phase = 0;
+	for (int i = -LOW_WATERMARK / 256; i < 100; ++i)
+	{
+		std::vector<short> samples(256 * 2);
+		for (int j = 0; j < 256; ++j, ++phase)
+		{
+			short sample = (short)(16000 * sin(2 * M_PI * tone * phase / 32000));
+			samples[j * 2] = samples[j * 2 + 1] = Common::swap16(sample);
+		}
+		mixer.PushSamples(samples.data(), 256);
+		if (i < 0)
+			continue;
+
+		std::vector<short> mixed(384 * 2);
+		mixer.Mix(mixed.data(), 384, false);
+		// Skip the start, while the level control settles.
+		if (i >= 20)
+			output.insert(output.end(), mixed.begin(), mixed.end());
+	}
+	EXPECT_EQ(0u, mixer.GetUnderruns());
+
+	double ratio = TonePower(output, image, 48000) / TonePower(output, tone, 48000);
+	EXPECT_LT(10 * log10(ratio), -50.0);
+}
+
+TEST_F(MixerTest, ResampleSampleMatchesScalar)
+{
+	srand(0x5e2);
+	GC_ALIGNED16(short input[RESAMPLER_TAPS * 2 + 8]);
+	for (int round = 0; round < 64; ++round)
+	{
+		for (short& sample : input)
+			sample = (short)rand();
+		// Full scale input in some rounds.
+		if (round % 8 == 0)
+		{
+			for (int i = 0; i < RESAMPLER_TAPS * 2; ++i)
+				input[i] = (i & 2) ? 32767 : -32768;
+		}
+
+		for (u32 phase = 0; phase < RESAMPLER_PHASES; ++phase)
+		{
+			// Odd offsets check that the input doesn't need to be aligned.
+			const short* start = input + (round & 3) * 2 + (round & 1);
+			int left, right, ref_left, ref_right;
+			TestMixer::ResampleSample(start, phase, &left, &right);
+			TestMixer::ResampleSampleScalar(start, phase, &ref_left, &ref_right);
+			ASSERT_EQ(ref_left, left) << "round " << round << " phase " << phase;
+			ASSERT_EQ(ref_right, right) << "round " << round << " phase " << phase;
+		}
+	}
+}
+
+TEST_F(MixerTest, WrapAroundReadsFreshSamples)
+{
+	// Go around the ring buffer with one level, so that the copy of its
+	// start kept after the end holds it too.
+	for (int i = 0; i < 32; ++i)
+	{
+		PushConstant(1000, -3000, 300);
+		MixExpecting(1000, -3000, 256);
+	}
+
+	// Each crossing switches to a new level first, so that a stale mirrored
+	// sample shows up in the output.
+	CrossRingEnd(-12345, 23456, true);
+	CrossRingEnd(5000, 7000, false);
+	CrossRingEnd(-32767, 32767, true);
+}
@@ -0,0 +1,77 @@
+#include <cstdlib>
+
+#include "Common/CommonTypes.h"
+#include "Common/MathUtil.h"
+#include "Core/HW/StreamADPCM.h"
+
+#include <gtest/gtest.h>
+
+// The sample by sample decoder DecodeBlock replaces.
+namespace Reference
+{
+
+static s16 ADPDecodeSample(s32 bits, s32 q, s32& hist1, s32& hist2)
+{
+	s32 hist = 0;
+	switch (q >> 4)
+	{
+	case 0:
+		hist = 0;
+		break;
+	case 1:
+		hist = (hist1 * 0x3c);
+		break;
+	case 2:
+		hist = (hist1 * 0x73) - (hist2 * 0x34);
+		break;
+	case 3:
+		hist = (hist1 * 0x62) - (hist2 * 0x37);
+		break;
+	}
+	hist = (hist + 0x20) >> 6;
+	MathUtil::Clamp(&hist, -0x200000, 0x1fffff);
+
+	s32 cur = (((s16)(bits << 12) >> (q & 0xf)) << 6) + hist;
+
+	hist2 = hist1;
+	hist1 = cur;
+
+	cur >>= 6;
+	MathUtil::Clamp(&cur, -0x8000, 0x7fff);
+
+	return (s16)cur;
+}
+
+}  // namespace Reference
+
+TEST(StreamADPCM, DecodeBlockMatchesReference)
+{
+	srand(0xd7c);
+	NGCADPCM::InitFilter();
+	s32 histl1 = 0, histl2 = 0, histr1 = 0, histr2 = 0;
+
+	for (int block = 0; block < 2000; ++block)
+	{
+		u8 adpcm[NGCADPCM::ONE_BLOCK_SIZE];
+		for (u8& byte : adpcm)
+			byte = (u8)rand();
+		// Mostly valid filters, with an occasional undefined one.
+		if (block % 16)
+		{
+			adpcm[0] &= 0x3f;
+			adpcm[1] &= 0x3f;
+		}
+
+		s16 pcm[NGCADPCM::SAMPLES_PER_BLOCK * 2];
+		NGCADPCM::DecodeBlock(pcm, adpcm);
+
+		for (int i = 0; i < NGCADPCM::SAMPLES_PER_BLOCK; ++i)
+		{
+			u8 bits = adpcm[i + (NGCADPCM::ONE_BLOCK_SIZE - NGCADPCM::SAMPLES_PER_BLOCK)];
+			ASSERT_EQ(Reference::ADPDecodeSample(bits & 0xf, adpcm[0], histl1, histl2), pcm[i * 2])
+				<< "block " << block << ", sample " << i;
+			ASSERT_EQ(Reference::ADPDecodeSample(bits >> 4, adpcm[1], histr1, histr2), pcm[i * 2 + 1])
+				<< "block " << block << ", sample " << i;
+		}
+	}
+}
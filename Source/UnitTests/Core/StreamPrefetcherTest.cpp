@@ -0,0 +1,124 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/VolumeHandler.h"
+#include "Core/HW/StreamPrefetcher.h"
+
+#include <gtest/gtest.h>
+
+class StreamPrefetcherTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		// A GameCube disc image of random data, save for the magic word that
+		// identifies it.
+		srand(0x5f3);
+		m_image.resize(IMAGE_SIZE);
+		for (u8& b : m_image)
+			b = (u8)rand();
+		const u8 magic[4] = { 0xC2, 0x33, 0x9F, 0x3D };
+		memcpy(&m_image[0x1c], magic, sizeof(magic));
+
+		m_filename = "StreamPrefetcherTest.iso";
+		{
+			File::IOFile file(m_filename, "wb");
+			ASSERT_TRUE(file.WriteBytes(m_image.data(), m_image.size()));
+		}
+		ASSERT_TRUE(VolumeHandler::SetVolumeName(m_filename));
+		StreamPrefetcher::Init();
+	}
+
+	void TearDown() override
+	{
+		StreamPrefetcher::Shutdown();
+		VolumeHandler::EjectVolume();
+		File::Delete(m_filename);
+	}
+
+	bool ReadMatches(u32 offset, u32 length)
+	{
+		std::vector<u8> buffer(length);
+		return StreamPrefetcher::ReadToPtr(buffer.data(), offset, length) &&
+		       memcmp(buffer.data(), &m_image[offset], length) == 0;
+	}
+
+	static const u32 IMAGE_SIZE = 4 * 1024 * 1024;
+
+	std::vector<u8> m_image;
+	std::string m_filename;
+};
+
+TEST_F(StreamPrefetcherTest, ReadsAheadOfThePlayPosition)
+{
+	// Without a disc, only prefetched data can be read. Give the I/O thread
+	// more time on each try.
+	const u32 position = 0x12340;
+	bool prefetched = false;
+	for (int attempt = 1; attempt <= 20 && !prefetched; ++attempt)
+	{
+		StreamPrefetcher::SetStreamPosition(position, 0x200000);
+		std::this_thread::sleep_for(std::chrono::milliseconds(10 * attempt));
+
+		VolumeHandler::EjectVolume();
+		prefetched = ReadMatches(position, 128 * 1024) && ReadMatches(0x200000, 32);
+		EXPECT_FALSE(ReadMatches(position + 0x100000, 32));
+
+		// Like the DVD interface does when a disc is inserted.
+		ASSERT_TRUE(VolumeHandler::SetVolumeName(m_filename));
+		StreamPrefetcher::Invalidate();
+	}
+	EXPECT_TRUE(prefetched);
+}
+
+TEST_F(StreamPrefetcherTest, ConcurrentReads)
+{
+	// Another thread reads the disc like the DVD interface and the Wii DI
+	// file system do, while the stream plays and changes tracks.
+	std::atomic<bool> done(false);
+	std::atomic<u32> other_mismatches(0);
+	std::thread other([&] {
+		DiscIO::IVolume* volume = VolumeHandler::GetVolume();
+		u32 seed = 1;
+		u8 buffer[0x1000];
+		while (!done)
+		{
+			seed = seed * 1103515245 + 12345;
+			u32 offset = (seed >> 8) % (IMAGE_SIZE - sizeof(buffer));
+			if (seed & 0x10000)
+				volume->Read(offset, sizeof(buffer), buffer);
+			else
+				VolumeHandler::ReadToPtr(buffer, offset, sizeof(buffer));
+			if (memcmp(buffer, &m_image[offset], sizeof(buffer)) != 0)
+				++other_mismatches;
+		}
+	});
+
+	u32 mismatches = 0;
+	u32 position = 0;
+	for (int i = 0; i < 200000; ++i)
+	{
+		if (i % 20000 == 0)
+		{
+			position = (rand() % (IMAGE_SIZE / 2)) & ~31;
+			if (i % 40000 == 0)
+				StreamPrefetcher::Invalidate();
+		}
+		StreamPrefetcher::SetStreamPosition(position, 0x300000);
+		if (!ReadMatches(position, 32))
+			++mismatches;
+		position += 32;
+	}
+	done = true;
+	other.join();
+
+	EXPECT_EQ(0u, mismatches);
+	EXPECT_EQ(0u, other_mismatches);
+}
@@ -0,0 +1,96 @@
+#include "Common/CommonTypes.h"
+#include "Core/HW/Memmap.h"
+
+#include <gtest/gtest.h>
+
+class TLBTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		Memory::InvalidateTLB();
+	}
+
+	static u32 Lookup(u32 address, Memory::XCheckTLBFlag flag = Memory::FLAG_READ)
+	{
+		u32 paddr = 0;
+		if (!Memory::LookupTLBPageAddress(flag, address, &paddr))
+			return 0;
+		return paddr;
+	}
+
+	// Pages 64 apart fall into the same set.
+	static const u32 A = 0x80000000;
+	static const u32 B = 0x80040000;
+	static const u32 C = 0x80080000;
+};
+
+TEST_F(TLBTest, LookupKeepsThePageOffset)
+{
+	EXPECT_EQ(0u, Lookup(A + 0x123));
+	Memory::UpdateTLBEntry(Memory::FLAG_READ, A + 0x123, 0x200000);
+	EXPECT_EQ(0x200123u, Lookup(A + 0x123));
+	EXPECT_EQ(0x200fffu, Lookup(A + 0xfff));
+	EXPECT_EQ(0u, Lookup(A + 0x1000));
+}
+
+TEST_F(TLBTest, SetsReplaceTheLeastRecentlyUsedWay)
+{
+	Memory::UpdateTLBEntry(Memory::FLAG_READ, A, 0x200000);
+	Memory::UpdateTLBEntry(Memory::FLAG_READ, B, 0x201000);
+	EXPECT_EQ(0x200000u, Lookup(A));
+	EXPECT_EQ(0x201000u, Lookup(B));
+	EXPECT_EQ(0x200000u, Lookup(A));
+
+	// Evicts B, which was used less recently than A.
+	Memory::UpdateTLBEntry(Memory::FLAG_READ, C, 0x202000);
+	EXPECT_EQ(0x200000u, Lookup(A));
+	EXPECT_EQ(0u, Lookup(B));
+	EXPECT_EQ(0x202000u, Lookup(C));
+
+	// Other sets are unaffected.
+	Memory::UpdateTLBEntry(Memory::FLAG_READ, A + 0x1000, 0x203000);
+	EXPECT_EQ(0x200000u, Lookup(A));
+	EXPECT_EQ(0x202000u, Lookup(C));
+	EXPECT_EQ(0x203000u, Lookup(A + 0x1000));
+}
+
+TEST_F(TLBTest, InstructionsAndDataHaveSeparateTLBs)
+{
+	Memory::UpdateTLBEntry(Memory::FLAG_OPCODE, A, 0x200000);
+	EXPECT_EQ(0u, Lookup(A, Memory::FLAG_READ));
+	EXPECT_EQ(0x200000u, Lookup(A, Memory::FLAG_OPCODE));
+
+	// Writes and accesses without exceptions share the data TLB.
+	Memory::UpdateTLBEntry(Memory::FLAG_WRITE, A, 0x300000);
+	EXPECT_EQ(0x300000u, Lookup(A, Memory::FLAG_READ));
+	EXPECT_EQ(0x300000u, Lookup(A, Memory::FLAG_NO_EXCEPTION));
+	EXPECT_EQ(0x200000u, Lookup(A, Memory::FLAG_OPCODE));
+}
+
+TEST_F(TLBTest, InvalidateEntryRemovesThePageFromBothTLBs)
+{
+	Memory::UpdateTLBEntry(Memory::FLAG_READ, A, 0x200000);
+	Memory::UpdateTLBEntry(Memory::FLAG_OPCODE, A, 0x200000);
+	Memory::UpdateTLBEntry(Memory::FLAG_READ, B, 0x201000);
+
+	// Like tlbie, any address in the page will do.
+	Memory::InvalidateTLBEntry(A + 0x800);
+	EXPECT_EQ(0u, Lookup(A, Memory::FLAG_READ));
+	EXPECT_EQ(0u, Lookup(A, Memory::FLAG_OPCODE));
+	EXPECT_EQ(0x201000u, Lookup(B));
+
+	// Invalidating a page that isn't cached leaves its set alone.
+	Memory::InvalidateTLBEntry(C);
+	EXPECT_EQ(0x201000u, Lookup(B));
+
+	Memory::InvalidateTLB();
+	EXPECT_EQ(0u, Lookup(B));
+}
+
+TEST_F(TLBTest, PageZeroIsNeverCached)
+{
+	// Invalid ways have tag 0, so page 0 would hit them.
+	EXPECT_EQ(0u, Lookup(0x123));
+	EXPECT_EQ(0u, Lookup(0x123, Memory::FLAG_OPCODE));
+}
@@ -0,0 +1,273 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+#include "Common/Timer.h"
+#include "Core/HW/DSP.h"
+#include "Core/HW/DSPHLE/DSPHLE.h"
+#include "Core/HW/DSPHLE/UCodes/UCodes.h"
+#include "Core/HW/DSPHLE/UCodes/Zelda.h"
+
+#include <gtest/gtest.h>
+
+// The light version doesn't raise DSP interrupts on boot.
+static const u32 LUIGI_CRC = 0x42f64ac4;
+
+class ZeldaVoiceTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		srand(0x2e1);
+		m_ucode.reset(new ZeldaUCode(&m_dsphle, LUIGI_CRC));
+	}
+
+	// Synthesized and blank voices, which don't read ARAM or RAM, with
+	// random pitches, lengths and volumes. Some are one-shots that stop
+	// partway through.
+	static std::vector<ZeldaVoicePB> MakeVoices(u32 count)
+	{
+		std::vector<ZeldaVoicePB> pbs(count);
+		for (u32 i = 0; i < count; ++i)
+		{
+			ZeldaVoicePB& pb = pbs[i];
+			memset(&pb, 0, sizeof(pb));
+			pb.Status = 1;
+			pb.NeedsReset = 1;
+			pb.Format = (i & 1) ? 0x0001 : 0x0000; // Saw and square wave
+			pb.IsBlank = i % 5 == 4;
+			pb.FixedSample = rand();
+			pb.RatioInt = 0x0800 + (rand() & 0x0FFF);
+			pb.Length = 0x100 + (rand() & 0x3FF);
+			pb.RepeatMode = i % 3 != 0;
+			pb.LoopStartPos = rand() % pb.Length;
+			// Mixed into the left and right buffers with a volume ramp.
+			pb.raw[0x08] = 1;
+			pb.raw[0x09] = rand() & 0x7FFF;
+			pb.raw[0x0a] = rand() & 0x7FFF;
+		}
+		return pbs;
+	}
+
+	DSPHLE m_dsphle;
+	std::unique_ptr<ZeldaUCode> m_ucode;
+};
+
+TEST_F(ZeldaVoiceTest, PooledMatchesSerial)
+{
+	std::vector<ZeldaVoicePB> voices = MakeVoices(64);
+	// A fixed size, so that the voices are spread over several threads on
+	// any host.
+	VoiceWorkerPool pool(4);
+
+	bool any_sound = false;
+	for (int frame = 0; frame < 500; ++frame)
+	{
+		// Like MixAudio, only render the voices that are playing.
+		std::vector<ZeldaVoicePB> serial;
+		for (const ZeldaVoicePB& pb : voices)
+		{
+			if (!pb.KeyOff)
+				serial.push_back(pb);
+		}
+		std::vector<ZeldaVoicePB> pooled = serial;
+
+		s32 serial_left[ZeldaUCode::MIX_BUFFER_SAMPLES], serial_right[ZeldaUCode::MIX_BUFFER_SAMPLES];
+		s32 pooled_left[ZeldaUCode::MIX_BUFFER_SAMPLES], pooled_right[ZeldaUCode::MIX_BUFFER_SAMPLES];
+		m_ucode->RenderVoices(serial, nullptr, serial_left, serial_right);
+		m_ucode->RenderVoices(pooled, &pool, pooled_left, pooled_right);
+
+		ASSERT_EQ(0, memcmp(serial_left, pooled_left, sizeof (serial_left))) << "frame " << frame;
+		ASSERT_EQ(0, memcmp(serial_right, pooled_right, sizeof (serial_right))) << "frame " << frame;
+		for (size_t i = 0; i < serial.size(); ++i)
+			ASSERT_EQ(0, memcmp(&serial[i], &pooled[i], sizeof (ZeldaVoicePB))) << "frame " << frame << ", voice " << i;
+
+		for (s32 sample : serial_left)
+			any_sound |= sample != 0;
+
+		// Write the PBs back, and restart the voices that stopped, like a
+		// game would.
+		size_t rendered = 0;
+		for (ZeldaVoicePB& pb : voices)
+		{
+			if (!pb.KeyOff)
+				pb = serial[rendered++];
+			else if (frame % 7 == 0)
+				pb.KeyOff = 0, pb.NeedsReset = 1;
+		}
+	}
+	EXPECT_TRUE(any_sound);
+}
+
+// Voices that play samples from ARAM. The light version reads them there
+// rather than through DMA.
+class ZeldaSampleVoiceTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		DSP::Init(true, false);
+		m_ucode.reset(new ZeldaUCode(&m_dsphle, LUIGI_CRC));
+
+		// Not rand(), whose sequence differs between hosts, so that the
+		// baseline hashes below hold everywhere.
+		m_seed = 0x5a3c;
+		u8* aram = DSP::GetARAMPtr();
+		for (u32 i = 0; i < ARAM_USED; ++i)
+			aram[i] = (u8)(Random() >> 8);
+
+		LoadAFCCoefs();
+	}
+
+	void TearDown() override
+	{
+		m_ucode.reset();
+		DSP::Shutdown();
+	}
+
+	u32 Random()
+	{
+		m_seed = m_seed * 1103515245 + 12345;
+		return m_seed >> 8;
+	}
+
+	// Games upload the table through a mail, which reads it from RAM. It is
+	// also the first thing in the savestate, so it is patched in there.
+	void LoadAFCCoefs()
+	{
+		static const s16 coefs[32] = {
+			0x0000, 0x0000, 0x0800, 0x0000, 0x0000, 0x0800, 0x0400, 0x0400,
+			0x1000, -0x0800, 0x0e00, -0x0600, 0x0c00, -0x0400, 0x1200, -0x0a00,
+			0x1068, -0x08c8, 0x12c0, -0x08fc, 0x1400, -0x0c00, 0x0800, -0x0800,
+			0x0400, -0x0400, -0x0400, 0x0400, -0x0400, 0x0000, -0x0800, 0x0000,
+		};
+
+		u8* ptr = nullptr;
+		PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+		m_ucode->DoState(measure);
+		std::vector<u8> state(reinterpret_cast<size_t>(ptr));
+
+		ptr = state.data();
+		PointerWrap write(&ptr, PointerWrap::MODE_WRITE);
+		m_ucode->DoState(write);
+		memcpy(state.data(), coefs, sizeof (coefs));
+
+		ptr = state.data();
+		PointerWrap read(&ptr, PointerWrap::MODE_READ);
+		m_ucode->DoState(read);
+	}
+
+	// Looping and one-shot voices of a sample format, at random places in
+	// ARAM, with random pitches and volumes.
+	std::vector<ZeldaVoicePB> MakeVoices(u16 format, u32 count)
+	{
+		std::vector<ZeldaVoicePB> pbs(count);
+		for (u32 i = 0; i < count; ++i)
+		{
+			ZeldaVoicePB& pb = pbs[i];
+			memset(&pb, 0, sizeof(pb));
+			pb.Status = 1;
+			pb.NeedsReset = 1;
+			pb.Format = format;
+			pb.RatioInt = 0x0400 + (Random() & 0x1FFF);
+			pb.Length = 0x100 + (Random() & 0xFFF);
+			pb.RepeatMode = i % 3 != 0;
+			pb.LoopStartPos = Random() % pb.Length;
+			pb.StartAddr = Random() % (ARAM_USED / 2);
+			if (format == 0x0010)
+				pb.StartAddr &= ~1;
+			pb.raw[0x08] = 1;
+			pb.raw[0x09] = Random() & 0x7FFF;
+			pb.raw[0x0a] = Random() & 0x7FFF;
+		}
+		return pbs;
+	}
+
+	// Renders the voices for a while and returns a hash of the mix.
+	u32 Render(std::vector<ZeldaVoicePB> voices, VoiceWorkerPool* pool)
+	{
+		std::vector<s32> output;
+		for (int frame = 0; frame < 200; ++frame)
+		{
+			std::vector<ZeldaVoicePB> playing;
+			for (const ZeldaVoicePB& pb : voices)
+			{
+				if (!pb.KeyOff)
+					playing.push_back(pb);
+			}
+
+			s32 left[ZeldaUCode::MIX_BUFFER_SAMPLES], right[ZeldaUCode::MIX_BUFFER_SAMPLES];
+			m_ucode->RenderVoices(playing, pool, left, right);
+			output.insert(output.end(), left, left + ZeldaUCode::MIX_BUFFER_SAMPLES);
+			output.insert(output.end(), right, right + ZeldaUCode::MIX_BUFFER_SAMPLES);
+
+			size_t rendered = 0;
+			for (ZeldaVoicePB& pb : voices)
+			{
+				if (!pb.KeyOff)
+					pb = playing[rendered++];
+				else if (frame % 7 == 0)
+					pb.KeyOff = 0, pb.NeedsReset = 1;
+			}
+		}
+		return HashAdler32((const u8*)output.data(), output.size() * sizeof (s32));
+	}
+
+	static const u32 ARAM_USED = 1024 * 1024;
+
+	DSPHLE m_dsphle;
+	std::unique_ptr<ZeldaUCode> m_ucode;
+	u32 m_seed;
+};
+
+// The hashes were taken from the voices rendered one by one, before they
+// were spread over threads.
+TEST_F(ZeldaSampleVoiceTest, MatchesBaseline)
+{
+	static const struct
+	{
+		u16 format;
+		u32 hash;
+	} baselines[] = {
+		{ 0x0005, 0xbf5c5246 }, // AFC, 32:5
+		{ 0x0009, 0xed3e4b17 }, // AFC, 32:9
+		{ 0x0008, 0x0e81df22 }, // PCM8
+		{ 0x0010, 0x7951c631 }, // PCM16
+	};
+
+	VoiceWorkerPool pool(4);
+	for (const auto& baseline : baselines)
+	{
+		std::vector<ZeldaVoicePB> voices = MakeVoices(baseline.format, 16);
+		EXPECT_EQ(baseline.hash, Render(voices, nullptr)) << "format " << baseline.format;
+		EXPECT_EQ(baseline.hash, Render(voices, &pool)) << "format " << baseline.format << ", pooled";
+	}
+}
+
+TEST_F(ZeldaVoiceTest, DISABLED_MixSpeed)
+{
+	const int frames = 20000;
+	std::vector<ZeldaVoicePB> pbs = MakeVoices(64);
+	for (ZeldaVoicePB& pb : pbs)
+		pb.RepeatMode = 1;
+	s32 left[ZeldaUCode::MIX_BUFFER_SAMPLES], right[ZeldaUCode::MIX_BUFFER_SAMPLES];
+
+	u32 start = Common::Timer::GetTimeMs();
+	for (int i = 0; i < frames; ++i)
+		m_ucode->RenderVoices(pbs, nullptr, left, right);
+	u32 serial_elapsed = Common::Timer::GetTimeMs() - start;
+
+	VoiceWorkerPool pool;
+	start = Common::Timer::GetTimeMs();
+	for (int i = 0; i < frames; ++i)
+		m_ucode->RenderVoices(pbs, &pool, left, right);
+	u32 pooled_elapsed = Common::Timer::GetTimeMs() - start;
+
+	printf("%.2f us per frame serially, %.2f us with %u threads\n",
+	       serial_elapsed * 1000.0 / frames, pooled_elapsed * 1000.0 / frames, pool.GetNumThreads());
+}
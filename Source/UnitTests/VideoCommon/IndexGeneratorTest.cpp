@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/Timer.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/VideoConfig.h"
+
+#include <gtest/gtest.h>
+
+typedef std::array<u32, 3> Triangle;
+
+// Rotates a triangle so that its smallest index comes first, which keeps the
+// winding but makes triangles from lists and strips comparable.
+static Triangle Normalize(u32 a, u32 b, u32 c)
+{
+	if (b < a && b < c)
+		return {{ b, c, a }};
+	if (c < a && c < b)
+		return {{ c, a, b }};
+	return {{ a, b, c }};
+}
+
+// The triangles GX draws for a primitive, in order.
+static std::vector<Triangle> ExpectedTriangles(int primitive, u32 num_verts, u32 index)
+{
+	std::vector<Triangle> triangles;
+	switch (primitive)
+	{
+	case GX_DRAW_QUADS:
+		for (u32 i = 3; i < num_verts; i += 4)
+		{
+			triangles.push_back(Normalize(index + i - 3, index + i - 2, index + i - 1));
+			triangles.push_back(Normalize(index + i - 3, index + i - 1, index + i));
+		}
+		if (num_verts % 4 == 3)
+			triangles.push_back(Normalize(index + num_verts - 3, index + num_verts - 2, index + num_verts - 1));
+		break;
+	case GX_DRAW_TRIANGLES:
+		for (u32 i = 2; i < num_verts; i += 3)
+			triangles.push_back(Normalize(index + i - 2, index + i - 1, index + i));
+		break;
+	case GX_DRAW_TRIANGLE_STRIP:
+		for (u32 i = 2; i < num_verts; ++i)
+		{
+			if (i & 1)
+				triangles.push_back(Normalize(index + i - 1, index + i - 2, index + i));
+			else
+				triangles.push_back(Normalize(index + i - 2, index + i - 1, index + i));
+		}
+		break;
+	case GX_DRAW_TRIANGLE_FAN:
+		for (u32 i = 2; i < num_verts; ++i)
+			triangles.push_back(Normalize(index, index + i - 1, index + i));
+		break;
+	}
+	return triangles;
+}
+
+// Expands generated indices back into triangles, either as a list or as
+// strips separated by primitive restart indices.
+static std::vector<Triangle> GeneratedTriangles(const u16* indices, u32 count, bool primitive_restart)
+{
+	std::vector<Triangle> triangles;
+	if (!primitive_restart)
+	{
+		EXPECT_EQ(0u, count % 3);
+		for (u32 i = 0; i + 2 < count; i += 3)
+			triangles.push_back(Normalize(indices[i], indices[i + 1], indices[i + 2]));
+		return triangles;
+	}
+
+	u32 strip_start = 0;
+	for (u32 i = 0; i < count; ++i)
+	{
+		if (indices[i] == 0xFFFF)
+		{
+			strip_start = i + 1;
+			continue;
+		}
+		u32 n = i - strip_start;
+		if (n < 2)
+			continue;
+		if (n & 1)
+			triangles.push_back(Normalize(indices[i - 1], indices[i - 2], indices[i]));
+		else
+			triangles.push_back(Normalize(indices[i - 2], indices[i - 1], indices[i]));
+	}
+	return triangles;
+}
+
+class IndexGeneratorTest : public testing::TestWithParam<bool>
+{
+protected:
+	void SetUp() override
+	{
+		m_old_primitive_restart = g_Config.backend_info.bSupportsPrimitiveRestart;
+		g_Config.backend_info.bSupportsPrimitiveRestart = GetParam();
+		IndexGenerator::Init();
+		m_indices.resize(65536 * 3);
+	}
+
+	void TearDown() override
+	{
+		g_Config.backend_info.bSupportsPrimitiveRestart = m_old_primitive_restart;
+	}
+
+	// Generates indices for a primitive following skip other vertices and
+	// returns the number of indices written for the primitive.
+	u32 Generate(int primitive, u32 num_verts, u32 skip)
+	{
+		IndexGenerator::Start(m_indices.data());
+		if (skip)
+			IndexGenerator::AddIndices(GX_DRAW_POINTS, skip);
+		u32 start = IndexGenerator::GetIndexLen();
+		EXPECT_EQ(skip, start);
+		IndexGenerator::AddIndices(primitive, num_verts);
+		EXPECT_EQ(skip + num_verts, IndexGenerator::GetNumVerts());
+		return IndexGenerator::GetIndexLen() - start;
+	}
+
+	std::vector<u16> m_indices;
+	bool m_old_primitive_restart;
+};
+
+TEST_P(IndexGeneratorTest, Triangles)
+{
+	static const int primitives[] = {
+		GX_DRAW_QUADS, GX_DRAW_TRIANGLES, GX_DRAW_TRIANGLE_STRIP, GX_DRAW_TRIANGLE_FAN
+	};
+	static const u32 skips[] = { 0, 1, 1000, 65000 };
+
+	for (int primitive : primitives)
+	{
+		for (u32 skip : skips)
+		{
+			for (u32 num_verts = 0; num_verts < 200 && skip + num_verts <= 65534; ++num_verts)
+			{
+				u32 count = Generate(primitive, num_verts, skip);
+				std::vector<Triangle> expected = ExpectedTriangles(primitive, num_verts, skip);
+				ASSERT_TRUE(expected == GeneratedTriangles(&m_indices[skip], count, GetParam()))
+					<< "primitive " << primitive << ", " << num_verts << " vertices after " << skip;
+			}
+		}
+	}
+}
+
+TEST_P(IndexGeneratorTest, LargeBatch)
+{
+	for (int primitive = GX_DRAW_QUADS; primitive <= GX_DRAW_TRIANGLE_FAN; ++primitive)
+	{
+		u32 count = Generate(primitive, 65533, 1);
+		std::vector<Triangle> expected = ExpectedTriangles(primitive == GX_DRAW_QUADS_2 ? GX_DRAW_QUADS : primitive, 65533, 1);
+		ASSERT_TRUE(expected == GeneratedTriangles(&m_indices[1], count, GetParam())) << "primitive " << primitive;
+	}
+}
+
+TEST_P(IndexGeneratorTest, LinesAndPoints)
+{
+	for (u32 num_verts = 0; num_verts < 100; ++num_verts)
+	{
+		u32 count = Generate(GX_DRAW_LINES, num_verts, 7);
+		ASSERT_EQ(num_verts / 2 * 2, count);
+		for (u32 i = 0; i < count; ++i)
+			ASSERT_EQ(7 + i, m_indices[7 + i]);
+
+		count = Generate(GX_DRAW_LINE_STRIP, num_verts, 7);
+		ASSERT_EQ(num_verts ? (num_verts - 1) * 2 : 0, count);
+		for (u32 i = 0; i < count; ++i)
+			ASSERT_EQ(7 + (i + 1) / 2, m_indices[7 + i]);
+
+		count = Generate(GX_DRAW_POINTS, num_verts, 7);
+		ASSERT_EQ(num_verts, count);
+		for (u32 i = 0; i < count; ++i)
+			ASSERT_EQ(7 + i, m_indices[7 + i]);
+	}
+}
+
+TEST_P(IndexGeneratorTest, DISABLED_GenerateSpeed)
+{
+	static const int primitives[] = {
+		GX_DRAW_QUADS, GX_DRAW_TRIANGLES, GX_DRAW_TRIANGLE_STRIP, GX_DRAW_TRIANGLE_FAN, GX_DRAW_POINTS
+	};
+	static const char* const names[] = { "quads", "triangles", "strip", "fan", "points" };
+	static const u32 sizes[] = { 4, 24, 256 };
+	const int iterations = 2000;
+
+	for (int p = 0; p < 5; ++p)
+	{
+		for (u32 size : sizes)
+		{
+			u32 start = Common::Timer::GetTimeMs();
+			for (int i = 0; i < iterations; ++i)
+			{
+				IndexGenerator::Start(m_indices.data());
+				while (IndexGenerator::GetRemainingIndices() >= size)
+					IndexGenerator::AddIndices(primitives[p], size);
+			}
+			u32 elapsed = Common::Timer::GetTimeMs() - start;
+
+			printf("%-9s %3u vertices, restart %d: %6.3f ms per 64k vertices\n",
+			       names[p], size, GetParam(), (double)elapsed / iterations);
+		}
+	}
+}
+
+INSTANTIATE_TEST_CASE_P(PrimitiveRestart, IndexGeneratorTest, testing::Bool());
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cstring>
+
+#include "Common/Common.h"
+#include "Common/Timer.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/BPStructs.h"
+#include "VideoCommon/DataReader.h"
+#include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/VertexManagerBase.h"
+#include "VideoCommon/VertexShaderGen.h"
+#include "VideoCommon/VideoBackendBase.h"
+#include "VideoCommon/XFMemory.h"
+
+#include <gtest/gtest.h>
+
+// Register writes check the backend for a loaded savestate and flush the
+// vertex manager. Neither has anything to do here.
+class TestVideoBackend : public VideoBackendHardware
+{
+public:
+	bool Initialize(void*) override { InitializeShared(); return true; }
+	void Shutdown() override {}
+	std::string GetName() const override { return "Test"; }
+	void ShowConfig(void*) override {}
+	unsigned int PeekMessages() override { return 0; }
+	void Video_Prepare() override {}
+	void Video_Cleanup() override {}
+};
+
+class TestVertexManager : public VertexManager
+{
+private:
+	::NativeVertexFormat* CreateNativeVertexFormat() override { return nullptr; }
+	void ResetBuffer(u32 stride) override {}
+	void vFlush(bool useDstAlpha) override {}
+};
+
+class ShaderUidTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		m_old_backend = g_video_backend;
+		g_video_backend = &m_backend;
+		m_backend.Initialize(nullptr);
+
+		BPInit();
+		memset(&xfmem, 0, sizeof(xfmem));
+
+		// Four TEV stages sampling two textures with one color channel,
+		// roughly what a typical draw looks like.
+		GenMode mode;
+		mode.hex = 0;
+		mode.numtevstages = 3;
+		mode.numtexgens = 2;
+		mode.numcolchans = 1;
+		WriteBP(BPMEM_GENMODE, mode.hex);
+		WriteXF(XFMEM_SETNUMCHAN, 1);
+		WriteXF(XFMEM_SETNUMTEXGENS, 2);
+		for (int i = 0; i < 4; ++i)
+		{
+			WriteBP(BPMEM_TEV_COLOR_ENV + 2 * i, 0x08fe00 + i);
+			WriteBP(BPMEM_TEV_ALPHA_ENV + 2 * i, 0x08ff00 + i);
+		}
+		WriteBP(BPMEM_TREF, 0x3c8 | (0x3c9 << 12));
+	}
+
+	void TearDown() override
+	{
+		g_video_backend = m_old_backend;
+	}
+
+	// Writes a register like a BP command in the FIFO does.
+	static void WriteBP(u32 address, u32 value)
+	{
+		LoadBPReg((address << 24) | value);
+	}
+
+	// Writes a register like an XF command in the FIFO does.
+	static void WriteXF(u32 address, u32 value)
+	{
+		u32 data = Common::swap32(value);
+		u8* old_data = g_pVideoData;
+		g_pVideoData = (u8*)&data;
+		LoadXFReg(1, address);
+		g_pVideoData = old_data;
+	}
+
+	static const u32 components = VB_HAS_POSMTXIDX | VB_HAS_COL0 | VB_HAS_UV0 | VB_HAS_UV1;
+
+	TestVideoBackend m_backend;
+	VideoBackend* m_old_backend;
+	TestVertexManager m_vertex_manager;
+};
+
+TEST_F(ShaderUidTest, CachedUidMatchesGenerated)
+{
+	PixelShaderUid generated, cached;
+	GetPixelShaderUid(generated, DSTALPHA_NONE, API_OPENGL, components);
+	GetPixelShaderUid(cached, DSTALPHA_NONE, API_OPENGL, components);
+	EXPECT_TRUE(generated == cached);
+
+	VertexShaderUid vgenerated, vcached;
+	GetVertexShaderUid(vgenerated, components, API_OPENGL);
+	GetVertexShaderUid(vcached, components, API_OPENGL);
+	EXPECT_TRUE(vgenerated == vcached);
+}
+
+TEST_F(ShaderUidTest, RegisterWritesInvalidate)
+{
+	PixelShaderUid before, after;
+	GetPixelShaderUid(before, DSTALPHA_NONE, API_OPENGL, components);
+
+	u32 env = bpmem.combiners[2].colorC.hex;
+	WriteBP(BPMEM_TEV_COLOR_ENV + 4, env ^ 0x000f00);
+	GetPixelShaderUid(after, DSTALPHA_NONE, API_OPENGL, components);
+	EXPECT_TRUE(before != after);
+
+	// Changing it back must give the original UID again.
+	WriteBP(BPMEM_TEV_COLOR_ENV + 4, env);
+	GetPixelShaderUid(after, DSTALPHA_NONE, API_OPENGL, components);
+	EXPECT_TRUE(before == after);
+
+	VertexShaderUid vbefore, vafter;
+	GetVertexShaderUid(vbefore, components, API_OPENGL);
+	WriteXF(XFMEM_SETNUMTEXGENS, 1);
+	GetVertexShaderUid(vafter, components, API_OPENGL);
+	EXPECT_TRUE(vbefore != vafter);
+}
+
+TEST_F(ShaderUidTest, OtherRegisterWritesKeepCachedUid)
+{
+	PixelShaderUid before, after;
+	GetPixelShaderUid(before, DSTALPHA_NONE, API_OPENGL, components);
+	VertexShaderUid vbefore, vafter;
+	GetVertexShaderUid(vbefore, components, API_OPENGL);
+
+	// Changed behind the register write handlers' backs, so the cached UIDs
+	// go stale, and only an invalidation brings the change in.
+	bpmem.combiners[2].colorC.hex ^= 0x000f00;
+	xfmem.numTexGen.numTexGens = 1;
+
+	// Constant colors are shader uniforms and not part of the UIDs.
+	WriteBP(BPMEM_TEV_REGISTER_L, 0x123456);
+	WriteXF(XFMEM_SETCHAN0_AMBCOLOR, 0x11223344);
+	GetPixelShaderUid(after, DSTALPHA_NONE, API_OPENGL, components);
+	GetVertexShaderUid(vafter, components, API_OPENGL);
+	EXPECT_TRUE(before == after);
+	EXPECT_TRUE(vbefore == vafter);
+
+	// A lit channel is part of both UIDs, so writing it brings in the
+	// changes from above.
+	WriteXF(XFMEM_SETCHAN0_COLOR, 0x0002);
+	GetPixelShaderUid(after, DSTALPHA_NONE, API_OPENGL, components);
+	GetVertexShaderUid(vafter, components, API_OPENGL);
+	EXPECT_TRUE(before != after);
+	EXPECT_TRUE(vbefore != vafter);
+}
+
+TEST_F(ShaderUidTest, ArgumentsAreNotCached)
+{
+	PixelShaderUid a, b;
+	GetPixelShaderUid(a, DSTALPHA_NONE, API_OPENGL, components);
+	GetPixelShaderUid(b, DSTALPHA_DUAL_SOURCE_BLEND, API_OPENGL, components);
+	EXPECT_TRUE(a != b);
+
+	VertexShaderUid va, vb;
+	GetVertexShaderUid(va, components, API_OPENGL);
+	GetVertexShaderUid(vb, components | VB_HAS_NRM0, API_OPENGL);
+	EXPECT_TRUE(va != vb);
+}
+
+// Only prints timings, run it with --gtest_also_run_disabled_tests
+TEST_F(ShaderUidTest, DISABLED_UidTimePerDraw)
+{
+	const int draws = 200000;
+	PixelShaderUid puid;
+	VertexShaderUid vuid;
+
+	// A TEV stage and the texgen count change between draws.
+	u32 env = bpmem.combiners[2].colorC.hex;
+	u32 start = Common::Timer::GetTimeMs();
+	for (int i = 0; i < draws; ++i)
+	{
+		WriteBP(BPMEM_TEV_COLOR_ENV + 4, env ^ (i & 1) << 8);
+		WriteXF(XFMEM_SETNUMTEXGENS, 1 + (i & 1));
+		GetPixelShaderUid(puid, DSTALPHA_NONE, API_OPENGL, components);
+		GetVertexShaderUid(vuid, components, API_OPENGL);
+	}
+	u32 changed = std::max<u32>(Common::Timer::GetTimeMs() - start, 1);
+
+	// Only constant colors change between draws.
+	start = Common::Timer::GetTimeMs();
+	for (int i = 0; i < draws; ++i)
+	{
+		WriteBP(BPMEM_TEV_REGISTER_L, i & 0xff);
+		GetPixelShaderUid(puid, DSTALPHA_NONE, API_OPENGL, components);
+		GetVertexShaderUid(vuid, components, API_OPENGL);
+	}
+	u32 unchanged = std::max<u32>(Common::Timer::GetTimeMs() - start, 1);
+
+	printf("state changed:   %8.1f ns/draw\n", changed * 1e6 / draws);
+	printf("state unchanged: %8.1f ns/draw\n", unchanged * 1e6 / draws);
+}
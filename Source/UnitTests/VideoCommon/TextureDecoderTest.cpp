@@ -0,0 +1,236 @@
+#include <cstdlib>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/CPUDetect.h"
+#include "Common/Timer.h"
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/VideoConfig.h"
+
+#include <gtest/gtest.h>
+
+struct TextureFormatTest
+{
+	const char* name;
+	int texformat;
+	TlutFormat tlutfmt;
+};
+
+// Names the format in failure messages.
+static void PrintTo(const TextureFormatTest& f, std::ostream* os)
+{
+	*os << f.name;
+}
+
+static const TextureFormatTest s_texture_formats[] = {
+	{ "I4",           GX_TF_I4,     GX_TL_IA8 },
+	{ "I8",           GX_TF_I8,     GX_TL_IA8 },
+	{ "IA4",          GX_TF_IA4,    GX_TL_IA8 },
+	{ "IA8",          GX_TF_IA8,    GX_TL_IA8 },
+	{ "RGB565",       GX_TF_RGB565, GX_TL_IA8 },
+	{ "RGB5A3",       GX_TF_RGB5A3, GX_TL_IA8 },
+	{ "RGBA8",        GX_TF_RGBA8,  GX_TL_IA8 },
+	{ "C4_IA8",       GX_TF_C4,     GX_TL_IA8 },
+	{ "C4_RGB565",    GX_TF_C4,     GX_TL_RGB565 },
+	{ "C4_RGB5A3",    GX_TF_C4,     GX_TL_RGB5A3 },
+	{ "C8_IA8",       GX_TF_C8,     GX_TL_IA8 },
+	{ "C8_RGB565",    GX_TF_C8,     GX_TL_RGB565 },
+	{ "C8_RGB5A3",    GX_TF_C8,     GX_TL_RGB5A3 },
+	{ "C14X2_IA8",    GX_TF_C14X2,  GX_TL_IA8 },
+	{ "C14X2_RGB565", GX_TF_C14X2,  GX_TL_RGB565 },
+	{ "C14X2_RGB5A3", GX_TF_C14X2,  GX_TL_RGB5A3 },
+	{ "CMPR",         GX_TF_CMPR,   GX_TL_IA8 },
+};
+
+class TextureDecoderTest : public testing::TestWithParam<TextureFormatTest>
+{
+protected:
+	void SetUp() override
+	{
+		srand(0x7e57);
+		m_tlut.resize(TexDecoder_GetPaletteSize(GX_TF_C14X2));
+		for (u8& b : m_tlut)
+			b = (u8)rand();
+
+		m_old_threaded = g_ActiveConfig.bOMPDecoder;
+		m_old_cpu_info = cpu_info;
+	}
+
+	void TearDown() override
+	{
+		g_ActiveConfig.bOMPDecoder = m_old_threaded;
+		cpu_info = m_old_cpu_info;
+	}
+
+	// Makes the decoder take its SSE2 paths instead of the ones picked at
+	// run time.
+	static void ForceSSE2()
+	{
+		cpu_info.bSSE3 = false;
+		cpu_info.bSSSE3 = false;
+		cpu_info.bSSE4_1 = false;
+		cpu_info.bSSE4_2 = false;
+		cpu_info.bAVX = false;
+		cpu_info.bAVX2 = false;
+	}
+
+	// Fills a texture of the given size with random data.
+	void GenerateTexture(int width, int height)
+	{
+		const TextureFormatTest& f = GetParam();
+		m_width = width;
+		m_height = height;
+		m_src.resize(TexDecoder_GetTextureSizeInBytes(width, height, f.texformat));
+		for (u8& b : m_src)
+			b = (u8)rand();
+		m_dst.assign(width * height, 0);
+	}
+
+	PC_TexFormat Decode()
+	{
+		const TextureFormatTest& f = GetParam();
+		return TexDecoder_Decode((u8*)m_dst.data(), m_src.data(), m_width, m_height, f.texformat, m_tlut.data(), f.tlutfmt);
+	}
+
+	// Compares the decoded texture against the portable decoder.
+	void ExpectMatchesGeneric()
+	{
+		const TextureFormatTest& f = GetParam();
+		std::vector<u32> expected(m_width * m_height, 0);
+		ASSERT_EQ(PC_TEX_FMT_RGBA32, _TexDecoder_DecodeImplGeneric(expected.data(), m_src.data(), m_width, m_height, f.texformat, m_tlut.data(), f.tlutfmt));
+
+		for (int i = 0; i < m_width * m_height; ++i)
+			ASSERT_EQ(expected[i], m_dst[i]) << f.name << " at " << i % m_width << "," << i / m_width;
+	}
+
+	// Compares the decoded texture against the per-texel decoder used by the
+	// software renderer.
+	void ExpectMatchesTexelDecoder()
+	{
+		const TextureFormatTest& f = GetParam();
+
+		// The texel decoder interpolates CMPR colors with a division by 3
+		// instead of the hardware's 3/8 approximation, see CMPRInterpolation.
+		if (f.texformat == GX_TF_CMPR)
+			return;
+
+		for (int t = 0; t < m_height; ++t)
+		{
+			for (int s = 0; s < m_width; ++s)
+			{
+				u32 texel;
+				TexDecoder_DecodeTexel((u8*)&texel, m_src.data(), s, t, m_width - 1, f.texformat, m_tlut.data(), f.tlutfmt);
+				ASSERT_EQ(texel, m_dst[t * m_width + s]) << f.name << " at " << s << "," << t;
+			}
+		}
+	}
+
+	int m_width, m_height;
+	std::vector<u8> m_src;
+	std::vector<u8> m_tlut;
+	std::vector<u32> m_dst;
+	bool m_old_threaded;
+	CPUInfo m_old_cpu_info;
+};
+
+TEST_P(TextureDecoderTest, MatchesGeneric)
+{
+	g_ActiveConfig.bOMPDecoder = false;
+	GenerateTexture(64, 32);
+	ASSERT_EQ(PC_TEX_FMT_RGBA32, Decode());
+	ExpectMatchesGeneric();
+}
+
+TEST_P(TextureDecoderTest, SSE2MatchesGeneric)
+{
+	ForceSSE2();
+	g_ActiveConfig.bOMPDecoder = false;
+	GenerateTexture(64, 32);
+	ASSERT_EQ(PC_TEX_FMT_RGBA32, Decode());
+	ExpectMatchesGeneric();
+}
+
+TEST_P(TextureDecoderTest, MatchesTexelDecoder)
+{
+	g_ActiveConfig.bOMPDecoder = false;
+	GenerateTexture(64, 32);
+	ASSERT_EQ(PC_TEX_FMT_RGBA32, Decode());
+	ExpectMatchesTexelDecoder();
+}
+
+// Large enough to be decoded on several threads, and for C14X2 to convert
+// the whole palette up front.
+TEST_P(TextureDecoderTest, LargeMatchesGeneric)
+{
+	GenerateTexture(256, 256);
+	for (int sse2 = 0; sse2 < 2; ++sse2)
+	{
+		if (sse2)
+			ForceSSE2();
+		for (int threaded = 0; threaded < 2; ++threaded)
+		{
+			SCOPED_TRACE(testing::Message() << (sse2 ? "SSE2, " : "") << (threaded ? "threaded" : "single threaded"));
+			g_ActiveConfig.bOMPDecoder = threaded != 0;
+			m_dst.assign(m_dst.size(), 0);
+			ASSERT_EQ(PC_TEX_FMT_RGBA32, Decode());
+			ExpectMatchesGeneric();
+		}
+	}
+}
+
+TEST_P(TextureDecoderTest, DISABLED_DecodeSpeed)
+{
+	const TextureFormatTest& f = GetParam();
+	const int iterations = 200;
+	GenerateTexture(1024, 1024);
+
+	u32 start = Common::Timer::GetTimeMs();
+	for (int i = 0; i < iterations; ++i)
+		_TexDecoder_DecodeImplGeneric(m_dst.data(), m_src.data(), m_width, m_height, f.texformat, m_tlut.data(), f.tlutfmt);
+	u32 elapsed = Common::Timer::GetTimeMs() - start;
+	printf("%-12s generic : %6.3f ms per 1024x1024 texture\n", f.name, (double)elapsed / iterations);
+
+	for (int threaded = 0; threaded < 2; ++threaded)
+	{
+		g_ActiveConfig.bOMPDecoder = threaded != 0;
+
+		start = Common::Timer::GetTimeMs();
+		for (int i = 0; i < iterations; ++i)
+			Decode();
+		elapsed = Common::Timer::GetTimeMs() - start;
+
+		printf("%-12s %s: %6.3f ms per 1024x1024 texture\n", f.name,
+		       threaded ? "threaded" : "single  ", (double)elapsed / iterations);
+	}
+}
+
+INSTANTIATE_TEST_CASE_P(AllFormats, TextureDecoderTest,
+                        testing::ValuesIn(s_texture_formats));
+
+TEST(TextureDecoderCMPR, CMPRInterpolation)
+{
+	// Four DXT1 blocks making up one 8x8 CMPR block. Every line selects
+	// colors 0, 1, 2 and 3 from left to right.
+	static const u8 src[32] = {
+		0xF8, 0x00, 0x00, 0x1F, 0x1B, 0x1B, 0x1B, 0x1B,  // red > blue: interpolated
+		0x00, 0x1F, 0xF8, 0x00, 0x1B, 0x1B, 0x1B, 0x1B,  // blue < red: average and transparent
+		0xF8, 0x00, 0x00, 0x1F, 0x1B, 0x1B, 0x1B, 0x1B,
+		0x00, 0x1F, 0xF8, 0x00, 0x1B, 0x1B, 0x1B, 0x1B,
+	};
+	u32 dst[8 * 8];
+
+	ASSERT_EQ(PC_TEX_FMT_RGBA32, TexDecoder_Decode((u8*)dst, src, 8, 8, GX_TF_CMPR, nullptr, GX_TL_IA8));
+
+	for (int y = 0; y < 8; ++y)
+	{
+		EXPECT_EQ(0xFF0000FFu, dst[y * 8 + 0]);
+		EXPECT_EQ(0xFFFF0000u, dst[y * 8 + 1]);
+		EXPECT_EQ(0xFF60009Fu, dst[y * 8 + 2]);
+		EXPECT_EQ(0xFF9F0060u, dst[y * 8 + 3]);
+
+		EXPECT_EQ(0xFFFF0000u, dst[y * 8 + 4]);
+		EXPECT_EQ(0xFF0000FFu, dst[y * 8 + 5]);
+		EXPECT_EQ(0xFF800080u, dst[y * 8 + 6]);
+		EXPECT_EQ(0x000000FFu, dst[y * 8 + 7]);
+	}
+}
@@ -1,6 +1,10 @@
+#include <cstdlib>
 #include <set>
+#include <vector>
 
 #include "Common/Common.h"
+#include "Common/CPUDetect.h"
+#include "Common/Timer.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/VertexLoader.h"
 
@@ -151,6 +155,184 @@ TEST_F(VertexLoaderTest, PositionDirectU16XY)
 	ExpectOut(21.0f); ExpectOut(12.0f); ExpectOut(0.0f);
 }
 
+// Scalar reference for the integer formats, used to check the vectorized
+// loaders that get selected at runtime.
+static float DequantizeReference(const u8* data, int format, float scale)
+{
+	switch (format)
+	{
+	case 0: return (float)data[0] * scale;
+	case 1: return (float)(s8)data[0] * scale;
+	case 2: return (float)(u16)((data[0] << 8) | data[1]) * scale;
+	case 3: return (float)(s16)((data[0] << 8) | data[1]) * scale;
+	}
+	return 0.f;
+}
+
+TEST_F(VertexLoaderTest, PositionQuantizedAllFormats)
+{
+	const int component_size[] = { 1, 1, 2, 2 };
+	u8* const array = &input_memory[8 * 1024 * 1024];
+	for (int i = 0; i < 1024; ++i)
+		array[i] = (u8)(i * 167 + 13);
+	cached_arraybases[ARRAY_POSITION] = array;
+	arraystrides[ARRAY_POSITION] = 7;
+
+	for (int mode = 1; mode <= 3; ++mode)
+	for (int format = 0; format <= 3; ++format)
+	for (int elements = 0; elements <= 1; ++elements)
+	{
+		SCOPED_TRACE(testing::Message() << "mode " << mode << " format " << format << " elements " << elements);
+		ResetPointers();
+		m_vtx_desc.Position = mode;
+		m_vtx_attr.g0.PosElements = elements;
+		m_vtx_attr.g0.PosFormat = format;
+		m_vtx_attr.g0.PosFrac = 3 * format;
+
+		const int count = elements ? 3 : 2;
+		const int size = component_size[format];
+		const float scale = 1.0f / (1U << (3 * format));
+		VertexLoader loader(m_vtx_desc, m_vtx_attr);
+
+		const u8* sources[32];
+		for (int v = 0; v < 32; ++v)
+		{
+			if (mode == 1)
+			{
+				sources[v] = &input_memory[m_input_pos];
+				for (int i = 0; i < count * size; ++i)
+					Input<u8>((u8)(v * 31 + i * 77 + 5));
+			}
+			else
+			{
+				const u8 index = (u8)(v * 5);
+				if (mode == 2)
+					Input<u8>(index);
+				else
+					Input<u16>(index);
+				sources[v] = array + index * 7;
+			}
+		}
+
+		loader.RunVertices(m_vtx_attr, 7, 32);
+
+		for (int v = 0; v < 32; ++v)
+		{
+			for (int i = 0; i < 3; ++i)
+				ExpectOut(i < count ? DequantizeReference(sources[v] + i * size, format, scale) : 0.f);
+		}
+	}
+}
+
+TEST_F(VertexLoaderTest, TexCoordQuantizedAllFormats)
+{
+	const int component_size[] = { 1, 1, 2, 2 };
+	u8* const array = &input_memory[8 * 1024 * 1024];
+	for (int i = 0; i < 1024; ++i)
+		array[i] = (u8)(i * 167 + 13);
+	cached_arraybases[ARRAY_POSITION] = array;
+	arraystrides[ARRAY_POSITION] = 16;
+	cached_arraybases[ARRAY_TEXCOORD0] = array;
+	arraystrides[ARRAY_TEXCOORD0] = 5;
+
+	for (int mode = 1; mode <= 3; ++mode)
+	for (int format = 0; format <= 3; ++format)
+	for (int elements = 0; elements <= 1; ++elements)
+	{
+		SCOPED_TRACE(testing::Message() << "mode " << mode << " format " << format << " elements " << elements);
+		ResetPointers();
+		m_vtx_desc.Position = 1;       // Direct
+		m_vtx_attr.g0.PosElements = 1; // XYZ
+		m_vtx_attr.g0.PosFormat = 4;   // Float
+		m_vtx_desc.Tex0Coord = mode;
+		m_vtx_attr.g0.Tex0CoordElements = elements;
+		m_vtx_attr.g0.Tex0CoordFormat = format;
+		m_vtx_attr.g0.Tex0Frac = 2 * format + 1;
+
+		const int count = elements ? 2 : 1;
+		const int size = component_size[format];
+		const float scale = 1.0f / (1U << (2 * format + 1));
+		VertexLoader loader(m_vtx_desc, m_vtx_attr);
+
+		const u8* sources[32];
+		for (int v = 0; v < 32; ++v)
+		{
+			Input(1.0f); Input(2.0f); Input(3.0f);
+			if (mode == 1)
+			{
+				sources[v] = &input_memory[m_input_pos];
+				for (int i = 0; i < count * size; ++i)
+					Input<u8>((u8)(v * 29 + i * 91 + 3));
+			}
+			else
+			{
+				const u8 index = (u8)(v * 3);
+				if (mode == 2)
+					Input<u8>(index);
+				else
+					Input<u16>(index);
+				sources[v] = array + index * 5;
+			}
+		}
+
+		loader.RunVertices(m_vtx_attr, 7, 32);
+
+		for (int v = 0; v < 32; ++v)
+		{
+			ExpectOut(1.0f); ExpectOut(2.0f); ExpectOut(3.0f);
+			for (int i = 0; i < count; ++i)
+				ExpectOut(DequantizeReference(sources[v] + i * size, format, scale));
+		}
+	}
+}
+
+TEST_F(VertexLoaderTest, QuantizedSSE2MatchesPortable)
+{
+	// Random vertex data, and an array that u16 indices can't reach past
+	// with these strides.
+	srand(0x27);
+	u8* const array = &input_memory[8 * 1024 * 1024];
+	for (int i = 0; i < 0x10000; ++i)
+		input_memory[i] = (u8)rand();
+	for (int i = 0; i < 0x80000; ++i)
+		array[i] = (u8)rand();
+	cached_arraybases[ARRAY_POSITION] = array;
+	arraystrides[ARRAY_POSITION] = 7;
+	cached_arraybases[ARRAY_TEXCOORD0] = array;
+	arraystrides[ARRAY_TEXCOORD0] = 5;
+
+	const CPUInfo old_cpu_info = cpu_info;
+	for (int mode = 1; mode <= 3; ++mode)
+	for (int format = 0; format <= 3; ++format)
+	for (int elements = 0; elements <= 1; ++elements)
+	{
+		SCOPED_TRACE(testing::Message() << "mode " << mode << " format " << format << " elements " << elements);
+		m_vtx_desc.Position = mode;
+		m_vtx_attr.g0.PosElements = elements;
+		m_vtx_attr.g0.PosFormat = format;
+		m_vtx_attr.g0.PosFrac = 5;
+		m_vtx_desc.Tex0Coord = mode;
+		m_vtx_attr.g0.Tex0CoordElements = elements;
+		m_vtx_attr.g0.Tex0CoordFormat = format;
+		m_vtx_attr.g0.Tex0Frac = 3;
+
+		// The loaders pick their functions when they are created.
+		cpu_info.bSSE2 = cpu_info.bSSE3 = cpu_info.bSSSE3 = cpu_info.bSSE4_1 = false;
+		VertexLoader portable(m_vtx_desc, m_vtx_attr);
+		cpu_info = old_cpu_info;
+		VertexLoader simd(m_vtx_desc, m_vtx_attr);
+
+		ResetPointers();
+		portable.RunVertices(m_vtx_attr, 7, 1000);
+		std::vector<u8> expected(&output_memory[0], VertexManager::s_pCurBufferPointer);
+
+		ResetPointers();
+		simd.RunVertices(m_vtx_attr, 7, 1000);
+		ASSERT_EQ(expected.size(), (size_t)(VertexManager::s_pCurBufferPointer - &output_memory[0]));
+		EXPECT_EQ(0, memcmp(expected.data(), &output_memory[0], expected.size()));
+	}
+}
+
 TEST_F(VertexLoaderTest, PositionDirectFloatXYZSpeed)
 {
 	m_vtx_desc.Position = 1;        // Direct
@@ -247,3 +429,84 @@ TEST_F(VertexLoaderTest, LargeFloatVertexSpeed)
 		loader.RunVertices(m_vtx_attr, 7, 100000);
 	}
 }
+
+// Measures the throughput of the most common attribute format combinations.
+// Indexed attributes read from a zeroed array at the start of input_memory.
+struct VertexFormatBenchmark
+{
+	const char* name;
+	int pos_mode, pos_format, pos_elements;
+	int nrm_mode, nrm_format;
+	int col_mode, col_format;
+	int tex_mode, tex_format;
+};
+
+static const VertexFormatBenchmark s_format_benchmarks[] = {
+	// name                  pos         nrm      col      tex0
+	{ "P-Dir-Flt3",          1, 4, 1,    0, 0,    0, 0,    0, 0 },
+	{ "P-Dir-S16-3",         1, 3, 1,    0, 0,    0, 0,    0, 0 },
+	{ "P-Idx16-Flt3",        3, 4, 1,    0, 0,    0, 0,    0, 0 },
+	{ "P-Idx16-S16-3",       3, 3, 1,    0, 0,    0, 0,    0, 0 },
+	{ "P-Idx8-S8-3",         2, 1, 1,    0, 0,    0, 0,    0, 0 },
+	{ "P-Dir-Flt3/C-RGBA8",  1, 4, 1,    0, 0,    1, 5,    0, 0 },
+	{ "P-Dir-Flt3/T-Flt2",   1, 4, 1,    0, 0,    0, 0,    1, 4 },
+	{ "P-Idx16-S16/T-Idx16-U16",
+	                         3, 3, 1,    0, 0,    0, 0,    3, 2 },
+	{ "P-Idx16-Flt/N-Idx16-S16/T-Idx16-Flt",
+	                         3, 4, 1,    3, 3,    0, 0,    3, 4 },
+	{ "P-Idx16-Flt/N-Idx16-S8/C-Idx16-RGBA8/T-Idx16-S16",
+	                         3, 4, 1,    3, 1,    3, 5,    3, 3 },
+	{ "P-Dir-Flt/N-Dir-Flt/C-Dir-RGBA8/T-Dir-Flt",
+	                         1, 4, 1,    1, 4,    1, 5,    1, 4 },
+	{ "P-Idx8-S16/C-Idx8-RGB565/T-Idx8-U8",
+	                         2, 3, 1,    0, 0,    2, 0,    2, 0 },
+};
+
+class VertexLoaderSpeedTest : public VertexLoaderTest,
+                              public testing::WithParamInterface<VertexFormatBenchmark>
+{
+};
+
+// Only prints timings, run it with --gtest_also_run_disabled_tests
+TEST_P(VertexLoaderSpeedTest, DISABLED_FormatThroughput)
+{
+	const VertexFormatBenchmark& b = GetParam();
+
+	m_vtx_desc.Position = b.pos_mode;
+	m_vtx_desc.Normal = b.nrm_mode;
+	m_vtx_desc.Color0 = b.col_mode;
+	m_vtx_desc.Tex0Coord = b.tex_mode;
+
+	m_vtx_attr.g0.PosElements = b.pos_elements;
+	m_vtx_attr.g0.PosFormat = b.pos_format;
+	m_vtx_attr.g0.NormalElements = 0;  // N only
+	m_vtx_attr.g0.NormalFormat = b.nrm_format;
+	m_vtx_attr.g0.Color0Elements = 1;  // Has Alpha
+	m_vtx_attr.g0.Color0Comp = b.col_format;
+	m_vtx_attr.g0.Tex0CoordElements = 1;  // ST
+	m_vtx_attr.g0.Tex0CoordFormat = b.tex_format;
+
+	for (int i = 0; i < 12; ++i)
+	{
+		cached_arraybases[i] = &input_memory[0];
+		arraystrides[i] = 16;
+	}
+
+	VertexLoader loader(m_vtx_desc, m_vtx_attr);
+
+	const int iterations = 20;
+	const int count = 100000;
+	u32 start = Common::Timer::GetTimeMs();
+	for (int i = 0; i < iterations; ++i)
+	{
+		ResetPointers();
+		loader.RunVertices(m_vtx_attr, 7, count);
+	}
+	u32 elapsed = std::max<u32>(Common::Timer::GetTimeMs() - start, 1);
+
+	printf("%-50s %4d bytes/vtx %8.2f Mvtx/s\n", b.name, loader.GetVertexSize(),
+	       (double)iterations * count / elapsed / 1000.0);
+}
+
+INSTANTIATE_TEST_CASE_P(CommonFormats, VertexLoaderSpeedTest,
+                        testing::ValuesIn(s_format_benchmarks));